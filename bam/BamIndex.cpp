@@ -17,17 +17,31 @@
 
 #include "BamIndex.h"
 #include <iomanip>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
 
 BamIndex::BamIndex()
     : IndexBase(),
       maxOverallOffset(0),
-      myUnMappedNumReads(-1)
+      myUnMappedNumReads(-1),
+      myLazyLoading(false),
+      myIsLazy(false),
+      myIndexMap(NULL),
+      myLazyRefs()
 {
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_init(&myLazyMutex, NULL);
+#endif
 }
 
 
 BamIndex::~BamIndex()
 {
+    freeLazyIndex();
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_destroy(&myLazyMutex);
+#endif
 }
 
 
@@ -38,6 +52,13 @@ void BamIndex::resetIndex()
 
     maxOverallOffset = 0;    
     myUnMappedNumReads = -1;
+    freeLazyIndex();
+}
+
+
+void BamIndex::setLazyLoading(bool lazy)
+{
+    myLazyLoading = lazy;
 }
 
 
@@ -47,6 +68,23 @@ SamStatus::Status BamIndex::readIndex(const char* filename)
     // Reset the index from anything that may previously be set.
     resetIndex();
 
+    if(myLazyLoading)
+    {
+        SamStatus::Status lazyStatus = readIndexLazy(filename);
+        if(lazyStatus == SamStatus::SUCCESS)
+        {
+            return(lazyStatus);
+        }
+        // Do not leave a partly read index behind.
+        resetIndex();
+        if(lazyStatus != SamStatus::FAIL_PARSE)
+        {
+            return(lazyStatus);
+        }
+        // Not an uncompressed BAI, so read it up front, which will
+        // handle compression or determine it is not an index.
+    }
+
     IFILE indexFile = ifopen(filename, "rb");
 
     // Failed to open the index file.
@@ -99,6 +137,11 @@ SamStatus::Status BamIndex::readIndex(const char* filename)
             ifclose(indexFile);
             return(SamStatus::FAIL_PARSE);
         }
+        if(ref->n_bin < 0)
+        {
+            ifclose(indexFile);
+            return(SamStatus::FAIL_PARSE);
+        }
 
         // If there are no bins, then there are no
         // mapped/unmapped reads.
@@ -124,6 +167,12 @@ SamStatus::Status BamIndex::readIndex(const char* filename)
                 ifclose(indexFile);
                 return(SamStatus::FAIL_IO);
             }
+            if(binNumber > MAX_NUM_BINS)
+            {
+                // Bin numbers are used to index the bins in a region.
+                ifclose(indexFile);
+                return(SamStatus::FAIL_PARSE);
+            }
 
             // Add the bin to the reference and get the
             // pointer back so the values can be set in it.
@@ -213,6 +262,298 @@ SamStatus::Status BamIndex::readIndex(const char* filename)
 }
 
 
+// Memory map the index file, recording where each reference starts and
+// its counts and min/max offsets.  Only marks the index as lazy if the
+// whole index was read; on failure the caller resets the index.
+SamStatus::Status BamIndex::readIndexLazy(const char* filename)
+{
+    // Check the magic before mapping the file since the index may be
+    // compressed.
+    FILE* indexFile = fopen(filename, "rb");
+    if(indexFile == NULL)
+    {
+        return(SamStatus::FAIL_IO);
+    }
+    char magic[4];
+    size_t magicSize = fread(magic, 1, 4, indexFile);
+    fclose(indexFile);
+    if((magicSize != 4) || (magic[0] != 'B') || (magic[1] != 'A') ||
+       (magic[2] != 'I') || (magic[3] != 1))
+    {
+        return(SamStatus::FAIL_PARSE);
+    }
+
+    myIndexMap = new MemoryMap();
+    // MemoryMap::open returns true on failure.
+    if(myIndexMap->open(filename))
+    {
+        delete myIndexMap;
+        myIndexMap = NULL;
+        return(SamStatus::FAIL_IO);
+    }
+    const char* data = (const char*)myIndexMap->data;
+    uint64_t length = myIndexMap->length();
+    uint64_t pos = 4;
+
+    if(pos + 4 > length)
+    {
+        return(SamStatus::FAIL_IO);
+    }
+    memcpy(&n_ref, data + pos, 4);
+    pos += 4;
+    if(n_ref < 0)
+    {
+        return(SamStatus::FAIL_PARSE);
+    }
+    myLazyRefs.resize(n_ref);
+
+    int32_t n_bin = 0;
+    uint32_t binNumber = 0;
+    int32_t n_chunk = 0;
+    int32_t n_intv = 0;
+    Chunk chunk;
+    for(int refIndex = 0; refIndex < n_ref; refIndex++)
+    {
+        LazyReference* ref = &(myLazyRefs[refIndex]);
+        ref->filePos = pos;
+        ref->minChunkOffset = Reference::UNSET_MIN_CHUNK_OFFSET;
+        ref->maxChunkOffset = 0;
+        ref->n_mapped = Reference::UNKNOWN_MAP_INFO;
+        ref->n_unmapped = Reference::UNKNOWN_MAP_INFO;
+        ref->bins = NULL;
+
+        if(pos + 4 > length)
+        {
+            return(SamStatus::FAIL_PARSE);
+        }
+        memcpy(&n_bin, data + pos, 4);
+        pos += 4;
+        if(n_bin < 0)
+        {
+            return(SamStatus::FAIL_PARSE);
+        }
+        // If there are no bins, then there are no mapped/unmapped reads.
+        if(n_bin == 0)
+        {
+            ref->n_mapped = 0;
+            ref->n_unmapped = 0;
+        }
+
+        // Skip over the bins, using the mapped/unmapped bin for the
+        // counts and min/max offsets if there is one, so the chunks
+        // of the other bins do not need to be read.
+        uint64_t binsPos = pos;
+        bool foundMaxBin = false;
+        for(int binIndex = 0; binIndex < n_bin; binIndex++)
+        {
+            if(pos + 8 > length)
+            {
+                return(SamStatus::FAIL_IO);
+            }
+            memcpy(&binNumber, data + pos, 4);
+            memcpy(&n_chunk, data + pos + 4, 4);
+            pos += 8;
+            if(binNumber > MAX_NUM_BINS)
+            {
+                // Bin numbers are used to index the bins in a region.
+                return(SamStatus::FAIL_PARSE);
+            }
+            if((n_chunk < 0) || (pos + n_chunk * sizeof(Chunk) > length))
+            {
+                return(SamStatus::FAIL_IO);
+            }
+            if((binNumber == MAX_NUM_BINS) && (n_chunk >= 2))
+            {
+                foundMaxBin = true;
+                memcpy(&chunk, data + pos, sizeof(Chunk));
+                ref->minChunkOffset = chunk.chunk_beg;
+                ref->maxChunkOffset = chunk.chunk_end;
+                memcpy(&chunk, data + pos + (n_chunk - 1) * sizeof(Chunk),
+                       sizeof(Chunk));
+                ref->n_mapped = chunk.chunk_beg;
+                ref->n_unmapped = chunk.chunk_end;
+            }
+            pos += n_chunk * sizeof(Chunk);
+        }
+        if(!foundMaxBin)
+        {
+            // No mapped/unmapped bin, so get the min/max from the chunks.
+            uint64_t binPos = binsPos;
+            for(int binIndex = 0; binIndex < n_bin; binIndex++)
+            {
+                memcpy(&n_chunk, data + binPos + 4, 4);
+                binPos += 8;
+                for(int i = 0; i < n_chunk; i++)
+                {
+                    memcpy(&chunk, data + binPos, sizeof(Chunk));
+                    binPos += sizeof(Chunk);
+                    if(chunk.chunk_beg < ref->minChunkOffset)
+                    {
+                        ref->minChunkOffset = chunk.chunk_beg;
+                    }
+                    if(chunk.chunk_end > ref->maxChunkOffset)
+                    {
+                        ref->maxChunkOffset = chunk.chunk_end;
+                    }
+                }
+            }
+        }
+        if(ref->maxChunkOffset > maxOverallOffset)
+        {
+            maxOverallOffset = ref->maxChunkOffset;
+        }
+
+        // Skip the linear index.
+        if(pos + 4 > length)
+        {
+            return(SamStatus::FAIL_IO);
+        }
+        memcpy(&n_intv, data + pos, 4);
+        pos += 4;
+        if((n_intv < 0) || (pos + n_intv * sizeof(uint64_t) > length))
+        {
+            return(SamStatus::FAIL_IO);
+        }
+        pos += n_intv * sizeof(uint64_t);
+    }
+
+    int32_t numUnmapped = 0;
+    if(pos + sizeof(int32_t) <= length)
+    {
+        memcpy(&numUnmapped, data + pos, sizeof(int32_t));
+        myUnMappedNumReads = numUnmapped;
+    }
+    myIsLazy = true;
+    return(SamStatus::SUCCESS);
+}
+
+
+// Load the bins & linear index of a reference in a lazily loaded index.
+const BamIndex::LazyBins* BamIndex::loadReference(int32_t refID) const
+{
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_lock(&myLazyMutex);
+#endif
+    LazyReference* ref = &(myLazyRefs[refID]);
+    if(ref->bins == NULL)
+    {
+        ref->bins = readLazyBins(ref->filePos);
+    }
+    const LazyBins* bins = ref->bins;
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_unlock(&myLazyMutex);
+#endif
+    return(bins);
+}
+
+
+// Read the bins & linear index of the reference at filePos in the index.
+BamIndex::LazyBins* BamIndex::readLazyBins(uint64_t filePos) const
+{
+    // The positions were validated when the index was read.
+    const char* data = (const char*)myIndexMap->data;
+    uint64_t pos = filePos;
+    int32_t n_bin = 0;
+    memcpy(&n_bin, data + pos, 4);
+    pos += 4;
+
+    // Find each bin, skipping the mapped/unmapped bin which is not used
+    // for finding chunks.
+    std::vector<std::pair<uint32_t, uint64_t> > binPositions;
+    binPositions.reserve(n_bin);
+    uint32_t binNumber = 0;
+    int32_t n_chunk = 0;
+    uint32_t numChunks = 0;
+    for(int binIndex = 0; binIndex < n_bin; binIndex++)
+    {
+        memcpy(&binNumber, data + pos, 4);
+        memcpy(&n_chunk, data + pos + 4, 4);
+        if(binNumber != MAX_NUM_BINS)
+        {
+            binPositions.push_back(std::make_pair(binNumber, pos));
+            numChunks += n_chunk;
+        }
+        pos += 8 + n_chunk * sizeof(Chunk);
+    }
+    std::sort(binPositions.begin(), binPositions.end());
+
+    LazyBins* bins = new LazyBins();
+    bins->binNumbers.reserve(binPositions.size());
+    bins->binChunks.reserve(binPositions.size() + 1);
+    bins->chunks.resize(numChunks);
+    uint32_t chunkIndex = 0;
+    for(unsigned int i = 0; i < binPositions.size(); i++)
+    {
+        uint64_t binPos = binPositions[i].second;
+        memcpy(&n_chunk, data + binPos + 4, 4);
+        bins->binNumbers.push_back(binPositions[i].first);
+        bins->binChunks.push_back(chunkIndex);
+        if(n_chunk > 0)
+        {
+            memcpy(&(bins->chunks[chunkIndex]), data + binPos + 8,
+                   n_chunk * sizeof(Chunk));
+        }
+        chunkIndex += n_chunk;
+    }
+    bins->binChunks.push_back(chunkIndex);
+
+    // Read the linear index.
+    int32_t n_intv = 0;
+    memcpy(&n_intv, data + pos, 4);
+    pos += 4;
+    bins->ioffsets.resize(n_intv);
+    if(n_intv > 0)
+    {
+        memcpy(&(bins->ioffsets[0]), data + pos, n_intv * sizeof(uint64_t));
+    }
+    return(bins);
+}
+
+
+void BamIndex::freeLazyIndex()
+{
+    for(unsigned int i = 0; i < myLazyRefs.size(); i++)
+    {
+        delete myLazyRefs[i].bins;
+    }
+    myLazyRefs.clear();
+    if(myIndexMap != NULL)
+    {
+        myIndexMap->close();
+        delete myIndexMap;
+        myIndexMap = NULL;
+    }
+    myIsLazy = false;
+}
+
+
+// Add the chunks that end at or after minOffset to the chunk list.
+bool BamIndex::addChunks(const Chunk* chunks, int numChunks,
+                         uint64_t minOffset, SortedChunkList& chunkList)
+{
+    for(int chunkIndex = 0; chunkIndex < numChunks; chunkIndex++)
+    {
+        // If the end of the chunk is less than the minimum offset
+        // for the 16K block that starts our region, then no
+        // records in this chunk will cross our region, so do
+        // not add it to the chunks we need to use.
+        if(chunks[chunkIndex].chunk_end < minOffset)
+        {
+            continue;
+        }
+        // Add the chunk to the map.
+        if(!chunkList.insert(chunks[chunkIndex]))
+        {
+            // Failed to add to the map, return false.
+            std::cerr << "Warning, Failed to add a chunk, so "
+                      << "no values will be returned.\n";
+            return(false);
+        }
+    }
+    return(true);
+}
+
+
 // Get the chunks for the specified reference id and start/end 0-based
 // coordinates.
 bool BamIndex::getChunksForRegion(int32_t refID, int32_t start, int32_t end, 
@@ -251,22 +592,23 @@ bool BamIndex::getChunksForRegion(int32_t refID, int32_t start, int32_t end,
         return(false);
     }
 
-    const Reference* ref = &(myRefs[refID]);
-
     // Handle where start/end are defaults.    
     if(start == -1)
     {
         if(end == -1)
         {
             // This is whole chromosome, so take a shortcut.
-            if(ref->maxChunkOffset == 0)
+            uint64_t minChunkOffset = 0;
+            uint64_t maxChunkOffset = 0;
+            getReferenceMinMax(refID, minChunkOffset, maxChunkOffset);
+            if(maxChunkOffset == 0)
             {
                 // No chunks for this region, but this is not an error.
                 return(true);
             }
             Chunk refChunk;
-            refChunk.chunk_beg = ref->minChunkOffset;
-            refChunk.chunk_end = ref->maxChunkOffset;
+            refChunk.chunk_beg = minChunkOffset;
+            refChunk.chunk_end = maxChunkOffset;
             return(chunkList.insert(refChunk));
         }
         else
@@ -289,6 +631,31 @@ bool BamIndex::getChunksForRegion(int32_t refID, int32_t start, int32_t end,
     
     getBinsForRegion(start, end, binInRangeMap);
 
+    if(myIsLazy)
+    {
+        // Loop through the sorted bins of the ref and if they are in
+        // the region, get the chunks.
+        const LazyBins* bins = loadReference(refID);
+        for(unsigned int i = 0; i < bins->binNumbers.size(); ++i)
+        {
+            if(binInRangeMap[bins->binNumbers[i]] == false)
+            {
+                // This bin is not in the region, so check the next one.
+                continue;
+            }
+            uint32_t firstChunk = bins->binChunks[i];
+            if(!addChunks(&(bins->chunks[0]) + firstChunk,
+                          bins->binChunks[i + 1] - firstChunk,
+                          minOffset, chunkList))
+            {
+                return(false);
+            }
+        }
+        return(chunkList.mergeOverlapping());
+    }
+
+    const Reference* ref = &(myRefs[refID]);
+
     // Loop through the bins in the ref and if they are in the region, get the chunks.
     for(int i = 0; i < ref->n_bin; ++i)
     {
@@ -300,24 +667,9 @@ bool BamIndex::getChunksForRegion(int32_t refID, int32_t start, int32_t end,
         }
 
         // Add each chunk in the bin to the map.
-        for(int chunkIndex = 0; chunkIndex < bin->n_chunk; chunkIndex++)
+        if(!addChunks(bin->chunks, bin->n_chunk, minOffset, chunkList))
         {
-            // If the end of the chunk is less than the minimum offset
-            // for the 16K block that starts our region, then no
-            // records in this chunk will cross our region, so do
-            // not add it to the chunks we need to use.
-            if(bin->chunks[chunkIndex].chunk_end < minOffset)
-            {
-                continue;
-            }
-            // Add the chunk to the map.
-            if(!chunkList.insert(bin->chunks[chunkIndex]))
-            {
-                // Failed to add to the map, return false.
-                std::cerr << "Warning, Failed to add a chunk, so "
-                          << "no values will be returned.\n";
-                return(false);
-            }
+            return(false);
         }
     }
 
@@ -338,19 +690,54 @@ bool BamIndex::getReferenceMinMax(int32_t refID,
                                   uint64_t& minOffset,
                                   uint64_t& maxOffset) const
 {
-    if((refID < 0) || (refID >= (int32_t)myRefs.size()))
+    if((refID < 0) || (refID >= n_ref))
     {
         // Reference ID is out of range for this index file.
         return(false);
     }
 
     // Get this reference.
-    minOffset = myRefs[refID].minChunkOffset;
-    maxOffset = myRefs[refID].maxChunkOffset;
+    if(myIsLazy)
+    {
+        minOffset = myLazyRefs[refID].minChunkOffset;
+        maxOffset = myLazyRefs[refID].maxChunkOffset;
+    }
+    else
+    {
+        minOffset = myRefs[refID].minChunkOffset;
+        maxOffset = myRefs[refID].maxChunkOffset;
+    }
     return(true);
 }
 
 
+// Returns the minimum offset of records that cross the 16K block that
+// contains the specified position for the given reference id.
+bool BamIndex::getMinOffsetFromLinearIndex(int32_t refID, uint32_t position,
+                                           uint64_t& minOffset) const
+{
+    if(!myIsLazy)
+    {
+        return(IndexBase::getMinOffsetFromLinearIndex(refID, position,
+                                                      minOffset));
+    }
+
+    minOffset = 0;
+    if((refID < 0) || (refID >= n_ref))
+    {
+        // out of range of the references, return false.
+        return(false);
+    }
+    const LazyBins* bins = loadReference(refID);
+    if(bins->ioffsets.empty())
+    {
+        return(false);
+    }
+    return(findMinOffset(&(bins->ioffsets[0]), bins->ioffsets.size(),
+                         position, minOffset));
+}
+
+
 // Get the number of mapped reads for this reference id.
 int32_t BamIndex::getNumMappedReads(int32_t refID)
 {
@@ -362,13 +749,17 @@ int32_t BamIndex::getNumMappedReads(int32_t refID)
        return(0);
    }
 
-    if((refID < 0) || (refID >= (int32_t)myRefs.size()))
+    if((refID < 0) || (refID >= n_ref))
     {
         // Reference ID is out of range for this index file.
         return(-1);
     }
 
     // Get this reference.
+    if(myIsLazy)
+    {
+        return(myLazyRefs[refID].n_mapped);
+    }
     return(myRefs[refID].n_mapped);
 }
 
@@ -383,13 +774,17 @@ int32_t BamIndex::getNumUnMappedReads(int32_t refID)
         return(myUnMappedNumReads);
     }
 
-    if((refID < 0) || (refID >= (int32_t)myRefs.size()))
+    if((refID < 0) || (refID >= n_ref))
     {
         // Reference ID is out of range for this index file.
         return(-1);
     }
 
     // Get this reference.
+    if(myIsLazy)
+    {
+        return(myLazyRefs[refID].n_unmapped);
+    }
     return(myRefs[refID].n_unmapped);
 }
 
@@ -401,7 +796,7 @@ void BamIndex::printIndex(int32_t refID, bool summary)
     std::cout << "# Reference Sequences: " << n_ref << std::endl;
 
     unsigned int startRef = 0;
-    unsigned int endRef = myRefs.size() - 1;
+    unsigned int endRef = n_ref - 1;
     std::vector<Reference> refsToProcess;
     if(refID != -1)
     {
@@ -410,6 +805,12 @@ void BamIndex::printIndex(int32_t refID, bool summary)
         endRef = refID;
     }
 
+    if(myIsLazy)
+    {
+        printLazyIndex(startRef, endRef, summary);
+        return;
+    }
+
     // Print out the information for each bin.
     for(unsigned int i = startRef; i <= endRef; ++i)
     {
@@ -488,3 +889,75 @@ void BamIndex::printIndex(int32_t refID, bool summary)
         }
     }
 }
+
+
+// Print the lazily loaded index information, loading each reference.
+// The mapped/unmapped bin is not part of the loaded bins, so is not
+// printed or counted.
+void BamIndex::printLazyIndex(unsigned int startRef, unsigned int endRef,
+                              bool summary)
+{
+    for(unsigned int i = startRef; i <= endRef; ++i)
+    {
+        const LazyReference* ref = &(myLazyRefs[i]);
+        const LazyBins* bins = loadReference(i);
+        std::cout << std::dec 
+                  << "\tReference ID: " << std::setw(4) << i
+                  << ";  #Bins: "<< std::setw(6) << bins->binNumbers.size()
+                  << ";  #Linear Index Entries: " 
+                  << std::setw(6) << bins->ioffsets.size()
+                  << ";  Min Chunk Offset: " 
+                  << std::setw(18) << std::hex << std::showbase << ref->minChunkOffset
+                  << ";  Max Chunk Offset: "
+                  << std::setw(18) << ref->maxChunkOffset
+                  << std::dec;
+        // Print the mapped/unmapped if set.
+        if(ref->n_mapped != Reference::UNKNOWN_MAP_INFO)
+        {            
+            std::cout << ";  " << ref->n_mapped << " Mapped Reads";
+            std::cout << ";  " << ref->n_unmapped << " Unmapped Reads";
+        }
+        std::cout << std::endl;
+
+        // Only print more details if not summary.
+        if(summary)
+        {
+            continue;
+        }
+        for(unsigned int binIndex = 0; binIndex < bins->binNumbers.size();
+            ++binIndex)
+        {
+            std::cout << "\t\t\tBin Name: " << bins->binNumbers[binIndex]
+                      << std::endl;
+            std::cout << "\t\t\t# Chunks: "
+                      << bins->binChunks[binIndex + 1] - bins->binChunks[binIndex]
+                      << std::endl;
+            std::cout << std::hex << std::showbase;
+            for(uint32_t chunkIndex = bins->binChunks[binIndex];
+                chunkIndex < bins->binChunks[binIndex + 1]; ++chunkIndex)
+            {
+                std::cout << "\t\t\t\tchunk_beg: "
+                          << bins->chunks[chunkIndex].chunk_beg 
+                          << std::endl;
+                std::cout << "\t\t\t\tchunk_end: "
+                          << bins->chunks[chunkIndex].chunk_end
+                          << std::endl;
+            }
+            std::cout << std::dec;
+        }
+
+        // Print the linear index.
+        for(unsigned int linearIndex = 0;
+            linearIndex < bins->ioffsets.size(); ++linearIndex)
+        {
+            if(bins->ioffsets[linearIndex] != 0)
+            {
+                std::cout << "\t\t\tLinearIndex["
+                          << std::dec << linearIndex << "] Offset: " 
+                          << std::hex << bins->ioffsets[linearIndex]
+                          << std::endl;
+            }
+        }
+        std::cout << std::dec;
+    }
+}
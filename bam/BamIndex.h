@@ -22,10 +22,14 @@
 #include <vector>
 #include <map>
 #include <stdlib.h>
+#ifdef __PTHREAD_AVAILABLE__
+#include <pthread.h>
+#endif
 
 #include "IndexBase.h"
 
 #include "InputFile.h"
+#include "MemoryMap.h"
 #include "SamStatus.h"
 
 class BamIndex : public IndexBase
@@ -38,6 +42,19 @@ public:
     /// Reset the member data for a new index file.
     virtual void resetIndex();
 
+    /// Set whether or not readIndex should load the index lazily.  When
+    /// lazy, readIndex memory maps the index file and only finds where
+    /// each reference is in it (and its counts and min/max offsets), and a
+    /// reference's bins and linear index are loaded into compact sorted
+    /// arrays the first time it is queried.  This makes opening the index
+    /// of an assembly with many references fast when only a few of them
+    /// are queried.  Compressed index files are always loaded up front.
+    /// Loading a reference is locked, so a lazy index can be queried from
+    /// several threads like one that was loaded up front.
+    /// Applies to the next readIndex call, defaults to false.
+    /// \param lazy true to load references as they are queried.
+    void setLazyLoading(bool lazy);
+
     // Read & parse the specified index file.
     /// \param filename the bam index file to be read.
     /// \return the status of the read.
@@ -52,6 +69,11 @@ public:
 
     uint64_t getMaxOffset() const;
 
+    /// Returns the minimum offset of records that cross the 16K block that
+    /// contains the specified position for the given reference id.
+    virtual bool getMinOffsetFromLinearIndex(int32_t refID, uint32_t position,
+                                             uint64_t& minOffset) const;
+
     /// Get the minimum and maximum file offsets for the specfied reference ID.
     /// \param refID the reference ID to locate in the file.
     /// \param minOffset returns the min file offset for the specified reference
@@ -89,9 +111,69 @@ public:
     static const int32_t REF_ID_ALL = -2;
 
 private:
+    BamIndex(const BamIndex& other);
+    BamIndex& operator=(const BamIndex& other);
+
+    // Bins and linear index of a lazily loaded reference.  Bins are
+    // sorted by bin number, with their chunks stored contiguously.
+    struct LazyBins
+    {
+        std::vector<uint32_t> binNumbers;
+        // Index into chunks of each bin's first chunk, plus the end.
+        std::vector<uint32_t> binChunks;
+        std::vector<Chunk> chunks;
+        std::vector<uint64_t> ioffsets;
+    };
+
+    // A reference of a lazily loaded index.
+    struct LazyReference
+    {
+        // Position of the reference in the index file.
+        uint64_t filePos;
+        uint64_t minChunkOffset;
+        uint64_t maxChunkOffset;
+        int32_t n_mapped;
+        int32_t n_unmapped;
+        // NULL until the reference is first queried.
+        LazyBins* bins;
+    };
+
+    // Memory map the index and find each reference in it.  Returns
+    // FAIL_PARSE without reading if it is not an uncompressed BAI file.
+    SamStatus::Status readIndexLazy(const char* filename);
+
+    // Load the bins of a lazily loaded reference if not yet loaded.  Const
+    // so the const queries can use it; the loaded bins are cached in
+    // myLazyRefs under myLazyMutex.
+    const LazyBins* loadReference(int32_t refID) const;
+
+    // Read the bins of the lazily loaded reference at filePos.
+    LazyBins* readLazyBins(uint64_t filePos) const;
+
+    // Print the index information of a lazily loaded index.
+    void printLazyIndex(unsigned int startRef, unsigned int endRef,
+                        bool summary);
+
+    // Free the lazily loaded references and unmap the file.
+    void freeLazyIndex();
+
+    // Add the chunks that end at or after minOffset to the chunk list.
+    static bool addChunks(const Chunk* chunks, int numChunks,
+                          uint64_t minOffset, SortedChunkList& chunkList);
+
     uint64_t maxOverallOffset;
 
     int32_t myUnMappedNumReads;
+
+    bool myLazyLoading;
+    // Set if the current index was loaded lazily.
+    bool myIsLazy;
+    MemoryMap* myIndexMap;
+    // Only the bins are changed after the index is read, by loadReference.
+    mutable std::vector<LazyReference> myLazyRefs;
+#ifdef __PTHREAD_AVAILABLE__
+    mutable pthread_mutex_t myLazyMutex;
+#endif
 };
 
 
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BamIndexBuilder.h"
+
+BamIndexBuilder::BamIndexBuilder()
+    : IndexBuilder()
+{
+}
+
+
+BamIndexBuilder::~BamIndexBuilder()
+{
+}
+
+
+void BamIndexBuilder::reset(const SamReferenceInfo& refInfo)
+{
+    int64_t maxLength = 0;
+    for(int i = 0; i < refInfo.getNumEntries(); i++)
+    {
+        if(refInfo.getReferenceLength(i) > maxLength)
+        {
+            maxLength = refInfo.getReferenceLength(i);
+        }
+    }
+    IndexBuilder::reset(refInfo.getNumEntries(), maxLength, false);
+}
+
+
+bool BamIndexBuilder::writeHeader(IFILE indexFile)
+{
+    if(isCsi())
+    {
+        // BAM CSI indexes have no auxiliary data.
+        return(writeCsiHeader(indexFile, ""));
+    }
+    int32_t numRefs = getNumRefs();
+    return((ifwrite(indexFile, "BAI\1", 4) == 4) &&
+           (ifwrite(indexFile, &numRefs, 4) == 4));
+}
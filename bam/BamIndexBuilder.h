@@ -0,0 +1,56 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BAM_INDEX_BUILDER_H__
+#define __BAM_INDEX_BUILDER_H__
+
+#include "IndexBuilder.h"
+#include "SamReferenceInfo.h"
+#include "SamStatus.h"
+
+/// Builds a BAM index (BAI, or CSI for references longer than BAI
+/// supports) from the records of a coordinate sorted BAM file as they are
+/// written, so the file does not need to be read again to index it.
+/// See IndexBuilder for adding records and writing the index.
+class BamIndexBuilder : public IndexBuilder
+{
+public:
+    BamIndexBuilder();
+    ~BamIndexBuilder();
+
+    /// Reset the builder for a new BAM file.  Picks CSI if a reference is
+    /// longer than BAI supports, otherwise BAI.
+    /// \param refInfo reference information from the BAM header.
+    void reset(const SamReferenceInfo& refInfo);
+
+    /// Returns the index file extension, ".bai" or ".csi".
+    const char* getExtension() const
+    {
+        return(isCsi() ? ".csi" : ".bai");
+    }
+
+protected:
+    // BAI indexes are not compressed, CSI indexes are.
+    virtual bool isIndexCompressed() const
+    {
+        return(isCsi());
+    }
+
+    virtual bool writeHeader(IFILE indexFile);
+};
+
+#endif
@@ -223,6 +223,17 @@ void BamInterface::readRecord(IFILE filePtr, SamFileHeader& header,
     }
 }
 
+void BamInterface::readRecord(IFILE filePtr, SamFileHeader& header,
+                              BamRecordView& record, 
+                              SamStatus& samStatus)
+{
+    if(record.setBufferFromFile(filePtr) != SamStatus::SUCCESS)
+    {
+        // Failed, so add the error message.
+        samStatus.addError(record.getStatus());
+    }
+}
+
 SamStatus::Status BamInterface::writeRecord(IFILE filePtr, 
                                             SamFileHeader& header,
                                             SamRecord& record,
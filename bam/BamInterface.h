@@ -43,6 +43,13 @@ public:
                             SamFileHeader& header,
                             SamRecord& record, 
                             SamStatus& samStatus);
+
+    // Reads the next record from the specified BAM file into the passed in
+    // view.
+    virtual void readRecord(IFILE filePtr, 
+                            SamFileHeader& header,
+                            BamRecordView& record, 
+                            SamStatus& samStatus);
    
     // Writes the specified record into the specified BAM file.
     virtual SamStatus::Status writeRecord(IFILE filePtr, 
@@ -0,0 +1,392 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+
+#include "BamRecordView.h"
+#include "BaseUtilities.h"
+
+
+BamRecordView::BamRecordView()
+    : myRecordPtr(NULL),
+      myBuffer(NULL),
+      myBufferAllocatedSize(0),
+      myStatus()
+{
+}
+
+
+BamRecordView::~BamRecordView()
+{
+    free(myBuffer);
+    myBuffer = NULL;
+    myRecordPtr = NULL;
+}
+
+
+SamStatus::Status BamRecordView::setBufferFromFile(IFILE filePtr)
+{
+    myStatus = SamStatus::SUCCESS;
+    myRecordPtr = NULL;
+    if((filePtr == NULL) || (filePtr->isOpen() == false))
+    {
+        // File is not open, return failure.
+        myStatus.setStatus(SamStatus::FAIL_ORDER,
+                           "Can't read from an unopened file.");
+        return(SamStatus::FAIL_ORDER);
+    }
+
+    // read the record size.
+    int32_t blockSize = 0;
+    int numBytes = ifread(filePtr, &blockSize, sizeof(int32_t));
+
+    // Check to see if the end of the file was hit and no bytes were read.
+    if(ifeof(filePtr) && (numBytes == 0))
+    {
+        // End of file, nothing was read, no more records.
+        std::string statusMsg = "No more records left to read, ";
+        statusMsg += filePtr->getFileName();
+        statusMsg += ".";
+        myStatus.setStatus(SamStatus::NO_MORE_RECS, statusMsg.c_str());
+        return(SamStatus::NO_MORE_RECS);
+    }
+
+    if(numBytes != sizeof(int32_t))
+    {
+        // Failed to read the entire block size.  Either the end of the file
+        // was reached early or there was an error.
+        std::string statusMsg = ifeof(filePtr) ?
+            "EOF reached in the middle of a record, " :
+            "Failed to read the record size, ";
+        statusMsg += filePtr->getFileName();
+        statusMsg += ".";
+        myStatus.setStatus(ifeof(filePtr) ? SamStatus::FAIL_PARSE :
+                           SamStatus::FAIL_IO, statusMsg.c_str());
+        return(myStatus.getStatus());
+    }
+
+    // The fixed fields must all be there.
+    int recordSize = blockSize + sizeof(int32_t);
+    if(recordSize < (int)sizeof(bamRecordStruct))
+    {
+        std::string statusMsg = "Invalid record size, ";
+        statusMsg += filePtr->getFileName();
+        statusMsg += ".";
+        myStatus.setStatus(SamStatus::FAIL_PARSE, statusMsg.c_str());
+        return(SamStatus::FAIL_PARSE);
+    }
+
+    // Grow the buffer if the record does not fit.
+    if(recordSize > myBufferAllocatedSize)
+    {
+        char* newBuffer = (char*)realloc(myBuffer, recordSize);
+        if(newBuffer == NULL)
+        {
+            myStatus.setStatus(SamStatus::FAIL_MEM,
+                               "Failed to Allocate Memory.");
+            return(SamStatus::FAIL_MEM);
+        }
+        myBuffer = newBuffer;
+        myBufferAllocatedSize = recordSize;
+    }
+
+    // Read the rest of the alignment block, starting at the reference id.
+    memcpy(myBuffer, &blockSize, sizeof(int32_t));
+    if(ifread(filePtr, myBuffer + sizeof(int32_t), blockSize)
+       != (unsigned int)blockSize)
+    {
+        std::string statusMsg = "Failed to read the record, ";
+        statusMsg += filePtr->getFileName();
+        statusMsg += ".";
+        myStatus.setStatus(SamStatus::FAIL_IO, statusMsg.c_str());
+        return(SamStatus::FAIL_IO);
+    }
+
+    myRecordPtr = (const bamRecordStruct*)myBuffer;
+    return(SamStatus::SUCCESS);
+}
+
+
+void BamRecordView::setBuffer(const void* bamRecord)
+{
+    myStatus = SamStatus::SUCCESS;
+    myRecordPtr = (const bamRecordStruct*)bamRecord;
+}
+
+
+int32_t BamRecordView::get0BasedAlignmentEnd() const
+{
+    int32_t alignmentLength = getAlignmentLength();
+    if(alignmentLength == 0)
+    {
+        // Length is 0, just return the start position.
+        return(myRecordPtr->myPosition);
+    }
+    return(myRecordPtr->myPosition + alignmentLength - 1);
+}
+
+
+int32_t BamRecordView::getAlignmentLength() const
+{
+    // Sum the operations that consume the reference: M, D, N, =, X.
+    static const uint32_t REF_OPS =
+        (1 << 0) | (1 << 2) | (1 << 3) | (1 << 7) | (1 << 8);
+
+    int32_t alignmentLength = 0;
+    for(int i = 0; i < myRecordPtr->myCigarLength; i++)
+    {
+        uint32_t cigarOp = getPackedCigar(i);
+        if(REF_OPS & (1 << (cigarOp & 0xF)))
+        {
+            alignmentLength += cigarOp >> 4;
+        }
+    }
+    return(alignmentLength);
+}
+
+
+uint32_t BamRecordView::getPackedCigar(int index) const
+{
+    // The cigar follows the read name so may not be aligned.
+    uint32_t cigarOp;
+    memcpy(&cigarOp, myRecordPtr->myData + myRecordPtr->myReadNameLength +
+           index * sizeof(uint32_t), sizeof(uint32_t));
+    return(cigarOp);
+}
+
+
+char BamRecordView::getSequence(int index) const
+{
+    static const char * asciiBases = "=AC.G...T......N";
+
+    int32_t readLen = getReadLength();
+    if(readLen == 0)
+    {
+        String exceptionString = "BamRecordView::getSequence(";
+        exceptionString += index;
+        exceptionString += ") is not allowed since sequence = '*'";
+        throw std::runtime_error(exceptionString.c_str());
+    }
+    else if((index < 0) || (index >= readLen))
+    {
+        String exceptionString = "BamRecordView::getSequence(";
+        exceptionString += index;
+        exceptionString += ") is out of range. Index must be between 0 and ";
+        exceptionString += (readLen - 1);
+        throw std::runtime_error(exceptionString.c_str());
+    }
+
+    const uint8_t* packedSequence = getPackedSequence();
+    return(index & 1 ?
+           asciiBases[packedSequence[index / 2] & 0xF] :
+           asciiBases[packedSequence[index / 2] >> 4]);
+}
+
+
+char BamRecordView::getQuality(int index) const
+{
+    int32_t readLen = getReadLength();
+    if(readLen == 0)
+    {
+        return(BaseUtilities::UNKNOWN_QUALITY_CHAR);
+    }
+    else if((index < 0) || (index >= readLen))
+    {
+        String exceptionString = "BamRecordView::getQuality(";
+        exceptionString += index;
+        exceptionString += ") is out of range. Index must be between 0 and ";
+        exceptionString += (readLen - 1);
+        throw std::runtime_error(exceptionString.c_str());
+    }
+
+    const uint8_t* packedQuality = getPackedQuality();
+    if(packedQuality[0] == 0xFF)
+    {
+        // No qualities, '*'.
+        return(BaseUtilities::UNKNOWN_QUALITY_CHAR);
+    }
+    return(packedQuality[index] + 33);
+}
+
+
+uint32_t BamRecordView::getTagLength() const
+{
+    const char* tagStart = (const char*)getPackedQuality() +
+        myRecordPtr->myReadLength;
+    const char* recordEnd = (const char*)myRecordPtr +
+        myRecordPtr->myBlockSize + sizeof(int32_t);
+    return(recordEnd - tagStart);
+}
+
+
+const void* BamRecordView::findTag(const char* tag, char& vtype) const
+{
+    const char* tagPtr = (const char*)getPackedQuality() +
+        myRecordPtr->myReadLength;
+    const char* recordEnd = (const char*)myRecordPtr +
+        myRecordPtr->myBlockSize + sizeof(int32_t);
+
+    // Each tag is 2 characters of tag name, a type character, and the
+    // value.
+    while(tagPtr + 3 <= recordEnd)
+    {
+        const char* value = tagPtr + 3;
+        if((tagPtr[0] == tag[0]) && (tagPtr[1] == tag[1]))
+        {
+            vtype = tagPtr[2];
+            return(value);
+        }
+        int valueSize = getTagValueSize(tagPtr[2], value);
+        if(valueSize < 0)
+        {
+            // Unknown type, so the rest of the tags can't be parsed.
+            break;
+        }
+        tagPtr = value + valueSize;
+    }
+    return(NULL);
+}
+
+
+bool BamRecordView::getIntegerTag(const char* tag, int& tagVal) const
+{
+    char vtype;
+    const void* value = findTag(tag, vtype);
+    if(value == NULL)
+    {
+        return(false);
+    }
+    switch(vtype)
+    {
+        case 'A':
+            tagVal = *(const char*)value;
+            return(true);
+        case 'c':
+            tagVal = *(const int8_t*)value;
+            return(true);
+        case 'C':
+            tagVal = *(const uint8_t*)value;
+            return(true);
+        case 's':
+        {
+            int16_t val;
+            memcpy(&val, value, sizeof(val));
+            tagVal = val;
+            return(true);
+        }
+        case 'S':
+        {
+            uint16_t val;
+            memcpy(&val, value, sizeof(val));
+            tagVal = val;
+            return(true);
+        }
+        case 'i':
+        {
+            int32_t val;
+            memcpy(&val, value, sizeof(val));
+            tagVal = val;
+            return(true);
+        }
+        case 'I':
+        {
+            uint32_t val;
+            memcpy(&val, value, sizeof(val));
+            tagVal = val;
+            return(true);
+        }
+        default:
+            return(false);
+    }
+}
+
+
+bool BamRecordView::getFloatTag(const char* tag, float& tagVal) const
+{
+    char vtype;
+    const void* value = findTag(tag, vtype);
+    if((value == NULL) || (vtype != 'f'))
+    {
+        return(false);
+    }
+    memcpy(&tagVal, value, sizeof(float));
+    return(true);
+}
+
+
+const char* BamRecordView::getStringTag(const char* tag) const
+{
+    char vtype;
+    const void* value = findTag(tag, vtype);
+    if((value == NULL) || ((vtype != 'Z') && (vtype != 'H')))
+    {
+        return(NULL);
+    }
+    return((const char*)value);
+}
+
+
+int BamRecordView::getTagValueSize(char vtype, const char* value)
+{
+    switch(vtype)
+    {
+        case 'Z':
+        case 'H':
+            return(strlen(value) + 1);
+        case 'B':
+        {
+            // Subtype, count, then the values.
+            int elementSize = getNumericTypeSize(value[0]);
+            if(elementSize == 0)
+            {
+                return(-1);
+            }
+            int32_t count;
+            memcpy(&count, value + 1, sizeof(int32_t));
+            return(1 + sizeof(int32_t) + count * elementSize);
+        }
+        default:
+        {
+            int size = getNumericTypeSize(vtype);
+            return((size == 0) ? -1 : size);
+        }
+    }
+}
+
+
+int BamRecordView::getNumericTypeSize(char vtype)
+{
+    switch(vtype)
+    {
+        case 'A':
+        case 'c':
+        case 'C':
+            return(1);
+        case 's':
+        case 'S':
+            return(2);
+        case 'i':
+        case 'I':
+        case 'f':
+            return(4);
+        default:
+            // Not a numeric type.
+            return(0);
+    }
+}
@@ -0,0 +1,190 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BAM_RECORD_VIEW_H__
+#define __BAM_RECORD_VIEW_H__
+
+#include <stdint.h>
+#include "SamStatus.h"
+#include "InputFile.h"
+#include "SamRecord.h"
+
+/// Read-only view of a BAM record that works directly on the BAM
+/// formatted bytes.  Unlike SamRecord, nothing is unpacked when a record
+/// is read: fields are decoded when they are requested, the sequence and
+/// quality are read from their packed form, and tags are found by
+/// scanning the tag bytes.  Once the record buffer has grown to fit the
+/// largest record, reading and accessing records does not allocate.
+/// Use it for read-only passes like filtering and counting; use SamRecord
+/// to modify or write records.
+class BamRecordView
+{
+public:
+    /// Constructor.
+    BamRecordView();
+
+    /// Destructor.
+    ~BamRecordView();
+
+    /// Read the next BAM record from the specified file into this view's
+    /// buffer (reused from record to record).  SamFile::ReadRecord should
+    /// normally be used instead, this is for reading the file directly.
+    /// \param filePtr BAM file positioned at the start of a record.
+    /// \return status of the read, NO_MORE_RECS at the end of the file.
+    SamStatus::Status setBufferFromFile(IFILE filePtr);
+
+    /// View the specified BAM formatted record, like the one returned by
+    /// SamRecord::getRecordBuffer.  The record is not copied, so it must
+    /// not change or be freed while it is viewed.
+    /// \param bamRecord BAM formatted record, starting with its block size.
+    void setBuffer(const void* bamRecord);
+
+    /// Returns whether or not there is a record to view.
+    bool isValid() const
+    {
+        return(myRecordPtr != NULL);
+    }
+
+    /// Get a const pointer to the BAM formatted record being viewed.
+    const void* getRecordBuffer() const
+    {
+        return(myRecordPtr);
+    }
+
+    ///////////////////////
+    /// @name  Get Fields
+    /// Get methods for the record fields, see the SamRecord methods of the
+    /// same name.
+    //@{
+    int32_t getBlockSize() const {return(myRecordPtr->myBlockSize);}
+    int32_t getReferenceID() const {return(myRecordPtr->myReferenceID);}
+    int32_t get1BasedPosition() const {return(myRecordPtr->myPosition + 1);}
+    int32_t get0BasedPosition() const {return(myRecordPtr->myPosition);}
+    uint8_t getReadNameLength() const {return(myRecordPtr->myReadNameLength);}
+    uint8_t getMapQuality() const {return(myRecordPtr->myMapQuality);}
+    uint16_t getBin() const {return(myRecordPtr->myBin);}
+    uint16_t getCigarLength() const {return(myRecordPtr->myCigarLength);}
+    uint16_t getFlag() const {return(myRecordPtr->myFlag);}
+    int32_t getReadLength() const {return(myRecordPtr->myReadLength);}
+    int32_t getMateReferenceID() const {return(myRecordPtr->myMateReferenceID);}
+    int32_t get1BasedMatePosition() const {return(myRecordPtr->myMatePosition + 1);}
+    int32_t get0BasedMatePosition() const {return(myRecordPtr->myMatePosition);}
+    int32_t getInsertSize() const {return(myRecordPtr->myInsertSize);}
+
+    /// Returns the 0-based inclusive rightmost position of the alignment
+    /// (the start position if the alignment has no length), computed from
+    /// the packed cigar.
+    int32_t get0BasedAlignmentEnd() const;
+
+    /// Returns the 1-based inclusive rightmost position of the alignment.
+    int32_t get1BasedAlignmentEnd() const {return(get0BasedAlignmentEnd() + 1);}
+
+    /// Returns the number of reference bases covered by the cigar.
+    int32_t getAlignmentLength() const;
+
+    /// Returns the null terminated read name, pointing into the record.
+    const char* getReadName() const
+    {
+        return(myRecordPtr->myData);
+    }
+
+    /// Returns the specified cigar operation in its packed BAM form:
+    /// length << 4 | operation, where operation indexes "MIDNSHP=X".
+    /// \param index index of the operation, 0 to getCigarLength() - 1.
+    uint32_t getPackedCigar(int index) const;
+
+    /// Returns the 4-bit packed sequence (2 bases per byte, the first base
+    /// in the high nibble), pointing into the record.
+    const uint8_t* getPackedSequence() const
+    {
+        return((const uint8_t*)myRecordPtr->myData +
+               myRecordPtr->myReadNameLength +
+               myRecordPtr->myCigarLength * sizeof(uint32_t));
+    }
+
+    /// Returns the phred qualities without the +33 offset (0xFF if the
+    /// quality is '*'), pointing into the record.
+    const uint8_t* getPackedQuality() const
+    {
+        return(getPackedSequence() + (myRecordPtr->myReadLength + 1) / 2);
+    }
+
+    /// Returns the base at the specified index of the sequence, decoded
+    /// from the packed sequence the same way SamRecord::getSequence(int)
+    /// does.  Throws an exception if the index is out of range.
+    char getSequence(int index) const;
+
+    /// Returns the quality character (phred + 33) at the specified index,
+    /// or BaseUtilities::UNKNOWN_QUALITY_CHAR if there are no qualities.
+    /// Throws an exception if the index is out of range.
+    char getQuality(int index) const;
+    //@}
+
+    ///////////////////////
+    /// @name  Get Tag Methods
+    /// Tags are found by scanning the record's tag bytes each call.
+    //@{
+
+    /// Returns the length of the BAM formatted tags.
+    uint32_t getTagLength() const;
+
+    /// Find the specified tag, returning a pointer to its value in the
+    /// record and setting vtype to its BAM type, or NULL if it is not found.
+    /// \param tag 2 character tag name.
+    /// \param vtype set to the BAM type of the tag (A, c, C, s, S, i, I, f,
+    /// Z, H, or B).
+    const void* findTag(const char* tag, char& vtype) const;
+
+    /// Get the value of the specified integer (or character) tag.
+    /// \return true if the tag was found and is an integer type.
+    bool getIntegerTag(const char* tag, int& tagVal) const;
+
+    /// Get the value of the specified float tag.
+    /// \return true if the tag was found and is a float.
+    bool getFloatTag(const char* tag, float& tagVal) const;
+
+    /// Returns the null terminated value of the specified string (Z or H)
+    /// tag, pointing into the record, or NULL if there is no such tag.
+    const char* getStringTag(const char* tag) const;
+    //@}
+
+    /// Returns the status associated with the last read.
+    const SamStatus& getStatus() const
+    {
+        return(myStatus);
+    }
+
+private:
+    BamRecordView(const BamRecordView& other);
+    BamRecordView& operator=(const BamRecordView& other);
+
+    // Returns the size of a tag value of the specified type, -1 if unknown.
+    static int getTagValueSize(char vtype, const char* value);
+
+    // Returns the size of a numeric tag type, 0 if it is not numeric.
+    static int getNumericTypeSize(char vtype);
+
+    const bamRecordStruct* myRecordPtr;
+
+    // Buffer that records read from a file are stored in.
+    char* myBuffer;
+    int myBufferAllocatedSize;
+
+    SamStatus myStatus;
+};
+
+#endif
@@ -0,0 +1,389 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdexcept>
+#include "BamShardRunner.h"
+
+// Number of bits in a linear index window.
+static const int WINDOW_SHIFT = 14;
+
+
+void BamShardRunner::getShards(const BamIndex& index, SamFileHeader& header,
+                               int numShards, std::vector<Shard>& shards)
+{
+    shards.clear();
+    if(numShards < 1)
+    {
+        numShards = 1;
+    }
+
+    const SamReferenceInfo& refInfo = header.getReferenceInfo();
+    int32_t numRefs = index.getNumRefs();
+    if(refInfo.getNumEntries() < numRefs)
+    {
+        numRefs = refInfo.getNumEntries();
+    }
+
+    // Get the compressed size of all of the references, from the BGZF
+    // block addresses of their first and last records.
+    uint64_t totalSize = 0;
+    uint64_t minOffset = 0;
+    uint64_t maxOffset = 0;
+    for(int32_t refID = 0; refID < numRefs; refID++)
+    {
+        if(index.getReferenceMinMax(refID, minOffset, maxOffset) &&
+           (maxOffset != 0))
+        {
+            totalSize += (maxOffset >> 16) - (minOffset >> 16) + 1;
+        }
+    }
+    uint64_t shardSize = totalSize / numShards;
+    if(shardSize < 1)
+    {
+        shardSize = 1;
+    }
+
+    // Split each reference at the first linear index window that has
+    // at least shardSize bytes before it.
+    for(int32_t refID = 0; refID < numRefs; refID++)
+    {
+        if(!index.getReferenceMinMax(refID, minOffset, maxOffset) ||
+           (maxOffset == 0))
+        {
+            // No records for this reference.
+            continue;
+        }
+        Shard shard;
+        shard.refID = refID;
+        shard.start = 0;
+        uint64_t shardAddress = minOffset >> 16;
+
+        int32_t refLength = refInfo.getReferenceLength(refID);
+        for(int32_t window = 1;
+            (int64_t(window) << WINDOW_SHIFT) < refLength; window++)
+        {
+            int32_t position = window << WINDOW_SHIFT;
+            uint64_t windowOffset = 0;
+            if(!index.getMinOffsetFromLinearIndex(refID, position,
+                                                  windowOffset))
+            {
+                // Past the end of the linear index.
+                break;
+            }
+            uint64_t windowAddress = windowOffset >> 16;
+            if((windowAddress > shardAddress) &&
+               (windowAddress - shardAddress >= shardSize))
+            {
+                shard.end = position;
+                shard.size = windowAddress - shardAddress;
+                shards.push_back(shard);
+                shard.start = position;
+                shardAddress = windowAddress;
+            }
+        }
+
+        // The last shard goes to the end of the reference.
+        shard.end = -1;
+        shard.size = 1;
+        if((maxOffset >> 16) >= shardAddress)
+        {
+            shard.size += (maxOffset >> 16) - shardAddress;
+        }
+        shards.push_back(shard);
+    }
+}
+
+
+BamShardRunner::BamShardRunner(int numWorkers)
+    : myNumWorkers(numWorkers),
+      myMaxShardLength(0),
+      myBamFilename(),
+      myIndexFilename(),
+      myProcessor(NULL),
+      myShards(),
+      myNextShard(0),
+      myFailed(false),
+      myStatus(ErrorHandler::RETURN)
+{
+    if(myNumWorkers < 1)
+    {
+        myNumWorkers = 1;
+    }
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_init(&myMutex, NULL);
+#endif
+}
+
+
+BamShardRunner::~BamShardRunner()
+{
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_destroy(&myMutex);
+#endif
+}
+
+
+void BamShardRunner::setMaxShardLength(int32_t maxLength)
+{
+    myMaxShardLength = maxLength;
+}
+
+
+bool BamShardRunner::run(const char* bamFilename, const char* indexFilename,
+                         int numShards, Processor& processor)
+{
+    myBamFilename = bamFilename;
+    myIndexFilename.clear();
+    if(indexFilename != NULL)
+    {
+        myIndexFilename = indexFilename;
+    }
+    myProcessor = &processor;
+    myShards.clear();
+    myNextShard = 0;
+    myFailed = false;
+    myStatus = SamStatus::SUCCESS;
+
+    if(numShards < 1)
+    {
+        numShards = 4 * myNumWorkers;
+    }
+
+    // Read the index and header to split the file.
+    {
+        SamFile samFile(ErrorHandler::RETURN);
+        SamFileHeader header;
+        if(!openFile(samFile, header))
+        {
+            return(false);
+        }
+        getShards(*samFile.GetBamIndex(), header, numShards, myShards);
+        splitShards(header);
+    }
+
+#ifdef __PTHREAD_AVAILABLE__
+    int numWorkers = myNumWorkers;
+    if(numWorkers > (int)myShards.size())
+    {
+        numWorkers = myShards.size();
+    }
+    std::vector<pthread_t> workers(numWorkers);
+    int numStarted = 0;
+    for(; numStarted < numWorkers; numStarted++)
+    {
+        if(pthread_create(&workers[numStarted], NULL, workerThread, this) != 0)
+        {
+            break;
+        }
+    }
+    if((numStarted == 0) && (numWorkers != 0))
+    {
+        lock();
+        setFailed(SamStatus::FAIL_MEM, "Failed to start the shard threads");
+        unlock();
+    }
+    for(int i = 0; i < numStarted; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+#else
+    processShards();
+#endif
+
+    return(!myFailed);
+}
+
+
+bool BamShardRunner::openFile(SamFile& samFile, SamFileHeader& header)
+{
+    std::string failMessage;
+    SamStatus::Status failStatus = SamStatus::FAIL_IO;
+    try
+    {
+        bool indexRead = false;
+        if(samFile.OpenForRead(myBamFilename.c_str()))
+        {
+            if(myIndexFilename.empty())
+            {
+                indexRead = samFile.ReadBamIndex();
+            }
+            else
+            {
+                indexRead = samFile.ReadBamIndex(myIndexFilename.c_str());
+            }
+        }
+        if(!indexRead || !samFile.ReadHeader(header))
+        {
+            failStatus = samFile.GetStatus();
+            failMessage = samFile.GetStatusMessage();
+        }
+    }
+    catch(std::exception& e)
+    {
+        failMessage = e.what();
+    }
+
+    if(!failMessage.empty())
+    {
+        lock();
+        setFailed(failStatus, failMessage.c_str());
+        unlock();
+        return(false);
+    }
+    return(true);
+}
+
+
+void BamShardRunner::splitShards(SamFileHeader& header)
+{
+    if(myMaxShardLength <= 0)
+    {
+        return;
+    }
+
+    const SamReferenceInfo& refInfo = header.getReferenceInfo();
+    std::vector<Shard> shards;
+    shards.swap(myShards);
+    for(unsigned int i = 0; i < shards.size(); i++)
+    {
+        const Shard& shard = shards[i];
+        int32_t end = shard.end;
+        if(end == -1)
+        {
+            end = refInfo.getReferenceLength(shard.refID);
+        }
+        int64_t length = (int64_t)end - shard.start;
+        if(length <= myMaxShardLength)
+        {
+            myShards.push_back(shard);
+            continue;
+        }
+
+        // Split into numParts equal parts, the last going to the same end.
+        int64_t numParts = (length + myMaxShardLength - 1) / myMaxShardLength;
+        Shard part = shard;
+        part.size = shard.size / numParts + 1;
+        for(int64_t j = 0; j < numParts; j++)
+        {
+            part.start = shard.start + length * j / numParts;
+            part.end = shard.start + length * (j + 1) / numParts;
+            if(j == numParts - 1)
+            {
+                part.end = shard.end;
+            }
+            myShards.push_back(part);
+        }
+    }
+}
+
+
+void BamShardRunner::processShards()
+{
+    // Each worker reads the file with its own handle.
+    SamFile samFile(ErrorHandler::RETURN);
+    SamFileHeader header;
+    if(!openFile(samFile, header))
+    {
+        return;
+    }
+
+    while(true)
+    {
+        lock();
+        if(myFailed || (myNextShard >= myShards.size()))
+        {
+            // Failed or there is nothing left to process.
+            unlock();
+            break;
+        }
+        const Shard& shard = myShards[myNextShard++];
+        unlock();
+
+        std::string failMessage;
+        SamStatus::Status failStatus = SamStatus::FAIL_PARSE;
+        try
+        {
+            if(!samFile.SetReadSection(shard.refID, shard.start, shard.end))
+            {
+                failStatus = samFile.GetStatus();
+                failMessage = samFile.GetStatusMessage();
+            }
+            else if(!myProcessor->processShard(samFile, header, shard))
+            {
+                char message[128];
+                snprintf(message, sizeof(message),
+                         "Failed to process the shard, refID = %d; "
+                         "startPos = %d; endPos = %d",
+                         shard.refID, shard.start, shard.end);
+                failMessage = message;
+            }
+        }
+        catch(std::exception& e)
+        {
+            failMessage = e.what();
+        }
+
+        if(!failMessage.empty())
+        {
+            lock();
+            setFailed(failStatus, failMessage.c_str());
+            unlock();
+            break;
+        }
+    }
+}
+
+
+void BamShardRunner::setFailed(SamStatus::Status status, const char* message)
+{
+    if(!myFailed)
+    {
+        myFailed = true;
+        myStatus.setStatus(status, message);
+    }
+}
+
+
+#ifdef __PTHREAD_AVAILABLE__
+void* BamShardRunner::workerThread(void* arg)
+{
+    ((BamShardRunner*)arg)->processShards();
+    return(NULL);
+}
+
+
+void BamShardRunner::lock()
+{
+    pthread_mutex_lock(&myMutex);
+}
+
+
+void BamShardRunner::unlock()
+{
+    pthread_mutex_unlock(&myMutex);
+}
+#else
+void BamShardRunner::lock()
+{
+}
+
+
+void BamShardRunner::unlock()
+{
+}
+#endif
@@ -0,0 +1,182 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BAM_SHARD_RUNNER_H__
+#define __BAM_SHARD_RUNNER_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#ifdef __PTHREAD_AVAILABLE__
+#include <pthread.h>
+#endif
+#include "SamFile.h"
+
+/// Splits an indexed, coordinate sorted BAM file into shards (regions of
+/// a reference) and processes the shards in a pool of worker threads,
+/// each reading the file with its own SamFile.
+///
+/// The shards are balanced by compressed size, taken from the index's
+/// linear index, rather than by number of bases, so dense and sparse
+/// regions take about the same time.  Only records on a reference are
+/// in a shard; records without a reference are not processed.
+///
+/// A record that overlaps the boundary between two shards is read by
+/// both, so per-position work limited to the shard's positions (for
+/// example Pileup::processAlignmentRegion with the shard's start and end)
+/// sees every record covering those positions and gives exact results.
+/// Per-record work should use Shard::ownsRecord so each record is only
+/// counted once.
+///
+/// Without pthreads, the shards are processed on the calling thread.
+class BamShardRunner
+{
+public:
+    /// A region of one reference.
+    struct Shard
+    {
+        int32_t refID;
+        /// inclusive 0-based start position.
+        int32_t start;
+        /// exclusive 0-based end position, -1 for the end of the reference.
+        int32_t end;
+        /// Approximate compressed bytes of the records in the shard.
+        uint64_t size;
+
+        /// Returns whether or not the record starts in this shard.  Each
+        /// record read from a shard is owned by exactly one shard, records
+        /// that start in an earlier shard are read again by the shards
+        /// they overlap.
+        bool ownsRecord(SamRecord& record) const
+        {
+            return(record.get0BasedPosition() >= start);
+        }
+    };
+
+    /// Work to run on each shard.  processShard is called from multiple
+    /// worker threads at once (for different shards), so it must be
+    /// thread safe.
+    class Processor
+    {
+    public:
+        virtual ~Processor() {}
+
+        /// Process the specified shard.  The read section of samFile is
+        /// already set to the shard, so ReadRecord returns the records
+        /// that overlap it.  shard is an entry of getShards, so its index
+        /// is &shard - &getShards()[0].
+        /// \param samFile file to read the shard's records from.
+        /// \param header header of the file.
+        /// \param shard the shard being processed.
+        /// \return true on success, false to stop processing.
+        virtual bool processShard(SamFile& samFile, SamFileHeader& header,
+                                  const Shard& shard) = 0;
+    };
+
+    /// Split the references of an indexed BAM file into about numShards
+    /// shards with about the same compressed size.  Shard boundaries are
+    /// on the 16K windows of the linear index, so there may be fewer
+    /// shards than requested, and a shard never covers more than one
+    /// reference.  References without records have no shards.
+    /// \param index index of the BAM file.
+    /// \param header header of the BAM file, used for the reference lengths.
+    /// \param numShards number of shards to aim for.
+    /// \param shards set to the shards, in file order.
+    static void getShards(const BamIndex& index, SamFileHeader& header,
+                          int numShards, std::vector<Shard>& shards);
+
+    /// Constructor.
+    /// \param numWorkers number of worker threads to process shards with.
+    BamShardRunner(int numWorkers);
+
+    ~BamShardRunner();
+
+    /// Set the maximum number of positions in a shard, splitting longer
+    /// shards into equal parts, to bound the per-shard work of processors
+    /// that hold state for each position.
+    /// \param maxLength maximum shard length, 0 for no limit (default).
+    void setMaxShardLength(int32_t maxLength);
+
+    /// Split the BAM file into shards and process each of them.
+    /// \param bamFilename name of the BAM file.
+    /// \param indexFilename name of the BAM index, NULL to find it from
+    /// the BAM file name.
+    /// \param numShards number of shards to aim for, 0 for 4 per worker.
+    /// \param processor work to run on each shard.
+    /// \return true if all shards were processed, false if one failed (see
+    /// getStatus).
+    bool run(const char* bamFilename, const char* indexFilename,
+             int numShards, Processor& processor);
+
+    /// Returns the status of the last run, with the reason if it failed.
+    const SamStatus& getStatus() const
+    {
+        return(myStatus);
+    }
+
+    /// Returns the shards of the last run.
+    const std::vector<Shard>& getShards() const
+    {
+        return(myShards);
+    }
+
+private:
+    BamShardRunner(const BamShardRunner& other);
+    BamShardRunner& operator=(const BamShardRunner& other);
+
+    // Open the BAM file, its index, and header for reading.  Returns false
+    // and sets the status on failure.
+    bool openFile(SamFile& samFile, SamFileHeader& header);
+
+    // Split the shards longer than myMaxShardLength.
+    void splitShards(SamFileHeader& header);
+
+    // Process shards until there are none left or one fails.
+    void processShards();
+
+    // Set the status to failed with the specified message, keeping the
+    // first failure.  Must be called with the lock held.
+    void setFailed(SamStatus::Status status, const char* message);
+
+#ifdef __PTHREAD_AVAILABLE__
+    static void* workerThread(void* arg);
+#endif
+
+    void lock();
+    void unlock();
+
+    int myNumWorkers;
+    int32_t myMaxShardLength;
+
+    // The file/processor of the current run.
+    std::string myBamFilename;
+    std::string myIndexFilename;
+    Processor* myProcessor;
+
+    std::vector<Shard> myShards;
+    // Next shard to be processed.
+    unsigned int myNextShard;
+    bool myFailed;
+
+    SamStatus myStatus;
+
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_t myMutex;
+#endif
+};
+
+#endif
@@ -26,6 +26,14 @@ GenericSamInterface::~GenericSamInterface()
 {
 }
 
+void GenericSamInterface::readRecord(IFILE filePtr, SamFileHeader& header,
+                                     BamRecordView& record,
+                                     SamStatus& samStatus)
+{
+    samStatus.setStatus(SamStatus::FAIL_IO,
+                        "Reading a BamRecordView is only supported for BAM files");
+}
+
 bool GenericSamInterface::isEOF(IFILE filePtr)
 {
     if (filePtr != NULL)
@@ -22,6 +22,7 @@
 #include "InputFile.h"
 #include "SamFileHeader.h"
 #include "SamRecord.h"
+#include "BamRecordView.h"
 
 class GenericSamInterface
 {
@@ -49,6 +50,13 @@ public:
     virtual void readRecord(IFILE filePtr, SamFileHeader& header, 
                             SamRecord& record, 
                             SamStatus& samStatus) = 0;
+
+    // Reads the next record from the specified file into the passed in
+    // view without unpacking it.  Only BAM files store records in the
+    // format the view reads, so by default this sets a FAIL_IO status.
+    virtual void readRecord(IFILE filePtr, SamFileHeader& header, 
+                            BamRecordView& record, 
+                            SamStatus& samStatus);
    
     // Pure virtual method that writes the specified record into the specified
     // file.
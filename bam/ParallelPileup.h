@@ -0,0 +1,630 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PARALLEL_PILEUP_H__
+#define __PARALLEL_PILEUP_H__
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Pileup.h"
+#include "BamShardRunner.h"
+
+/// A slot of the pileup ring of a ParallelPileup shard, pointing to the
+/// element for its position, which is owned by the shard and reused once it
+/// has been delivered.
+template <class PILEUP_TYPE>
+class ParallelPileupSlot
+{
+public:
+    ParallelPileupSlot() : myElement(NULL) {}
+    // NOTE that this method does not actually copy, it just resets.
+    ParallelPileupSlot(const ParallelPileupSlot& q) : myElement(NULL) {}
+
+    void setElement(PILEUP_TYPE* element) { myElement = element; }
+    PILEUP_TYPE* getElement() { return(myElement); }
+
+    void addEntry(SamRecord& record) { myElement->addEntry(record); }
+    void analyze() { myElement->analyze(); }
+    // The element is reset when it is set, and released when delivered.
+    void reset(int32_t refPosition) {}
+    void release() {}
+
+private:
+    PILEUP_TYPE* myElement;
+};
+
+
+// The record-major pileup of a shard adds to the elements of the slots.
+template <class PILEUP_TYPE>
+class PileupRunAdder<ParallelPileupSlot<PILEUP_TYPE> >
+{
+public:
+    static inline void addMatches(ParallelPileupSlot<PILEUP_TYPE>* slots,
+                                  int count, const PileupRecordInfo& info,
+                                  int32_t queryIndex)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            PileupRunAdder<PILEUP_TYPE>::addMatches(slots[i].getElement(), 1,
+                                                    info, queryIndex + i);
+        }
+    }
+
+    static inline void addDeletions(ParallelPileupSlot<PILEUP_TYPE>* slots,
+                                    int count, const PileupRecordInfo& info)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            PileupRunAdder<PILEUP_TYPE>::addDeletions(slots[i].getElement(),
+                                                      1, info);
+        }
+    }
+};
+
+
+/// Performs the pileup of an indexed, coordinate sorted BAM file on
+/// several threads, giving the same results as Pileup::processFile.
+///
+/// The file is split into shards by BamShardRunner, and each worker thread
+/// runs its own pileup of a shard's positions.  The analyzed positions of
+/// each shard are buffered in a reorder buffer and passed to FUNC_CLASS on
+/// the calling thread in genomic order, so FUNC_CLASS (and the element's
+/// analyze, for the default FUNC_CLASS) is called on the same elements in
+/// the same order as by Pileup::processFile, and does not need to be
+/// thread safe.  Only records on a reference are in the pileup.
+///
+/// Delivered elements are reused for the shard's later positions, so a
+/// shard only holds the elements that are in its pileup or waiting to be
+/// delivered.  Shards waiting behind the one being delivered buffer all of
+/// their positions, so shards are limited to setMaxShardLength positions
+/// and at most setMaxShardsInFlight shards are buffered at once.
+/// PileupElementPooled keeps the buffered elements small.
+///
+/// Without pthreads, the shards are processed on the calling thread.
+template <class PILEUP_TYPE,
+          class FUNC_CLASS = defaultPileup<PILEUP_TYPE> >
+class ParallelPileup
+{
+public:
+    /// Constructor.
+    /// \param numWorkers number of worker threads to build pileups with.
+    ParallelPileup(int numWorkers, const FUNC_CLASS& fp = FUNC_CLASS());
+
+    ~ParallelPileup();
+
+    /// Set the maximum number of positions in a shard (default 65536).
+    void setMaxShardLength(int32_t maxLength)
+    {
+        myMaxShardLength = maxLength;
+    }
+
+    /// Set the maximum number of shards that are being piled up or waiting
+    /// to be delivered at once (default twice the number of workers).
+    void setMaxShardsInFlight(int maxShards)
+    {
+        myMaxInFlight = (maxShards < 1) ? 1 : maxShards;
+    }
+
+    /// Set whether the shard pileups add records a CIGAR operation at a
+    /// time, see Pileup::setRecordMajor.  Defaults to false.
+    void setRecordMajor(bool recordMajor)
+    {
+        myRecordMajor = recordMajor;
+    }
+
+    /// Performs a pileup on the specified file.
+    /// \param fileName name of the BAM file.
+    /// \param indexFileName name of the BAM index, NULL to find it from
+    /// the BAM file name.
+    /// \param excludeFlag records with any of these flag bits set are
+    /// dropped, defaults to the same as Pileup::processFile.
+    /// \param includeFlag records without all of these flag bits set are
+    /// dropped, defaults to 0.
+    /// \return 0 for success and non-zero for failure (see getStatus).
+    int processFile(const std::string& fileName,
+                    const char* indexFileName = NULL,
+                    uint16_t excludeFlag = 0x0704,
+                    uint16_t includeFlag = 0);
+
+    /// Returns the FUNC_CLASS the positions are delivered to.
+    FUNC_CLASS& getAnalyzeFunc()
+    {
+        return(myAnalyzeFunc);
+    }
+
+    /// Returns the status of the last processFile, with the reason if it
+    /// failed.
+    const SamStatus& getStatus() const
+    {
+        return(myStatus);
+    }
+
+private:
+    ParallelPileup(const ParallelPileup& other);
+    ParallelPileup& operator=(const ParallelPileup& other);
+
+    // The elements of a shard and how many have been analyzed.
+    struct ShardState
+    {
+        ShardState() : elements(), ready(), spare(), done(false) {}
+        ~ShardState()
+        {
+            for(unsigned int i = 0; i < elements.size(); i++)
+            {
+                delete elements[i];
+            }
+        }
+
+        // All of the elements allocated for the shard, only changed by
+        // the worker.
+        std::vector<PILEUP_TYPE*> elements;
+        // Analyzed elements waiting to be delivered.
+        std::vector<PILEUP_TYPE*> ready;
+        // Delivered elements waiting to be reused by the worker.
+        std::vector<PILEUP_TYPE*> spare;
+        // Whether all of the elements have been analyzed.
+        bool done;
+    };
+
+    // Pileup of one shard, which adds the analyzed elements to the shard's
+    // ready list rather than analyzing them.
+    class ShardPileup : public Pileup<ParallelPileupSlot<PILEUP_TYPE> >
+    {
+    public:
+        ShardPileup(ParallelPileup& parent, ShardState& state)
+            : myParent(parent), myState(state), mySpare() {}
+
+    protected:
+        virtual void resetElement(ParallelPileupSlot<PILEUP_TYPE>& slot,
+                                  int position)
+        {
+            if(mySpare.empty())
+            {
+                // Take the elements delivered since the last time.
+                myParent.lock();
+                mySpare.swap(myState.spare);
+                myParent.unlock();
+            }
+            PILEUP_TYPE* element;
+            if(mySpare.empty())
+            {
+                element = new PILEUP_TYPE();
+                myState.elements.push_back(element);
+            }
+            else
+            {
+                element = mySpare.back();
+                mySpare.pop_back();
+            }
+            element->reset(position);
+            slot.setElement(element);
+        }
+
+        virtual void analyzeHead()
+        {
+            myParent.lock();
+            myState.ready.push_back(this->myElements[this->pileupHead -
+                                                     this->pileupStart].
+                                    getElement());
+            myParent.unlock();
+            myParent.signal();
+        }
+
+    private:
+        ParallelPileup& myParent;
+        ShardState& myState;
+        // Delivered elements taken from the shard state to be reused.
+        std::vector<PILEUP_TYPE*> mySpare;
+    };
+
+    class ShardProcessor : public BamShardRunner::Processor
+    {
+    public:
+        ShardProcessor(ParallelPileup& parent) : myParent(parent) {}
+        bool processShard(SamFile& samFile, SamFileHeader& header,
+                          const BamShardRunner::Shard& shard)
+        {
+            return(myParent.processShard(samFile, header, shard));
+        }
+    private:
+        ParallelPileup& myParent;
+    };
+
+    // Pile up the shard, called by the worker threads.  Failures are
+    // recorded in myShardFailMessage rather than thrown.
+    bool processShard(SamFile& samFile, SamFileHeader& header,
+                      const BamShardRunner::Shard& shard);
+
+    // Deliver the elements of the shard to myAnalyzeFunc as they are
+    // analyzed.  Returns false if the shard failed or was not processed.
+    bool deliverShard(int shardIndex);
+
+    // Stop the workers, which stop at their next wait.
+    void abort();
+
+#ifdef __PTHREAD_AVAILABLE__
+    static void* runnerThread(void* arg);
+#endif
+
+    void lock();
+    void unlock();
+    // Wake up all waiting threads.
+    void signal();
+    // Wait for a signal, must be called with the lock held.
+    void wait();
+
+    FUNC_CLASS myAnalyzeFunc;
+    BamShardRunner myRunner;
+    int32_t myMaxShardLength;
+    int myMaxInFlight;
+    bool myRecordMajor;
+
+    // The file and flags of the current processFile.
+    std::string myFileName;
+    const char* myIndexFileName;
+    uint16_t myExcludeFlag;
+    uint16_t myIncludeFlag;
+
+    // The states of the shards that are being piled up or delivered.
+    std::map<int, ShardState*> myStates;
+    // Index of the shard being delivered.
+    int myDeliverShard;
+    // Whether the runner has finished processing the shards.
+    bool myRunnerDone;
+    bool myAborted;
+    // Why the first failed shard failed.
+    std::string myShardFailMessage;
+
+    SamStatus myStatus;
+
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_t myMutex;
+    pthread_cond_t myCondition;
+#endif
+};
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::ParallelPileup(int numWorkers,
+                                                        const FUNC_CLASS& fp)
+    : myAnalyzeFunc(fp),
+      myRunner(numWorkers),
+      myMaxShardLength(65536),
+      myMaxInFlight(2 * ((numWorkers < 1) ? 1 : numWorkers)),
+      myRecordMajor(false),
+      myFileName(),
+      myIndexFileName(NULL),
+      myExcludeFlag(0),
+      myIncludeFlag(0),
+      myStates(),
+      myDeliverShard(0),
+      myRunnerDone(false),
+      myAborted(false),
+      myShardFailMessage(),
+      myStatus(ErrorHandler::RETURN)
+{
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_init(&myMutex, NULL);
+    pthread_cond_init(&myCondition, NULL);
+#endif
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::~ParallelPileup()
+{
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_cond_destroy(&myCondition);
+    pthread_mutex_destroy(&myMutex);
+#endif
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+int ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::processFile(const std::string& fileName,
+                                                         const char* indexFileName,
+                                                         uint16_t excludeFlag,
+                                                         uint16_t includeFlag)
+{
+    myFileName = fileName;
+    myIndexFileName = indexFileName;
+    myExcludeFlag = excludeFlag;
+    myIncludeFlag = includeFlag;
+    myStates.clear();
+    myDeliverShard = 0;
+    myRunnerDone = false;
+    myAborted = false;
+    myShardFailMessage.clear();
+    myStatus = SamStatus::SUCCESS;
+    myRunner.setMaxShardLength(myMaxShardLength);
+
+#ifdef __PTHREAD_AVAILABLE__
+    // The runner and its workers pile up the shards while this thread
+    // delivers them in order.
+    pthread_t runner;
+    if(pthread_create(&runner, NULL, runnerThread, this) != 0)
+    {
+        myStatus.setStatus(SamStatus::FAIL_MEM,
+                           "Failed to start the pileup threads");
+        return(myStatus.getStatus());
+    }
+
+    bool delivered = true;
+    try
+    {
+        while(delivered)
+        {
+            delivered = deliverShard(myDeliverShard);
+            lock();
+            ++myDeliverShard;
+            unlock();
+            signal();
+        }
+    }
+    catch(...)
+    {
+        // Stop the workers before passing on the exception.
+        abort();
+        pthread_join(runner, NULL);
+        throw;
+    }
+    // Stop any workers still waiting if a shard failed.
+    abort();
+    pthread_join(runner, NULL);
+#else
+    ShardProcessor processor(*this);
+    myRunner.run(myFileName.c_str(), myIndexFileName, 0, processor);
+#endif
+
+    // Free any shards that were not delivered.
+    typename std::map<int, ShardState*>::iterator iter;
+    for(iter = myStates.begin(); iter != myStates.end(); ++iter)
+    {
+        delete iter->second;
+    }
+    myStates.clear();
+
+    if(myRunner.getStatus() != SamStatus::SUCCESS)
+    {
+        myStatus = myRunner.getStatus();
+    }
+    if(!myShardFailMessage.empty())
+    {
+        // More specific than the runner's message.
+        myStatus.setStatus(SamStatus::FAIL_PARSE, myShardFailMessage.c_str());
+    }
+    return(myStatus.getStatus());
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+bool ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::processShard(SamFile& samFile,
+                                                           SamFileHeader& header,
+                                                           const BamShardRunner::Shard& shard)
+{
+    int shardIndex = &shard - &(myRunner.getShards()[0]);
+
+    // Wait until the shard is close enough to the one being delivered.
+    ShardState* state = new ShardState();
+    lock();
+    while(!myAborted && (shardIndex >= myDeliverShard + myMaxInFlight))
+    {
+        wait();
+    }
+    if(myAborted)
+    {
+        unlock();
+        delete state;
+        return(false);
+    }
+    myStates[shardIndex] = state;
+    unlock();
+
+    bool success = true;
+    std::string failMessage;
+    try
+    {
+        samFile.setSortedValidation(SamFile::COORDINATE);
+        ShardPileup pileup(*this, *state);
+        pileup.setRecordMajor(myRecordMajor);
+        SamRecord record;
+        while(samFile.ReadRecord(header, record))
+        {
+            uint16_t flag = record.getFlag();
+            if((flag & myExcludeFlag) ||
+               ((flag & myIncludeFlag) != myIncludeFlag))
+            {
+                continue;
+            }
+            pileup.processAlignmentRegion(record, shard.start, shard.end);
+        }
+        success = (samFile.GetStatus() == SamStatus::NO_MORE_RECS);
+        pileup.flushPileup();
+    }
+    catch(std::exception& e)
+    {
+        failMessage = e.what();
+    }
+    catch(...)
+    {
+        failMessage = "Unknown exception while piling up the shard";
+    }
+
+    lock();
+    if(!failMessage.empty())
+    {
+        success = false;
+        if(myShardFailMessage.empty())
+        {
+            myShardFailMessage = failMessage;
+        }
+    }
+    state->done = true;
+    unlock();
+    signal();
+    if(!success)
+    {
+        abort();
+        return(false);
+    }
+
+#ifndef __PTHREAD_AVAILABLE__
+    // The shards are processed in order on this thread, so deliver them
+    // as they finish.
+    deliverShard(shardIndex);
+    ++myDeliverShard;
+#endif
+    return(true);
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+bool ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::deliverShard(int shardIndex)
+{
+    std::vector<PILEUP_TYPE*> elements;
+    ShardState* state = NULL;
+    bool done = false;
+    while(!done)
+    {
+        lock();
+        while(true)
+        {
+            if(state == NULL)
+            {
+                typename std::map<int, ShardState*>::iterator iter =
+                    myStates.find(shardIndex);
+                if(iter != myStates.end())
+                {
+                    state = iter->second;
+                }
+            }
+            if(myAborted || ((state == NULL) && myRunnerDone))
+            {
+                // Failed, or there are no more shards.
+                unlock();
+                return(false);
+            }
+            if((state != NULL) && (!state->ready.empty() || state->done))
+            {
+                break;
+            }
+            wait();
+        }
+        elements.swap(state->ready);
+        done = state->done;
+        unlock();
+
+        for(unsigned int i = 0; i < elements.size(); i++)
+        {
+            myAnalyzeFunc(*(elements[i]));
+            elements[i]->release();
+        }
+        // Hand the elements back to the worker to reuse.
+        lock();
+        state->spare.insert(state->spare.end(), elements.begin(),
+                            elements.end());
+        unlock();
+        elements.clear();
+    }
+
+    lock();
+    myStates.erase(shardIndex);
+    unlock();
+    delete state;
+    return(true);
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::abort()
+{
+    lock();
+    myAborted = true;
+    unlock();
+    signal();
+}
+
+
+#ifdef __PTHREAD_AVAILABLE__
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void* ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::runnerThread(void* arg)
+{
+    ParallelPileup* parent = (ParallelPileup*)arg;
+    ShardProcessor processor(*parent);
+    parent->myRunner.run(parent->myFileName.c_str(), parent->myIndexFileName,
+                         0, processor);
+    parent->lock();
+    parent->myRunnerDone = true;
+    parent->unlock();
+    parent->signal();
+    return(NULL);
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::lock()
+{
+    pthread_mutex_lock(&myMutex);
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::unlock()
+{
+    pthread_mutex_unlock(&myMutex);
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::signal()
+{
+    pthread_cond_broadcast(&myCondition);
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::wait()
+{
+    pthread_cond_wait(&myCondition, &myMutex);
+}
+#else
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::lock()
+{
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::unlock()
+{
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::signal()
+{
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void ParallelPileup<PILEUP_TYPE, FUNC_CLASS>::wait()
+{
+}
+#endif
+
+#endif
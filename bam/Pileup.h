@@ -21,6 +21,7 @@
 #include <stdexcept>
 #include "SamFile.h"
 #include "PosList.h"
+#include "PileupElement.h"
 
 
 class PileupHelper
@@ -94,6 +95,16 @@ public:
                             uint16_t excludeFlag = 0x0704, 
                             uint16_t includeFlag = 0);
 
+    /// Set whether alignments are added record-major: the CIGAR of each
+    /// record is walked once and each run of matched or deleted positions
+    /// is added to the consecutive elements by PileupRunAdder<PILEUP_TYPE>
+    /// rather than calling addElement for each position.  Element types
+    /// that specialize PileupRunAdder then skip the virtual addEntry call
+    /// and the query index lookup of each position.  Overrides of
+    /// addElement are not called when this is set.  Also applies to
+    /// processAlignmentRegion without an excludeList.  Defaults to false.
+    void setRecordMajor(bool recordMajor) { myRecordMajor = recordMajor; }
+
     /// Add an alignment to the pileup.
     virtual void processAlignment(SamRecord& record);
    
@@ -121,6 +132,15 @@ protected:
     // Always need the reference position.
     void addAlignmentPosition(int refPosition, SamRecord& record);
 
+    // Add the positions of the alignment in the region (see
+    // processAlignmentRegion) a CIGAR operation at a time.
+    void processAlignmentRuns(SamRecord& record, int startPos = 0,
+                              int endPos = -1);
+
+    // Get the offset of the position in myElements, adding the record
+    // information to any overflow error.
+    int recordPosition(int refPosition, SamRecord& record);
+
 
     virtual void flushPileup(int refID, int refPosition);
     void flushPileup(int refPosition);
@@ -145,6 +165,8 @@ protected:
     int myCurrentRefID;
 
     GenomeSequence* myRefPtr;
+
+    bool myRecordMajor;
 };
 
 
@@ -157,7 +179,8 @@ Pileup<PILEUP_TYPE, FUNC_CLASS>::Pileup(const FUNC_CLASS& fp)
       pileupTail(-1),
       pileupWindow(PileupHelper::DEFAULT_WINDOW_SIZE),
       myCurrentRefID(-2),
-      myRefPtr(NULL)
+      myRefPtr(NULL),
+      myRecordMajor(false)
 {
     // Not using pointers since this is templated.
     myElements.resize(pileupWindow);
@@ -173,7 +196,8 @@ Pileup<PILEUP_TYPE, FUNC_CLASS>::Pileup(int window, const FUNC_CLASS& fp)
       pileupTail(-1),
       pileupWindow(window),
       myCurrentRefID(-2),
-      myRefPtr(NULL)
+      myRefPtr(NULL),
+      myRecordMajor(false)
 {
     // Not using pointers since this is templated.
     myElements.resize(window);
@@ -189,7 +213,8 @@ Pileup<PILEUP_TYPE, FUNC_CLASS>::Pileup(const std::string& refSeqFileName, const
       pileupTail(-1),
       pileupWindow(PileupHelper::DEFAULT_WINDOW_SIZE),
       myCurrentRefID(-2),
-      myRefPtr(NULL)
+      myRefPtr(NULL),
+      myRecordMajor(false)
 {
     myRefPtr = new GenomeSequence(refSeqFileName.c_str());
 
@@ -209,7 +234,8 @@ Pileup<PILEUP_TYPE, FUNC_CLASS>::Pileup(int window, const std::string& refSeqFil
       pileupTail(-1),
       pileupWindow(window),
       myCurrentRefID(-2),
-      myRefPtr(NULL)
+      myRefPtr(NULL),
+      myRecordMajor(false)
 {
     myRefPtr = new GenomeSequence(refSeqFileName.c_str());
 
@@ -295,6 +321,12 @@ int Pileup<PILEUP_TYPE, FUNC_CLASS>::processFile(const std::string& fileName,
 template <class PILEUP_TYPE, class FUNC_CLASS>
 void Pileup<PILEUP_TYPE, FUNC_CLASS>::processAlignment(SamRecord& record)
 {
+    if(myRecordMajor)
+    {
+        processAlignmentRuns(record);
+        return;
+    }
+
     int refPosition = record.get0BasedPosition();
     int refID = record.getReferenceID();
 
@@ -318,6 +350,12 @@ void Pileup<PILEUP_TYPE, FUNC_CLASS>::processAlignmentRegion(SamRecord& record,
                                                              int endPos,
                                                              PosList* excludeList)
 {
+    if(myRecordMajor && (excludeList == NULL))
+    {
+        processAlignmentRuns(record, startPos, endPos);
+        return;
+    }
+
     int refPosition = record.get0BasedPosition();
     int refID = record.getReferenceID();
 
@@ -383,6 +421,140 @@ void Pileup<PILEUP_TYPE, FUNC_CLASS>::flushPileup()
 template <class PILEUP_TYPE, class FUNC_CLASS>
 void Pileup<PILEUP_TYPE, FUNC_CLASS>::addAlignmentPosition(int refPosition,
                                                            SamRecord& record)
+{
+    addElement(myElements[recordPosition(refPosition, record)], record);
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+void Pileup<PILEUP_TYPE, FUNC_CLASS>::processAlignmentRuns(SamRecord& record,
+                                                           int startPos,
+                                                           int endPos)
+{
+    int refPosition = record.get0BasedPosition();
+    int refID = record.getReferenceID();
+
+    // Flush any elements from the pileup that are prior to this record
+    // since the file is sorted, we are done with those positions.
+    flushPileup(refID, refPosition);
+
+    // Only add the positions in the region.
+    int firstPosition = refPosition;
+    if(startPos > firstPosition)
+    {
+        firstPosition = startPos;
+    }
+    int lastPosition = record.get0BasedAlignmentEnd();
+    if((endPos != -1) && (lastPosition >= endPos))
+    {
+        lastPosition = endPos - 1;
+    }
+    if(lastPosition < firstPosition)
+    {
+        // No reference positions in the region.
+        return;
+    }
+
+    PileupRecordInfo info;
+    info.record = &record;
+    info.sequence = record.getSequence();
+    info.quality = record.getQuality();
+    if(strcmp(info.quality, "*") == 0)
+    {
+        info.quality = NULL;
+    }
+    int32_t readLength = record.getReadLength();
+    Cigar* cigar = record.getCigarInfo();
+    if((cigar == NULL) || (readLength == 0) ||
+       (cigar->getExpectedQueryBaseCount() != readLength) ||
+       ((info.quality != NULL) &&
+        ((int32_t)strlen(info.quality) != readLength)))
+    {
+        // Let addEntry handle (and report) any problems with the record.
+        for(int position = firstPosition; position <= lastPosition; ++position)
+        {
+            addAlignmentPosition(position, record);
+        }
+        return;
+    }
+    info.chromosome = record.getReferenceName();
+    info.flag = record.getFlag();
+    info.mapQuality = record.getMapQuality();
+
+    // Reset the elements for every position up front, which also checks
+    // that they all fit in the window.
+    recordPosition(firstPosition, record);
+    recordPosition(lastPosition, record);
+
+    int32_t queryIndex = 0;
+    for(int i = 0; (i < cigar->size()) && (refPosition <= lastPosition); i++)
+    {
+        const Cigar::CigarOperator& op = (*cigar)[i];
+        bool isMatch = ((op.operation == Cigar::match) ||
+                        (op.operation == Cigar::mismatch));
+        if(!isMatch &&
+           (op.operation != Cigar::del) && (op.operation != Cigar::skip))
+        {
+            if(Cigar::foundInQuery(op))
+            {
+                queryIndex += op.count;
+            }
+            continue;
+        }
+
+        // Clip the run to the region.
+        int runStart = refPosition;
+        int runEnd = refPosition + op.count - 1;
+        if(runStart < firstPosition)
+        {
+            runStart = firstPosition;
+        }
+        if(runEnd > lastPosition)
+        {
+            runEnd = lastPosition;
+        }
+
+        // Add the run, splitting it where it wraps around myElements.
+        int32_t runQueryIndex = queryIndex + runStart - refPosition;
+        while(runStart <= runEnd)
+        {
+            int offset = runStart - pileupStart;
+            if(offset >= pileupWindow)
+            {
+                offset -= pileupWindow;
+            }
+            int count = pileupWindow - offset;
+            if(count > runEnd - runStart + 1)
+            {
+                count = runEnd - runStart + 1;
+            }
+            if(isMatch)
+            {
+                PileupRunAdder<PILEUP_TYPE>::addMatches(&myElements[offset],
+                                                        count, info,
+                                                        runQueryIndex);
+                runQueryIndex += count;
+            }
+            else
+            {
+                PileupRunAdder<PILEUP_TYPE>::addDeletions(&myElements[offset],
+                                                          count, info);
+            }
+            runStart += count;
+        }
+
+        refPosition += op.count;
+        if(isMatch)
+        {
+            queryIndex += op.count;
+        }
+    }
+}
+
+
+template <class PILEUP_TYPE, class FUNC_CLASS>
+int Pileup<PILEUP_TYPE, FUNC_CLASS>::recordPosition(int refPosition,
+                                                    SamRecord& record)
 {
     int offset = 0;
     try{
@@ -412,8 +584,7 @@ void Pileup<PILEUP_TYPE, FUNC_CLASS>::addAlignmentPosition(int refPosition,
                   << "; pileupHead = " << pileupHead
                   << "; pileupTail = " << pileupTail;
     }
-
-    addElement(myElements[offset], record);
+    return(offset);
 }
 
 
@@ -443,6 +614,7 @@ void Pileup<PILEUP_TYPE, FUNC_CLASS>::flushPileup(int position)
     while((pileupHead < position) && (pileupHead <= pileupTail))
     {
         analyzeHead();
+        myElements[pileupHead - pileupStart].release();
 
         pileupHead++;
         
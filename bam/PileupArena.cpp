@@ -0,0 +1,163 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include <vector>
+#include "PileupArena.h"
+
+PileupArena::PileupArena()
+    : myNumSlabs(0),
+      myFreeHead(NO_BLOCK),
+      myNumInUse(0)
+{
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_init(&myMutex, NULL);
+#endif
+}
+
+
+PileupArena::~PileupArena()
+{
+    for(int32_t i = 0; i < myNumSlabs; i++)
+    {
+        delete[] mySlabs[i];
+    }
+    myNumSlabs = 0;
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_destroy(&myMutex);
+#endif
+}
+
+
+#ifdef __PTHREAD_AVAILABLE__
+// Arenas of exited threads, to be reused by new threads.
+static std::vector<PileupArena*> ourFreeArenas;
+static pthread_mutex_t ourFreeArenasMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Holds the arena of a thread, returning it to ourFreeArenas when the
+// thread exits.  Arenas are never deleted since elements may still be
+// using them.
+class PileupArenaHolder
+{
+public:
+    PileupArenaHolder()
+    {
+        pthread_mutex_lock(&ourFreeArenasMutex);
+        if(ourFreeArenas.empty())
+        {
+            myArena = new PileupArena();
+        }
+        else
+        {
+            myArena = ourFreeArenas.back();
+            ourFreeArenas.pop_back();
+        }
+        pthread_mutex_unlock(&ourFreeArenasMutex);
+    }
+
+    ~PileupArenaHolder()
+    {
+        pthread_mutex_lock(&ourFreeArenasMutex);
+        ourFreeArenas.push_back(myArena);
+        pthread_mutex_unlock(&ourFreeArenasMutex);
+    }
+
+    PileupArena* myArena;
+};
+
+
+PileupArena& PileupArena::getThreadArena()
+{
+    static thread_local PileupArenaHolder holder;
+    return(*holder.myArena);
+}
+#else
+PileupArena& PileupArena::getThreadArena()
+{
+    static PileupArena arena;
+    return(arena);
+}
+#endif
+
+
+int32_t PileupArena::allocateBlock()
+{
+    lock();
+    if(myFreeHead == NO_BLOCK)
+    {
+        // Add a slab, chaining its blocks into the free list.
+        if(myNumSlabs >= MAX_SLABS)
+        {
+            unlock();
+            throw std::runtime_error("Pileup arena is full.");
+        }
+        int32_t firstID = myNumSlabs << SLAB_SHIFT;
+        Block* slab = new Block[SLAB_MASK + 1];
+        for(int32_t i = 0; i < SLAB_MASK; i++)
+        {
+            slab[i].next = firstID + i + 1;
+        }
+        slab[SLAB_MASK].next = NO_BLOCK;
+        mySlabs[myNumSlabs++] = slab;
+        myFreeHead = firstID;
+    }
+
+    int32_t blockID = myFreeHead;
+    Block& block = getBlock(blockID);
+    myFreeHead = block.next;
+    block.next = NO_BLOCK;
+    ++myNumInUse;
+    unlock();
+    return(blockID);
+}
+
+
+void PileupArena::releaseChain(int32_t first, int32_t last, int numBlocks)
+{
+    if(first == NO_BLOCK)
+    {
+        return;
+    }
+    lock();
+    getBlock(last).next = myFreeHead;
+    myFreeHead = first;
+    myNumInUse -= numBlocks;
+    unlock();
+}
+
+
+#ifdef __PTHREAD_AVAILABLE__
+void PileupArena::lock()
+{
+    pthread_mutex_lock(&myMutex);
+}
+
+
+void PileupArena::unlock()
+{
+    pthread_mutex_unlock(&myMutex);
+}
+#else
+void PileupArena::lock()
+{
+}
+
+
+void PileupArena::unlock()
+{
+}
+#endif
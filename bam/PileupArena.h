@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PILEUP_ARENA_H__
+#define __PILEUP_ARENA_H__
+
+#include <stdint.h>
+#ifdef __PTHREAD_AVAILABLE__
+#include <pthread.h>
+#endif
+
+/// Shared storage for the entries of pileup elements.
+///
+/// Entries are kept in fixed size blocks that are carved out of large
+/// slabs.  Each element chains together the blocks it needs, and returns
+/// them to the free list when it is reset, so as the pileup window slides
+/// the blocks of flushed positions are reused by new positions.  The arena
+/// only grows when the coverage of the whole window grows, and never moves
+/// existing blocks.
+///
+/// Each thread gets its own arena from getThreadArena.  Allocating and
+/// releasing blocks is locked, so an element filled on one thread can be
+/// read, released and destroyed on another (as ParallelPileup does), and
+/// arenas are kept after their thread exits, for its elements and the
+/// next thread.
+class PileupArena
+{
+public:
+    /// Per-read information stored for each read at a pileup position.
+    struct Entry
+    {
+        /// Flag set in flags if the read has a deletion at this position.
+        static const uint8_t DELETION = 0x1;
+        /// Flag set in flags if the read is on the reverse strand.
+        static const uint8_t REVERSE = 0x2;
+
+        /// Base of the read at this position, '-' for a deletion.
+        char base;
+        /// Quality character of the base, ' ' if there are no qualities.
+        char quality;
+        /// Mapping quality of the read.
+        uint8_t mapQuality;
+        /// DELETION/REVERSE flags.
+        uint8_t flags;
+        /// 0-based index of the base in the read, -1 for a deletion.
+        int32_t readIndex;
+    };
+
+    /// Number of entries in each block.
+    static const int BLOCK_SIZE = 32;
+
+    /// Block ID used to end a chain of blocks.
+    static const int32_t NO_BLOCK = -1;
+
+    /// A block of entries and the ID of the next block in its chain.
+    struct Block
+    {
+        Entry entries[BLOCK_SIZE];
+        int32_t next;
+    };
+
+    PileupArena();
+    ~PileupArena();
+
+    /// Returns the arena of the calling thread.  The arena stays valid
+    /// after the thread exits.
+    static PileupArena& getThreadArena();
+
+    /// Get an unused block, growing the arena if none are free.
+    /// \return the ID of the block, whose next is NO_BLOCK.
+    int32_t allocateBlock();
+
+    /// Return a chain of blocks to the free list.
+    /// \param first ID of the first block in the chain.
+    /// \param last ID of the last block in the chain.
+    /// \param numBlocks number of blocks in the chain.
+    void releaseChain(int32_t first, int32_t last, int numBlocks);
+
+    /// Get the block with the specified ID.
+    Block& getBlock(int32_t blockID)
+    {
+        return(mySlabs[blockID >> SLAB_SHIFT][blockID & SLAB_MASK]);
+    }
+
+    /// Get the block with the specified ID.
+    const Block& getBlock(int32_t blockID) const
+    {
+        return(mySlabs[blockID >> SLAB_SHIFT][blockID & SLAB_MASK]);
+    }
+
+    /// Returns the number of blocks the arena has allocated.
+    int32_t getNumBlocks() const
+    {
+        return(myNumSlabs << SLAB_SHIFT);
+    }
+
+    /// Returns the number of blocks that are in use by elements.
+    int32_t getNumBlocksInUse() const
+    {
+        return(myNumInUse);
+    }
+
+private:
+    PileupArena(const PileupArena& other);
+    PileupArena& operator=(const PileupArena& other);
+
+    // Number of blocks in each slab is 1 << SLAB_SHIFT.
+    static const int SLAB_SHIFT = 10;
+    static const int32_t SLAB_MASK = (1 << SLAB_SHIFT) - 1;
+    // The slab table is fixed so it can be read while another thread adds
+    // a slab, allowing up to 256M entries per arena.
+    static const int32_t MAX_SLABS = 8192;
+
+    void lock();
+    void unlock();
+
+    Block* mySlabs[MAX_SLABS];
+    int32_t myNumSlabs;
+    int32_t myFreeHead;
+    int32_t myNumInUse;
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_t myMutex;
+#endif
+};
+
+#endif
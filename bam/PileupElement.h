@@ -46,6 +46,11 @@ public:
 
     /// Resets the entry, setting the new position associated with this element.
     virtual void reset(int32_t refPosition);
+
+    /// Called after the element has been analyzed, before it is reset for
+    /// a new position, so elements can give back storage they no longer
+    /// need.  Does nothing by default.
+    virtual void release() {}
     
     /// Get the chromosome name stored in this element.
     const char* getChromosome() const { return(myChromosome.c_str()); }
@@ -64,6 +69,16 @@ protected:
     /// Get a pointer to the reference.
     static GenomeSequence* getReference() { return(myRefPtr); }
 
+    /// Save the chromosome name if this is the first entry, the same as
+    /// addEntry does, for child classes that add entries without it.
+    void setChromosome(const char* chromosome)
+    {
+        if(myChromosome.empty())
+        {
+            myChromosome = chromosome;
+        }
+    }
+
 private:
     int32_t myRefPosition;
     std::string myChromosome;
@@ -71,4 +86,58 @@ private:
 };
 
 
+/// Information about a record that is looked up once per record by the
+/// record-major pileup (see Pileup::setRecordMajor) and passed to the
+/// PileupRunAdder of each run of positions.
+struct PileupRecordInfo
+{
+    /// The record being added.
+    SamRecord* record;
+    /// Reference name of the record.
+    const char* chromosome;
+    /// Sequence of the record, with the record's sequence translation.
+    const char* sequence;
+    /// Quality string of the record, NULL if the qualities are not set.
+    const char* quality;
+    /// Flag of the record.
+    uint16_t flag;
+    /// Mapping quality of the record.
+    uint8_t mapQuality;
+};
+
+
+/// Adds runs of consecutive reference positions of one record to
+/// consecutive pileup elements for the record-major pileup.  This default
+/// calls addEntry on each element, so works for any PILEUP_TYPE.  Element
+/// types specialize it to append the entries directly with non-virtual
+/// inline methods, without working out the query index of each position.
+template <class PILEUP_TYPE>
+class PileupRunAdder
+{
+public:
+    /// Add count aligned bases, starting at queryIndex of the record, to
+    /// the count elements starting at elements.
+    static inline void addMatches(PILEUP_TYPE* elements, int count,
+                                  const PileupRecordInfo& info,
+                                  int32_t queryIndex)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            elements[i].addEntry(*info.record);
+        }
+    }
+
+    /// Add count deleted or skipped positions of the record to the count
+    /// elements starting at elements.
+    static inline void addDeletions(PILEUP_TYPE* elements, int count,
+                                    const PileupRecordInfo& info)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            elements[i].addEntry(*info.record);
+        }
+    }
+};
+
+
 #endif
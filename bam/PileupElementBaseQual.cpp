@@ -84,23 +84,7 @@ void PileupElementBaseQual::addEntry(SamRecord& record)
     // if the index has gone beyond the allocated space, double the size.
     if(myIndex >= myAllocatedSize)
     {
-        char* tempBuffer = (char*)realloc(myBases, myAllocatedSize * 2);
-        if(tempBuffer == NULL)
-        {
-            std::cerr << "Memory Allocation Failure\n";
-            // TODO
-            return;
-        }
-        myBases = tempBuffer;
-        tempBuffer = (char*)realloc(myQualities, myAllocatedSize * 2);
-        if(tempBuffer == NULL)
-        {
-            std::cerr << "Memory Allocation Failure\n";
-            // TODO
-            return;
-        }
-        myQualities = tempBuffer;       
-        myAllocatedSize = myAllocatedSize * 2;
+        grow();
     }
 
     Cigar* cigar = record.getCigarInfo();
@@ -154,6 +138,24 @@ void PileupElementBaseQual::analyze()
     }
 }
 
+void PileupElementBaseQual::grow()
+{
+    // Leave room for the null terminator added by analyze.
+    char* tempBuffer = (char*)realloc(myBases, myAllocatedSize * 2 + 1);
+    if(tempBuffer == NULL)
+    {
+        throw std::runtime_error("Failed to allocate pileup bases.");
+    }
+    myBases = tempBuffer;
+    tempBuffer = (char*)realloc(myQualities, myAllocatedSize * 2 + 1);
+    if(tempBuffer == NULL)
+    {
+        throw std::runtime_error("Failed to allocate pileup qualities.");
+    }
+    myQualities = tempBuffer;
+    myAllocatedSize = myAllocatedSize * 2;
+}
+
 void PileupElementBaseQual::reset(int refPosition)
 {
     // Call the base class.
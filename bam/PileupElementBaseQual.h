@@ -40,9 +40,45 @@ public:
     // Resets the entry, setting the new position associated with this element.
     virtual void reset(int32_t refPosition);
 
+    // Add the base at queryIndex of the record without the virtual call
+    // and query index lookup of addEntry, used by the record-major pileup.
+    inline void addBase(const PileupRecordInfo& info, int32_t queryIndex)
+    {
+        setChromosome(info.chromosome);
+        if(++myIndex >= myAllocatedSize)
+        {
+            grow();
+        }
+        char qual = ' ';
+        if((info.quality != NULL) && (info.quality[queryIndex] != UNSET_QUAL))
+        {
+            qual = info.quality[queryIndex];
+        }
+        myBases[myIndex] = info.sequence[queryIndex];
+        myQualities[myIndex] = qual;
+    }
+
+    // Add a deletion of the record, used by the record-major pileup.
+    inline void addDeletion(const PileupRecordInfo& info)
+    {
+        setChromosome(info.chromosome);
+        if(myAddDelAsBase)
+        {
+            if(++myIndex >= myAllocatedSize)
+            {
+                grow();
+            }
+            myBases[myIndex] = '-';
+            myQualities[myIndex] = '0';
+        }
+    }
+
 private:
     static const char UNSET_QUAL = 0xFF;
 
+    // Double the size of the buffers.
+    void grow();
+
     char* myBases;
     char* myQualities;
     int myAllocatedSize;
@@ -50,4 +86,29 @@ private:
     bool myAddDelAsBase;
 };
 
+
+template <>
+class PileupRunAdder<PileupElementBaseQual>
+{
+public:
+    static inline void addMatches(PileupElementBaseQual* elements, int count,
+                                  const PileupRecordInfo& info,
+                                  int32_t queryIndex)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            elements[i].addBase(info, queryIndex + i);
+        }
+    }
+
+    static inline void addDeletions(PileupElementBaseQual* elements,
+                                    int count, const PileupRecordInfo& info)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            elements[i].addDeletion(info);
+        }
+    }
+};
+
 #endif
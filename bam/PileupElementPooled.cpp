@@ -0,0 +1,204 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+
+#include "PileupElementPooled.h"
+
+PileupElementPooled::PileupElementPooled()
+    : PileupElement(),
+      myArena(&PileupArena::getThreadArena()),
+      myFirstBlock(PileupArena::NO_BLOCK),
+      myLastBlock(PileupArena::NO_BLOCK),
+      myLastEntries(NULL),
+      myNumBlocks(0),
+      myNumEntries(0),
+      myNumDeletions(0),
+      myCursorBlock(PileupArena::NO_BLOCK),
+      myCursorStart(0)
+{
+}
+
+
+// NOTE that this method does not actually copy, it just resets.
+PileupElementPooled::PileupElementPooled(const PileupElementPooled& q)
+    : PileupElement(),
+      myArena(&PileupArena::getThreadArena()),
+      myFirstBlock(PileupArena::NO_BLOCK),
+      myLastBlock(PileupArena::NO_BLOCK),
+      myLastEntries(NULL),
+      myNumBlocks(0),
+      myNumEntries(0),
+      myNumDeletions(0),
+      myCursorBlock(PileupArena::NO_BLOCK),
+      myCursorStart(0)
+{
+}
+
+
+PileupElementPooled::~PileupElementPooled()
+{
+    releaseBlocks();
+}
+
+
+// Add an entry to this pileup element.
+void PileupElementPooled::addEntry(SamRecord& record)
+{
+    // Call the base class:
+    PileupElement::addEntry(record);
+
+    Cigar* cigar = record.getCigarInfo();
+    if(cigar == NULL)
+    {
+        throw std::runtime_error("Failed to retrieve cigar info from the record.");
+    }
+
+    PileupRecordInfo info;
+    info.flag = record.getFlag();
+    info.mapQuality = record.getMapQuality();
+    PileupArena::Entry& entry = newEntry(info);
+
+    int32_t readIndex =
+        cigar->getQueryIndex(getRefPosition(), record.get0BasedPosition());
+
+    // If the readPosition is N/A, this is a deletion.
+    if(readIndex != CigarRoller::INDEX_NA)
+    {
+        entry.base = record.getSequence(readIndex);
+        entry.quality = record.getQuality(readIndex);
+        if(entry.quality == UNSET_QUAL)
+        {
+            entry.quality = ' ';
+        }
+        entry.readIndex = readIndex;
+    }
+    else
+    {
+        setDeletion(entry);
+    }
+}
+
+
+void PileupElementPooled::analyze()
+{
+    if(getRefPosition() == UNSET_POSITION)
+    {
+        return;
+    }
+
+    std::cout << getChromosome() << "\t" << getRefPosition() << "\tN\t"
+              << getNumBases() << "\t";
+
+    // Write the bases then the qualities a block at a time.
+    char buffer[PileupArena::BLOCK_SIZE];
+    for(int pass = 0; pass < 2; pass++)
+    {
+        int remaining = myNumEntries;
+        for(int32_t blockID = myFirstBlock; blockID != PileupArena::NO_BLOCK;
+            blockID = myArena->getBlock(blockID).next)
+        {
+            const PileupArena::Block& block = myArena->getBlock(blockID);
+            int numInBlock = remaining;
+            if(numInBlock > PileupArena::BLOCK_SIZE)
+            {
+                numInBlock = PileupArena::BLOCK_SIZE;
+            }
+            remaining -= numInBlock;
+            int length = 0;
+            for(int i = 0; i < numInBlock; i++)
+            {
+                const PileupArena::Entry& entry = block.entries[i];
+                if(!(entry.flags & PileupArena::Entry::DELETION))
+                {
+                    buffer[length++] = (pass == 0) ? entry.base : entry.quality;
+                }
+            }
+            std::cout.write(buffer, length);
+        }
+        std::cout << ((pass == 0) ? "\t" : "\n");
+    }
+}
+
+
+void PileupElementPooled::reset(int refPosition)
+{
+    // Call the base class.
+    PileupElement::reset(refPosition);
+
+    releaseBlocks();
+}
+
+
+void PileupElementPooled::release()
+{
+    releaseBlocks();
+}
+
+
+const PileupArena::Entry& PileupElementPooled::getEntry(int index) const
+{
+    if((index < 0) || (index >= myNumEntries))
+    {
+        throw std::out_of_range("PileupElementPooled::getEntry index out of range.");
+    }
+
+    // Walk from the cursor if the entry is at or after it, otherwise from
+    // the first block.
+    if((myCursorBlock == PileupArena::NO_BLOCK) || (index < myCursorStart))
+    {
+        myCursorBlock = myFirstBlock;
+        myCursorStart = 0;
+    }
+    while(index >= myCursorStart + PileupArena::BLOCK_SIZE)
+    {
+        myCursorBlock = myArena->getBlock(myCursorBlock).next;
+        myCursorStart += PileupArena::BLOCK_SIZE;
+    }
+    return(myArena->getBlock(myCursorBlock).entries[index - myCursorStart]);
+}
+
+
+void PileupElementPooled::addBlock()
+{
+    int32_t blockID = myArena->allocateBlock();
+    if(myLastBlock == PileupArena::NO_BLOCK)
+    {
+        myFirstBlock = blockID;
+    }
+    else
+    {
+        myArena->getBlock(myLastBlock).next = blockID;
+    }
+    myLastBlock = blockID;
+    myLastEntries = myArena->getBlock(blockID).entries;
+    ++myNumBlocks;
+}
+
+
+void PileupElementPooled::releaseBlocks()
+{
+    myArena->releaseChain(myFirstBlock, myLastBlock, myNumBlocks);
+    myFirstBlock = PileupArena::NO_BLOCK;
+    myLastBlock = PileupArena::NO_BLOCK;
+    myLastEntries = NULL;
+    myNumBlocks = 0;
+    myNumEntries = 0;
+    myNumDeletions = 0;
+    myCursorBlock = PileupArena::NO_BLOCK;
+    myCursorStart = 0;
+}
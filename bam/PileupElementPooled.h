@@ -0,0 +1,165 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PILEUP_ELEMENT_POOLED_H__
+#define __PILEUP_ELEMENT_POOLED_H__
+
+#include <stdint.h>
+#include "PileupElement.h"
+#include "PileupArena.h"
+#include "SamFlag.h"
+
+/// This class inherits from the base class and stores the base, quality
+/// and read information of each read at the position in a PileupArena
+/// rather than in its own buffers, so the elements of a pileup window
+/// share memory that is reused as the window slides.  analyze prints the
+/// same output as PileupElementBaseQual.
+///
+/// Elements use the arena of the thread that constructed them, so a pileup
+/// of these elements must be used and destroyed by one thread.
+class PileupElementPooled : public PileupElement
+{
+public:
+    PileupElementPooled();
+    // NOTE that this method does not actually copy, it just resets.
+    PileupElementPooled(const PileupElementPooled& q);
+    virtual ~PileupElementPooled();
+
+    /// Add an entry to this pileup element.
+    virtual void addEntry(SamRecord& record);
+
+    /// Print the bases & qualities of the position, skipping deletions.
+    virtual void analyze();
+
+    /// Resets the entry, releasing its blocks, and setting the new position
+    /// associated with this element.
+    virtual void reset(int32_t refPosition);
+
+    /// Release the blocks once the element has been analyzed, so they can
+    /// be reused by the next positions of the window.
+    virtual void release();
+
+    /// Returns the number of entries, including deletions.
+    int getNumEntries() const { return(myNumEntries); }
+
+    /// Returns the number of entries that are not deletions.
+    int getNumBases() const { return(myNumEntries - myNumDeletions); }
+
+    /// Get the entry at the specified index (in the order the reads were
+    /// added).  Accessing the entries in order takes constant time per entry.
+    /// \param index 0-based index, must be less than getNumEntries.
+    const PileupArena::Entry& getEntry(int index) const;
+
+    /// Add the base at queryIndex of the record without the virtual call
+    /// and query index lookup of addEntry, used by the record-major pileup.
+    inline void addBase(const PileupRecordInfo& info, int32_t queryIndex)
+    {
+        setChromosome(info.chromosome);
+        PileupArena::Entry& entry = newEntry(info);
+        entry.base = info.sequence[queryIndex];
+        entry.quality = ' ';
+        if((info.quality != NULL) && (info.quality[queryIndex] != UNSET_QUAL))
+        {
+            entry.quality = info.quality[queryIndex];
+        }
+        entry.readIndex = queryIndex;
+    }
+
+    /// Add a deletion of the record, used by the record-major pileup.
+    inline void addDeletion(const PileupRecordInfo& info)
+    {
+        setChromosome(info.chromosome);
+        PileupArena::Entry& entry = newEntry(info);
+        setDeletion(entry);
+    }
+
+private:
+    static const char UNSET_QUAL = 0xFF;
+
+    // Get a new entry with the record's mapping quality and strand set.
+    inline PileupArena::Entry& newEntry(const PileupRecordInfo& info)
+    {
+        int blockIndex = myNumEntries % PileupArena::BLOCK_SIZE;
+        if(blockIndex == 0)
+        {
+            addBlock();
+        }
+        ++myNumEntries;
+        PileupArena::Entry& entry = myLastEntries[blockIndex];
+        entry.mapQuality = info.mapQuality;
+        entry.flags = SamFlag::isReverse(info.flag) ?
+            PileupArena::Entry::REVERSE : 0;
+        return(entry);
+    }
+
+    // Mark the entry as a deletion.
+    inline void setDeletion(PileupArena::Entry& entry)
+    {
+        entry.base = '-';
+        entry.quality = ' ';
+        entry.flags |= PileupArena::Entry::DELETION;
+        entry.readIndex = -1;
+        ++myNumDeletions;
+    }
+
+    // Add a block to the end of the chain.
+    void addBlock();
+
+    // Release the blocks back to the arena.
+    void releaseBlocks();
+
+    PileupArena* myArena;
+    int32_t myFirstBlock;
+    int32_t myLastBlock;
+    // Entries of the last block (blocks never move in the arena).
+    PileupArena::Entry* myLastEntries;
+    int myNumBlocks;
+    int myNumEntries;
+    int myNumDeletions;
+
+    // Block holding the last entry returned by getEntry, and the index of
+    // its first entry.
+    mutable int32_t myCursorBlock;
+    mutable int myCursorStart;
+};
+
+
+template <>
+class PileupRunAdder<PileupElementPooled>
+{
+public:
+    static inline void addMatches(PileupElementPooled* elements, int count,
+                                  const PileupRecordInfo& info,
+                                  int32_t queryIndex)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            elements[i].addBase(info, queryIndex + i);
+        }
+    }
+
+    static inline void addDeletions(PileupElementPooled* elements, int count,
+                                    const PileupRecordInfo& info)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            elements[i].addDeletion(info);
+        }
+    }
+};
+
+#endif
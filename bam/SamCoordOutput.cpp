@@ -22,7 +22,10 @@
 SamCoordOutput::SamCoordOutput(SamRecordPool& pool)
     : myOutputFile(NULL),
       myHeader(NULL),
-      myPool(&pool)
+      myPool(&pool),
+      myBuckets(),
+      myWindowStart(0),
+      myNumInBuckets(0)
 {
 }
 
@@ -42,6 +45,27 @@ void SamCoordOutput::setOutputFile(SamFile* outFile, SamFileHeader* header)
 }
 
 
+void SamCoordOutput::setBucketWindow(uint32_t windowSize)
+{
+    // Move any records in the buckets to the tree, in order.
+    for(uint32_t i = 0; (i < myBuckets.size()) && (myNumInBuckets > 0); i++)
+    {
+        uint64_t chromPos = myWindowStart + i;
+        std::vector<SamRecord*>& bucket =
+            myBuckets[chromPos % myBuckets.size()];
+        for(unsigned int j = 0; j < bucket.size(); j++)
+        {
+            myReadBuffer.insert(std::pair<uint64_t, SamRecord*>(chromPos,
+                                                                bucket[j]));
+        }
+        myNumInBuckets -= bucket.size();
+    }
+    myBuckets.clear();
+    myBuckets.resize(windowSize);
+    myNumInBuckets = 0;
+}
+
+
 bool SamCoordOutput::add(SamRecord* record)
 {
     if(record != NULL)
@@ -49,6 +73,22 @@ bool SamCoordOutput::add(SamRecord* record)
         int32_t chrom = record->getReferenceID();
         uint64_t chromPos = 
             SamHelper::combineChromPos(chrom, record->get0BasedPosition());
+        if(!myBuckets.empty() && (chrom >= 0))
+        {
+            if(myNumInBuckets == 0)
+            {
+                // Nothing in the buckets, so the window can be moved
+                // to start at this record.
+                myWindowStart = chromPos;
+            }
+            if((chromPos >= myWindowStart) &&
+               (chromPos - myWindowStart < myBuckets.size()))
+            {
+                myBuckets[chromPos % myBuckets.size()].push_back(record);
+                ++myNumInBuckets;
+                return(true);
+            }
+        }
         myReadBuffer.insert(std::pair<uint64_t, SamRecord*>(chromPos, record));
         return(true);
     }
@@ -63,12 +103,13 @@ bool SamCoordOutput::flushAll()
 
 bool SamCoordOutput::flush(int32_t chromID, int32_t pos0Based)
 {
-    static std::multimap<uint64_t, SamRecord*>::iterator iter;
-
     uint64_t chromPos = SamHelper::combineChromPos(chromID, pos0Based);
+    if(chromID == -1)
+    {
+        chromPos = UINT64_MAX;
+    }
 
     bool returnVal = true;
-    iter = myReadBuffer.begin();
     
     if((myOutputFile == NULL) || (myHeader == NULL))
     {
@@ -77,22 +118,59 @@ bool SamCoordOutput::flush(int32_t chromID, int32_t pos0Based)
         returnVal = false;
     }
 
-    while((iter != myReadBuffer.end()) &&
-          (((*iter).first <= chromPos) || (chromID == -1)))
+    // Write the buckets in position order, first writing any records
+    // in the tree that start at/before each position.
+    while((myNumInBuckets > 0) && (myWindowStart <= chromPos))
     {
-        if((myOutputFile != NULL) && (myHeader != NULL))
-        {
-            returnVal &= 
-                myOutputFile->WriteRecord(*myHeader, *((*iter).second));
-        }
-        if(myPool != NULL)
-        {
-            myPool->releaseRecord((*iter).second);
-        }
-        else
+        returnVal &= flushTree(myWindowStart);
+        std::vector<SamRecord*>& bucket =
+            myBuckets[myWindowStart % myBuckets.size()];
+        for(unsigned int i = 0; i < bucket.size(); i++)
         {
-            delete((*iter).second);
+            returnVal &= writeRecord(bucket[i]);
         }
+        myNumInBuckets -= bucket.size();
+        bucket.clear();
+        ++myWindowStart;
+    }
+    returnVal &= flushTree(chromPos);
+
+    // The window now starts after the flushed position.
+    if((chromID >= 0) && (myWindowStart <= chromPos))
+    {
+        myWindowStart = chromPos + 1;
+    }
+
+    return(returnVal);
+}
+
+
+bool SamCoordOutput::writeRecord(SamRecord* record)
+{
+    bool returnVal = true;
+    if((myOutputFile != NULL) && (myHeader != NULL))
+    {
+        returnVal = myOutputFile->WriteRecord(*myHeader, *record);
+    }
+    if(myPool != NULL)
+    {
+        myPool->releaseRecord(record);
+    }
+    else
+    {
+        delete(record);
+    }
+    return(returnVal);
+}
+
+
+bool SamCoordOutput::flushTree(uint64_t chromPos)
+{
+    bool returnVal = true;
+    std::multimap<uint64_t, SamRecord*>::iterator iter = myReadBuffer.begin();
+    while((iter != myReadBuffer.end()) && ((*iter).first <= chromPos))
+    {
+        returnVal &= writeRecord((*iter).second);
         ++iter;
     }
     // Remove the elements from the begining up to,
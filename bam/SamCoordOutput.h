@@ -20,10 +20,18 @@
 
 #include "SamFile.h"
 #include "SamRecordPool.h"
+#include <vector>
 
 /// Class for buffering up output reads to ensure that it is sorted. 
 /// They are added in almost sorted order.
 /// Flush writes any records that start at/before the specified position.
+///
+/// By default, records are kept in a sorted tree.  For input that is
+/// nearly sorted (for example after soft clipping or shifting indels),
+/// setBucketWindow switches to a ring of per-position buckets covering
+/// the positions just after the last flush, which makes adding and
+/// flushing a record constant time; only records outside of that window
+/// go in the tree.  Either way, records are written in the same order.
 class SamCoordOutput
 {
 public:
@@ -43,6 +51,15 @@ public:
     /// used for writing the records.
     void setOutputFile(SamFile* outFile, SamFileHeader* header);
 
+    /// Buffer records in a ring of buckets, one per position, covering
+    /// the windowSize positions starting at the first position that has
+    /// not been flushed.  windowSize should be larger than the distance
+    /// records are out of order plus the distance between flushes; records
+    /// outside of the window are still handled, but more slowly.
+    /// \param windowSize number of positions in the window, 0 to only use
+    /// the sorted tree (the default).
+    void setBucketWindow(uint32_t windowSize);
+
     /// Add the specified record to this read buffer.
     bool add(SamRecord* record);
 
@@ -66,10 +83,24 @@ private:
     // no parameters private.
     SamCoordOutput();
 
+    // Write the record if there is an output file and release it.
+    bool writeRecord(SamRecord* record);
+
+    // Write and remove the tree records that start at/before chromPos.
+    bool flushTree(uint64_t chromPos);
+
     SamFile* myOutputFile;
     SamFileHeader* myHeader;
     std::multimap<uint64_t, SamRecord*> myReadBuffer;
     SamRecordPool* myPool;
+
+    // Ring of buckets, the bucket for a position in the window is at
+    // position % size.
+    std::vector<std::vector<SamRecord*> > myBuckets;
+    // First chrom/position in the window.
+    uint64_t myWindowStart;
+    // Number of records in the buckets.
+    uint32_t myNumInBuckets;
 };
 
 
@@ -15,9 +15,11 @@
  *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <stdexcept>
+#include <algorithm>
 #include "SamFile.h"
 #include "SamFileHeader.h"
 #include "SamRecord.h"
+#include "SamFlag.h"
 #include "BamInterface.h"
 #include "SamInterface.h"
 #include "BgzfFileType.h"
@@ -86,6 +88,10 @@ SamFile::~SamFile()
     {
         delete myStatistics;
     }
+    if(myIndexBuilder != NULL)
+    {
+        delete myIndexBuilder;
+    }
 }
 
 
@@ -204,6 +210,11 @@ bool SamFile::OpenForRead(const char * filename, SamFileHeader* header)
         }
     }
 
+    if((myFilePtr != NULL) && (myNumThreads > 0))
+    {
+        myFilePtr->setNumThreads(myNumThreads);
+    }
+
     // File is open for reading.
     myIsOpenForRead = true;
 
@@ -225,6 +236,7 @@ bool SamFile::OpenForWrite(const char * filename, SamFileHeader* header)
     // Reset for any previously operated on files.
     resetFile();
     
+    bool isBam = false;
     int lastchar = 0;
     while (filename[lastchar] != 0) lastchar++;   
     if (lastchar >= 4 && 
@@ -243,6 +255,7 @@ bool SamFile::OpenForWrite(const char * filename, SamFileHeader* header)
         myFilePtr = ifopen(filename, "wb0", InputFile::BGZF);
 
         myInterfacePtr = new BamInterface;
+        isBam = true;
     }
     else if (lastchar >= 3 && 
              filename[lastchar - 3] == 'b' &&
@@ -255,9 +268,15 @@ bool SamFile::OpenForWrite(const char * filename, SamFileHeader* header)
         {
             filename = "-";
         }
-        myFilePtr = ifopen(filename, "wb", InputFile::BGZF);
+        std::string mode = "wb";
+        if((myCompressionLevel >= 0) && (myCompressionLevel <= 9))
+        {
+            mode += (char)('0' + myCompressionLevel);
+        }
+        myFilePtr = ifopen(filename, mode.c_str(), InputFile::BGZF);
         
         myInterfacePtr = new BamInterface;
+        isBam = true;
     }
     else
     {
@@ -281,6 +300,18 @@ bool SamFile::OpenForWrite(const char * filename, SamFileHeader* header)
         myStatus.setStatus(SamStatus::FAIL_IO, errorMessage.c_str());
         return(false);
     }
+
+    if(myNumThreads > 0)
+    {
+        myFilePtr->setNumThreads(myNumThreads);
+    }
+
+    // Keep track of the BGZF blocks so the index can be built as the
+    // records are written.  Can't index stdout.
+    if(myGenerateIndex && isBam && (filename[0] != '-'))
+    {
+        myIsIndexing = myFilePtr->trackWrittenBlocks();
+    }
    
     myIsOpenForWrite = true;
 
@@ -308,6 +339,7 @@ bool SamFile::ReadBamIndex(const char* bamIndexFilename)
 
     // Create a new bam index.
     myBamIndex = new BamIndex();
+    myBamIndex->setLazyLoading(myLazyBamIndex);
     SamStatus::Status indexStat = myBamIndex->readIndex(bamIndexFilename);
 
     if(indexStat != SamStatus::SUCCESS)
@@ -376,6 +408,12 @@ bool SamFile::ReadBamIndex()
 }
 
 
+void SamFile::SetLazyBamIndex(bool lazy)
+{
+    myLazyBamIndex = lazy;
+}
+
+
 // Sets the reference to the specified genome sequence object.
 void SamFile::SetReference(GenomeSequence* reference)
 {
@@ -399,9 +437,18 @@ void SamFile::SetWriteSequenceTranslation(SamRecord::SequenceTranslation transla
 // Close the file if there is one open.
 void SamFile::Close()
 {
+    // Write the index while the file is still open.
+    std::string indexError;
+    SamStatus::Status indexStatus = writeIndex(indexError);
+
     // Resetting the file will close it if it is open, and
     // will reset all other variables.
     resetFile();
+
+    if(indexStatus != SamStatus::SUCCESS)
+    {
+        myStatus.setStatus(indexStatus, indexError.c_str());
+    }
 }
 
 
@@ -502,6 +549,14 @@ bool SamFile::WriteHeader(SamFileHeader& header)
     {
         // The header has now been successfully written.
         myHasHeader = true;
+        if(myIsIndexing)
+        {
+            if(myIndexBuilder == NULL)
+            {
+                myIndexBuilder = new BamIndexBuilder();
+            }
+            myIndexBuilder->reset(header.getReferenceInfo());
+        }
         return(true);
     }
 
@@ -628,6 +683,219 @@ bool SamFile::ReadRecord(SamFileHeader& header,
 
 
 
+// Read a batch of records from the currently opened file.
+int SamFile::ReadRecords(SamFileHeader& header, SamRecordPool& pool,
+                         std::vector<SamRecord*>& records, int maxRecords)
+{
+    myStatus = SamStatus::SUCCESS;
+
+    if(myIsOpenForRead == false)
+    {
+        // File is not open for read
+        myStatus.setStatus(SamStatus::FAIL_ORDER, 
+                           "Cannot read records since the file is not open for reading");
+        throw(std::runtime_error("SOFTWARE BUG: trying to read SAM/BAM records prior to opening the file."));
+        return(0);
+    }
+
+    if(myHasHeader == false)
+    {
+        // The header has not yet been read.
+        myStatus.setStatus(SamStatus::FAIL_ORDER, 
+                           "Cannot read records since the header has not been read.");
+        throw(std::runtime_error("SOFTWARE BUG: trying to read SAM/BAM records prior to reading the header."));
+        return(0);
+    }
+
+    // Check to see if a new region has been set.  If so, determine the
+    // chunks for that region.
+    if(myNewSection)
+    {
+        if(!processNewSection(header))
+        {
+            // processNewSection sets myStatus with the failure reason.
+            return(0);
+        }
+    }
+
+    // Determine which of the per record checks are needed for this batch.
+    bool checkSection = 
+        (myRefID != BamIndex::REF_ID_ALL) || myReadSections;
+    bool checkFlags = (myRequiredFlags != 0) || (myExcludedFlags != 0);
+    bool checkSort = (mySortedType != UNSORTED);
+
+    int numRead = 0;
+    SamRecord* record = NULL;
+    while((numRead < maxRecords) && (myStatus == SamStatus::SUCCESS))
+    {
+        // Get a record to read into unless the last one was filtered out.
+        if(record == NULL)
+        {
+            record = pool.getRecord();
+            if(record == NULL)
+            {
+                // No more records are available.
+                if(numRead == 0)
+                {
+                    myStatus.setStatus(SamStatus::FAIL_MEM, 
+                                       "No records available in the pool to read into.");
+                }
+                break;
+            }
+        }
+        record->setReference(myRefPtr);
+        record->setSequenceTranslation(myReadTranslation);
+
+        // If reading by index, make sure it is in the correct position.
+        if(!ensureIndexedReadPosition())
+        {
+            // Either there are no more records in the section
+            // or it failed to move to the right section.
+            break;
+        }
+        
+        myInterfacePtr->readRecord(myFilePtr, header, *record, myStatus);
+        if(myStatus != SamStatus::SUCCESS)
+        {
+            // Failed to read the record, so break out of the loop.
+            break;
+        }
+
+        if(checkSection && !checkRecordInSection(*record))
+        {
+            // The record is not in the section, read the next one into it.
+            // The while loop will detect if NO_MORE_RECS was set.
+            continue;
+        }
+
+        if(checkFlags)
+        {
+            uint16_t flag = record->getFlag();
+            if(((flag & myRequiredFlags) != myRequiredFlags) ||
+               ((flag & myExcludedFlags) != 0))
+            {
+                continue;
+            }
+        }
+
+        //increment the record count.
+        myRecordCount++;
+        
+        if(myStatistics != NULL)
+        {
+            // Statistics should be updated.
+            myStatistics->updateStatistics(*record);
+        }
+        
+        if(checkSort && !validateSortOrder(*record, header))
+        {
+            // ValidateSortOrder sets the status on a failure.
+            break;
+        }
+
+        records.push_back(record);
+        record = NULL;
+        ++numRead;
+    }
+
+    // Return the record that was not used.
+    pool.releaseRecord(record);
+    return(numRead);
+}
+
+
+// Read a record from the currently opened file into a BAM record view.
+bool SamFile::ReadRecord(SamFileHeader& header, 
+                         BamRecordView& record)
+{
+    myStatus = SamStatus::SUCCESS;
+
+    if(myIsOpenForRead == false)
+    {
+        // File is not open for read
+        myStatus.setStatus(SamStatus::FAIL_ORDER, 
+                           "Cannot read record since the file is not open for reading");
+        throw(std::runtime_error("SOFTWARE BUG: trying to read a SAM/BAM record prior to opening the file."));
+        return(false);
+    }
+
+    if(myHasHeader == false)
+    {
+        // The header has not yet been read.
+        myStatus.setStatus(SamStatus::FAIL_ORDER, 
+                           "Cannot read record since the header has not been read.");
+        throw(std::runtime_error("SOFTWARE BUG: trying to read a SAM/BAM record prior to reading the header."));
+        return(false);
+    }
+
+    // Check to see if a new region has been set.  If so, determine the
+    // chunks for that region.
+    if(myNewSection)
+    {
+        if(!processNewSection(header))
+        {
+            // processNewSection sets myStatus with the failure reason.
+            return(false);
+        }
+    }
+
+    // Read until a record is not successfully read or there are no more
+    // requested records.  Same as reading a SamRecord, but nothing is
+    // unpacked.
+    while(myStatus == SamStatus::SUCCESS)
+    {
+        if(!ensureIndexedReadPosition())
+        {
+            // Either there are no more records in the section
+            // or it failed to move to the right section.
+            break;
+        }
+        
+        myInterfacePtr->readRecord(myFilePtr, header, record, myStatus);
+        if(myStatus != SamStatus::SUCCESS)
+        {
+            // Failed to read the record, so break out of the loop.
+            break;
+        }
+
+        if(!checkRecordInSection(record))
+        {
+            // The record is not in the section.
+            // The while loop will detect if NO_MORE_RECS was set.
+            continue;
+        }
+
+        // Check the flag for required/excluded flags.
+        uint16_t flag = record.getFlag();
+        if(((flag & myRequiredFlags) != myRequiredFlags) ||
+           ((flag & myExcludedFlags) != 0))
+        {
+            continue;
+        }
+
+        //increment the record count.
+        myRecordCount++;
+        
+        if(myStatistics != NULL)
+        {
+            // Statistics should be updated.
+            myStatistics->updateStatistics(record);
+        }
+        
+        // Successfully read the record, so check the sort order.
+        if(!validateSortOrder(record, header))
+        {
+            // ValidateSortOrder sets the status on a failure.
+            return(false);
+        }
+        return(true);
+    }
+
+    // Return true if a record was found.
+    return(myStatus == SamStatus::SUCCESS);
+}
+
+
 // Write a record to the currently opened file.
 bool SamFile::WriteRecord(SamFileHeader& header, 
                           SamRecord& record)
@@ -662,6 +930,12 @@ bool SamFile::WriteRecord(SamFileHeader& header,
         record.setReference(myRefPtr);
     }
 
+    int64_t recordStart = 0;
+    if(myIsIndexing)
+    {
+        recordStart = myFilePtr->getUncompressedPosition();
+    }
+
     // File is open for writing and the header has been written, so write the
     // record.
     myStatus = myInterfacePtr->writeRecord(myFilePtr, header, record,
@@ -671,6 +945,17 @@ bool SamFile::WriteRecord(SamFileHeader& header,
     {
         // A record was successfully written, so increment the record count.
         myRecordCount++;
+        if(myIsIndexing)
+        {
+            // If the record is out of order, the builder stops and the
+            // failure is reported when the file is closed.
+            myIndexBuilder->addRecord(record.getReferenceID(),
+                                      record.get0BasedPosition(),
+                                      record.get0BasedAlignmentEnd() + 1,
+                                      SamFlag::isMapped(record.getFlag()),
+                                      recordStart,
+                                      myFilePtr->getUncompressedPosition());
+        }
         return(true);
     }
     return(false);
@@ -728,6 +1013,8 @@ bool SamFile::SetReadSection(int32_t refID, int32_t start, int32_t end,
     myOverlapSection = overlap;
     myStartPos = start;
     myEndPos = end;
+    myReadSections = false;
+    myRecordSections.clear();
     myRefID = refID;
     myRefName.clear();
     myChunksToRead.clear();
@@ -764,6 +1051,8 @@ bool SamFile::SetReadSection(const char* refName, int32_t start, int32_t end,
     myOverlapSection = overlap;
     myStartPos = start;
     myEndPos = end;
+    myReadSections = false;
+    myRecordSections.clear();
     if((strcmp(refName, "") == 0) || (strcmp(refName, "*") == 0))
     {
         // No Reference name specified, so read just the "-1" entries.
@@ -791,6 +1080,48 @@ bool SamFile::SetReadSection(const char* refName, int32_t start, int32_t end,
 }
 
 
+// Sets multiple regions of the BAM file to be read.
+bool SamFile::SetReadSections(const SamRegionList& regions, bool overlap)
+{
+    // If there is not a BAM file open for reading, return failure.
+    // Opening a new file clears the read section, so it must be
+    // set after the file is opened.
+    if(!myIsBamOpenForRead)
+    {
+        // There is not a BAM file open for reading.
+        myStatus.setStatus(SamStatus::FAIL_ORDER, 
+                           "Cannot set sections since there is no bam file open");
+        return(false);
+    }
+
+    myNewSection = true;
+    myOverlapSection = overlap;
+    // The sections are converted to reference ids and sorted when
+    // the first record is read, since that requires the header.
+    myReadSections = true;
+    myRegionList = regions;
+    mySections.clear();
+    myFirstSection = 0;
+    myRecordSections.clear();
+    myStartPos = -1;
+    myEndPos = -1;
+    myRefID = BamIndex::REF_ID_ALL;
+    myRefName.clear();
+    myChunksToRead.clear();
+    // Reset the end of the current chunk.  We are resetting our read, so
+    // we no longer have a "current chunk" that we are reading.
+    myCurrentChunkEnd = 0;
+    myStatus = SamStatus::SUCCESS;
+
+    // Reset the sort order criteria since we moved around in the file.    
+    myPrevCoord = -1;
+    myPrevRefID = 0;
+    myPrevReadName.Clear();
+
+    return(true);
+}
+
+
 void SamFile::SetReadFlags(uint16_t requiredFlags, uint16_t excludedFlags)
 {
     myRequiredFlags = requiredFlags;
@@ -919,6 +1250,28 @@ const BamIndex* SamFile::GetBamIndex()
 }
 
 
+void SamFile::SetNumThreads(int numThreads)
+{
+    myNumThreads = numThreads;
+    if(myFilePtr != NULL)
+    {
+        myFilePtr->setNumThreads(numThreads);
+    }
+}
+
+
+void SamFile::SetCompressionLevel(int compressionLevel)
+{
+    myCompressionLevel = compressionLevel;
+}
+
+
+void SamFile::GenerateIndex(bool genIndex)
+{
+    myGenerateIndex = genIndex;
+}
+
+
 // initialize.
 void SamFile::init()
 {
@@ -926,12 +1279,20 @@ void SamFile::init()
     myInterfacePtr = NULL;
     myStatistics = NULL;
     myBamIndex = NULL;
+    myLazyBamIndex = false;
     myRefPtr = NULL;
     myReadTranslation = SamRecord::NONE;
     myWriteTranslation = SamRecord::NONE;
     myAttemptRecovery = false;
+    myNumThreads = 0;
+    myCompressionLevel = -1;
     myRequiredFlags = 0;
     myExcludedFlags = 0;
+    myGenerateIndex = false;
+    myIndexBuilder = NULL;
+    myIsIndexing = false;
+    myReadSections = false;
+    myFirstSection = 0;
 }
 
 
@@ -965,6 +1326,11 @@ void SamFile::init(const char* filename, OpenType mode, SamFileHeader* header)
 // Reset variables for each file.
 void SamFile::resetFile()
 {
+    // Write the index if one is being built and it was not written by
+    // Close.  Any failure is lost since the file is being reset.
+    std::string indexError;
+    writeIndex(indexError);
+
     // Close the file.
     if (myFilePtr != NULL)
     {
@@ -997,6 +1363,11 @@ void SamFile::resetFile()
     myOverlapSection = true;
     myCurrentChunkEnd = 0;
     myChunksToRead.clear();
+    myReadSections = false;
+    myRegionList.clear();
+    mySections.clear();
+    myFirstSection = 0;
+    myRecordSections.clear();
     if(myBamIndex != NULL)
     {
         delete myBamIndex;
@@ -1013,6 +1384,34 @@ void SamFile::resetFile()
 }
 
 
+SamStatus::Status SamFile::writeIndex(std::string& errorMessage)
+{
+    if(!myIsIndexing)
+    {
+        return(SamStatus::SUCCESS);
+    }
+    myIsIndexing = false;
+    if(!myHasHeader || (myFilePtr == NULL))
+    {
+        // Nothing was written, so there is nothing to index.
+        return(SamStatus::SUCCESS);
+    }
+
+    std::string indexName = myFilePtr->getFileName();
+    indexName += myIndexBuilder->getExtension();
+    SamStatus::Status status =
+        myIndexBuilder->writeIndex(indexName.c_str(), *myFilePtr);
+    if(status != SamStatus::SUCCESS)
+    {
+        errorMessage = "Failed to write the bam index file ";
+        errorMessage += indexName;
+        errorMessage += ": ";
+        errorMessage += myIndexBuilder->getFailMessage();
+    }
+    return(status);
+}
+
+
 // Validate that the record is sorted compared to the previously read record
 // if there is one, according to the specified sort order.
 // If the sort order is UNSORTED, true is returned.
@@ -1024,6 +1423,22 @@ bool SamFile::validateSortOrder(SamRecord& record, SamFileHeader& header)
     }
     record.setSequenceTranslation(myReadTranslation);
 
+    return(validateSortOrder(record.getReadName(), record.getReferenceID(),
+                             record.get0BasedPosition(), header));
+}
+
+
+bool SamFile::validateSortOrder(const BamRecordView& record,
+                                SamFileHeader& header)
+{
+    return(validateSortOrder(record.getReadName(), record.getReferenceID(),
+                             record.get0BasedPosition(), header));
+}
+
+
+bool SamFile::validateSortOrder(const char* readName, int32_t refID,
+                                int32_t coord, SamFileHeader& header)
+{
     bool status = false;
     if(mySortedType == UNSORTED)
     {
@@ -1042,9 +1457,6 @@ bool SamFile::validateSortOrder(SamRecord& record, SamFileHeader& header)
         if(mySortedType == QUERY_NAME)
         {
             // Validate that it is sorted by query name.
-            // Get the query name from the record.
-            const char* readName = record.getReadName();
-
             // Check if it is sorted either in samtools way or picard's way.
             if((myPrevReadName.Compare(readName) > 0) &&
                (strcmp(myPrevReadName.c_str(), readName) > 0))
@@ -1069,9 +1481,6 @@ bool SamFile::validateSortOrder(SamRecord& record, SamFileHeader& header)
         else 
         {
             // Validate that it is sorted by COORDINATES.
-            // Get the leftmost coordinate and the reference index.
-            int32_t refID = record.getReferenceID();
-            int32_t coord = record.get0BasedPosition();
             // The unmapped reference id is at the end of a sorted file.
             if(refID == BamIndex::REF_ID_UNMAPPED)
             {
@@ -1166,7 +1575,7 @@ SamFile::SortedType SamFile::getSortOrderFromHeader(SamFileHeader& header)
  bool SamFile::ensureIndexedReadPosition()
  {
      // If no sections are specified, return true.
-     if(myRefID == BamIndex::REF_ID_ALL)
+     if((myRefID == BamIndex::REF_ID_ALL) && !myReadSections)
      {
          return(true);
      }
@@ -1210,13 +1619,39 @@ SamFile::SortedType SamFile::getSortOrderFromHeader(SamFileHeader& header)
 
 bool SamFile::checkRecordInSection(SamRecord& record)
 {
-    bool recordFound = true;
-    if(myRefID == BamIndex::REF_ID_ALL)
+    if((myRefID == BamIndex::REF_ID_ALL) && !myReadSections)
+    {
+        return(true);
+    }
+    return(checkRecordInSection(record.getReferenceID(),
+                                record.get0BasedPosition(),
+                                record.get0BasedAlignmentEnd()));
+}
+
+
+bool SamFile::checkRecordInSection(const BamRecordView& record)
+{
+    if((myRefID == BamIndex::REF_ID_ALL) && !myReadSections)
     {
         return(true);
     }
+    return(checkRecordInSection(record.getReferenceID(),
+                                record.get0BasedPosition(),
+                                record.get0BasedAlignmentEnd()));
+}
+
+
+bool SamFile::checkRecordInSection(int32_t refID, int32_t start0Based,
+                                   int32_t alignmentEnd0Based)
+{
+    if(myReadSections)
+    {
+        return(checkRecordInSections(refID, start0Based, alignmentEnd0Based));
+    }
+
+    bool recordFound = true;
     // Check to see if it is in the correct reference/position.
-    if(record.getReferenceID() != myRefID)
+    if(refID != myRefID)
     {
         // Incorrect reference ID, return no more records.
         myStatus = SamStatus::NO_MORE_RECS;
@@ -1232,7 +1667,7 @@ bool SamFile::checkRecordInSection(SamRecord& record)
     // return NO_MORE_RECS.
     // Since myEndPos is Exclusive 0-based, anything >= myEndPos is outside
     // of the region.
-    if((myEndPos != -1) && (record.get0BasedPosition() >= myEndPos))
+    if((myEndPos != -1) && (start0Based >= myEndPos))
     {
         myStatus = SamStatus::NO_MORE_RECS;
         return(false);
@@ -1241,7 +1676,7 @@ bool SamFile::checkRecordInSection(SamRecord& record)
     // We know the start is less than the end position, so the alignment
     // overlaps the region if the alignment end position is greater than the
     // start of the region.
-    if((myStartPos != -1) && (record.get0BasedAlignmentEnd() < myStartPos))
+    if((myStartPos != -1) && (alignmentEnd0Based < myStartPos))
     {
         // If it does not overlap the region, so go to the next
         // record...set recordFound back to false.
@@ -1256,9 +1691,9 @@ bool SamFile::checkRecordInSection(SamRecord& record)
         // 2) the end position is specified and the record end position
         //    is greater than or equal to the region end position.
         //    (equal to since the region is exclusive.
-        if((record.get0BasedPosition() < myStartPos) ||
+        if((start0Based < myStartPos) ||
            ((myEndPos != -1) && 
-            (record.get0BasedAlignmentEnd() >= myEndPos)))
+            (alignmentEnd0Based >= myEndPos)))
         {
             // This record is not fully contained, so move on to the next
             // record.
@@ -1268,6 +1703,60 @@ bool SamFile::checkRecordInSection(SamRecord& record)
 
     return(recordFound);
 }
+
+
+bool SamFile::checkRecordInSections(int32_t refID, int32_t start0Based,
+                                    int32_t alignmentEnd0Based)
+{
+    myRecordSections.clear();
+
+    // Records are coordinate sorted, so skip past the sections that end
+    // before this record starts, no later record can fall in them.
+    // Records without a reference are at the end of the file, past all
+    // of the sections.
+    while(myFirstSection < mySections.size())
+    {
+        const ReadSection& section = mySections[myFirstSection];
+        if((refID != BamIndex::REF_ID_UNMAPPED) &&
+           ((section.refID > refID) ||
+            ((section.refID == refID) &&
+             ((section.end == -1) || (section.end > start0Based)))))
+        {
+            break;
+        }
+        ++myFirstSection;
+    }
+    if(myFirstSection >= mySections.size())
+    {
+        // Past all of the sections.
+        myStatus = SamStatus::NO_MORE_RECS;
+        return(false);
+    }
+
+    // Check the sections that start before the end of this record.
+    for(unsigned int i = myFirstSection; 
+        (i < mySections.size()) && (mySections[i].refID == refID) &&
+            (mySections[i].start <= alignmentEnd0Based); ++i)
+    {
+        const ReadSection& section = mySections[i];
+        if((section.end != -1) && (start0Based >= section.end))
+        {
+            // This section ends before the record.
+            continue;
+        }
+        if(!myOverlapSection &&
+           ((start0Based < section.start) ||
+            ((section.end != -1) && (alignmentEnd0Based >= section.end))))
+        {
+            // Not fully contained in this section.
+            continue;
+        }
+        myRecordSections.push_back(section.index);
+    }
+
+    std::sort(myRecordSections.begin(), myRecordSections.end());
+    return(!myRecordSections.empty());
+}
    
 
 bool SamFile::processNewSection(SamFileHeader &header)
@@ -1314,6 +1803,11 @@ bool SamFile::processNewSection(SamFileHeader &header)
     // we no longer have a "current chunk" that we are reading.
     myCurrentChunkEnd = 0;
 
+    if(myReadSections)
+    {
+        return(processNewSections(header));
+    }
+
     // Check to see if the read section was set based on the reference name
     // but not yet converted to reference id.
     if(!myRefName.empty())
@@ -1350,6 +1844,59 @@ bool SamFile::processNewSection(SamFileHeader &header)
     return(true);
 }
 
+bool SamFile::processNewSections(SamFileHeader &header)
+{
+    mySections.clear();
+    myFirstSection = 0;
+    myStatus = SamStatus::SUCCESS;
+
+    // Combine the chunks for each section, keeping the sections on
+    // references that are in the header.
+    for(int i = 0; i < myRegionList.size(); i++)
+    {
+        const SamRegionList::Region& region = myRegionList.get(i);
+        ReadSection section;
+        section.refID = header.getReferenceID(region.refName.c_str());
+        section.start = region.start;
+        section.end = region.end;
+        section.index = i;
+        if((section.refID < 0) ||
+           ((section.end != -1) && (section.start >= section.end)))
+        {
+            // Unknown reference or empty region, nothing to read.
+            continue;
+        }
+
+        // Just this region's chunks, so each is only added once.
+        SortedChunkList regionChunks;
+        if(!myBamIndex->getChunksForRegion(section.refID, section.start,
+                                           section.end, regionChunks))
+        {
+            String errorMsg = "Failed to get the specified region, refID = ";
+            errorMsg += section.refID;
+            errorMsg += "; startPos = ";
+            errorMsg += section.start;
+            errorMsg += "; endPos = ";
+            errorMsg += section.end;
+            myStatus.setStatus(SamStatus::FAIL_PARSE, 
+                               errorMsg);
+            mySections.clear();
+            myChunksToRead.clear();
+            return(true);
+        }
+        myChunksToRead.add(regionChunks);
+        mySections.push_back(section);
+    }
+    myRegionList.clear();
+
+    // Merge the chunks from different sections that overlap or share
+    // a BGZF block, so each block is only read once.
+    myChunksToRead.mergeOverlapping();
+    std::stable_sort(mySections.begin(), mySections.end());
+    return(true);
+}
+
+
 //
 // When the caller to SamFile::ReadRecord() catches an
 // exception, it may choose to call this method to resync
@@ -24,7 +24,11 @@
 #include "SamRecord.h"
 #include "GenericSamInterface.h"
 #include "BamIndex.h"
+#include "BamIndexBuilder.h"
 #include "SamStatistics.h"
+#include "SamRecordPool.h"
+#include "SamRegionList.h"
+#include <vector>
 
 /// Allows the user to easily read/write a SAM/BAM file.
 /// The SamFile class contains additional functionality that allows a user
@@ -125,6 +129,14 @@ public:
     /// \return true = success; false = failure.
     bool ReadBamIndex();
 
+    /// Set whether or not bam index files read after this call are loaded
+    /// lazily, only loading the parts for a reference when a section on it
+    /// is read (see BamIndex::setLazyLoading).  Speeds up reading the index
+    /// of files with many references when only a few regions are read.
+    /// Defaults to false, and is carried over between files.
+    /// \param lazy true to load the index lazily.
+    void SetLazyBamIndex(bool lazy);
+
     /// Sets the reference to the specified genome sequence object.
     /// \param reference pointer to the GenomeSequence object.
     void SetReference(GenomeSequence* reference);
@@ -182,6 +194,39 @@ public:
     ///                false = record was not successfully set 
     ///                (or not sorted as expected).
     bool ReadRecord(SamFileHeader& header, SamRecord& record);
+
+    /// Reads the next record from the file into the passed in view without
+    /// unpacking it into a SamRecord, only supported for BAM files.
+    /// Sections, required/excluded flags, statistics, and sort validation
+    /// are handled the same as when reading into a SamRecord, and the two
+    /// versions can be mixed while reading a file.  The view's data is
+    /// only valid until the next record is read into it.
+    /// \return true  = record was successfully set (and sorted if applicable),
+    ///                false = record was not successfully set 
+    ///                (or not sorted as expected).
+    bool ReadRecord(SamFileHeader& header, BamRecordView& record);
+
+    /// Reads up to maxRecords records from the file into records taken from
+    /// the pool, appending them to the passed in vector.  The records are
+    /// read, filtered by section and flags, counted in the statistics, and
+    /// sort validated the same as ReadRecord, but with the per call checks
+    /// done once for the whole batch, and records that are filtered out
+    /// reused for the next read.  The caller owns the returned records and
+    /// should release them back to the pool when done with them, so
+    /// batches can be handed off to other threads while the next one is read.
+    ///
+    /// Fewer than maxRecords records are returned if the end of the file
+    /// or section is reached (status NO_MORE_RECS), the pool has no more
+    /// records to give out (status SUCCESS, or FAIL_MEM if no records could
+    /// be read), or a record fails to be read or is not sorted (that
+    /// record is not returned and the status is set to the failure).
+    /// \param header header of the file being read.
+    /// \param pool pool to get records from.
+    /// \param records vector the records are appended to.
+    /// \param maxRecords maximum number of records to read.
+    /// \return number of records appended to records.
+    int ReadRecords(SamFileHeader& header, SamRecordPool& pool,
+                    std::vector<SamRecord*>& records, int maxRecords);
    
     /// Writes the specified record into the file.
     /// Validates that the record is sorted according to the value set by
@@ -278,6 +323,35 @@ public:
     bool SetReadSection(const char* refName, int32_t start, int32_t end, 
                         bool overlap = true);
 
+    /// Sets multiple regions of the BAM file to be read, such as the
+    /// targets in a BED file.  The index chunks for all of the regions are
+    /// combined and chunks in the same BGZF block are merged, so the
+    /// records are read in one pass through the file, reading each block
+    /// once, rather than seeking back for each region.  Each record is
+    /// returned once even if it falls in more than one region, and
+    /// GetRecordSections returns which regions it fell in.  Regions may be
+    /// in any order and may overlap; regions on references that are not in
+    /// the header are not read.  When all records have been retrieved,
+    /// ReadRecord will return failure until a new read section is set.
+    /// Must be called only after the file has been opened for reading.
+    /// Sorting validation is reset everytime SetReadSections is called since
+    /// it can jump around in the file.
+    /// \param regions the regions to read, copied so it can be changed
+    /// after this call.
+    /// \param overlap When true (default), return reads that just overlap a region; when false, only return reads that fall completely within a region
+    /// \return true = success; false = failure.
+    bool SetReadSections(const SamRegionList& regions, bool overlap = true);
+
+    /// Returns the indices (into the SamRegionList passed to
+    /// SetReadSections) of the regions that the last record read falls in,
+    /// in increasing order.  For ReadRecords, this is for the last record in
+    /// the batch.  Empty if SetReadSections is not being used.
+    /// \return indices of the regions the last record read falls in.
+    const std::vector<int>& GetRecordSections()
+    {
+        return(myRecordSections);
+    }
+
     /// Specify which reads should be returned by ReadRecord.
     /// Reads will only be returned by ReadRecord that contain the specified
     /// required flags and that do not contain any of the specified excluded
@@ -332,6 +406,20 @@ public:
     /// \param genStats set to true if statistics should be generated, false if not.
     void GenerateStatistics(bool genStats);
 
+    /// Whether or not to build an index while writing coordinate sorted
+    /// BAM files, so a separate indexing pass is not needed.  The index is
+    /// written to the BAM filename plus ".bai" when the file is closed, or
+    /// plus ".csi" if a reference is too long for a BAI index.  If the
+    /// records are not coordinate sorted, no index is written and Close
+    /// sets the status to FAIL_ORDER.  If a record can not be indexed (its
+    /// reference is not in the header, or it is past the end the index
+    /// supports), no index is written and Close sets the status to
+    /// FAIL_PARSE.  Applies to files opened for writing
+    /// after this call (not SAM files or stdout), and is carried over
+    /// between files.
+    /// \param genIndex set to true if an index should be built, false if not.
+    void GenerateIndex(bool genIndex);
+
     /// Return the bam index if one has been opened.
     /// \return const pointer to the bam index, or null if one has not been opened.
     const BamIndex* GetBamIndex();
@@ -343,6 +431,21 @@ public:
         return(iftell(myFilePtr));
     }
     
+    /// Set the number of worker threads used to decompress BAM (BGZF)
+    /// blocks ahead of the current read position, or to compress them when
+    /// writing.  Records are still read/written in file order and indexed
+    /// reads (SetReadSection) keep working.  Applies to the open file and
+    /// to files opened afterwards.
+    /// \param numThreads number of worker threads, 0 to process the blocks
+    /// on the calling thread (default).
+    void SetNumThreads(int numThreads);
+
+    /// Set the compression level (0-9) used for BAM files opened for
+    /// writing after this call, -1 for the default level.  Files ending
+    /// in .ubam are always written uncompressed.
+    /// \param compressionLevel zlib compression level.
+    void SetCompressionLevel(int compressionLevel);
+
     /// Turn off file read buffering.
     inline void DisableBuffering()
     {
@@ -369,6 +472,7 @@ protected:
     /// Sorting validation is reset everytime SetReadPosition is called since
     /// it can jump around in the file.
     bool validateSortOrder(SamRecord& record, SamFileHeader& header);
+    bool validateSortOrder(const BamRecordView& record, SamFileHeader& header);
    
     // Return the sort order as defined by the header.  If it is undefined
     // or set to an unknown value, UNSORTED is returned.
@@ -391,6 +495,28 @@ protected:
     // If the record position indicates there will be no more records within the
     // region, return false AND set the sam status to indicate NO_MORE_RECS.
     bool checkRecordInSection(SamRecord& record);
+    bool checkRecordInSection(const BamRecordView& record);
+    bool checkRecordInSection(int32_t refID, int32_t start0Based,
+                              int32_t alignmentEnd0Based);
+
+    // Check whether or not the record falls within the sections specified
+    // by SetReadSections, setting myRecordSections to the ones it does.
+    // Same return and status as checkRecordInSection.
+    bool checkRecordInSections(int32_t refID, int32_t start0Based,
+                               int32_t alignmentEnd0Based);
+
+    // Get the chunks for the sections specified by SetReadSections.
+    bool processNewSections(SamFileHeader &header);
+
+    // Validate the sort order of a record with the specified read name,
+    // reference id, and 0-based position.
+    bool validateSortOrder(const char* readName, int32_t refID,
+                           int32_t coord, SamFileHeader& header);
+
+    // Write the index being built for the file being written, if there is
+    // one.  Returns the status of the write, setting errorMessage if it
+    // failed.
+    SamStatus::Status writeIndex(std::string& errorMessage);
 
     IFILE  myFilePtr;
     GenericSamInterface* myInterfacePtr;
@@ -431,6 +557,36 @@ protected:
     uint64_t myCurrentChunkEnd;
     SortedChunkList myChunksToRead;
     BamIndex* myBamIndex;
+    bool myLazyBamIndex;
+
+    /// Values for reading multiple sections (SetReadSections).
+    struct ReadSection
+    {
+        int32_t refID;
+        int32_t start;
+        int32_t end;
+        // Index of the region in the SamRegionList.
+        int index;
+
+        bool operator< (const ReadSection& other) const
+        {
+            return((refID < other.refID) ||
+                   ((refID == other.refID) && (start < other.start)));
+        }
+    };
+    bool myReadSections;
+    SamRegionList myRegionList;
+    // Sections sorted by reference id and start.
+    std::vector<ReadSection> mySections;
+    // First section that records still being read could fall in.
+    unsigned int myFirstSection;
+    std::vector<int> myRecordSections;
+
+    /// Values for building an index while writing a BAM file.
+    bool myGenerateIndex;
+    BamIndexBuilder* myIndexBuilder;
+    // Whether or not an index is being built for the open file.
+    bool myIsIndexing;
 
     GenomeSequence* myRefPtr;
     SamRecord::SequenceTranslation myReadTranslation;
@@ -441,6 +597,9 @@ protected:
 private:
     bool    myAttemptRecovery;
 
+    int myNumThreads;
+    int myCompressionLevel;
+
     uint16_t myRequiredFlags;
     uint16_t myExcludedFlags;
 
@@ -0,0 +1,478 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <set>
+#include "SamMergeReader.h"
+#include "SamHelper.h"
+
+
+SamMergeReader::Input::Input()
+    : file(ErrorHandler::RETURN),
+      header(),
+      record(ErrorHandler::RETURN),
+      chromPos(0),
+      done(false),
+      sameRefIDs(true),
+      rgIDs(),
+      pgIDs()
+{
+}
+
+
+SamMergeReader::Input::~Input()
+{
+}
+
+
+SamMergeReader::SamMergeReader()
+    : myInputs(),
+      myTree(),
+      myHeader(NULL),
+      myLastInput(-1),
+      myNumThreads(0),
+      myStatus(ErrorHandler::RETURN)
+{
+}
+
+
+SamMergeReader::~SamMergeReader()
+{
+    close();
+}
+
+
+void SamMergeReader::setNumThreads(int numThreads)
+{
+    myNumThreads = numThreads;
+}
+
+
+bool SamMergeReader::open(const std::vector<std::string>& filenames,
+                          SamFileHeader& header)
+{
+    close();
+    myStatus = SamStatus::SUCCESS;
+    if(filenames.empty())
+    {
+        myStatus.setStatus(SamStatus::FAIL_ORDER, "No files to merge");
+        return(false);
+    }
+
+    for(unsigned int i = 0; i < filenames.size(); i++)
+    {
+        Input* input = new Input();
+        myInputs.push_back(input);
+        input->file.SetNumThreads(myNumThreads);
+        if(!input->file.OpenForRead(filenames[i].c_str(), &(input->header)))
+        {
+            myStatus.setStatus(input->file.GetStatus(),
+                               input->file.GetStatusMessage());
+            close();
+            return(false);
+        }
+        // The merge relies on each input being sorted.
+        input->file.setSortedValidation(SamFile::COORDINATE);
+    }
+
+    header.resetHeader();
+    if(!mergeHeaders(header))
+    {
+        close();
+        return(false);
+    }
+    myHeader = &header;
+
+    // Read the first record of each input and build the tree.
+    int numInputs = myInputs.size();
+    for(int i = 0; i < numInputs; i++)
+    {
+        if(!readNext(i))
+        {
+            close();
+            return(false);
+        }
+    }
+    myTree.assign(numInputs, 0);
+    if(numInputs > 1)
+    {
+        // Play each match from the leaves up, keeping the winners of each
+        // node to play at the next level.
+        std::vector<int> winners(2 * numInputs);
+        for(int i = 0; i < numInputs; i++)
+        {
+            winners[numInputs + i] = i;
+        }
+        for(int node = numInputs - 1; node >= 1; node--)
+        {
+            int left = winners[2 * node];
+            int right = winners[2 * node + 1];
+            if(isBefore(right, left))
+            {
+                winners[node] = right;
+                myTree[node] = left;
+            }
+            else
+            {
+                winners[node] = left;
+                myTree[node] = right;
+            }
+        }
+        myTree[0] = winners[1];
+    }
+    return(true);
+}
+
+
+SamRecord* SamMergeReader::readRecord()
+{
+    if(myInputs.empty() || (myHeader == NULL))
+    {
+        myStatus.setStatus(SamStatus::FAIL_ORDER,
+                           "Cannot read a record since no files are open");
+        return(NULL);
+    }
+    myStatus = SamStatus::SUCCESS;
+
+    // Replace the record that was returned last time.
+    if(myLastInput >= 0)
+    {
+        if(!readNext(myLastInput))
+        {
+            return(NULL);
+        }
+        replay(myLastInput);
+    }
+
+    myLastInput = myTree[0];
+    Input* input = myInputs[myLastInput];
+    if(input->done)
+    {
+        // The winner is only done when all inputs are.
+        myLastInput = -1;
+        myStatus = SamStatus::NO_MORE_RECS;
+        return(NULL);
+    }
+    return(&(input->record));
+}
+
+
+void SamMergeReader::close()
+{
+    for(unsigned int i = 0; i < myInputs.size(); i++)
+    {
+        myInputs[i]->file.Close();
+        delete myInputs[i];
+    }
+    myInputs.clear();
+    myTree.clear();
+    myHeader = NULL;
+    myLastInput = -1;
+}
+
+
+bool SamMergeReader::mergeHeaders(SamFileHeader& header)
+{
+    SamFileHeader& firstHeader = myInputs[0]->header;
+    if(firstHeader.getHD() != NULL)
+    {
+        header.addRecordCopy(*(firstHeader.getHD()));
+    }
+    else
+    {
+        header.setHDTag("VN", "1.0");
+    }
+    header.setHDTag("SO", "coordinate");
+
+    std::set<std::string> comments;
+    for(unsigned int i = 0; i < myInputs.size(); i++)
+    {
+        Input& input = *(myInputs[i]);
+        if(!mergeReferences(input, header) ||
+           !mergeIDs(input, header, true) || !mergeIDs(input, header, false))
+        {
+            return(false);
+        }
+        input.header.resetCommentIter();
+        const char* comment = input.header.getNextComment();
+        while(comment[0] != '\0')
+        {
+            if(comments.insert(comment).second)
+            {
+                header.addComment(comment);
+            }
+            comment = input.header.getNextComment();
+        }
+    }
+    return(true);
+}
+
+
+bool SamMergeReader::mergeReferences(Input& input, SamFileHeader& header)
+{
+    const SamReferenceInfo& refInfo = input.header.getReferenceInfo();
+    int32_t prevID = -1;
+    for(int32_t refID = 0; refID < refInfo.getNumEntries(); refID++)
+    {
+        const char* name = refInfo.getReferenceLabel(refID).c_str();
+        int32_t length = refInfo.getReferenceLength(refID);
+        int32_t mergedID = header.getReferenceID(name);
+        if(mergedID < 0)
+        {
+            // New reference, so add it after the others.
+            SamHeaderSQ* sq = input.header.getSQ(name);
+            if(sq != NULL)
+            {
+                header.addRecordCopy(*sq);
+            }
+            else
+            {
+                char lengthString[16];
+                snprintf(lengthString, sizeof(lengthString), "%d", length);
+                header.setSQTag("LN", lengthString, name);
+            }
+            mergedID = header.getReferenceID(name);
+        }
+        else if(header.getReferenceInfo().getReferenceLength(mergedID) !=
+                length)
+        {
+            std::string message = "Reference ";
+            message += name;
+            message += " has different lengths in the files being merged";
+            myStatus.setStatus(SamStatus::FAIL_PARSE, message.c_str());
+            return(false);
+        }
+        if(mergedID <= prevID)
+        {
+            std::string message = "Reference ";
+            message += name;
+            message +=
+                " is in a different order than in the other files being merged";
+            myStatus.setStatus(SamStatus::FAIL_PARSE, message.c_str());
+            return(false);
+        }
+        if(mergedID != refID)
+        {
+            input.sameRefIDs = false;
+        }
+        prevID = mergedID;
+    }
+    return(true);
+}
+
+
+bool SamMergeReader::mergeIDs(Input& input, SamFileHeader& header, bool isRG)
+{
+    std::map<std::string, std::string>& renamed =
+        isRG ? input.rgIDs : input.pgIDs;
+
+    // Find the lines that are already in the merged header, and the ones
+    // that need new IDs.
+    std::vector<std::string> lines;
+    std::set<std::string> inputIDs;
+    if(isRG)
+    {
+        input.header.resetRGRecordIter();
+    }
+    else
+    {
+        input.header.resetPGRecordIter();
+    }
+    SamHeaderRecord* record = NULL;
+    while((record = (isRG ? input.header.getNextRGRecord() :
+                     input.header.getNextPGRecord())) != NULL)
+    {
+        std::string id = record->getTagValue("ID");
+        inputIDs.insert(id);
+        std::string line;
+        record->appendString(line);
+        SamHeaderRecord* existing = NULL;
+        if(isRG)
+        {
+            existing = header.getRG(id.c_str());
+        }
+        else
+        {
+            existing = header.getPG(id.c_str());
+        }
+        if(existing != NULL)
+        {
+            std::string existingLine;
+            existing->appendString(existingLine);
+            if(existingLine == line)
+            {
+                // Same line, so it is shared.
+                continue;
+            }
+            renamed[id] = "";
+        }
+        lines.push_back(line);
+    }
+
+    // Pick IDs that are not in the merged header or this input.
+    char suffix[16];
+    std::map<std::string, std::string>::iterator iter;
+    for(iter = renamed.begin(); iter != renamed.end(); iter++)
+    {
+        for(int n = 1; iter->second.empty(); n++)
+        {
+            snprintf(suffix, sizeof(suffix), "-%d", n);
+            std::string newID = iter->first + suffix;
+            bool inHeader = isRG ? (header.getRG(newID.c_str()) != NULL) :
+                (header.getPG(newID.c_str()) != NULL);
+            if(!inHeader && (inputIDs.count(newID) == 0))
+            {
+                iter->second = newID;
+            }
+        }
+    }
+
+    // Add the lines with the IDs (and PG's previous program) updated.
+    for(unsigned int i = 0; i < lines.size(); i++)
+    {
+        std::string line = lines[i];
+        if(!line.empty() && (line[line.size() - 1] == '\n'))
+        {
+            line.erase(line.size() - 1);
+        }
+        if(!renamed.empty())
+        {
+            std::string updated;
+            size_t start = 0;
+            while(start != std::string::npos)
+            {
+                size_t end = line.find('\t', start);
+                std::string field = line.substr(start, end - start);
+                if((field.compare(0, 3, "ID:") == 0) ||
+                   (!isRG && (field.compare(0, 3, "PP:") == 0)))
+                {
+                    iter = renamed.find(field.substr(3));
+                    if(iter != renamed.end())
+                    {
+                        field = field.substr(0, 3) + iter->second;
+                    }
+                }
+                if(start != 0)
+                {
+                    updated += '\t';
+                }
+                updated += field;
+                start = (end == std::string::npos) ? end : end + 1;
+            }
+            line.swap(updated);
+        }
+        if(!header.addHeaderLine(line.c_str()))
+        {
+            std::string message = "Failed to merge the header line: " + line;
+            myStatus.setStatus(SamStatus::FAIL_PARSE, message.c_str());
+            return(false);
+        }
+    }
+    return(true);
+}
+
+
+bool SamMergeReader::readNext(int inputIndex)
+{
+    Input& input = *(myInputs[inputIndex]);
+    if(input.done)
+    {
+        return(true);
+    }
+    if(!input.file.ReadRecord(input.header, input.record))
+    {
+        input.done = true;
+        if(input.file.GetStatus() != SamStatus::NO_MORE_RECS)
+        {
+            myStatus.setStatus(input.file.GetStatus(),
+                               input.file.GetStatusMessage());
+            return(false);
+        }
+        return(true);
+    }
+
+    SamRecord& record = input.record;
+    if(!input.sameRefIDs)
+    {
+        // Copy the names since setting them overwrites the record's copy.
+        std::string refName = record.getReferenceName();
+        std::string mateRefName = record.getMateReferenceName();
+        record.setReferenceName(*myHeader, refName.c_str());
+        record.setMateReferenceName(*myHeader, mateRefName.c_str());
+    }
+    std::map<std::string, std::string>::iterator iter;
+    if(!input.rgIDs.empty())
+    {
+        const String* rg = record.getStringTag("RG");
+        if((rg != NULL) &&
+           ((iter = input.rgIDs.find(rg->c_str())) != input.rgIDs.end()))
+        {
+            record.addTag("RG", 'Z', iter->second.c_str());
+        }
+    }
+    if(!input.pgIDs.empty())
+    {
+        const String* pg = record.getStringTag("PG");
+        if((pg != NULL) &&
+           ((iter = input.pgIDs.find(pg->c_str())) != input.pgIDs.end()))
+        {
+            record.addTag("PG", 'Z', iter->second.c_str());
+        }
+    }
+
+    // Unplaced records (position -1) go before the placed records of
+    // their reference, and records without a reference go last.
+    input.chromPos =
+        SamHelper::combineChromPos(record.getReferenceID(),
+                                   record.get0BasedPosition() + 1);
+    return(true);
+}
+
+
+bool SamMergeReader::isBefore(int a, int b) const
+{
+    const Input* inputA = myInputs[a];
+    const Input* inputB = myInputs[b];
+    if(inputA->done || inputB->done)
+    {
+        return(!inputA->done);
+    }
+    if(inputA->chromPos != inputB->chromPos)
+    {
+        return(inputA->chromPos < inputB->chromPos);
+    }
+    return(a < b);
+}
+
+
+void SamMergeReader::replay(int inputIndex)
+{
+    // Play the input against the losers on the path to the root,
+    // keeping the loser at each node.
+    int numInputs = myInputs.size();
+    int winner = inputIndex;
+    for(int node = (numInputs + inputIndex) / 2; node >= 1; node /= 2)
+    {
+        if(isBefore(myTree[node], winner))
+        {
+            int loser = winner;
+            winner = myTree[node];
+            myTree[node] = loser;
+        }
+    }
+    myTree[0] = winner;
+}
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SAM_MERGE_READER_H__
+#define __SAM_MERGE_READER_H__
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "SamFile.h"
+
+/// Reads several coordinate sorted SAM/BAM files as one, returning their
+/// records in coordinate order.
+///
+/// The headers of the inputs are merged into one header:
+///   - references are matched by name, references only in later inputs
+///     are added after the earlier ones, and record reference IDs are
+///     remapped to the merged header.  References with the same name must
+///     have the same length, and the inputs must list their shared
+///     references in the same relative order.
+///   - RG and PG lines with the same ID and the same fields are kept once.
+///     If the fields differ, the later one gets a new ID (ID-1, ID-2, ...)
+///     and its records' RG/PG tags (and PP tags of its PG lines) are
+///     updated to match.
+///   - the HD line is taken from the first input with SO set to
+///     coordinate, and duplicate comments are dropped.
+///
+/// The next record of each input is kept in a tournament (loser) tree, so
+/// each record takes log2(number of inputs) comparisons.  Records at the
+/// same position are returned in input order.
+class SamMergeReader
+{
+public:
+    SamMergeReader();
+    ~SamMergeReader();
+
+    /// Set the number of BGZF read-ahead threads for each BAM input,
+    /// applied to the files opened afterwards, so the decompression of all
+    /// of the inputs overlaps with each other and with the merge.
+    /// \param numThreads number of threads per input, 0 for none (default).
+    void setNumThreads(int numThreads);
+
+    /// Open the coordinate sorted files and merge their headers, closing
+    /// any files that are already open.
+    /// \param filenames names of the SAM/BAM files to merge.
+    /// \param header set to the merged header.
+    /// \return true if the files were opened and their headers merged,
+    /// false on failure (see getStatus).
+    bool open(const std::vector<std::string>& filenames,
+              SamFileHeader& header);
+
+    /// Get the next record in coordinate order.  The record belongs to
+    /// this reader and is valid until the next call to readRecord or close.
+    /// Its reference IDs and RG/PG tags are for the merged header.
+    /// \return the next record, NULL if there are no more records
+    /// (getStatus is NO_MORE_RECS) or on failure.
+    SamRecord* readRecord();
+
+    /// Returns the index of the input that the last record was read from.
+    int getRecordInput() const
+    {
+        return(myLastInput);
+    }
+
+    /// Returns the number of open inputs.
+    int getNumInputs() const
+    {
+        return(myInputs.size());
+    }
+
+    /// Close all of the inputs.
+    void close();
+
+    /// Returns the status of the last method call, with the reason if it
+    /// failed.
+    const SamStatus& getStatus() const
+    {
+        return(myStatus);
+    }
+
+private:
+    SamMergeReader(const SamMergeReader& other);
+    SamMergeReader& operator=(const SamMergeReader& other);
+
+    // An input file, its next record, and how to update its records.
+    struct Input
+    {
+        Input();
+        ~Input();
+
+        SamFile file;
+        SamFileHeader header;
+        SamRecord record;
+        // Sort key of the record, not valid once done.
+        uint64_t chromPos;
+        bool done;
+        // Whether the input's reference IDs match the merged ones.
+        bool sameRefIDs;
+        // The RG/PG IDs that were renamed in the merged header.
+        std::map<std::string, std::string> rgIDs;
+        std::map<std::string, std::string> pgIDs;
+    };
+
+    // Merge the header of each input into the merged header.
+    bool mergeHeaders(SamFileHeader& header);
+    bool mergeReferences(Input& input, SamFileHeader& header);
+    // Merge the RG or PG lines of the input into the merged header.
+    bool mergeIDs(Input& input, SamFileHeader& header, bool isRG);
+
+    // Read the next record of the input, updating it to the merged header.
+    bool readNext(int inputIndex);
+
+    // Whether input a's record comes before input b's.
+    bool isBefore(int a, int b) const;
+
+    // Update the tree after the record of the specified input changed.
+    void replay(int inputIndex);
+
+    std::vector<Input*> myInputs;
+    // Loser tree: myTree[0] is the input with the next record and
+    // myTree[1..n-1] are the losers at each internal node.  The leaf of
+    // input i is at n + i.
+    std::vector<int> myTree;
+    SamFileHeader* myHeader;
+    // Input whose record was last returned, which is read next.
+    int myLastInput;
+    int myNumThreads;
+    SamStatus myStatus;
+};
+
+#endif
@@ -19,6 +19,7 @@
 
 #include "SamQuerySeqWithRefHelper.h"
 #include "BaseUtilities.h"
+#include "BasePacking.h"
 #include "SamFlag.h"
 
 SamQuerySeqWithRefIter::SamQuerySeqWithRefIter(SamRecord& record,
@@ -247,49 +248,8 @@ void SamQuerySeqWithRef::seqWithEquals(const char* currentSeq,
                                        const GenomeSequence& refSequence,
                                        std::string& updatedSeq)
 {
-    updatedSeq = currentSeq;
-
-    int32_t seqLength = updatedSeq.length();
-    int32_t queryIndex = 0;
-
-    uint32_t startOfReadOnRefIndex = 
-        refSequence.getGenomePosition(referenceName);
-    
-    if(startOfReadOnRefIndex == INVALID_GENOME_INDEX)
-    {
-        // This reference name was not found in the reference file, so just
-        // return.
-        return;
-    }
-    startOfReadOnRefIndex += seq0BasedPos;
-    
-    // Loop until the entire sequence has been updated.
-    while(queryIndex < seqLength)
-    {
-        // Still more bases, look for matches.
-
-        // Get the reference offset for this read position.
-        int32_t refOffset = cigar.getRefOffset(queryIndex);
-        if(refOffset != Cigar::INDEX_NA)
-        {
-            // Both the reference and the read have a base, so get the bases.
-            char readBase = currentSeq[queryIndex];
-            char refBase = refSequence[startOfReadOnRefIndex + refOffset];
-
-            // If neither base is unknown and they are the same, count it
-            // as a match.
-            if(!BaseUtilities::isAmbiguous(readBase) && 
-               !BaseUtilities::isAmbiguous(refBase) && 
-               (BaseUtilities::areEqual(readBase, refBase)))
-            {
-                // Match.
-                updatedSeq[queryIndex] = '=';
-            }
-        }
-        // Increment the query index to the next position.
-        ++queryIndex;
-        continue;
-    }
+    translateSeq(currentSeq, seq0BasedPos, cigar, referenceName,
+                 refSequence, updatedSeq, true);
 }
 
 
@@ -299,11 +259,23 @@ void SamQuerySeqWithRef::seqWithoutEquals(const char* currentSeq,
                                           const char* referenceName,
                                           const GenomeSequence& refSequence,
                                           std::string& updatedSeq)
+{
+    translateSeq(currentSeq, seq0BasedPos, cigar, referenceName,
+                 refSequence, updatedSeq, false);
+}
+
+
+void SamQuerySeqWithRef::translateSeq(const char* currentSeq,
+                                      int32_t seq0BasedPos,
+                                      Cigar& cigar, 
+                                      const char* referenceName,
+                                      const GenomeSequence& refSequence,
+                                      std::string& updatedSeq,
+                                      bool toEquals)
 {
     updatedSeq = currentSeq;
 
     int32_t seqLength = updatedSeq.length();
-    int32_t queryIndex = 0;
 
     uint32_t startOfReadOnRefIndex = 
         refSequence.getGenomePosition(referenceName);
@@ -315,33 +287,53 @@ void SamQuerySeqWithRef::seqWithoutEquals(const char* currentSeq,
         return;
     }
     startOfReadOnRefIndex += seq0BasedPos;
-    
-    // Loop until the entire sequence has been updated.
-    while(queryIndex < seqLength)
-    {
-        // Still more bases, look for matches.
 
-        // Get the reference offset for this read position.
-        int32_t refOffset = cigar.getRefOffset(queryIndex);
-        if(refOffset != Cigar::INDEX_NA)
+    // Walk the cigar, comparing each match/mismatch run of read bases
+    // against the reference bases it aligns to.
+    // (Bases that match are set to '=' when translating to equals.  When
+    // translating from equals, ambiguous bases are not skipped to catch a
+    // case where ambiguous had been converted to a '=', and if both are
+    // ambiguous, it will still be set to ambiguous.)
+    std::string refBases;
+    int32_t queryIndex = 0;
+    int32_t refOffset = 0;
+    for(int i = 0; (i < cigar.size()) && (queryIndex < seqLength); i++)
+    {
+        const Cigar::CigarOperator& op = cigar.getOperator(i);
+        if(Cigar::isMatchOrMismatch(op))
         {
-            // Both the reference and the read have a base, so get the bases.
-            char readBase = currentSeq[queryIndex];
-            char refBase = refSequence[startOfReadOnRefIndex + refOffset];
-            
-            // If the bases are equal, set the sequence to the reference
-            // base. (Skips the check for ambiguous to catch a case where
-            // ambiguous had been converted to a '=', and if both are ambiguous,
-            // it will still be set to ambiguous.)
-            if(BaseUtilities::areEqual(readBase, refBase))
+            // Both the reference and the read have bases.
+            int32_t runLength = op.count;
+            if(runLength > seqLength - queryIndex)
             {
-                // Match.
-                updatedSeq[queryIndex] = refBase;
+                runLength = seqLength - queryIndex;
+            }
+            refBases.resize(runLength);
+            for(int32_t j = 0; j < runLength; j++)
+            {
+                refBases[j] = 
+                    refSequence[startOfReadOnRefIndex + refOffset + j];
+            }
+            if(toEquals)
+            {
+                BasePacking::seqWithEquals(currentSeq + queryIndex,
+                                           refBases.c_str(), runLength,
+                                           &(updatedSeq[queryIndex]));
+            }
+            else
+            {
+                BasePacking::seqWithoutEquals(currentSeq + queryIndex,
+                                              refBases.c_str(), runLength,
+                                              &(updatedSeq[queryIndex]));
             }
         }
-
-        // Increment the query index to the next position.
-        ++queryIndex;
-        continue;
+        if(Cigar::foundInQuery(op))
+        {
+            queryIndex += op.count;
+        }
+        if(Cigar::foundInReference(op))
+        {
+            refOffset += op.count;
+        }
     }
 }
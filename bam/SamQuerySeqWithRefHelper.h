@@ -137,5 +137,16 @@ public:
 
 private:
     SamQuerySeqWithRef();
+
+    // Compare the cigar's match/mismatch runs of the sequence against the
+    // reference, translating to '=' if toEquals is set, or from '='
+    // otherwise.
+    static void translateSeq(const char* currentSeq,
+                             int32_t seq0BasedPos,
+                             Cigar& cigar, 
+                             const char* referenceName,
+                             const GenomeSequence& refSequence,
+                             std::string& updatedSeq,
+                             bool toEquals);
 };
 #endif
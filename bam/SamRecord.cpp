@@ -25,6 +25,7 @@
 #include "SamValidation.h"
 
 #include "BaseUtilities.h"
+#include "BasePacking.h"
 #include "SamQuerySeqWithRefHelper.h"
 
 const char* SamRecord::DEFAULT_READ_NAME = "UNKNOWN";
@@ -2613,74 +2614,39 @@ bool SamRecord::fixBuffer(SequenceTranslation translation)
             translatedSeq = getSequence(translation);
         }
 
-        for (int i = 0; i < myRecordPtr->myReadLength; i++) 
+        if((!myIsSequenceBufferValid) ||
+           (translation != myBufferSequenceTranslation))
         {
-            if((!myIsSequenceBufferValid) ||
-               (translation != myBufferSequenceTranslation))
+            // Sequence buffer is not valid, so set the sequence.
+            if(!BasePacking::packSequence(translatedSeq,
+                                          myRecordPtr->myReadLength,
+                                          packedSequence))
             {
-                // Sequence buffer is not valid, so set the sequence.
-                int seqVal = 0;
-                switch(translatedSeq[i])
-                {
-                    case '=':
-                        seqVal = 0;
-                        break;
-                    case 'A':
-                    case 'a':
-                        seqVal = 1;
-                        break;
-                    case 'C':
-                    case 'c':
-                        seqVal = 2;
-                        break;
-                    case 'G':
-                    case 'g':
-                        seqVal = 4;
-                        break;
-                    case 'T':
-                    case 't':
-                        seqVal = 8;
-                        break;
-                    case 'N':
-                    case 'n':
-                    case '.':
-                        seqVal = 15;
-                        break;
-                    default:
-                        myStatus.addError(SamStatus::FAIL_PARSE,
-                                          "Unknown Sequence character found.");
-                        status = false;
-                        break;
-                };
-            
-                if(i & 1)
-                {
-                    // Odd number i's go in the lower 4 bits, so OR in the
-                    // lower bits
-                    packedSequence[i/2] |= seqVal;
-                }
-                else
-                {
-                    // Even i's go in the upper 4 bits and are always set first.
-                    packedSequence[i/2] = seqVal << 4;
-                }
+                myStatus.addError(SamStatus::FAIL_PARSE,
+                                  "Unknown Sequence character found.");
+                status = false;
             }
+        }
 
-            if(!myIsQualityBufferValid)
+        if(!myIsQualityBufferValid)
+        {
+            // Set the quality.
+            int qualityLen = 0;
+            if(!noQuality)
             {
-                // Set the quality.
-                if((noQuality) || (myQuality.Length() <= i))
-                {
-                    // No quality or the quality is smaller than the sequence,
-                    // so set it to 0xFF
-                    packedQuality[i] = 0xFF;
-                }
-                else
+                // Copy the quality string.
+                qualityLen = myQuality.Length();
+                if(qualityLen > myRecordPtr->myReadLength)
                 {
-                    // Copy the quality string.
-                    packedQuality[i] = myQuality[i] - 33;
+                    qualityLen = myRecordPtr->myReadLength;
                 }
+                BasePacking::packQuality(myQuality.c_str(), qualityLen,
+                                         packedQuality);
             }
+            // No quality or the quality is smaller than the sequence,
+            // so set the rest to 0xFF
+            memset(packedQuality + qualityLen, 0xFF,
+                   myRecordPtr->myReadLength - qualityLen);
         }
         myPackedSequence = (unsigned char *)myRecordPtr->myData + 
             myRecordPtr->myReadNameLength + 
@@ -2756,31 +2722,22 @@ void SamRecord::setSequenceAndQualityFromBuffer()
         myQuality.SetLength(myRecordPtr->myReadLength);
     }
    
-    const char * asciiBases = "=AC.G...T......N";
-
     // Flag to see if the quality is specified - the quality contains a value
     // other than 0xFF.  If all values are 0xFF, then there is no quality.
     bool qualitySpecified = false;
 
-    for (int i = 0; i < myRecordPtr->myReadLength; i++)
+    if(extractSequence)
     {
-        if(extractSequence)
-        {
-            mySequence[i] = i & 1 ?
-                asciiBases[myPackedSequence[i / 2] & 0xF] :
-                asciiBases[myPackedSequence[i / 2] >> 4];
-        }
-
-        if(extractQuality)
-        {
-            if(myPackedQuality[i] != 0xFF)
-            {
-                // Quality is specified, so mark the flag.
-                qualitySpecified = true;
-            }
-
-            myQuality[i] = myPackedQuality[i] + 33;
-        }
+        BasePacking::unpackSequence(myPackedSequence,
+                                    myRecordPtr->myReadLength,
+                                    (char*)mySequence);
+    }
+    if(extractQuality)
+    {
+        qualitySpecified =
+            BasePacking::unpackQuality(myPackedQuality,
+                                       myRecordPtr->myReadLength,
+                                       (char*)myQuality);
     }
 
     // If the read length is 0, then set the sequence and quality to '*'
@@ -0,0 +1,568 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/time.h>
+#include <stdexcept>
+#include "SamRecordPipeline.h"
+
+
+SamRecordPipeline::SamRecordPipeline(int numWorkers, int batchSize,
+                                     int maxBatches)
+    : myNumWorkers(numWorkers),
+      myBatchSize(batchSize),
+      myMaxBatches(maxBatches),
+      myOutFile(NULL),
+      myHeader(NULL),
+      myProcessor(NULL),
+      myPool(),
+      myNextReadSequence(0),
+      myNextWriteSequence(0),
+      myNumInFlight(0),
+      myReadDone(false),
+      myFailed(false),
+      myNumRead(0),
+      myNumWritten(0),
+      myNumDropped(0),
+      myMaxWorkQueueDepth(0),
+      myMaxWriteQueueDepth(0),
+      myStartTime(0),
+      myEndTime(0),
+      myRunning(false),
+      myStatus(ErrorHandler::RETURN)
+{
+    if(myNumWorkers < 1)
+    {
+        myNumWorkers = 1;
+    }
+    if(myBatchSize < 1)
+    {
+        myBatchSize = 1;
+    }
+    if(myMaxBatches < 1)
+    {
+        // Enough for each worker to have one batch and one queued, plus
+        // one being read and one being written.
+        myMaxBatches = 2 * myNumWorkers + 2;
+    }
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_init(&myMutex, NULL);
+    pthread_cond_init(&myWorkCond, NULL);
+    pthread_cond_init(&myWriteCond, NULL);
+    pthread_cond_init(&myWrittenCond, NULL);
+#endif
+}
+
+
+SamRecordPipeline::~SamRecordPipeline()
+{
+    for(unsigned int i = 0; i < myFreeBatches.size(); i++)
+    {
+        delete myFreeBatches[i];
+    }
+    myFreeBatches.clear();
+    for(unsigned int i = 0; i < myRecycledRecords.size(); i++)
+    {
+        myPool.releaseRecord(myRecycledRecords[i]);
+    }
+    myRecycledRecords.clear();
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_cond_destroy(&myWrittenCond);
+    pthread_cond_destroy(&myWriteCond);
+    pthread_cond_destroy(&myWorkCond);
+    pthread_mutex_destroy(&myMutex);
+#endif
+}
+
+
+bool SamRecordPipeline::run(SamFile& inFile, SamFile& outFile,
+                            SamFileHeader& header, Processor& processor)
+{
+    lock();
+    myOutFile = &outFile;
+    myHeader = &header;
+    myProcessor = &processor;
+    myNextReadSequence = 0;
+    myNextWriteSequence = 0;
+    myNumInFlight = 0;
+    myReadDone = false;
+    myFailed = false;
+    myNumRead = 0;
+    myNumWritten = 0;
+    myNumDropped = 0;
+    myMaxWorkQueueDepth = 0;
+    myMaxWriteQueueDepth = 0;
+    myStartTime = now();
+    myEndTime = 0;
+    myRunning = true;
+    myStatus = SamStatus::SUCCESS;
+    unlock();
+
+#ifdef __PTHREAD_AVAILABLE__
+    std::vector<pthread_t> workers(myNumWorkers);
+    int numWorkers = 0;
+    for(; numWorkers < myNumWorkers; numWorkers++)
+    {
+        if(pthread_create(&workers[numWorkers], NULL, workerThread, this) != 0)
+        {
+            break;
+        }
+    }
+    pthread_t writerId;
+    bool writerStarted =
+        (pthread_create(&writerId, NULL, writerThread, this) == 0);
+    if((numWorkers == 0) || !writerStarted)
+    {
+        lock();
+        setFailed(SamStatus::FAIL_MEM, "Failed to start the pipeline threads");
+        unlock();
+    }
+#endif
+
+    // Read batches on this thread until the end of the file or a failure.
+    while(true)
+    {
+        lock();
+#ifdef __PTHREAD_AVAILABLE__
+        while((myNumInFlight >= myMaxBatches) && !myFailed)
+        {
+            pthread_cond_wait(&myWrittenCond, &myMutex);
+        }
+#endif
+        if(myFailed)
+        {
+            unlock();
+            break;
+        }
+        std::vector<SamRecord*> recycled;
+        recycled.swap(myRecycledRecords);
+        Batch* batch = NULL;
+        if(myFreeBatches.empty())
+        {
+            batch = new Batch;
+        }
+        else
+        {
+            batch = myFreeBatches.back();
+            myFreeBatches.pop_back();
+        }
+        unlock();
+
+        for(unsigned int i = 0; i < recycled.size(); i++)
+        {
+            myPool.releaseRecord(recycled[i]);
+        }
+        batch->records.clear();
+
+        bool readFailed = false;
+        std::string failMessage;
+        SamStatus::Status failStatus = SamStatus::FAIL_IO;
+        try
+        {
+            inFile.ReadRecords(header, myPool, batch->records, myBatchSize);
+            if((inFile.GetStatus() != SamStatus::SUCCESS) &&
+               (inFile.GetStatus() != SamStatus::NO_MORE_RECS))
+            {
+                readFailed = true;
+                failStatus = inFile.GetStatus();
+                failMessage = inFile.GetStatusMessage();
+            }
+        }
+        catch(std::exception& e)
+        {
+            readFailed = true;
+            failMessage = e.what();
+        }
+        bool endOfFile = readFailed ||
+            (inFile.GetStatus() == SamStatus::NO_MORE_RECS);
+
+        lock();
+        if(readFailed)
+        {
+            setFailed(failStatus, failMessage.c_str());
+        }
+        if(batch->records.empty() || myFailed)
+        {
+            releaseBatch(batch);
+            myFreeBatches.push_back(batch);
+            unlock();
+            break;
+        }
+        batch->sequence = myNextReadSequence++;
+        myNumRead += batch->records.size();
+        ++myNumInFlight;
+#ifdef __PTHREAD_AVAILABLE__
+        myWorkQueue.push_back(batch);
+        if((int)myWorkQueue.size() > myMaxWorkQueueDepth)
+        {
+            myMaxWorkQueueDepth = myWorkQueue.size();
+        }
+        pthread_cond_signal(&myWorkCond);
+        unlock();
+#else
+        unlock();
+        // No threads, so process and write it here.
+        bool success = processBatch(*batch) && writeBatch(*batch);
+        lock();
+        --myNumInFlight;
+        releaseBatch(batch);
+        myFreeBatches.push_back(batch);
+        unlock();
+        if(!success)
+        {
+            break;
+        }
+#endif
+        if(endOfFile)
+        {
+            break;
+        }
+    }
+
+    lock();
+    myReadDone = true;
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_cond_broadcast(&myWorkCond);
+    pthread_cond_broadcast(&myWriteCond);
+#endif
+    unlock();
+
+#ifdef __PTHREAD_AVAILABLE__
+    for(int i = 0; i < numWorkers; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    if(writerStarted)
+    {
+        pthread_join(writerId, NULL);
+    }
+#endif
+
+    // Clean up anything left after a failure.
+    lock();
+    while(!myWorkQueue.empty())
+    {
+        releaseBatch(myWorkQueue.front());
+        myFreeBatches.push_back(myWorkQueue.front());
+        myWorkQueue.pop_front();
+    }
+    for(std::map<uint64_t, Batch*>::iterator iter = myWriteQueue.begin();
+        iter != myWriteQueue.end(); iter++)
+    {
+        releaseBatch(iter->second);
+        myFreeBatches.push_back(iter->second);
+    }
+    myWriteQueue.clear();
+    myNumInFlight = 0;
+    myEndTime = now();
+    myRunning = false;
+    bool success = !myFailed;
+    unlock();
+    return(success);
+}
+
+
+uint64_t SamRecordPipeline::getNumRecordsRead()
+{
+    lock();
+    uint64_t result = myNumRead;
+    unlock();
+    return(result);
+}
+
+
+uint64_t SamRecordPipeline::getNumRecordsWritten()
+{
+    lock();
+    uint64_t result = myNumWritten;
+    unlock();
+    return(result);
+}
+
+
+uint64_t SamRecordPipeline::getNumRecordsDropped()
+{
+    lock();
+    uint64_t result = myNumDropped;
+    unlock();
+    return(result);
+}
+
+
+int SamRecordPipeline::getWorkQueueDepth()
+{
+    lock();
+    int result = myWorkQueue.size();
+    unlock();
+    return(result);
+}
+
+
+int SamRecordPipeline::getMaxWorkQueueDepth()
+{
+    lock();
+    int result = myMaxWorkQueueDepth;
+    unlock();
+    return(result);
+}
+
+
+int SamRecordPipeline::getWriteQueueDepth()
+{
+    lock();
+    int result = myWriteQueue.size();
+    unlock();
+    return(result);
+}
+
+
+int SamRecordPipeline::getMaxWriteQueueDepth()
+{
+    lock();
+    int result = myMaxWriteQueueDepth;
+    unlock();
+    return(result);
+}
+
+
+double SamRecordPipeline::getElapsedSeconds()
+{
+    lock();
+    double endTime = myRunning ? now() : myEndTime;
+    double result = endTime - myStartTime;
+    unlock();
+    return(result);
+}
+
+
+double SamRecordPipeline::getRecordsPerSecond()
+{
+    double seconds = getElapsedSeconds();
+    if(seconds <= 0)
+    {
+        return(0);
+    }
+    return(getNumRecordsWritten() / seconds);
+}
+
+
+bool SamRecordPipeline::processBatch(Batch& batch)
+{
+    batch.keep.resize(batch.records.size());
+    try
+    {
+        for(unsigned int i = 0; i < batch.records.size(); i++)
+        {
+            batch.keep[i] = myProcessor->process(*(batch.records[i]));
+        }
+    }
+    catch(std::exception& e)
+    {
+        lock();
+        setFailed(SamStatus::FAIL_PARSE, e.what());
+        unlock();
+        return(false);
+    }
+    return(true);
+}
+
+
+bool SamRecordPipeline::writeBatch(Batch& batch)
+{
+    uint64_t numWritten = 0;
+    uint64_t numDropped = 0;
+    std::string failMessage;
+    try
+    {
+        for(unsigned int i = 0; i < batch.records.size(); i++)
+        {
+            if(!batch.keep[i])
+            {
+                ++numDropped;
+                continue;
+            }
+            if(!myOutFile->WriteRecord(*myHeader, *(batch.records[i])))
+            {
+                failMessage = myOutFile->GetStatusMessage();
+                break;
+            }
+            ++numWritten;
+        }
+    }
+    catch(std::exception& e)
+    {
+        failMessage = e.what();
+    }
+
+    lock();
+    myNumWritten += numWritten;
+    myNumDropped += numDropped;
+    if(!failMessage.empty())
+    {
+        setFailed(SamStatus::FAIL_IO, failMessage.c_str());
+    }
+    unlock();
+    return(failMessage.empty());
+}
+
+
+void SamRecordPipeline::setFailed(SamStatus::Status status,
+                                  const char* message)
+{
+    if(!myFailed)
+    {
+        myFailed = true;
+        myStatus.setStatus(status, message);
+    }
+#ifdef __PTHREAD_AVAILABLE__
+    // Wake everyone up so they can stop.
+    pthread_cond_broadcast(&myWorkCond);
+    pthread_cond_broadcast(&myWriteCond);
+    pthread_cond_broadcast(&myWrittenCond);
+#endif
+}
+
+
+void SamRecordPipeline::releaseBatch(Batch* batch)
+{
+    // Records can only go back to the pool on the reading thread, so
+    // save them until the next batch is read.
+    myRecycledRecords.insert(myRecycledRecords.end(),
+                             batch->records.begin(), batch->records.end());
+    batch->records.clear();
+}
+
+
+double SamRecordPipeline::now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return(tv.tv_sec + tv.tv_usec / 1000000.0);
+}
+
+
+#ifdef __PTHREAD_AVAILABLE__
+void* SamRecordPipeline::workerThread(void* arg)
+{
+    ((SamRecordPipeline*)arg)->worker();
+    return(NULL);
+}
+
+
+void* SamRecordPipeline::writerThread(void* arg)
+{
+    ((SamRecordPipeline*)arg)->writer();
+    return(NULL);
+}
+
+
+void SamRecordPipeline::worker()
+{
+    lock();
+    while(true)
+    {
+        while(myWorkQueue.empty() && !myReadDone && !myFailed)
+        {
+            pthread_cond_wait(&myWorkCond, &myMutex);
+        }
+        if(myFailed || myWorkQueue.empty())
+        {
+            // Failed or there is nothing left to process.
+            break;
+        }
+        Batch* batch = myWorkQueue.front();
+        myWorkQueue.pop_front();
+        unlock();
+
+        bool success = processBatch(*batch);
+
+        lock();
+        if(!success)
+        {
+            // processBatch set the failure, clean up the batch.
+            releaseBatch(batch);
+            myFreeBatches.push_back(batch);
+            break;
+        }
+        myWriteQueue[batch->sequence] = batch;
+        if((int)myWriteQueue.size() - 1 > myMaxWriteQueueDepth)
+        {
+            // The batch the writer can write next isn't waiting.
+            myMaxWriteQueueDepth = myWriteQueue.size() - 1;
+        }
+        if(batch->sequence == myNextWriteSequence)
+        {
+            pthread_cond_signal(&myWriteCond);
+        }
+    }
+    unlock();
+}
+
+
+void SamRecordPipeline::writer()
+{
+    lock();
+    while(true)
+    {
+        std::map<uint64_t, Batch*>::iterator next =
+            myWriteQueue.find(myNextWriteSequence);
+        while((next == myWriteQueue.end()) && !myFailed &&
+              !(myReadDone && (myNextWriteSequence == myNextReadSequence)))
+        {
+            pthread_cond_wait(&myWriteCond, &myMutex);
+            next = myWriteQueue.find(myNextWriteSequence);
+        }
+        if(myFailed || (next == myWriteQueue.end()))
+        {
+            // Failed or everything that was read has been written.
+            break;
+        }
+        Batch* batch = next->second;
+        myWriteQueue.erase(next);
+        unlock();
+
+        bool success = writeBatch(*batch);
+
+        lock();
+        releaseBatch(batch);
+        myFreeBatches.push_back(batch);
+        ++myNextWriteSequence;
+        --myNumInFlight;
+        pthread_cond_signal(&myWrittenCond);
+        if(!success)
+        {
+            break;
+        }
+    }
+    unlock();
+}
+#endif
+
+
+void SamRecordPipeline::lock()
+{
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_lock(&myMutex);
+#endif
+}
+
+
+void SamRecordPipeline::unlock()
+{
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_unlock(&myMutex);
+#endif
+}
@@ -0,0 +1,201 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SAM_RECORD_PIPELINE_H__
+#define __SAM_RECORD_PIPELINE_H__
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <vector>
+#ifdef __PTHREAD_AVAILABLE__
+#include <pthread.h>
+#endif
+#include "SamFile.h"
+#include "SamRecordPool.h"
+
+/// Reads records from one SamFile, runs a processor on each record in a
+/// pool of worker threads, and writes the processed records to another
+/// SamFile in their original order.
+///
+/// The calling thread reads batches of records (SamFile::ReadRecords),
+/// worker threads process whole batches, and a writer thread writes the
+/// batches back in order.  Records are recycled through a SamRecordPool
+/// and at most maxBatches batches are in the pipeline at once, so memory
+/// use is bounded no matter how large the file is.
+///
+/// Without pthreads, the records are processed on the calling thread.
+class SamRecordPipeline
+{
+public:
+    /// Work to run on each record.  process is called from multiple worker
+    /// threads at once, so it must be thread safe.
+    class Processor
+    {
+    public:
+        virtual ~Processor() {}
+
+        /// Process the specified record.
+        /// \return true to write the record, false to drop it.
+        virtual bool process(SamRecord& record) = 0;
+    };
+
+    /// Default number of records in each batch.
+    static const int DEFAULT_BATCH_SIZE = 1000;
+
+    /// Constructor.
+    /// \param numWorkers number of worker threads to process records with.
+    /// \param batchSize number of records handed to a worker at a time.
+    /// \param maxBatches maximum number of batches being read, processed,
+    /// or waiting to be written at once, 0 for 2 per worker plus 2.
+    SamRecordPipeline(int numWorkers, int batchSize = DEFAULT_BATCH_SIZE,
+                      int maxBatches = 0);
+
+    ~SamRecordPipeline();
+
+    /// Read all remaining records from inFile, process them, and write the
+    /// ones the processor keeps to outFile.  Both files must already be
+    /// open and the header must have been read from inFile and written to
+    /// outFile.  Read sections, flag filters, and sort validation set on
+    /// the files apply as usual.
+    /// \param inFile file to read records from.
+    /// \param outFile file to write the processed records to.
+    /// \param header header used for reading and writing the records.
+    /// \param processor work to run on each record.
+    /// \return true if all records were read, processed, and written,
+    /// false if a step failed (see getStatus).
+    bool run(SamFile& inFile, SamFile& outFile, SamFileHeader& header,
+             Processor& processor);
+
+    /// Returns the status of the last run, with the reason if it failed.
+    const SamStatus& getStatus() const
+    {
+        return(myStatus);
+    }
+
+    ///////////////////////
+    /// @name  Counters
+    /// Counters for the current or last run.  They can be read from
+    /// another thread while run is going.
+    //@{
+    /// Number of records read.
+    uint64_t getNumRecordsRead();
+    /// Number of records written.
+    uint64_t getNumRecordsWritten();
+    /// Number of records the processor dropped.
+    uint64_t getNumRecordsDropped();
+    /// Number of batches waiting for a worker.
+    int getWorkQueueDepth();
+    /// Largest number of batches that waited for a worker at once.
+    int getMaxWorkQueueDepth();
+    /// Number of processed batches waiting to be written (waiting on an
+    /// earlier batch that is still being processed).
+    int getWriteQueueDepth();
+    /// Largest number of processed batches that waited to be written.
+    int getMaxWriteQueueDepth();
+    /// Seconds the current or last run took.
+    double getElapsedSeconds();
+    /// Records written per second by the current or last run.
+    double getRecordsPerSecond();
+    //@}
+
+private:
+    SamRecordPipeline(const SamRecordPipeline& other);
+    SamRecordPipeline& operator=(const SamRecordPipeline& other);
+
+    struct Batch
+    {
+        uint64_t sequence;
+        std::vector<SamRecord*> records;
+        // Whether or not to write each record.
+        std::vector<bool> keep;
+    };
+
+    // Process each record in the batch, returns false on failure.
+    bool processBatch(Batch& batch);
+
+    // Write the kept records in the batch, returns false on failure.
+    bool writeBatch(Batch& batch);
+
+    // Set the status to failed with the specified message, keeping the
+    // first failure.  Must be called with the lock held.
+    void setFailed(SamStatus::Status status, const char* message);
+
+    // Release all records in the batch to the pool.
+    void releaseBatch(Batch* batch);
+
+    double now();
+
+#ifdef __PTHREAD_AVAILABLE__
+    static void* workerThread(void* arg);
+    static void* writerThread(void* arg);
+    void worker();
+    void writer();
+#endif
+
+    void lock();
+    void unlock();
+
+    int myNumWorkers;
+    int myBatchSize;
+    int myMaxBatches;
+
+    // The file/header/processor of the current run.
+    SamFile* myOutFile;
+    SamFileHeader* myHeader;
+    Processor* myProcessor;
+
+    SamRecordPool myPool;
+    std::vector<Batch*> myFreeBatches;
+    // Records that were written and can go back to the pool.  The pool is
+    // only used by the reading thread.
+    std::vector<SamRecord*> myRecycledRecords;
+
+    // Batches waiting to be processed.
+    std::deque<Batch*> myWorkQueue;
+    // Processed batches waiting to be written, by sequence.
+    std::map<uint64_t, Batch*> myWriteQueue;
+    uint64_t myNextReadSequence;
+    uint64_t myNextWriteSequence;
+    // Number of batches that are queued, being processed, or being written.
+    int myNumInFlight;
+    bool myReadDone;
+    bool myFailed;
+
+    uint64_t myNumRead;
+    uint64_t myNumWritten;
+    uint64_t myNumDropped;
+    int myMaxWorkQueueDepth;
+    int myMaxWriteQueueDepth;
+    double myStartTime;
+    double myEndTime;
+    bool myRunning;
+
+    SamStatus myStatus;
+
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_t myMutex;
+    // Signalled when there is work, or the reading is done.
+    pthread_cond_t myWorkCond;
+    // Signalled when a batch is ready to be written.
+    pthread_cond_t myWriteCond;
+    // Signalled when a batch was written.
+    pthread_cond_t myWrittenCond;
+#endif
+};
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "SamRegionList.h"
+#include "InputFile.h"
+
+SamRegionList::SamRegionList()
+    : myRegions()
+{
+}
+
+
+SamRegionList::~SamRegionList()
+{
+}
+
+
+void SamRegionList::add(const char* refName, int32_t start, int32_t end)
+{
+    Region region;
+    region.refName = refName;
+    region.start = start;
+    region.end = end;
+    myRegions.push_back(region);
+}
+
+
+bool SamRegionList::readBed(const char* filename)
+{
+    IFILE bedFile = ifopen(filename, "rb");
+    if(bedFile == NULL)
+    {
+        return(false);
+    }
+
+    bool status = true;
+    std::string line;
+    int lineStatus = 0;
+    while(lineStatus == 0)
+    {
+        line.clear();
+        lineStatus = bedFile->readLine(line);
+        if(!line.empty() && (line[line.size() - 1] == '\r'))
+        {
+            line.erase(line.size() - 1);
+        }
+
+        // Skip blank, header, track, and browser lines.
+        if(line.empty() || (line[0] == '#') ||
+           (line.compare(0, 5, "track") == 0) ||
+           (line.compare(0, 7, "browser") == 0))
+        {
+            continue;
+        }
+
+        // Parse the reference name, start, and end.
+        size_t nameEnd = line.find('\t');
+        if(nameEnd == std::string::npos)
+        {
+            status = false;
+            break;
+        }
+        const char* startField = line.c_str() + nameEnd + 1;
+        char* startEnd = NULL;
+        long start = strtol(startField, &startEnd, 10);
+        if((startEnd == startField) || (*startEnd != '\t'))
+        {
+            status = false;
+            break;
+        }
+        char* endEnd = NULL;
+        long end = strtol(startEnd + 1, &endEnd, 10);
+        if((endEnd == startEnd + 1) ||
+           ((*endEnd != '\t') && (*endEnd != '\0')) ||
+           (start < 0) || (end < start))
+        {
+            status = false;
+            break;
+        }
+
+        add(line.substr(0, nameEnd).c_str(), start, end);
+    }
+
+    ifclose(bedFile);
+    return(status);
+}
+
+
+void SamRegionList::clear()
+{
+    myRegions.clear();
+}
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SAM_REGION_LIST_H__
+#define __SAM_REGION_LIST_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/// List of regions (reference name and positions) to read from an indexed
+/// BAM file with SamFile::SetReadSections.  Regions are kept in the order
+/// they were added and may overlap; the index of a region in this list is
+/// what SamFile reports for the records that fall in it.
+class SamRegionList
+{
+public:
+    /// A region of a reference.
+    struct Region
+    {
+        std::string refName;
+        /// inclusive 0-based start position, -1 for the start of the reference.
+        int32_t start;
+        /// exclusive 0-based end position, -1 for the end of the reference.
+        int32_t end;
+    };
+
+    SamRegionList();
+    ~SamRegionList();
+
+    /// Add a region to the end of the list.
+    /// \param refName reference name of the region.
+    /// \param start inclusive 0-based start position of the region, -1 for
+    /// the start of the reference.
+    /// \param end exclusive 0-based end position of the region, -1 for the
+    /// end of the reference.
+    void add(const char* refName, int32_t start, int32_t end);
+
+    /// Add the regions in the specified BED file (tab separated reference
+    /// name, 0-based start, and exclusive end, with any other columns
+    /// ignored) to the end of the list.  Header, track, and browser lines
+    /// are skipped.
+    /// \param filename name of the BED file, may be gzipped.
+    /// \return true if the file was read, false if it could not be opened
+    /// or has an invalid line (regions before that line are still added).
+    bool readBed(const char* filename);
+
+    /// Remove all regions from the list.
+    void clear();
+
+    /// Return the number of regions in the list.
+    int size() const
+    {
+        return(myRegions.size());
+    }
+
+    /// Return the region at the specified index.
+    const Region& get(int index) const
+    {
+        return(myRegions[index]);
+    }
+
+private:
+    std::vector<Region> myRegions;
+};
+
+#endif
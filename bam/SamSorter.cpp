@@ -0,0 +1,465 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#ifdef __PTHREAD_AVAILABLE__
+#include <pthread.h>
+#endif
+#include "SamSorter.h"
+#include "SamHelper.h"
+
+// Most temporary files to merge at once, more are merged in rounds.
+static const unsigned int MAX_MERGE_RUNS = 256;
+// Fewest records to sort on their own thread.
+static const size_t MIN_RECORDS_PER_THREAD = 10000;
+
+
+SamSorter::SamSorter(SamFile::SortedType sortType)
+    : myByName(sortType == SamFile::QUERY_NAME),
+      myMaxMemory(512 * 1024 * 1024),
+      myNumThreads(1),
+      myTempPrefix(),
+      myPool(-1),
+      myEntries(),
+      myNumRuns(0),
+      myFailed(false),
+      myStatus(ErrorHandler::RETURN)
+{
+}
+
+
+SamSorter::~SamSorter()
+{
+}
+
+
+void SamSorter::setMaxMemory(uint64_t maxBytes)
+{
+    myMaxMemory = maxBytes;
+}
+
+
+void SamSorter::setNumThreads(int numThreads)
+{
+    myNumThreads = numThreads;
+    if(myNumThreads < 1)
+    {
+        myNumThreads = 1;
+    }
+}
+
+
+void SamSorter::setTempPrefix(const char* prefix)
+{
+    myTempPrefix = prefix;
+}
+
+
+bool SamSorter::sort(const char* inFilename, const char* outFilename)
+{
+    myEntries.clear();
+    myNumRuns = 0;
+    myFailed = false;
+    myStatus = SamStatus::SUCCESS;
+    std::string tempPrefix = myTempPrefix;
+    if(tempPrefix.empty())
+    {
+        tempPrefix = outFilename;
+    }
+
+    SamFile inFile(ErrorHandler::RETURN);
+    SamFileHeader header;
+    if(myNumThreads > 1)
+    {
+        inFile.SetNumThreads(myNumThreads);
+    }
+    if(!inFile.OpenForRead(inFilename, &header))
+    {
+        setFailed(inFile.GetStatus(), inFile.GetStatusMessage());
+        return(false);
+    }
+
+    // The output is sorted, so update the header to say so.
+    if(header.getHDTagValue("VN")[0] == '\0')
+    {
+        header.setHDTag("VN", "1.0");
+    }
+    header.setHDTag("SO", myByName ? "queryname" : "coordinate");
+
+    // Read the records, writing a sorted run each time the memory
+    // limit is reached.
+    std::vector<std::string> runFilenames;
+    uint64_t memory = 0;
+    char runName[32];
+    SamRecord* record = myPool.getRecord();
+    while(inFile.ReadRecord(header, *record))
+    {
+        myEntries.resize(myEntries.size() + 1);
+        setEntry(record, myEntries.back());
+        memory += record->getBlockSize() + sizeof(SamRecord) +
+            sizeof(SortEntry);
+        if(memory >= myMaxMemory)
+        {
+            sortEntries();
+            snprintf(runName, sizeof(runName), ".%d.bam", myNumRuns++);
+            runFilenames.push_back(tempPrefix + runName);
+            if(!writeEntries(header, runFilenames.back().c_str(), false))
+            {
+                removeRuns(runFilenames);
+                return(false);
+            }
+            memory = 0;
+        }
+        record = myPool.getRecord();
+    }
+    myPool.releaseRecord(record);
+    if(inFile.GetStatus() != SamStatus::NO_MORE_RECS)
+    {
+        setFailed(inFile.GetStatus(), inFile.GetStatusMessage());
+    }
+    inFile.Close();
+
+    if(!myFailed)
+    {
+        sortEntries();
+        if(runFilenames.empty())
+        {
+            // Everything fit in memory.
+            writeEntries(header, outFilename, true);
+            return(!myFailed);
+        }
+        // Write the last run and merge them all.
+        if(!myEntries.empty())
+        {
+            snprintf(runName, sizeof(runName), ".%d.bam", myNumRuns++);
+            runFilenames.push_back(tempPrefix + runName);
+            writeEntries(header, runFilenames.back().c_str(), false);
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < myEntries.size(); i++)
+        {
+            myPool.releaseRecord(myEntries[i].record);
+        }
+        myEntries.clear();
+    }
+
+    // Merge the runs in rounds if there are too many to open at once.
+    // The merged run replaces the first runs, so records that compare
+    // equal stay in input order.
+    while(!myFailed && (runFilenames.size() > MAX_MERGE_RUNS))
+    {
+        std::vector<std::string> mergeFilenames(runFilenames.begin(),
+                                                runFilenames.begin() +
+                                                MAX_MERGE_RUNS);
+        runFilenames.erase(runFilenames.begin(),
+                           runFilenames.begin() + MAX_MERGE_RUNS);
+        snprintf(runName, sizeof(runName), ".%d.bam", myNumRuns++);
+        runFilenames.insert(runFilenames.begin(), tempPrefix + runName);
+        mergeRuns(header, mergeFilenames, runFilenames[0].c_str(), false);
+        removeRuns(mergeFilenames);
+    }
+    if(!myFailed)
+    {
+        mergeRuns(header, runFilenames, outFilename, true);
+    }
+    removeRuns(runFilenames);
+    return(!myFailed);
+}
+
+
+bool SamSorter::EntryLess::operator()(const SortEntry& a,
+                                      const SortEntry& b) const
+{
+    if(myByName)
+    {
+        return(strcmp(a.readName, b.readName) < 0);
+    }
+    return(a.chromPos < b.chromPos);
+}
+
+
+void SamSorter::setEntry(SamRecord* record, SortEntry& entry)
+{
+    // Add 1 to the position so unplaced records (position -1) go before
+    // the placed records of the reference.  Records without a reference
+    // have the highest ID, so they go last.
+    entry.chromPos = SamHelper::combineChromPos(record->getReferenceID(),
+                                                record->get0BasedPosition()
+                                                + 1);
+    entry.readName = record->getReadName();
+    entry.record = record;
+}
+
+
+void SamSorter::sortEntries()
+{
+    size_t numPieces = myEntries.size() / MIN_RECORDS_PER_THREAD;
+    if(numPieces > (size_t)myNumThreads)
+    {
+        numPieces = myNumThreads;
+    }
+#ifdef __PTHREAD_AVAILABLE__
+    if(numPieces > 1)
+    {
+        // Sort a piece on each thread, then merge the pieces in pairs,
+        // in parallel, until one is left.
+        std::vector<size_t> bounds;
+        for(size_t i = 0; i <= numPieces; i++)
+        {
+            bounds.push_back(myEntries.size() * i / numPieces);
+        }
+        std::vector<Task> tasks(numPieces);
+        for(size_t i = 0; i < numPieces; i++)
+        {
+            tasks[i].sorter = this;
+            tasks[i].start = bounds[i];
+            tasks[i].middle = bounds[i + 1];
+            tasks[i].end = bounds[i + 1];
+        }
+        runTasks(tasks, sortTask);
+
+        while(bounds.size() > 2)
+        {
+            tasks.clear();
+            std::vector<size_t> mergedBounds;
+            for(size_t i = 0; i + 2 < bounds.size(); i += 2)
+            {
+                Task task = {this, bounds[i], bounds[i + 1], bounds[i + 2]};
+                tasks.push_back(task);
+                mergedBounds.push_back(bounds[i]);
+            }
+            if(bounds.size() % 2 == 0)
+            {
+                // Odd number of pieces, the last one is merged next round.
+                mergedBounds.push_back(bounds[bounds.size() - 2]);
+            }
+            mergedBounds.push_back(bounds.back());
+            runTasks(tasks, mergeTask);
+            bounds.swap(mergedBounds);
+        }
+        return;
+    }
+#endif
+    std::stable_sort(myEntries.begin(), myEntries.end(), EntryLess(myByName));
+}
+
+
+bool SamSorter::writeEntries(SamFileHeader& header, const char* filename,
+                             bool isOutput)
+{
+    SamFile outFile(ErrorHandler::RETURN);
+    bool status = openForWrite(outFile, header, filename, isOutput);
+    for(size_t i = 0; i < myEntries.size(); i++)
+    {
+        if(status && !outFile.WriteRecord(header, *(myEntries[i].record)))
+        {
+            setFailed(outFile.GetStatus(), outFile.GetStatusMessage());
+            status = false;
+        }
+        myPool.releaseRecord(myEntries[i].record);
+    }
+    myEntries.clear();
+    outFile.Close();
+    return(status);
+}
+
+
+bool SamSorter::mergeRuns(SamFileHeader& header,
+                          const std::vector<std::string>& inFilenames,
+                          const char* outFilename, bool isOutput)
+{
+    SamFile outFile(ErrorHandler::RETURN);
+    if(!openForWrite(outFile, header, outFilename, isOutput))
+    {
+        return(false);
+    }
+
+    // Open each run and read its first record.
+    size_t numRuns = inFilenames.size();
+    std::vector<SamFile*> runFiles(numRuns, (SamFile*)NULL);
+    std::vector<SamRecord> runRecords(numRuns);
+    std::vector<SortEntry> heads(numRuns);
+    // Indices of the runs that have records, as a heap of their next
+    // record, ties going to the earlier run so the sort is stable.
+    std::vector<size_t> heap;
+    EntryLess entryLess(myByName);
+    SamFileHeader runHeader;
+    for(size_t i = 0; (i < numRuns) && !myFailed; i++)
+    {
+        runFiles[i] = new SamFile(ErrorHandler::RETURN);
+        if(!runFiles[i]->OpenForRead(inFilenames[i].c_str(), &runHeader))
+        {
+            setFailed(runFiles[i]->GetStatus(),
+                      runFiles[i]->GetStatusMessage());
+        }
+        else if(runFiles[i]->ReadRecord(runHeader, runRecords[i]))
+        {
+            setEntry(&(runRecords[i]), heads[i]);
+            heap.push_back(i);
+        }
+    }
+    struct HeapGreater
+    {
+        HeapGreater(const std::vector<SortEntry>& heads,
+                    const EntryLess& entryLess)
+            : myHeads(heads), myEntryLess(entryLess) {}
+        bool operator()(size_t a, size_t b) const
+        {
+            if(myEntryLess(myHeads[b], myHeads[a]))
+            {
+                return(true);
+            }
+            return(!myEntryLess(myHeads[a], myHeads[b]) && (a > b));
+        }
+        const std::vector<SortEntry>& myHeads;
+        const EntryLess& myEntryLess;
+    } heapGreater(heads, entryLess);
+    std::make_heap(heap.begin(), heap.end(), heapGreater);
+
+    // Write the smallest record and replace it with the next record of
+    // its run.
+    while(!heap.empty() && !myFailed)
+    {
+        std::pop_heap(heap.begin(), heap.end(), heapGreater);
+        size_t run = heap.back();
+        if(!outFile.WriteRecord(header, runRecords[run]))
+        {
+            setFailed(outFile.GetStatus(), outFile.GetStatusMessage());
+            break;
+        }
+        if(runFiles[run]->ReadRecord(runHeader, runRecords[run]))
+        {
+            setEntry(&(runRecords[run]), heads[run]);
+            std::push_heap(heap.begin(), heap.end(), heapGreater);
+        }
+        else
+        {
+            heap.pop_back();
+            if(runFiles[run]->GetStatus() != SamStatus::NO_MORE_RECS)
+            {
+                setFailed(runFiles[run]->GetStatus(),
+                          runFiles[run]->GetStatusMessage());
+            }
+        }
+    }
+
+    for(size_t i = 0; i < numRuns; i++)
+    {
+        delete runFiles[i];
+    }
+    outFile.Close();
+    return(!myFailed);
+}
+
+
+bool SamSorter::openForWrite(SamFile& samFile, SamFileHeader& header,
+                             const char* filename, bool isOutput)
+{
+    if(myNumThreads > 1)
+    {
+        samFile.SetNumThreads(myNumThreads);
+    }
+    if(!isOutput)
+    {
+        // Temporary files are read back once, so favor speed.
+        samFile.SetCompressionLevel(1);
+    }
+    if(!samFile.OpenForWrite(filename, &header))
+    {
+        setFailed(samFile.GetStatus(), samFile.GetStatusMessage());
+        return(false);
+    }
+    if(isOutput)
+    {
+        samFile.setSortedValidation(myByName ? SamFile::QUERY_NAME :
+                                    SamFile::COORDINATE);
+    }
+    return(true);
+}
+
+
+void SamSorter::removeRuns(const std::vector<std::string>& runFilenames)
+{
+    for(size_t i = 0; i < runFilenames.size(); i++)
+    {
+        remove(runFilenames[i].c_str());
+    }
+}
+
+
+void SamSorter::setFailed(SamStatus::Status status,
+                          const std::string& message)
+{
+    if(!myFailed)
+    {
+        myFailed = true;
+        myStatus.setStatus(status, message.c_str());
+    }
+}
+
+
+#ifdef __PTHREAD_AVAILABLE__
+void* SamSorter::sortTask(void* arg)
+{
+    Task* task = (Task*)arg;
+    std::vector<SortEntry>& entries = task->sorter->myEntries;
+    std::stable_sort(entries.begin() + task->start,
+                     entries.begin() + task->end,
+                     EntryLess(task->sorter->myByName));
+    return(NULL);
+}
+
+
+void* SamSorter::mergeTask(void* arg)
+{
+    Task* task = (Task*)arg;
+    std::vector<SortEntry>& entries = task->sorter->myEntries;
+    std::inplace_merge(entries.begin() + task->start,
+                       entries.begin() + task->middle,
+                       entries.begin() + task->end,
+                       EntryLess(task->sorter->myByName));
+    return(NULL);
+}
+
+
+void SamSorter::runTasks(std::vector<Task>& tasks, void* (*function)(void*))
+{
+    std::vector<pthread_t> threads(tasks.size());
+    std::vector<bool> started(tasks.size(), false);
+    for(size_t i = 0; i < tasks.size(); i++)
+    {
+        started[i] =
+            (pthread_create(&threads[i], NULL, function, &tasks[i]) == 0);
+        if(!started[i])
+        {
+            // Could not start a thread, so do the work on this one.
+            function(&tasks[i]);
+        }
+    }
+    for(size_t i = 0; i < tasks.size(); i++)
+    {
+        if(started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+#endif
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SAM_SORTER_H__
+#define __SAM_SORTER_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "SamFile.h"
+#include "SamRecordPool.h"
+
+/// Sorts a SAM/BAM file by coordinate or by read name.
+///
+/// Records are read until the memory limit is reached, then that run is
+/// sorted (split across the worker threads) and written to a temporary
+/// BAM file.  Once the input is read, the runs are merged into the output
+/// file.  If the input fits in one run, it is written straight to the
+/// output without temporary files.
+///
+/// Coordinate sorting is by reference ID then position, with unmapped
+/// records without a reference at the end.  Read name sorting is by
+/// strcmp of the names.  Records that compare equal keep their input
+/// order.  The output header's SO tag is set to match, and the output is
+/// checked with SamFile::setSortedValidation as it is written.
+class SamSorter
+{
+public:
+    /// Constructor.
+    /// \param sortType SamFile::COORDINATE or SamFile::QUERY_NAME.
+    SamSorter(SamFile::SortedType sortType);
+    ~SamSorter();
+
+    /// Set the approximate number of bytes of records to hold in memory
+    /// before writing a run to a temporary file (default 512MB).
+    void setMaxMemory(uint64_t maxBytes);
+
+    /// Set the number of threads used to sort each run and to compress
+    /// the temporary and output files (default 1).
+    void setNumThreads(int numThreads);
+
+    /// Set the prefix of the temporary files, which are named
+    /// prefix.<run>.bam.  Defaults to the output file name.
+    void setTempPrefix(const char* prefix);
+
+    /// Sort the records of the input file into the output file.
+    /// \param inFilename name of the SAM/BAM file to sort.
+    /// \param outFilename name of the sorted SAM/BAM file to write.
+    /// \return true on success, false on failure (see getStatus).
+    bool sort(const char* inFilename, const char* outFilename);
+
+    /// Returns the status of the last sort, with the reason if it failed.
+    const SamStatus& getStatus() const
+    {
+        return(myStatus);
+    }
+
+    /// Returns the number of temporary runs written by the last sort,
+    /// 0 if the input fit in memory.
+    int getNumRuns() const
+    {
+        return(myNumRuns);
+    }
+
+private:
+    SamSorter();
+    SamSorter(const SamSorter& other);
+    SamSorter& operator=(const SamSorter& other);
+
+    // A record with its precomputed sort key.
+    struct SortEntry
+    {
+        uint64_t chromPos;
+        const char* readName;
+        SamRecord* record;
+    };
+
+    // Orders SortEntries by the sort type.
+    class EntryLess
+    {
+    public:
+        EntryLess(bool byName) : myByName(byName) {}
+        bool operator()(const SortEntry& a, const SortEntry& b) const;
+    private:
+        bool myByName;
+    };
+
+    // Get the sort entry for a record.
+    static void setEntry(SamRecord* record, SortEntry& entry);
+
+    // Sort myEntries, splitting the work across the threads.
+    void sortEntries();
+
+    // Write myEntries to the specified file and release the records.
+    bool writeEntries(SamFileHeader& header, const char* filename,
+                      bool isOutput);
+
+    // Merge the sorted input files into the output file.
+    bool mergeRuns(SamFileHeader& header,
+                   const std::vector<std::string>& inFilenames,
+                   const char* outFilename, bool isOutput);
+
+    // Open the file for writing with the header, setting the status on
+    // failure.
+    bool openForWrite(SamFile& samFile, SamFileHeader& header,
+                      const char* filename, bool isOutput);
+
+    // Delete the temporary files that were written.
+    void removeRuns(const std::vector<std::string>& runFilenames);
+
+    // Set the status to failed with the specified message, keeping the
+    // first failure.
+    void setFailed(SamStatus::Status status, const std::string& message);
+
+#ifdef __PTHREAD_AVAILABLE__
+    // Sorts or merges one range of myEntries.
+    struct Task
+    {
+        SamSorter* sorter;
+        size_t start;
+        size_t middle;
+        size_t end;
+    };
+    static void* sortTask(void* arg);
+    static void* mergeTask(void* arg);
+    // Run the function on each task, each on its own thread.
+    void runTasks(std::vector<Task>& tasks, void* (*function)(void*));
+#endif
+
+    bool myByName;
+    uint64_t myMaxMemory;
+    int myNumThreads;
+    std::string myTempPrefix;
+
+    SamRecordPool myPool;
+    std::vector<SortEntry> myEntries;
+
+    int myNumRuns;
+    bool myFailed;
+    SamStatus myStatus;
+};
+
+#endif
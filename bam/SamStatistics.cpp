@@ -43,16 +43,26 @@ void SamStatistics::reset()
 
 
 bool SamStatistics::updateStatistics(SamRecord& samRecord)
+{
+    updateStatistics(samRecord.getFlag(), samRecord.getReadLength());
+    return(true);
+}
+
+
+bool SamStatistics::updateStatistics(const BamRecordView& record)
+{
+    updateStatistics(record.getFlag(), record.getReadLength());
+    return(true);
+}
+
+
+void SamStatistics::updateStatistics(uint16_t flag, int32_t readLen)
 {
     // Each record has one read, so update the read count.
     ++myReadCount;
 
-    int32_t readLen = samRecord.getReadLength();
-
-    // Get the flag to determine the type or 
+    // Use the flag to determine the type or 
     // read (mapped, paired, proper paired).
-    uint16_t flag = samRecord.getFlag();
-
     // If the read is mapped, update the mapped c
     if(SamFlag::isMapped(flag))
     {
@@ -78,8 +88,6 @@ bool SamStatistics::updateStatistics(SamRecord& samRecord)
     
     // Increment the total number of bases.
     myBaseCount += readLen;
-
-    return(true);
 }
 
 
@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 #include "SamRecord.h"
+#include "BamRecordView.h"
 
 class SamStatistics
 {
@@ -32,10 +33,14 @@ public:
 
     // Method to update the statistics to include the passed in record.
     bool updateStatistics(SamRecord& samRecord);
+    bool updateStatistics(const BamRecordView& record);
 
     void print();
 
 private:
+    // Update the statistics for a record with the specified flag and
+    // read length.
+    void updateStatistics(uint16_t flag, int32_t readLen);
 
     ///////////////////////////////////////////////////////
     // Read Counts 
@@ -16,6 +16,7 @@
  */
 #include "SamFile.h"
 #include "Pileup.h"
+#include "ParallelPileup.h"
 #include  "PileupElementBaseQual.h"
 
 
@@ -124,5 +125,9 @@ int main(int argc, char ** argv)
     Pileup<PileupElementBaseQual, AnalyzeClass> pileup4(1024, myAnalyzeClass);
     pileup4.processFile(fileName);
 
+    printf("\nParallelPileup<PileupElementBaseQual> on entire file with 4 threads: %s\n", fileName);
+    ParallelPileup<PileupElementBaseQual> pileup5(4);
+    pileup5.processFile(fileName, indexName);
+
     return(0);
 }
@@ -20,6 +20,9 @@
 #include "BamIndexTest.h"
 
 #include <assert.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
 
 void testIndex(BamIndex& bamIndex)
 {
@@ -224,6 +227,32 @@ void testIndex(BamIndex& bamIndex)
     assert(samRecord.getNumOverlaps(1010, 1011) == 0);
     assert(samRecord.getNumOverlaps(1011, 1012) == 0);
     assert(inFile.ReadRecord(samHeader, samRecord) == false);
+
+    // Read sections with worker threads decompressing ahead.
+    SamFile threadFile;
+    threadFile.SetNumThreads(2);
+    assert(threadFile.OpenForRead("testFiles/sortedBam.bam"));
+    threadFile.setSortedValidation(SamFile::COORDINATE);
+    assert(threadFile.ReadBamIndex("testFiles/sortedBam.bam.bai"));
+    assert(threadFile.ReadHeader(samHeader));
+    assert(threadFile.SetReadSection(1));
+    assert(threadFile.ReadRecord(samHeader, samRecord));
+    validateRead5(samRecord);
+    assert(threadFile.ReadRecord(samHeader, samRecord));
+    validateRead7(samRecord);
+    assert(threadFile.ReadRecord(samHeader, samRecord) == false);
+    assert(threadFile.SetReadSection("1", 1010, 1012));
+    assert(threadFile.ReadRecord(samHeader, samRecord));
+    validateRead1(samRecord);
+    assert(threadFile.ReadRecord(samHeader, samRecord));
+    validateRead2(samRecord);
+    assert(threadFile.ReadRecord(samHeader, samRecord) == false);
+    assert(threadFile.SetReadSection(-1));
+    assert(threadFile.ReadRecord(samHeader, samRecord));
+    validateRead8(samRecord);
+    assert(threadFile.ReadRecord(samHeader, samRecord));
+    validateRead10(samRecord);
+    assert(threadFile.ReadRecord(samHeader, samRecord) == false);
 #endif
 }
 
@@ -277,7 +306,434 @@ void testBamIndex()
     index = test1.getBamIndex();
     assert(index != NULL);
     testIndex(*index);
+
+    // Build indexes while writing.
+    testBuildIndex("results/indexOnWrite.bam", 0);
+    testBuildIndex("results/indexOnWriteThreaded.bam", 3);
+    // Uncompressed blocks are split when written, so this checks the
+    // offsets of records in the split blocks.
+    testBuildIndex("results/indexOnWrite.ubam", 0);
+    testBuildIndex("results/indexOnWriteThreaded.ubam", 2);
+    testBuildIndexUnsorted();
+    testBuildIndexCsi();
+
+    testReadSections();
+    testLazyIndex();
 #endif
 }
 
 
+// Read the records in the section, returning their names and positions.
+static std::vector<std::string> readSection(SamFile& samFile,
+                                            SamFileHeader& samHeader,
+                                            int32_t refID, int32_t start,
+                                            int32_t end)
+{
+    std::vector<std::string> records;
+    assert(samFile.SetReadSection(refID, start, end));
+    SamRecord samRecord;
+    while(samFile.ReadRecord(samHeader, samRecord))
+    {
+        char record[256];
+        snprintf(record, sizeof(record), "%s:%d", samRecord.getReadName(),
+                 samRecord.get1BasedPosition());
+        records.push_back(record);
+    }
+    return(records);
+}
+
+
+void testBuildIndex(const char* outputName, int numThreads)
+{
+    std::string indexName = outputName;
+    indexName += ".bai";
+    remove(indexName.c_str());
+
+    // Copy the sorted bam, building the index while writing it.
+    SamFile inFile, outFile;
+    SamFileHeader samHeader;
+    SamRecord samRecord;
+    assert(inFile.OpenForRead("testFiles/sortedBam.bam", &samHeader));
+    outFile.GenerateIndex(true);
+    outFile.SetNumThreads(numThreads);
+    assert(outFile.OpenForWrite(outputName, &samHeader));
+    while(inFile.ReadRecord(samHeader, samRecord))
+    {
+        assert(outFile.WriteRecord(samHeader, samRecord));
+    }
+    outFile.Close();
+    assert(outFile.GetStatus() == SamStatus::SUCCESS);
+
+    // The counts are the same as the samtools index.  The offsets depend
+    // on how the file was compressed, so check them by reading sections.
+    BamIndex bamIndex;
+    assert(bamIndex.readIndex(indexName.c_str()) == SamStatus::SUCCESS);
+    assert(bamIndex.getNumRefs() == 23);
+    assert(bamIndex.getNumMappedReads(1) == 2);
+    assert(bamIndex.getNumUnMappedReads(1) == 0);
+    assert(bamIndex.getNumMappedReads(0) == 4);
+    assert(bamIndex.getNumUnMappedReads(0) == 1);
+    assert(bamIndex.getNumMappedReads(-1) == 0);
+    assert(bamIndex.getNumUnMappedReads(-1) == 2);
+    assert(bamIndex.getNumMappedReads(22) == 0);
+    assert(bamIndex.getNumUnMappedReads(22) == 0);
+    SortedChunkList chunkList;
+    assert(bamIndex.getChunksForRegion(3, -1, -1, chunkList) == true);
+    assert(chunkList.empty());
+
+    // Sections read with the new index match the samtools index.
+    SamFile expectedFile, newFile;
+    SamFileHeader expectedHeader, newHeader;
+    assert(expectedFile.OpenForRead("testFiles/sortedBam.bam",
+                                    &expectedHeader));
+    assert(expectedFile.ReadBamIndex("testFiles/sortedBam.bam.bai"));
+    assert(newFile.OpenForRead(outputName, &newHeader));
+    assert(newFile.ReadBamIndex());
+
+    int32_t sections[][3] = {{-1, -1, -1}, {0, -1, -1}, {1, -1, -1},
+                             {2, -1, -1}, {3, -1, -1}, {0, 1010, 1011},
+                             {0, 1011, 1012}, {0, 0, 1012}, {0, 1013, 2000},
+                             {1, 0, 1750}, {1, 1750, 1751}, {1, 1751, -1},
+                             {2, 74, 75}, {2, 0, 100000000}};
+    int numSections = sizeof(sections) / sizeof(sections[0]);
+    for(int i = 0; i < numSections; i++)
+    {
+        std::vector<std::string> expected =
+            readSection(expectedFile, expectedHeader, sections[i][0],
+                        sections[i][1], sections[i][2]);
+        assert(expected == readSection(newFile, newHeader, sections[i][0],
+                                       sections[i][1], sections[i][2]));
+    }
+}
+
+
+void testBuildIndexUnsorted()
+{
+    const char* outputName = "results/indexOnWriteUnsorted.bam";
+    remove("results/indexOnWriteUnsorted.bam.bai");
+
+    SamFile inFile;
+    SamFile outFile(ErrorHandler::RETURN);
+    SamFileHeader samHeader;
+    SamRecord samRecord;
+    assert(inFile.OpenForRead("testFiles/testSam.sam", &samHeader));
+    outFile.GenerateIndex(true);
+    assert(outFile.OpenForWrite(outputName, &samHeader));
+    while(inFile.ReadRecord(samHeader, samRecord))
+    {
+        // The records are still written.
+        assert(outFile.WriteRecord(samHeader, samRecord));
+    }
+    outFile.Close();
+    assert(outFile.GetStatus() == SamStatus::FAIL_ORDER);
+    assert(strcmp(outFile.GetStatusMessage(), "FAIL_ORDER: Failed to write the bam index file results/indexOnWriteUnsorted.bam.bai: records are not sorted by coordinate") == 0);
+
+    // No index is written.
+    IFILE indexFile = ifopen("results/indexOnWriteUnsorted.bam.bai", "rb");
+    assert(indexFile == NULL);
+}
+
+
+void testBuildIndexCsi()
+{
+    const char* outputName = "results/indexOnWriteCsi.bam";
+    remove("results/indexOnWriteCsi.bam.csi");
+
+    // A reference longer than BAI supports.
+    SamFileHeader samHeader;
+    assert(samHeader.addHeaderLine("@SQ\tSN:1\tLN:600000000"));
+    assert(samHeader.addHeaderLine("@SQ\tSN:2\tLN:1000"));
+
+    SamFile outFile;
+    outFile.GenerateIndex(true);
+    assert(outFile.OpenForWrite(outputName, &samHeader));
+    SamRecord samRecord;
+    int32_t positions[] = {10, 20000, 550000000};
+    for(int i = 0; i < 3; i++)
+    {
+        samRecord.resetRecord();
+        assert(samRecord.setReadName("read"));
+        assert(samRecord.setFlag(0));
+        assert(samRecord.setReferenceName(samHeader, "1"));
+        assert(samRecord.set1BasedPosition(positions[i]));
+        assert(samRecord.setMapQuality(60));
+        assert(samRecord.setCigar("4M"));
+        assert(samRecord.setSequence("ACGT"));
+        assert(samRecord.setQuality("IIII"));
+        assert(outFile.WriteRecord(samHeader, samRecord));
+    }
+    outFile.Close();
+    assert(outFile.GetStatus() == SamStatus::SUCCESS);
+
+    // CSI indexes are BGZF compressed, ifopen determines that.
+    IFILE indexFile = ifopen("results/indexOnWriteCsi.bam.csi", "rb");
+    assert(indexFile != NULL);
+    char magic[4];
+    int32_t values[4];
+    assert(ifread(indexFile, magic, 4) == 4);
+    assert((magic[0] == 'C') && (magic[1] == 'S') && (magic[2] == 'I') &&
+           (magic[3] == 1));
+    assert(ifread(indexFile, values, 16) == 16);
+    // min_shift, depth, l_aux, n_ref.
+    assert(values[0] == 14);
+    assert(values[1] == 6);
+    assert(values[2] == 0);
+    assert(values[3] == 2);
+    // The first reference has 3 bins plus the mapped/unmapped bin.
+    assert(ifread(indexFile, values, 4) == 4);
+    assert(values[0] == 4);
+    ifclose(indexFile);
+}
+
+
+
+
+// Read the records in the sections, returning their names, positions, and
+// the sections they fell in.
+static std::vector<std::string> readSections(SamFile& samFile,
+                                             SamFileHeader& samHeader,
+                                             const SamRegionList& regions,
+                                             bool overlap)
+{
+    std::vector<std::string> records;
+    assert(samFile.SetReadSections(regions, overlap));
+    SamRecord samRecord;
+    while(samFile.ReadRecord(samHeader, samRecord))
+    {
+        char record[256];
+        snprintf(record, sizeof(record), "%s:%d", samRecord.getReadName(),
+                 samRecord.get1BasedPosition());
+        std::string recordSections = record;
+        const std::vector<int>& sections = samFile.GetRecordSections();
+        for(unsigned int i = 0; i < sections.size(); i++)
+        {
+            snprintf(record, sizeof(record), "%c%d", (i == 0) ? '[' : ',',
+                     sections[i]);
+            recordSections += record;
+        }
+        recordSections += "]";
+        records.push_back(recordSections);
+    }
+    assert(samFile.GetStatus() == SamStatus::NO_MORE_RECS);
+    return(records);
+}
+
+
+void testReadSections()
+{
+    SamFile inFile;
+    assert(inFile.OpenForRead("testFiles/sortedBam.bam"));
+    inFile.setSortedValidation(SamFile::COORDINATE);
+    assert(inFile.ReadBamIndex("testFiles/sortedBam.bam.bai"));
+    SamFileHeader samHeader;
+    assert(inFile.ReadHeader(samHeader));
+
+    // Overlapping regions out of order, and a region on an unknown
+    // reference.
+    SamRegionList regions;
+    regions.add("1", 1010, 1012);
+    regions.add("2", -1, -1);
+    regions.add("1", 74, 75);
+    regions.add("unknown", 0, 100);
+    regions.add("1", 1000, 1011);
+    std::vector<std::string> records =
+        readSections(inFile, samHeader, regions, true);
+    assert(records.size() == 6);
+    assert(records[0] == "18:462+29M5I3M:F:295:75[2]");
+    assert(records[1] == "18:462+29M5I3M:F:295:75[2]");
+    assert(records[2] == "1:1011:F:255+17M15D20M:1011[0,4]");
+    assert(records[3] == "1:1011:F:255+17M15D20M:1012[0]");
+    assert(records[4] == "18:462+29M5I3M:F:295:75[1]");
+    assert(records[5] == "18:462+29M5I3M:F:297:1751[1]");
+
+    // Only reads fully contained in a region.
+    regions.clear();
+    regions.add("1", 1010, 1011);
+    regions.add("1", 1011, 1012);
+    records = readSections(inFile, samHeader, regions, false);
+    assert(records.size() == 1);
+    assert(records[0] == "1:1011:F:255+17M15D20M:1012[1]");
+
+    // Setting a single section afterwards reads just that section.
+    assert(readSection(inFile, samHeader, 2, -1, -1).size() == 1);
+    assert(inFile.GetRecordSections().empty());
+
+    // No regions on references in the file.
+    regions.clear();
+    regions.add("unknown", 0, 100);
+    assert(readSections(inFile, samHeader, regions, true).empty());
+
+    // Regions from a BED file.
+    regions.clear();
+    assert(regions.readBed("testFiles/regions.bed"));
+    assert(regions.size() == 3);
+    assert(regions.get(1).refName == "2");
+    assert(regions.get(1).start == 0);
+    assert(regions.get(1).end == 2000);
+    records = readSections(inFile, samHeader, regions, true);
+    assert(records.size() == 6);
+    assert(records[0] == "18:462+29M5I3M:F:295:75[0]");
+    assert(records[1] == "18:462+29M5I3M:F:295:75[0]");
+    assert(records[2] == "1:1011:F:255+17M15D20M:1011[2]");
+    assert(records[3] == "1:1011:F:255+17M15D20M:1012[2]");
+    assert(records[4] == "18:462+29M5I3M:F:295:75[1]");
+    assert(records[5] == "18:462+29M5I3M:F:297:1751[1]");
+
+    assert(!regions.readBed("testFiles/missing.bed"));
+
+    // Many regions sharing the same chunks still return each record once.
+    static const int NUM_REGIONS = 4000;
+    regions.clear();
+    for(int i = 0; i < NUM_REGIONS; i++)
+    {
+        if(i % 2 == 0)
+        {
+            regions.add("1", 1010, 1012);
+        }
+        else
+        {
+            regions.add("2", -1, -1);
+        }
+    }
+    assert(inFile.SetReadSections(regions, true));
+    SamRecord samRecord;
+    int numRecords = 0;
+    while(inFile.ReadRecord(samHeader, samRecord))
+    {
+        ++numRecords;
+        const std::vector<int>& sections = inFile.GetRecordSections();
+        assert(sections.size() == NUM_REGIONS / 2);
+        int firstSection =
+            (samRecord.getReferenceID() == samHeader.getReferenceID("1")) ?
+            0 : 1;
+        for(unsigned int i = 0; i < sections.size(); i++)
+        {
+            assert(sections[i] == (int)(firstSection + i * 2));
+        }
+    }
+    assert(inFile.GetStatus() == SamStatus::NO_MORE_RECS);
+    assert(numRecords == 4);
+}
+
+
+// Check that the chunks for a region are the same for both indexes.
+static void compareChunks(BamIndex& index1, BamIndex& index2, int32_t refID,
+                          int32_t start, int32_t end)
+{
+    SortedChunkList chunks1;
+    SortedChunkList chunks2;
+    assert(index1.getChunksForRegion(refID, start, end, chunks1) ==
+           index2.getChunksForRegion(refID, start, end, chunks2));
+    while(!chunks1.empty())
+    {
+        assert(!chunks2.empty());
+        Chunk chunk1 = chunks1.pop();
+        Chunk chunk2 = chunks2.pop();
+        assert(chunk1.chunk_beg == chunk2.chunk_beg);
+        assert(chunk1.chunk_end == chunk2.chunk_end);
+    }
+    assert(chunks2.empty());
+}
+
+
+void testLazyIndex()
+{
+    BamIndex lazyIndex;
+    lazyIndex.setLazyLoading(true);
+    assert(lazyIndex.readIndex("testFiles/sortedBam.bam.bai") ==
+           SamStatus::SUCCESS);
+    testIndex(lazyIndex);
+
+    // Compare the lazily loaded index to the normal one, querying the
+    // references in a different order than they are in the file.
+    BamIndex index;
+    assert(index.readIndex("testFiles/sortedBam.bam.bai") ==
+           SamStatus::SUCCESS);
+    assert(lazyIndex.readIndex("testFiles/sortedBam.bam.bai") ==
+           SamStatus::SUCCESS);
+    assert(lazyIndex.getNumRefs() == index.getNumRefs());
+    assert(lazyIndex.getMaxOffset() == index.getMaxOffset());
+    for(int32_t refID = index.getNumRefs() - 1; refID >= -1; refID--)
+    {
+        assert(lazyIndex.getNumMappedReads(refID) ==
+               index.getNumMappedReads(refID));
+        assert(lazyIndex.getNumUnMappedReads(refID) ==
+               index.getNumUnMappedReads(refID));
+        uint64_t min1 = 1, max1 = 1, min2 = 2, max2 = 2;
+        assert(lazyIndex.getReferenceMinMax(refID, min1, max1) ==
+               index.getReferenceMinMax(refID, min2, max2));
+        compareChunks(lazyIndex, index, refID, -1, -1);
+        compareChunks(lazyIndex, index, refID, 0, 100);
+        compareChunks(lazyIndex, index, refID, 1000, 2000);
+        compareChunks(lazyIndex, index, refID, 1750, -1);
+        if(refID >= 0)
+        {
+            assert((min1 == min2) && (max1 == max2));
+            uint64_t offset1 = 1, offset2 = 2;
+            assert(lazyIndex.getMinOffsetFromLinearIndex(refID, 1750,
+                                                         offset1) ==
+                   index.getMinOffsetFromLinearIndex(refID, 1750, offset2));
+            assert(offset1 == offset2);
+        }
+    }
+
+    // Read sections with a lazily loaded index.
+    SamFile inFile;
+    inFile.SetLazyBamIndex(true);
+    SamFileHeader samHeader;
+    assert(inFile.OpenForRead("testFiles/sortedBam.bam", &samHeader));
+    assert(inFile.ReadBamIndex());
+    std::vector<std::string> records = readSection(inFile, samHeader, 0,
+                                                   1010, 1012);
+    assert(records.size() == 2);
+    assert(records[0] == "1:1011:F:255+17M15D20M:1011");
+    assert(records[1] == "1:1011:F:255+17M15D20M:1012");
+    records = readSection(inFile, samHeader, 1, -1, -1);
+    assert(records.size() == 2);
+    records = readSection(inFile, samHeader, -1, -1, -1);
+    assert(records.size() == 2);
+
+    // Failures.
+    assert(lazyIndex.readIndex("testFiles/missing.bai") == SamStatus::FAIL_IO);
+    assert(lazyIndex.getNumRefs() == 0);
+    assert(lazyIndex.readIndex("testFiles/testSam.sam") ==
+           SamStatus::FAIL_PARSE);
+
+    // A truncated index fails without leaving a partly read index behind.
+    FILE* inIndex = fopen("testFiles/sortedBam.bam.bai", "rb");
+    assert(inIndex != NULL);
+    char buffer[30];
+    assert(fread(buffer, 1, sizeof(buffer), inIndex) == sizeof(buffer));
+    fclose(inIndex);
+    FILE* truncIndex = fopen("results/truncated.bai", "wb");
+    assert(truncIndex != NULL);
+    assert(fwrite(buffer, 1, sizeof(buffer), truncIndex) == sizeof(buffer));
+    fclose(truncIndex);
+    assert(lazyIndex.readIndex("testFiles/sortedBam.bam.bai") ==
+           SamStatus::SUCCESS);
+    assert(lazyIndex.readIndex("results/truncated.bai") ==
+           SamStatus::FAIL_IO);
+    assert(lazyIndex.getNumRefs() == 0);
+    assert(lazyIndex.getNumMappedReads(0) == -1);
+
+    // A negative number of bins or a bin number past the last bin is a
+    // parse failure.
+    int32_t negativeBins[] = {1, -1};
+    int32_t badBinNumber[] = {1, 1, 37451, 0, 0};
+    int32_t* badIndexes[] = {negativeBins, badBinNumber};
+    size_t badIndexSizes[] = {sizeof(negativeBins), sizeof(badBinNumber)};
+    for(int i = 0; i < 2; i++)
+    {
+        FILE* badIndex = fopen("results/badBins.bai", "wb");
+        assert(badIndex != NULL);
+        assert(fwrite("BAI\1", 1, 4, badIndex) == 4);
+        assert(fwrite(badIndexes[i], 1, badIndexSizes[i], badIndex) ==
+               badIndexSizes[i]);
+        fclose(badIndex);
+        assert(lazyIndex.readIndex("results/badBins.bai") ==
+               SamStatus::FAIL_PARSE);
+        BamIndex eagerIndex;
+        assert(eagerIndex.readIndex("results/badBins.bai") ==
+               SamStatus::FAIL_PARSE);
+    }
+}
@@ -26,4 +26,9 @@ public:
 };
 
 void testBamIndex();
+void testBuildIndex(const char* outputName, int numThreads);
+void testBuildIndexUnsorted();
+void testBuildIndexCsi();
+void testReadSections();
+void testLazyIndex();
 
@@ -31,9 +31,21 @@
 #include "TestSamRecordPool.h"
 #include "TestSamCoordOutput.h"
 #include "TestSamRecordHelper.h"
+#include "TestBamRecordView.h"
+#include "TestSamRecordPipeline.h"
+#include "TestBamShardRunner.h"
+#include "TestSamSorter.h"
+#include "TestSamMergeReader.h"
+#include "TestParallelPileup.h"
+#include "BgzfFileType.h"
 
 int main(int argc, char ** argv)
 {
+#ifdef __ZLIB_AVAILABLE__
+    // The expected output files were compressed with zlib.
+    BgzfFileType::setCodec(BGZF_CODEC_ZLIB);
+#endif
+
     if(argc == 1)
     {
         testReadSam();
@@ -51,6 +63,8 @@ int main(int argc, char ** argv)
                                   "results/addedTagToBam.sam");
         testAddHeaderAndTagToFile("testFiles/testBam.bam",
                                   "results/addedTagToBam.bam");
+        testAddHeaderAndTagToFile("testFiles/testBam.bam",
+                                  "results/addedTagToBamThreaded.bam", 2);
 #endif
 
         testValidateSortedRead();
@@ -85,6 +99,12 @@ int main(int argc, char ** argv)
         testSamRecordPool();
         testSamCoordOutput();
         testSamRecordHelper();
+        testBamRecordView();
+        testSamRecordPipeline();
+        testBamShardRunner();
+        testSamSorter();
+        testSamMergeReader();
+        testParallelPileup();
     }
     else
     {
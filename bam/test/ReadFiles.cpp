@@ -113,9 +113,11 @@ void testRead(SamFile &inSam)
 }
 
 
-void testAddHeaderAndTagToFile(const char* inputName, const char* outputName)
+void testAddHeaderAndTagToFile(const char* inputName, const char* outputName,
+                               int numThreads)
 {
     SamFile inSam, outSam;
+    outSam.SetNumThreads(numThreads);
     assert(inSam.OpenForRead(inputName));
     assert(outSam.OpenForWrite(outputName));
 
@@ -20,7 +20,8 @@ void testReadSam();
 void testReadBam();
 void testRead(SamFile &inSam);
 
-void testAddHeaderAndTagToFile(const char* inputName, const char* outputName);
+void testAddHeaderAndTagToFile(const char* inputName, const char* outputName,
+                               int numThreads = 0);
 
 void testValidateSortedRead();
 
@@ -0,0 +1,223 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestBamRecordView.h"
+#include <assert.h>
+#include <string.h>
+
+void testBamRecordView()
+{
+    // BAM files can't be read without zlib.
+#ifdef __ZLIB_AVAILABLE__
+    BamRecordViewTest::testReadFile("testFiles/testBam.bam");
+    BamRecordViewTest::testReadFile("testFiles/sortedBam.bam");
+    BamRecordViewTest::testReadSection("testFiles/sortedBam.bam");
+#endif
+    BamRecordViewTest::testNotBam("testFiles/testSam.sam");
+}
+
+
+void BamRecordViewTest::testReadFile(const char* fileName)
+{
+    // Read the file both as SamRecords and as views and compare.
+    SamFile samIn;
+    SamFile viewIn;
+    SamFileHeader samHeader;
+    SamFileHeader viewHeader;
+    assert(samIn.OpenForRead(fileName, &samHeader));
+    assert(viewIn.OpenForRead(fileName, &viewHeader));
+    viewIn.GenerateStatistics(true);
+
+    SamRecord samRecord;
+    BamRecordView view;
+    assert(!view.isValid());
+    int numRecs = 0;
+    while(samIn.ReadRecord(samHeader, samRecord))
+    {
+        assert(viewIn.ReadRecord(viewHeader, view));
+        assert(view.isValid());
+        compareRecord(samRecord, view);
+
+        // The view can also be set to the SamRecord's buffer.
+        BamRecordView recordView;
+        recordView.setBuffer(samRecord.getRecordBuffer());
+        compareRecord(samRecord, recordView);
+        ++numRecs;
+    }
+    assert(samIn.GetStatus() == SamStatus::NO_MORE_RECS);
+    assert(viewIn.ReadRecord(viewHeader, view) == false);
+    assert(viewIn.GetStatus() == SamStatus::NO_MORE_RECS);
+    assert(!view.isValid());
+    assert(numRecs > 0);
+    assert(viewIn.GetCurrentRecordCount() == (uint32_t)numRecs);
+}
+
+
+void BamRecordViewTest::testReadSection(const char* fileName)
+{
+    // Read sections with flag filters and sort validation, both as
+    // SamRecords and as views.
+    SamFile samIn;
+    SamFile viewIn;
+    SamFileHeader samHeader;
+    SamFileHeader viewHeader;
+    assert(samIn.OpenForRead(fileName, &samHeader));
+    assert(viewIn.OpenForRead(fileName, &viewHeader));
+    assert(samIn.ReadBamIndex());
+    assert(viewIn.ReadBamIndex());
+    samIn.setSortedValidation(SamFile::COORDINATE);
+    viewIn.setSortedValidation(SamFile::COORDINATE);
+    samIn.SetReadFlags(0, 0x10);
+    viewIn.SetReadFlags(0, 0x10);
+
+    SamRecord samRecord;
+    BamRecordView view;
+    int numRecs = 0;
+    for(int refID = -1; refID < samHeader.getNumSQs(); refID++)
+    {
+        assert(samIn.SetReadSection(refID));
+        assert(viewIn.SetReadSection(refID));
+        while(samIn.ReadRecord(samHeader, samRecord))
+        {
+            assert(viewIn.ReadRecord(viewHeader, view));
+            compareRecord(samRecord, view);
+            ++numRecs;
+        }
+        assert(viewIn.ReadRecord(viewHeader, view) == false);
+        assert(viewIn.GetStatus() == SamStatus::NO_MORE_RECS);
+    }
+    assert(numRecs > 0);
+
+    // Overlapping/contained sections of 1:1000-1100.
+    for(int overlap = 0; overlap < 2; overlap++)
+    {
+        assert(samIn.SetReadSection("1", 1000, 1100, overlap));
+        assert(viewIn.SetReadSection("1", 1000, 1100, overlap));
+        while(samIn.ReadRecord(samHeader, samRecord))
+        {
+            assert(viewIn.ReadRecord(viewHeader, view));
+            compareRecord(samRecord, view);
+        }
+        assert(viewIn.ReadRecord(viewHeader, view) == false);
+    }
+}
+
+
+void BamRecordViewTest::testNotBam(const char* fileName)
+{
+    // Views can only be read from BAM files.
+    SamFile samIn;
+    SamFileHeader samHeader;
+    assert(samIn.OpenForRead(fileName, &samHeader));
+    BamRecordView view;
+    bool caughtException = false;
+    try
+    {
+        assert(samIn.ReadRecord(samHeader, view) == false);
+    }
+    catch (std::exception& e)
+    {
+        caughtException = true;
+        assert(strcmp(e.what(), "FAIL_IO: Reading a BamRecordView is only supported for BAM files") == 0);
+    }
+    assert(caughtException);
+    assert(samIn.GetStatus() == SamStatus::FAIL_IO);
+}
+
+
+void BamRecordViewTest::compareRecord(SamRecord& samRecord,
+                                      const BamRecordView& view)
+{
+    assert(view.getBlockSize() == samRecord.getBlockSize());
+    assert(view.getReferenceID() == samRecord.getReferenceID());
+    assert(view.get1BasedPosition() == samRecord.get1BasedPosition());
+    assert(view.get0BasedPosition() == samRecord.get0BasedPosition());
+    assert(view.getReadNameLength() == samRecord.getReadNameLength());
+    assert(view.getMapQuality() == samRecord.getMapQuality());
+    assert(view.getBin() == samRecord.getBin());
+    assert(view.getCigarLength() == samRecord.getCigarLength());
+    assert(view.getFlag() == samRecord.getFlag());
+    assert(view.getReadLength() == samRecord.getReadLength());
+    assert(view.getMateReferenceID() == samRecord.getMateReferenceID());
+    assert(view.get1BasedMatePosition() == samRecord.get1BasedMatePosition());
+    assert(view.getInsertSize() == samRecord.getInsertSize());
+    assert(view.get0BasedAlignmentEnd() == samRecord.get0BasedAlignmentEnd());
+    assert(view.get1BasedAlignmentEnd() == samRecord.get1BasedAlignmentEnd());
+    assert(view.getAlignmentLength() == samRecord.getAlignmentLength());
+    assert(strcmp(view.getReadName(), samRecord.getReadName()) == 0);
+
+    // Compare the cigar through its string form.
+    static const char* ops = "MIDNSHP=X";
+    String cigar;
+    for(int i = 0; i < view.getCigarLength(); i++)
+    {
+        uint32_t cigarOp = view.getPackedCigar(i);
+        cigar += (int)(cigarOp >> 4);
+        cigar += ops[cigarOp & 0xF];
+    }
+    if(view.getCigarLength() == 0)
+    {
+        cigar = "*";
+    }
+    assert(cigar == samRecord.getCigar());
+
+    for(int i = 0; i < view.getReadLength(); i++)
+    {
+        assert(view.getSequence(i) == samRecord.getSequence(i));
+        assert(view.getQuality(i) == samRecord.getQuality(i));
+    }
+
+    // Compare the tags.
+    assert(view.getTagLength() == samRecord.getTagLength());
+    char tag[3];
+    char vtype;
+    void* value;
+    samRecord.resetTagIter();
+    while(samRecord.getNextSamTag(tag, vtype, &value))
+    {
+        char viewType;
+        assert(view.findTag(tag, viewType) != NULL);
+        if(SamRecord::isIntegerType(vtype) || SamRecord::isCharType(vtype))
+        {
+            int intVal;
+            assert(view.getIntegerTag(tag, intVal));
+            if(SamRecord::isCharType(vtype))
+            {
+                assert(intVal == *(char*)value);
+            }
+            else
+            {
+                assert(intVal == *(int*)value);
+            }
+        }
+        else if(SamRecord::isFloatType(vtype))
+        {
+            float floatVal;
+            assert(view.getFloatTag(tag, floatVal));
+            assert(floatVal == *(float*)value);
+        }
+        else if(vtype == 'Z')
+        {
+            assert(view.getStringTag(tag) != NULL);
+            assert(*(String*)value == view.getStringTag(tag));
+        }
+    }
+    char viewType;
+    assert(view.findTag("ZZ", viewType) == NULL);
+    int intVal;
+    assert(!view.getIntegerTag("ZZ", intVal));
+}
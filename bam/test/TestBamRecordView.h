@@ -0,0 +1,32 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SamFile.h"
+#include "BamRecordView.h"
+
+void testBamRecordView();
+
+class BamRecordViewTest
+{
+public:
+    static void testReadFile(const char* fileName);
+    static void testReadSection(const char* fileName);
+    static void testNotBam(const char* fileName);
+private:
+    static void compareRecord(SamRecord& samRecord,
+                              const BamRecordView& view);
+};
@@ -0,0 +1,319 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestBamShardRunner.h"
+#include "BamShardRunner.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static const int NUM_REFS = 3;
+static const int32_t REF_LENGTHS[NUM_REFS] = {2000000, 100000, 1000};
+static const int READ_LENGTH = 50;
+
+
+// Add the depth at each position of the shard, and count the records
+// that start in the shard.
+class DepthProcessor : public BamShardRunner::Processor
+{
+public:
+    DepthProcessor()
+        : myDepths(NUM_REFS), myNumOwned(0)
+    {
+        for(int i = 0; i < NUM_REFS; i++)
+        {
+            myDepths[i].resize(REF_LENGTHS[i], 0);
+        }
+#ifdef __PTHREAD_AVAILABLE__
+        pthread_mutex_init(&myMutex, NULL);
+#endif
+    }
+
+    ~DepthProcessor()
+    {
+#ifdef __PTHREAD_AVAILABLE__
+        pthread_mutex_destroy(&myMutex);
+#endif
+    }
+
+    bool processShard(SamFile& samFile, SamFileHeader& header,
+                      const BamShardRunner::Shard& shard)
+    {
+        int32_t shardEnd = shard.end;
+        if(shardEnd == -1)
+        {
+            shardEnd = REF_LENGTHS[shard.refID];
+        }
+        // Count locally, then add to the totals.
+        std::vector<int> depth(shardEnd - shard.start, 0);
+        int numOwned = 0;
+        SamRecord samRecord;
+        while(samFile.ReadRecord(header, samRecord))
+        {
+            assert(samRecord.getReferenceID() == shard.refID);
+            for(int32_t pos = samRecord.get0BasedPosition();
+                pos <= samRecord.get0BasedAlignmentEnd(); pos++)
+            {
+                if((pos >= shard.start) && (pos < shardEnd))
+                {
+                    ++depth[pos - shard.start];
+                }
+            }
+            if(shard.ownsRecord(samRecord))
+            {
+                ++numOwned;
+            }
+        }
+        if(samFile.GetStatus() != SamStatus::NO_MORE_RECS)
+        {
+            return(false);
+        }
+
+#ifdef __PTHREAD_AVAILABLE__
+        pthread_mutex_lock(&myMutex);
+#endif
+        for(unsigned int i = 0; i < depth.size(); i++)
+        {
+            myDepths[shard.refID][shard.start + i] += depth[i];
+        }
+        myNumOwned += numOwned;
+#ifdef __PTHREAD_AVAILABLE__
+        pthread_mutex_unlock(&myMutex);
+#endif
+        return(true);
+    }
+
+    std::vector<std::vector<int> > myDepths;
+    int myNumOwned;
+
+private:
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_t myMutex;
+#endif
+};
+
+
+// Fail on the shard containing position 500000 of the first reference.
+class FailShardProcessor : public BamShardRunner::Processor
+{
+public:
+    bool processShard(SamFile& samFile, SamFileHeader& header,
+                      const BamShardRunner::Shard& shard)
+    {
+        return(!((shard.refID == 0) && (shard.start <= 500000) &&
+                 ((shard.end == -1) || (shard.end > 500000))));
+    }
+};
+
+
+void testBamShardRunner()
+{
+    // Shards are found using the BAM index, which is compressed.
+#ifdef __ZLIB_AVAILABLE__
+    const char* filename = "results/shardTest.bam";
+    BamShardRunnerTest::writeFile(filename);
+    BamShardRunnerTest::testGetShards(filename);
+    BamShardRunnerTest::testRun(filename, NULL, 4, 8);
+    BamShardRunnerTest::testRun(filename, "results/shardTest.bam.bai", 1, 3);
+    BamShardRunnerTest::testRun(filename, NULL, 3, 0);
+    BamShardRunnerTest::testFailure(filename);
+#endif
+}
+
+
+void BamShardRunnerTest::writeFile(const char* filename)
+{
+    SamFileHeader samHeader;
+    char line[64];
+    for(int i = 0; i < NUM_REFS; i++)
+    {
+        snprintf(line, sizeof(line), "@SQ\tSN:%d\tLN:%d", i + 1,
+                 REF_LENGTHS[i]);
+        assert(samHeader.addHeaderLine(line));
+    }
+    assert(samHeader.addHeaderLine("@HD\tVN:1.0\tSO:coordinate"));
+
+    SamFile outFile;
+    outFile.GenerateIndex(true);
+    assert(outFile.OpenForWrite(filename, &samHeader));
+
+    // Random sequences so the records take up many BGZF blocks.
+    SamRecord samRecord;
+    unsigned int random = 1;
+    std::string sequence(READ_LENGTH, 'A');
+    std::string quality(READ_LENGTH, 'I');
+    const char bases[] = "ACGT";
+    char readName[32];
+    int numRecords = 0;
+    // Records on reference 1 are dense, reference 2 sparse, and reference
+    // 3 has none.
+    int32_t spacing[NUM_REFS] = {37, 500, 0};
+    for(int refID = 0; refID < NUM_REFS; refID++)
+    {
+        if(spacing[refID] == 0)
+        {
+            continue;
+        }
+        for(int32_t pos = 1; pos + READ_LENGTH <= REF_LENGTHS[refID];
+            pos += spacing[refID])
+        {
+            for(int i = 0; i < READ_LENGTH; i++)
+            {
+                random = random * 1103515245 + 12345;
+                sequence[i] = bases[(random >> 16) & 3];
+            }
+            snprintf(readName, sizeof(readName), "read%d", numRecords++);
+            samRecord.resetRecord();
+            assert(samRecord.setReadName(readName));
+            assert(samRecord.setFlag(0));
+            const char* refName = samHeader.getReferenceLabel(refID).c_str();
+            assert(samRecord.setReferenceName(samHeader, refName));
+            assert(samRecord.set1BasedPosition(pos));
+            assert(samRecord.setMapQuality(60));
+            assert(samRecord.setCigar("50M"));
+            assert(samRecord.setSequence(sequence.c_str()));
+            assert(samRecord.setQuality(quality.c_str()));
+            assert(outFile.WriteRecord(samHeader, samRecord));
+        }
+    }
+    // Records without a reference are not in any shard.
+    for(int i = 0; i < 5; i++)
+    {
+        samRecord.resetRecord();
+        assert(samRecord.setReadName("unmapped"));
+        assert(samRecord.setFlag(4));
+        assert(samRecord.setSequence(sequence.c_str()));
+        assert(samRecord.setQuality(quality.c_str()));
+        assert(outFile.WriteRecord(samHeader, samRecord));
+    }
+    outFile.Close();
+    assert(outFile.GetStatus() == SamStatus::SUCCESS);
+}
+
+
+void BamShardRunnerTest::testGetShards(const char* filename)
+{
+    SamFile samFile;
+    SamFileHeader samHeader;
+    assert(samFile.OpenForRead(filename, &samHeader));
+    assert(samFile.ReadBamIndex());
+    const BamIndex* index = samFile.GetBamIndex();
+    assert(index != NULL);
+
+    std::vector<BamShardRunner::Shard> shards;
+    BamShardRunner::getShards(*index, samHeader, 8, shards);
+
+    // The dense reference is split, the sparse one is small enough for one
+    // shard, and the empty one has none.  Shards are contiguous.
+    assert(shards.size() >= 6);
+    assert(shards[0].refID == 0);
+    assert(shards[0].start == 0);
+    uint64_t totalSize = 0;
+    for(unsigned int i = 1; i < shards.size(); i++)
+    {
+        if(shards[i].refID == shards[i - 1].refID)
+        {
+            assert(shards[i].start == shards[i - 1].end);
+            assert(shards[i].start % 16384 == 0);
+        }
+        else
+        {
+            assert(shards[i - 1].end == -1);
+            assert(shards[i].start == 0);
+        }
+        totalSize += shards[i - 1].size;
+    }
+    totalSize += shards.back().size;
+    assert(shards.back().refID == 1);
+    assert(shards.back().end == -1);
+    assert(shards[shards.size() - 2].refID == 0);
+
+    // Shards on the dense reference are about the same size.
+    for(unsigned int i = 0; i < shards.size() - 2; i++)
+    {
+        assert(shards[i].size <= totalSize / 4);
+    }
+
+    // One shard per reference.
+    BamShardRunner::getShards(*index, samHeader, 1, shards);
+    assert(shards.size() == 2);
+    assert((shards[0].refID == 0) && (shards[0].start == 0) &&
+           (shards[0].end == -1));
+    assert((shards[1].refID == 1) && (shards[1].start == 0) &&
+           (shards[1].end == -1));
+}
+
+
+void BamShardRunnerTest::testRun(const char* filename,
+                                 const char* indexFilename,
+                                 int numWorkers, int numShards)
+{
+    // Get the expected depths by reading the whole file.
+    std::vector<std::vector<int> > expected(NUM_REFS);
+    for(int i = 0; i < NUM_REFS; i++)
+    {
+        expected[i].resize(REF_LENGTHS[i], 0);
+    }
+    int numMapped = 0;
+    SamFile samFile;
+    SamFileHeader samHeader;
+    assert(samFile.OpenForRead(filename, &samHeader));
+    SamRecord samRecord;
+    while(samFile.ReadRecord(samHeader, samRecord))
+    {
+        if(samRecord.getReferenceID() < 0)
+        {
+            continue;
+        }
+        ++numMapped;
+        for(int32_t pos = samRecord.get0BasedPosition();
+            pos <= samRecord.get0BasedAlignmentEnd(); pos++)
+        {
+            ++expected[samRecord.getReferenceID()][pos];
+        }
+    }
+
+    DepthProcessor processor;
+    BamShardRunner runner(numWorkers);
+    assert(runner.run(filename, indexFilename, numShards, processor));
+    assert(runner.getStatus() == SamStatus::SUCCESS);
+    assert(runner.getShards().size() > 2);
+    // Records that cross shard boundaries are in both shards, so the
+    // depths are exact, but are only owned by one.
+    assert(processor.myNumOwned == numMapped);
+    for(int i = 0; i < NUM_REFS; i++)
+    {
+        assert(processor.myDepths[i] == expected[i]);
+    }
+}
+
+
+void BamShardRunnerTest::testFailure(const char* filename)
+{
+    FailShardProcessor processor;
+    BamShardRunner runner(3);
+    assert(runner.run(filename, NULL, 8, processor) == false);
+    assert(runner.getStatus() == SamStatus::FAIL_PARSE);
+
+    // Missing file.
+    DepthProcessor depthProcessor;
+    assert(runner.run("results/missingShard.bam", NULL, 8,
+                      depthProcessor) == false);
+    assert(runner.getStatus() == SamStatus::FAIL_IO);
+    assert(runner.getShards().empty());
+}
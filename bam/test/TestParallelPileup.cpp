@@ -0,0 +1,267 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestParallelPileup.h"
+#include "ParallelPileup.h"
+#include "PileupElementBaseQual.h"
+#include "PileupElementPooled.h"
+#include <assert.h>
+#include <stdio.h>
+#include <sstream>
+#include <string>
+
+static const int NUM_REFS = 3;
+static const int32_t REF_LENGTHS[NUM_REFS] = {300000, 50000, 1000};
+
+
+struct PileupCounts
+{
+    PileupCounts() : numPositions(0), numEntries(0), lastChromosome(),
+                     lastPosition(-1) {}
+    int numPositions;
+    int numEntries;
+    std::string lastChromosome;
+    int32_t lastPosition;
+};
+
+
+// Counts the entries of the delivered positions, checking they are in
+// order.
+class CountEntries
+{
+public:
+    CountEntries(PileupCounts& counts) : myCounts(&counts) {}
+    bool operator() (PileupElementPooled& element)
+    {
+        if(myCounts->lastChromosome == element.getChromosome())
+        {
+            assert(element.getRefPosition() > myCounts->lastPosition);
+        }
+        myCounts->lastChromosome = element.getChromosome();
+        myCounts->lastPosition = element.getRefPosition();
+        ++myCounts->numPositions;
+        myCounts->numEntries += element.getNumEntries();
+        return(true);
+    }
+    PileupCounts* myCounts;
+};
+
+
+// Throws something other than a std::exception when it gets a record at
+// THROW_POSITION.
+class ThrowingElement : public PileupElementBaseQual
+{
+public:
+    static const int32_t THROW_POSITION = 123456;
+    void addEntry(SamRecord& record)
+    {
+        if(getRefPosition() == THROW_POSITION)
+        {
+            throw THROW_POSITION;
+        }
+        PileupElementBaseQual::addEntry(record);
+    }
+};
+
+
+// Run a pileup on one thread, returning what it printed.
+template <class PILEUP_TYPE>
+static std::string runPileup(const char* filename)
+{
+    std::stringstream output;
+    std::streambuf* coutBuf = std::cout.rdbuf(output.rdbuf());
+    Pileup<PILEUP_TYPE> pileup;
+    int status = pileup.processFile(filename);
+    std::cout.rdbuf(coutBuf);
+    assert(status == 0);
+    return(output.str());
+}
+
+
+// Run a parallel pileup, returning what it printed.
+template <class PILEUP_TYPE>
+static std::string runParallelPileup(const char* filename, int numWorkers,
+                                     int32_t maxShardLength, int maxInFlight,
+                                     bool recordMajor)
+{
+    std::stringstream output;
+    std::streambuf* coutBuf = std::cout.rdbuf(output.rdbuf());
+    ParallelPileup<PILEUP_TYPE> pileup(numWorkers);
+    pileup.setMaxShardLength(maxShardLength);
+    pileup.setMaxShardsInFlight(maxInFlight);
+    pileup.setRecordMajor(recordMajor);
+    int status = pileup.processFile(filename);
+    std::cout.rdbuf(coutBuf);
+    assert(status == 0);
+    assert(pileup.getStatus() == SamStatus::SUCCESS);
+    return(output.str());
+}
+
+
+void testParallelPileup()
+{
+    // Shards are found using the BAM index, which is compressed.
+#ifdef __ZLIB_AVAILABLE__
+    const char* filename = "results/parallelPileup.bam";
+    ParallelPileupTest::writeFile(filename);
+    ParallelPileupTest::testOutput(filename);
+    ParallelPileupTest::testCount(filename);
+    ParallelPileupTest::testFailure(filename);
+#endif
+}
+
+
+void ParallelPileupTest::writeFile(const char* filename)
+{
+    SamFileHeader samHeader;
+    char line[64];
+    for(int i = 0; i < NUM_REFS; i++)
+    {
+        snprintf(line, sizeof(line), "@SQ\tSN:%d\tLN:%d", i + 1,
+                 REF_LENGTHS[i]);
+        assert(samHeader.addHeaderLine(line));
+    }
+    assert(samHeader.addHeaderLine("@HD\tVN:1.0\tSO:coordinate"));
+
+    SamFile outFile;
+    outFile.GenerateIndex(true);
+    assert(outFile.OpenForWrite(filename, &samHeader));
+
+    SamRecord samRecord;
+    unsigned int random = 1;
+    std::string sequence(50, 'A');
+    std::string quality(50, 'I');
+    const char bases[] = "ACGT";
+    const char* cigars[] = {"50M", "20M5D30M", "3S40M2I5M", "10M100N40M"};
+    char readName[32];
+    int numRecords = 0;
+    // Reads on the first reference are dense with gaps every 10000
+    // positions, the second is sparse, and the third has none.
+    int32_t spacing[NUM_REFS] = {3, 400, 0};
+    for(int refID = 0; refID < NUM_REFS; refID++)
+    {
+        if(spacing[refID] == 0)
+        {
+            continue;
+        }
+        for(int32_t pos = 1; pos + 200 <= REF_LENGTHS[refID];
+            pos += spacing[refID])
+        {
+            if((pos % 10000) < 300)
+            {
+                continue;
+            }
+            for(int i = 0; i < 50; i++)
+            {
+                random = random * 1103515245 + 12345;
+                sequence[i] = bases[(random >> 16) & 3];
+            }
+            snprintf(readName, sizeof(readName), "read%d", numRecords);
+            samRecord.resetRecord();
+            assert(samRecord.setReadName(readName));
+            // Some duplicates, which are excluded by default.
+            assert(samRecord.setFlag((numRecords % 2) ? 16 :
+                                     ((numRecords % 10 == 0) ? 1024 : 0)));
+            const char* refName = samHeader.getReferenceLabel(refID).c_str();
+            assert(samRecord.setReferenceName(samHeader, refName));
+            assert(samRecord.set1BasedPosition(pos));
+            assert(samRecord.setMapQuality(numRecords % 60));
+            assert(samRecord.setCigar(cigars[numRecords % 4]));
+            assert(samRecord.setSequence(sequence.c_str()));
+            assert(samRecord.setQuality(quality.c_str()));
+            assert(outFile.WriteRecord(samHeader, samRecord));
+            ++numRecords;
+        }
+    }
+    for(int i = 0; i < 5; i++)
+    {
+        samRecord.resetRecord();
+        assert(samRecord.setReadName("unmapped"));
+        assert(samRecord.setFlag(4));
+        assert(samRecord.setSequence(sequence.c_str()));
+        assert(samRecord.setQuality(quality.c_str()));
+        assert(outFile.WriteRecord(samHeader, samRecord));
+    }
+    outFile.Close();
+    assert(outFile.GetStatus() == SamStatus::SUCCESS);
+}
+
+
+void ParallelPileupTest::testOutput(const char* filename)
+{
+    std::string expected = runPileup<PileupElementBaseQual>(filename);
+    assert(!expected.empty());
+
+    // Records that overlap shards are piled up by both, and many small
+    // shards with only one in flight at a time still come back in order.
+    assert(runParallelPileup<PileupElementBaseQual>(filename, 4, 65536, 8,
+                                                    false) == expected);
+    assert(runParallelPileup<PileupElementBaseQual>(filename, 3, 7000, 1,
+                                                    true) == expected);
+    assert(runParallelPileup<PileupElementPooled>(filename, 4, 5000, 4,
+                                                  true) == expected);
+    assert(runParallelPileup<PileupElementPooled>(filename, 1, 0, 2,
+                                                  false) == expected);
+}
+
+
+void ParallelPileupTest::testCount(const char* filename)
+{
+    // Count the entries of the reverse reads on one thread.
+    PileupCounts expected;
+    {
+        Pileup<PileupElementPooled, CountEntries> pileup((CountEntries(expected)));
+        assert(pileup.processFile(filename, 0x0704, 16) == 0);
+    }
+    assert(expected.numPositions > 250000);
+    assert(expected.numEntries > expected.numPositions);
+
+    // The delivered positions and entries match.
+    PileupCounts counts;
+    ParallelPileup<PileupElementPooled, CountEntries>
+        pileup(4, CountEntries(counts));
+    pileup.setMaxShardLength(20000);
+    pileup.setRecordMajor(true);
+    assert(pileup.processFile(filename, NULL, 0x0704, 16) == 0);
+    assert(pileup.getAnalyzeFunc().myCounts == &counts);
+    assert(counts.numPositions == expected.numPositions);
+    assert(counts.numEntries == expected.numEntries);
+}
+
+
+void ParallelPileupTest::testFailure(const char* filename)
+{
+    ParallelPileup<PileupElementBaseQual> pileup(2);
+    assert(pileup.processFile("results/missingParallel.bam") != 0);
+    assert(pileup.getStatus() == SamStatus::FAIL_IO);
+
+    // An exception from a worker's pileup is returned as the status.
+    std::stringstream output;
+    std::streambuf* coutBuf = std::cout.rdbuf(output.rdbuf());
+    ParallelPileup<ThrowingElement> throwPileup(3);
+    throwPileup.setMaxShardLength(10000);
+    int status = throwPileup.processFile(filename);
+    // It can be reused after the failure.
+    throwPileup.setMaxShardLength(1000);
+    int status2 = throwPileup.processFile(filename, NULL, 0x0704, 16);
+    std::cout.rdbuf(coutBuf);
+    assert(status == SamStatus::FAIL_PARSE);
+    assert(std::string(throwPileup.getStatus().getStatusMessage()).find(
+               "Unknown exception while piling up the shard") !=
+           std::string::npos);
+    assert(status2 == SamStatus::FAIL_PARSE);
+}
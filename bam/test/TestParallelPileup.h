@@ -0,0 +1,34 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TEST_PARALLEL_PILEUP_H__
+#define __TEST_PARALLEL_PILEUP_H__
+
+void testParallelPileup();
+
+class ParallelPileupTest
+{
+public:
+    static void writeFile(const char* filename);
+    static void testOutput(const char* filename);
+    static void testCount(const char* filename);
+    static void testFailure(const char* filename);
+
+private:
+};
+
+#endif
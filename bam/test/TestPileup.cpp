@@ -15,11 +15,14 @@
  *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "TestPileup.h"
+#include <fstream>
+#include <sstream>
 
 void testPileup()
 {
     TestPileup pileupTest;
     pileupTest.testPileupPosition();
+    testPooledPileup();
 }
 
 void TestPileupElement::analyze()
@@ -60,3 +63,112 @@ void TestPileup::testPileupPosition()
     }
     assert(caught);
 }
+
+
+// Run the pileup over the file, returning what it printed.
+template <class PILEUP_TYPE>
+static std::string runPileup(const char* filename, bool recordMajor = false)
+{
+    std::stringstream output;
+    std::streambuf* coutBuf = std::cout.rdbuf(output.rdbuf());
+    Pileup<PILEUP_TYPE> pileup;
+    pileup.setRecordMajor(recordMajor);
+    int status = pileup.processFile(filename);
+    std::cout.rdbuf(coutBuf);
+    assert(status == 0);
+    return(output.str());
+}
+
+
+bool PooledEntryCheck::operator() (PileupElementPooled& element)
+{
+    int numDeletions = 0;
+    for(int i = 0; i < element.getNumEntries(); i++)
+    {
+        const PileupArena::Entry& entry = element.getEntry(i);
+        bool isDeletion = (entry.flags & PileupArena::Entry::DELETION) != 0;
+        assert(isDeletion == (entry.base == '-'));
+        assert(isDeletion == (entry.readIndex == -1));
+        assert(entry.readIndex < 20);
+        assert(entry.mapQuality < 60);
+        if(isDeletion)
+        {
+            ++numDeletions;
+        }
+        else
+        {
+            assert((entry.quality == ' ') || (entry.quality == 'I'));
+        }
+    }
+    assert(element.getNumBases() == element.getNumEntries() - numDeletions);
+    // Going back to an earlier entry works too.
+    if(element.getNumEntries() > 0)
+    {
+        assert(&element.getEntry(0) == &element.getEntry(0));
+        assert(element.getEntry(element.getNumEntries() - 1).readIndex < 20);
+    }
+    return(true);
+}
+
+
+void testPooledPileup()
+{
+    // Deep coverage, with deletions, reverse reads, and missing qualities.
+    const char* filename = "results/pooledPileup.sam";
+    std::ofstream samFile(filename);
+    samFile << "@HD\tVN:1.0\tSO:coordinate\n@SQ\tSN:1\tLN:10000\n";
+    int numRecords = 600;
+    for(int i = 0; i < numRecords; i++)
+    {
+        const char* cigar = "20M";
+        if(i % 3 == 0)
+        {
+            cigar = "8M2D12M";
+        }
+        else if(i % 3 == 1)
+        {
+            cigar = "2S5M1I4M3N8M";
+        }
+        samFile << "read" << i << "\t" << ((i % 2) ? 16 : 0) << "\t1\t"
+                << (100 + i / 10) << "\t" << (i % 60) << "\t" << cigar
+                << "\t*\t0\t0\tACGTACGTACGTACGTACGT\t"
+                << ((i % 5 == 0) ? "*" : "IIIIIIIIIIIIIIIIIIII") << "\n";
+    }
+    samFile.close();
+
+    // Same output as the non-pooled element, and when adding the records
+    // a CIGAR operation at a time.
+    std::string expected = runPileup<PileupElementBaseQual>(filename);
+    assert(!expected.empty());
+    assert(runPileup<PileupElementPooled>(filename) == expected);
+    assert(runPileup<PileupElementBaseQual>(filename, true) == expected);
+    assert(runPileup<PileupElementPooled>(filename, true) == expected);
+    // Element types without a PileupRunAdder use addEntry.
+    assert(runPileup<PileupElement>(filename, true) ==
+           runPileup<PileupElement>(filename));
+
+    // The blocks are all returned to the arena and reused as the window
+    // slides, so the arena only holds about the blocks of one read length.
+    PileupArena& arena = PileupArena::getThreadArena();
+    assert(arena.getNumBlocksInUse() == 0);
+    assert(arena.getNumBlocks() > 0);
+    assert(arena.getNumBlocks() <= 2048);
+
+    Pileup<PileupElementPooled, PooledEntryCheck> pileup;
+    assert(pileup.processFile(filename) == 0);
+    assert(arena.getNumBlocksInUse() == 0);
+    pileup.setRecordMajor(true);
+    assert(pileup.processFile(filename) == 0);
+    assert(arena.getNumBlocksInUse() == 0);
+
+#ifdef __ZLIB_AVAILABLE__
+    expected = runPileup<PileupElementBaseQual>("testFiles/sortedBam.bam");
+    assert(!expected.empty());
+    assert(runPileup<PileupElementPooled>("testFiles/sortedBam.bam") ==
+           expected);
+    assert(runPileup<PileupElementBaseQual>("testFiles/sortedBam.bam", true)
+           == expected);
+    assert(runPileup<PileupElementPooled>("testFiles/sortedBam.bam", true) ==
+           expected);
+#endif
+}
@@ -17,6 +17,7 @@
 
 #include "Pileup.h"
 #include "PileupElementBaseQual.h"
+#include "PileupElementPooled.h"
 
 void testPileup();
 
@@ -35,3 +36,15 @@ public:
     void testPileupPosition();
 private:
 };
+
+
+// Checks the entries of each pooled element against the deep coverage
+// file written by testPooledPileup.
+class PooledEntryCheck
+{
+public:
+    bool operator() (PileupElementPooled& element);
+};
+
+
+void testPooledPileup();
@@ -20,19 +20,30 @@
 #include "SamCoordOutput.h"
 #include "SamRecordPool.h"
 #include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
 
 void testSamCoordOutput()
 {
     // Call generic test.
-    SamCoordOutputTest::testSamCoordOutput();
+    SamCoordOutputTest::testSamCoordOutput(0,
+                                           "results/TestSamCoordOutput.sam");
+    // The same with a window small enough that some records are outside
+    // of it.
+    SamCoordOutputTest::testSamCoordOutput(4,
+                                           "results/TestSamCoordOutputBuckets.sam");
+    SamCoordOutputTest::testBucketWindow();
 }
 
 
-void SamCoordOutputTest::testSamCoordOutput()
+void SamCoordOutputTest::testSamCoordOutput(uint32_t windowSize,
+                                            const char* outFilename)
 {
     SamRecordPool pool(3);
 
     SamCoordOutput outputBuffer(pool);
+    outputBuffer.setBucketWindow(windowSize);
 
     SamFile inSam;
     SamFile outSam;
@@ -79,7 +90,7 @@ void SamCoordOutputTest::testSamCoordOutput()
     outputBuffer.setOutputFile(&outSam, &samHeader);
 
     // Open output file and write the header.
-    assert(outSam.OpenForWrite("results/TestSamCoordOutput.sam"));
+    assert(outSam.OpenForWrite(outFilename));
     assert(outSam.WriteHeader(samHeader));
 
     // Read another 1 record (reuse record pointers).
@@ -149,3 +160,112 @@ void SamCoordOutputTest::testSamCoordOutput()
     // Flush the rest by passing in -1, -1
     assert(outputBuffer.flush(-1, -1));
 }
+
+
+// Add the same nearly sorted records to a buffer using just the tree and
+// ones using buckets, and check they are written in the same order.
+void SamCoordOutputTest::testBucketWindow()
+{
+    SamFileHeader samHeader;
+    assert(samHeader.addHeaderLine("@SQ\tSN:1\tLN:1000000"));
+    assert(samHeader.addHeaderLine("@SQ\tSN:2\tLN:1000000"));
+
+    const int NUM_BUFFERS = 3;
+    uint32_t windowSizes[NUM_BUFFERS] = {0, 64, 1024};
+    SamRecordPool pool(-1);
+    SamCoordOutput* outputBuffers[NUM_BUFFERS];
+    SamFile outSams[NUM_BUFFERS];
+    char filename[64];
+    for(int i = 0; i < NUM_BUFFERS; i++)
+    {
+        snprintf(filename, sizeof(filename),
+                 "results/TestSamCoordOutputWindow%d.sam", i);
+        assert(outSams[i].OpenForWrite(filename));
+        assert(outSams[i].WriteHeader(samHeader));
+        outputBuffers[i] = new SamCoordOutput(pool);
+        outputBuffers[i]->setBucketWindow(windowSizes[i]);
+        outputBuffers[i]->setOutputFile(&outSams[i], &samHeader);
+    }
+
+    // Records mostly shifted a little from sorted, with some far before
+    // their sorted position, some far after, and some unmapped.
+    srand(1);
+    char readName[32];
+    for(int i = 0; i < 4000; i++)
+    {
+        const char* refName = (i < 2500) ? "1" : "2";
+        int32_t pos = (i % 2500) * 3 + 1000 + (rand() % 41) - 20;
+        if(rand() % 50 == 0)
+        {
+            pos -= rand() % 500;
+        }
+        else if(rand() % 50 == 0)
+        {
+            pos += rand() % 5000;
+        }
+        bool unmapped = (rand() % 100 == 0);
+        snprintf(readName, sizeof(readName), "read%d", i);
+        for(int j = 0; j < NUM_BUFFERS; j++)
+        {
+            SamRecord* record = pool.getRecord();
+            assert(record != NULL);
+            record->resetRecord();
+            assert(record->setReadName(readName));
+            if(unmapped)
+            {
+                assert(record->setFlag(4));
+            }
+            else
+            {
+                assert(record->setReferenceName(samHeader, refName));
+                assert(record->set0BasedPosition(pos));
+                assert(record->setCigar("4M"));
+            }
+            assert(record->setSequence("ACGT"));
+            assert(outputBuffers[j]->add(record));
+        }
+        // Flush up to a bit before the last record, or everything on
+        // the first reference when switching references.
+        if(i == 2500)
+        {
+            for(int j = 0; j < NUM_BUFFERS; j++)
+            {
+                assert(outputBuffers[j]->flush(0, -1));
+            }
+        }
+        else if(i % 20 == 0)
+        {
+            for(int j = 0; j < NUM_BUFFERS; j++)
+            {
+                assert(outputBuffers[j]->flush((i < 2500) ? 0 : 1,
+                                               pos - 100));
+            }
+        }
+    }
+    for(int i = 0; i < NUM_BUFFERS; i++)
+    {
+        assert(outputBuffers[i]->flushAll());
+        delete outputBuffers[i];
+        outSams[i].Close();
+    }
+
+    // Compare the output of the buffers.
+    std::vector<std::string> outputs(NUM_BUFFERS);
+    for(int i = 0; i < NUM_BUFFERS; i++)
+    {
+        snprintf(filename, sizeof(filename),
+                 "results/TestSamCoordOutputWindow%d.sam", i);
+        FILE* file = fopen(filename, "r");
+        assert(file != NULL);
+        char buffer[4096];
+        size_t numRead = 0;
+        while((numRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            outputs[i].append(buffer, numRead);
+        }
+        fclose(file);
+    }
+    assert(outputs[0].size() > 4000 * 20);
+    assert(outputs[1] == outputs[0]);
+    assert(outputs[2] == outputs[0]);
+}
@@ -18,12 +18,16 @@
 #ifndef __TEST_SAM_COORD_OUTPUT_H__
 #define __TEST_SAM_COORD_OUTPUT_H__
 
+#include <stdint.h>
+
 void testSamCoordOutput();
 
 class SamCoordOutputTest
 {
 public:
-    static void testSamCoordOutput();
+    static void testSamCoordOutput(uint32_t windowSize,
+                                   const char* outFilename);
+    static void testBucketWindow();
 
 private:
 };
@@ -0,0 +1,319 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestSamMergeReader.h"
+#include "SamMergeReader.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+static const int NUM_RECORDS = 1000;
+
+#ifdef __ZLIB_AVAILABLE__
+static const char* EXTENSION = "bam";
+#else
+static const char* EXTENSION = "sam";
+#endif
+
+
+void testSamMergeReader()
+{
+    std::vector<std::string> filenames;
+    SamMergeReaderTest::writeInputs(filenames);
+    SamMergeReaderTest::testMerge(filenames, 0);
+    SamMergeReaderTest::testMerge(filenames, 2);
+    SamMergeReaderTest::testFailure();
+}
+
+
+void SamMergeReaderTest::writeFile(const char* filename,
+                                   const char* headerLines,
+                                   const char* prefix, int numRecords,
+                                   const std::vector<std::string>& refNames,
+                                   const char* rg, const char* pg,
+                                   const char* pg2)
+{
+    SamFileHeader samHeader;
+    assert(samHeader.addHeader(headerLines));
+    SamFile outFile;
+    assert(outFile.OpenForWrite(filename, &samHeader));
+    outFile.setSortedValidation(SamFile::COORDINATE);
+
+    // Sorted positions on each reference.  Positions are multiples of 10
+    // so the files have records at the same positions.
+    SamRecord samRecord;
+    char readName[32];
+    int recordNum = 0;
+    for(unsigned int ref = 0; ref < refNames.size(); ref++)
+    {
+        std::vector<int32_t> positions;
+        for(int i = 0; i < numRecords / (int)refNames.size(); i++)
+        {
+            positions.push_back((rand() % 500) * 10);
+        }
+        std::sort(positions.begin(), positions.end());
+        for(unsigned int i = 0; i < positions.size(); i++)
+        {
+            samRecord.resetRecord();
+            snprintf(readName, sizeof(readName), "%s_%d", prefix,
+                     recordNum++);
+            assert(samRecord.setReadName(readName));
+            assert(samRecord.setFlag(1));
+            assert(samRecord.setReferenceName(samHeader,
+                                              refNames[ref].c_str()));
+            assert(samRecord.set0BasedPosition(positions[i]));
+            // Mates on the first reference.
+            assert(samRecord.setMateReferenceName(samHeader,
+                                                  refNames[0].c_str()));
+            assert(samRecord.set0BasedMatePosition(positions[i]));
+            assert(samRecord.setCigar("10M"));
+            assert(samRecord.setSequence("ACGTACGTAC"));
+            assert(samRecord.addTag("RG", 'Z', rg));
+            assert(samRecord.addTag("PG", 'Z',
+                                    ((pg2 != NULL) && (i % 2)) ? pg2 : pg));
+            assert(outFile.WriteRecord(samHeader, samRecord));
+        }
+    }
+    for(int i = 0; i < 3; i++)
+    {
+        samRecord.resetRecord();
+        snprintf(readName, sizeof(readName), "%s_%d", prefix, recordNum++);
+        assert(samRecord.setReadName(readName));
+        assert(samRecord.setFlag(4));
+        assert(samRecord.setSequence("ACGTACGTAC"));
+        assert(samRecord.addTag("RG", 'Z', rg));
+        assert(samRecord.addTag("PG", 'Z', pg));
+        assert(outFile.WriteRecord(samHeader, samRecord));
+    }
+    outFile.Close();
+    assert(outFile.GetStatus() == SamStatus::SUCCESS);
+}
+
+
+void SamMergeReaderTest::writeInputs(std::vector<std::string>& filenames)
+{
+    srand(1);
+    char filename[64];
+    std::vector<std::string> refNames;
+
+    // All three references.
+    snprintf(filename, sizeof(filename), "results/mergeIn0.%s", EXTENSION);
+    filenames.push_back(filename);
+    refNames.push_back("1");
+    refNames.push_back("2");
+    refNames.push_back("3");
+    writeFile(filename,
+              "@HD\tVN:1.4\tSO:coordinate\n"
+              "@SQ\tSN:1\tLN:100000\n@SQ\tSN:2\tLN:100000\n"
+              "@SQ\tSN:3\tLN:100000\n"
+              "@RG\tID:grp1\tSM:a\n@PG\tID:bwa\tPN:bwa\tVN:1\n@CO\tlane 1\n",
+              "in0", NUM_RECORDS, refNames, "grp1", "bwa", NULL);
+
+    // Missing a reference, a read group with the same ID, and the same
+    // program.
+    snprintf(filename, sizeof(filename), "results/mergeIn1.%s", EXTENSION);
+    filenames.push_back(filename);
+    refNames.clear();
+    refNames.push_back("1");
+    refNames.push_back("3");
+    writeFile(filename,
+              "@HD\tVN:1.4\tSO:coordinate\n"
+              "@SQ\tSN:1\tLN:100000\n@SQ\tSN:3\tLN:100000\n"
+              "@RG\tID:grp1\tSM:b\n@PG\tID:bwa\tPN:bwa\tVN:1\n@CO\tlane 1\n",
+              "in1", NUM_RECORDS, refNames, "grp1", "bwa", NULL);
+
+    // An extra reference, and a different program with the same ID that
+    // another program follows.
+    snprintf(filename, sizeof(filename), "results/mergeIn2.%s", EXTENSION);
+    filenames.push_back(filename);
+    refNames.clear();
+    refNames.push_back("1");
+    refNames.push_back("4");
+    writeFile(filename,
+              "@HD\tVN:1.4\tSO:coordinate\n"
+              "@SQ\tSN:1\tLN:100000\n@SQ\tSN:2\tLN:100000\n"
+              "@SQ\tSN:3\tLN:100000\n@SQ\tSN:4\tLN:5000\n"
+              "@RG\tID:grp2\tSM:c\n@PG\tID:bwa\tPN:bwa\tVN:2\n"
+              "@PG\tID:dedup\tPN:dedup\tPP:bwa\n@CO\tlane 2\n",
+              "in2", NUM_RECORDS, refNames, "grp2", "bwa", "dedup");
+}
+
+
+void SamMergeReaderTest::testMerge(const std::vector<std::string>& filenames,
+                                   int numThreads)
+{
+    SamMergeReader reader;
+    SamFileHeader header;
+    reader.setNumThreads(numThreads);
+    assert(reader.open(filenames, header));
+    assert(reader.getNumInputs() == 3);
+
+    // Check the merged header.
+    assert(strcmp(header.getSortOrder(), "coordinate") == 0);
+    const SamReferenceInfo& refInfo = header.getReferenceInfo();
+    assert(refInfo.getNumEntries() == 4);
+    assert(refInfo.getReferenceLabel(0) == "1");
+    assert(refInfo.getReferenceLabel(1) == "2");
+    assert(refInfo.getReferenceLabel(2) == "3");
+    assert(refInfo.getReferenceLabel(3) == "4");
+    assert(refInfo.getReferenceLength(3) == 5000);
+    assert(header.getNumRGs() == 3);
+    assert(strcmp(header.getRGTagValue("SM", "grp1"), "a") == 0);
+    assert(strcmp(header.getRGTagValue("SM", "grp1-1"), "b") == 0);
+    assert(strcmp(header.getRGTagValue("SM", "grp2"), "c") == 0);
+    assert(header.getNumPGs() == 3);
+    assert(strcmp(header.getPGTagValue("VN", "bwa"), "1") == 0);
+    assert(strcmp(header.getPGTagValue("VN", "bwa-1"), "2") == 0);
+    assert(strcmp(header.getPGTagValue("PP", "dedup"), "bwa-1") == 0);
+    std::string comments;
+    header.appendCommentLines(comments);
+    assert(comments == "@CO\tlane 1\n@CO\tlane 2\n");
+
+    // Write the merged records, checking they are sorted.
+    char outFilename[64];
+    snprintf(outFilename, sizeof(outFilename), "results/merged%d.%s",
+             numThreads, EXTENSION);
+    SamFile outFile;
+    assert(outFile.OpenForWrite(outFilename, &header));
+    outFile.setSortedValidation(SamFile::COORDINATE);
+
+    const char* expectedRG[] = {"grp1", "grp1-1", "grp2"};
+    int numRecords = 0;
+    int numTies = 0;
+    int32_t prevRefID = -1;
+    int32_t prevPos = -1;
+    int prevInput = -1;
+    SamRecord* record = NULL;
+    while((record = reader.readRecord()) != NULL)
+    {
+        ++numRecords;
+        int input = reader.getRecordInput();
+        char prefix[8];
+        snprintf(prefix, sizeof(prefix), "in%d_", input);
+        assert(strncmp(record->getReadName(), prefix, 4) == 0);
+        assert(*(record->getStringTag("RG")) == expectedRG[input]);
+        const String* pg = record->getStringTag("PG");
+        if(input == 2)
+        {
+            assert((*pg == "bwa-1") || (*pg == "dedup"));
+        }
+        else
+        {
+            assert(*pg == "bwa");
+        }
+        if(record->getReferenceID() >= 0)
+        {
+            // The names still match the IDs, which were remapped.
+            assert(header.getReferenceLabel(record->getReferenceID()) ==
+                   record->getReferenceName());
+            assert(record->getMateReferenceID() == 0);
+            if(input == 1)
+            {
+                assert((record->getReferenceID() == 0) ||
+                       (record->getReferenceID() == 2));
+            }
+            if((record->getReferenceID() == prevRefID) &&
+               (record->get0BasedPosition() == prevPos))
+            {
+                // Ties are in input order.
+                assert(input >= prevInput);
+                if(input != prevInput)
+                {
+                    ++numTies;
+                }
+            }
+        }
+        prevRefID = record->getReferenceID();
+        prevPos = record->get0BasedPosition();
+        prevInput = input;
+        assert(outFile.WriteRecord(header, *record));
+    }
+    assert(reader.getStatus() == SamStatus::NO_MORE_RECS);
+    // Each file has NUM_RECORDS split evenly between its references, plus
+    // 3 unmapped.
+    assert(numRecords == (NUM_RECORDS / 3) * 3 + 2 * NUM_RECORDS + 3 * 3);
+    assert(numTies > 0);
+    outFile.Close();
+    assert(outFile.GetStatus() == SamStatus::SUCCESS);
+    reader.close();
+    assert(reader.readRecord() == NULL);
+    assert(reader.getStatus() == SamStatus::FAIL_ORDER);
+}
+
+
+void SamMergeReaderTest::testFailure()
+{
+    SamMergeReader reader;
+    SamFileHeader header;
+    std::vector<std::string> filenames;
+    assert(!reader.open(filenames, header));
+
+    char filename[64];
+    snprintf(filename, sizeof(filename), "results/mergeIn0.%s", EXTENSION);
+    filenames.push_back(filename);
+    filenames.push_back("results/missingMerge.bam");
+    assert(!reader.open(filenames, header));
+    assert(reader.getStatus() == SamStatus::FAIL_IO);
+    assert(reader.getNumInputs() == 0);
+
+    // A reference with a different length.
+    std::vector<std::string> refNames(1, "1");
+    filenames.pop_back();
+    filenames.push_back("results/mergeBadLength.sam");
+    writeFile(filenames.back().c_str(), "@SQ\tSN:1\tLN:5000\n", "bad", 10,
+              refNames, "grp1", "bwa", NULL);
+    assert(!reader.open(filenames, header));
+    assert(reader.getStatus() == SamStatus::FAIL_PARSE);
+
+    // References in a different order.
+    filenames.pop_back();
+    filenames.push_back("results/mergeBadOrder.sam");
+    writeFile(filenames.back().c_str(),
+              "@SQ\tSN:3\tLN:100000\n@SQ\tSN:1\tLN:100000\n", "bad", 10,
+              refNames, "grp1", "bwa", NULL);
+    assert(!reader.open(filenames, header));
+    assert(reader.getStatus() == SamStatus::FAIL_PARSE);
+
+    // An input that is not sorted.
+    filenames.pop_back();
+    filenames.push_back("results/mergeUnsorted.sam");
+    SamFileHeader unsortedHeader;
+    assert(unsortedHeader.addHeaderLine("@SQ\tSN:1\tLN:100000"));
+    SamFile unsortedFile;
+    assert(unsortedFile.OpenForWrite(filenames.back().c_str(),
+                                     &unsortedHeader));
+    SamRecord samRecord;
+    for(int i = 0; i < 3; i++)
+    {
+        samRecord.resetRecord();
+        assert(samRecord.setReadName("unsorted"));
+        assert(samRecord.setReferenceName(unsortedHeader, "1"));
+        assert(samRecord.set0BasedPosition(1000 - i));
+        assert(samRecord.setCigar("10M"));
+        assert(samRecord.setSequence("ACGTACGTAC"));
+        assert(unsortedFile.WriteRecord(unsortedHeader, samRecord));
+    }
+    unsortedFile.Close();
+    assert(reader.open(filenames, header));
+    SamRecord* record = NULL;
+    while((record = reader.readRecord()) != NULL)
+    {
+    }
+    assert(reader.getStatus() == SamStatus::INVALID_SORT);
+}
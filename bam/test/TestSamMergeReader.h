@@ -0,0 +1,43 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TEST_SAM_MERGE_READER_H__
+#define __TEST_SAM_MERGE_READER_H__
+
+#include <string>
+#include <vector>
+
+void testSamMergeReader();
+
+class SamMergeReaderTest
+{
+public:
+    static void writeInputs(std::vector<std::string>& filenames);
+    static void testMerge(const std::vector<std::string>& filenames,
+                          int numThreads);
+    static void testFailure();
+
+private:
+    // Write a sorted file with the header lines and numRecords records on
+    // the specified references, plus a few without a reference.
+    static void writeFile(const char* filename, const char* headerLines,
+                          const char* prefix, int numRecords,
+                          const std::vector<std::string>& refNames,
+                          const char* rg, const char* pg, const char* pg2);
+};
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestSamRecordPipeline.h"
+#include "SamRecordPipeline.h"
+#include "SamFlag.h"
+#include <assert.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Shift the indels left, like ShiftIndelsTest.
+class ShiftProcessor : public SamRecordPipeline::Processor
+{
+public:
+    bool process(SamRecord& record)
+    {
+        record.shiftIndelsLeft();
+        return(true);
+    }
+};
+
+
+// Drop unmapped records, and tag the rest.
+class DropUnmappedProcessor : public SamRecordPipeline::Processor
+{
+public:
+    bool process(SamRecord& record)
+    {
+        if(SamFlag::isMapped(record.getFlag()) == false)
+        {
+            return(false);
+        }
+        return(record.addIntTag("XP", record.get1BasedPosition()));
+    }
+};
+
+
+// Fail on the specified record.
+class FailProcessor : public SamRecordPipeline::Processor
+{
+public:
+    bool process(SamRecord& record)
+    {
+        if(record.get1BasedPosition() == 1751)
+        {
+            throw(std::runtime_error("Failed on the 1751 record"));
+        }
+        return(true);
+    }
+};
+
+
+void testSamRecordPipeline()
+{
+    // The output is checked against the ShiftIndels expected results.
+    SamRecordPipelineTest::testShift("testFiles/testShift.sam",
+                                     "results/testShiftPipeline.sam");
+    SamRecordPipelineTest::testShift("testFiles/testShift.sam",
+                                     "results/testShiftPipeline.bam");
+
+    SamRecordPipelineTest::testDrop("testFiles/testSam.sam", 1, 1, 1);
+    SamRecordPipelineTest::testDrop("testFiles/testSam.sam", 3, 2, 0);
+    SamRecordPipelineTest::testDrop("testFiles/testSam.sam", 4, 1, 2);
+#ifdef __ZLIB_AVAILABLE__
+    SamRecordPipelineTest::testDrop("testFiles/testBam.bam", 2, 1000, 0);
+    SamRecordPipelineTest::testDrop("testFiles/sortedBam.bam", 8, 1, 0);
+#endif
+    SamRecordPipelineTest::testFailure("testFiles/testSam.sam");
+}
+
+
+void SamRecordPipelineTest::testShift(const char* input, const char* output)
+{
+    SamFile inSam, outSam;
+    assert(inSam.OpenForRead(input));
+    assert(outSam.OpenForWrite(output));
+    SamFileHeader samHeader;
+    assert(inSam.ReadHeader(samHeader));
+    assert(outSam.WriteHeader(samHeader));
+
+    ShiftProcessor processor;
+    SamRecordPipeline pipeline(3, 2);
+    assert(pipeline.run(inSam, outSam, samHeader, processor));
+    assert(pipeline.getStatus() == SamStatus::SUCCESS);
+    assert(pipeline.getNumRecordsRead() == pipeline.getNumRecordsWritten());
+    assert(pipeline.getNumRecordsDropped() == 0);
+}
+
+
+void SamRecordPipelineTest::testDrop(const char* input, int numWorkers,
+                                     int batchSize, int maxBatches)
+{
+    // Get the expected records.
+    std::vector<std::string> expected;
+    SamFile inSam;
+    SamFileHeader samHeader;
+    assert(inSam.OpenForRead(input, &samHeader));
+    SamRecord samRecord;
+    uint64_t numRecords = 0;
+    while(inSam.ReadRecord(samHeader, samRecord))
+    {
+        ++numRecords;
+        if(SamFlag::isMapped(samRecord.getFlag()))
+        {
+            expected.push_back(samRecord.getReadName());
+        }
+    }
+    inSam.Close();
+
+    const char* output = "results/pipelineDrop.sam";
+    SamFile outSam;
+    assert(inSam.OpenForRead(input, &samHeader));
+    assert(outSam.OpenForWrite(output, &samHeader));
+
+    DropUnmappedProcessor processor;
+    SamRecordPipeline pipeline(numWorkers, batchSize, maxBatches);
+    assert(pipeline.run(inSam, outSam, samHeader, processor));
+    assert(pipeline.getNumRecordsRead() == numRecords);
+    assert(pipeline.getNumRecordsWritten() == expected.size());
+    assert(pipeline.getNumRecordsDropped() == numRecords - expected.size());
+    assert(pipeline.getWorkQueueDepth() == 0);
+    assert(pipeline.getWriteQueueDepth() == 0);
+    assert(pipeline.getElapsedSeconds() >= 0);
+    if(maxBatches > 0)
+    {
+        assert(pipeline.getMaxWorkQueueDepth() <= maxBatches);
+        assert(pipeline.getMaxWriteQueueDepth() < maxBatches);
+    }
+    outSam.Close();
+
+    // Check the output is in the original order with the new tag.
+    assert(inSam.OpenForRead(output, &samHeader));
+    unsigned int index = 0;
+    while(inSam.ReadRecord(samHeader, samRecord))
+    {
+        assert(index < expected.size());
+        assert(expected[index++] == samRecord.getReadName());
+        int tagVal = 0;
+        assert(samRecord.getIntegerTag("XP", tagVal));
+        assert(tagVal == samRecord.get1BasedPosition());
+    }
+    assert(index == expected.size());
+}
+
+
+void SamRecordPipelineTest::testFailure(const char* input)
+{
+    SamFile inSam, outSam;
+    SamFileHeader samHeader;
+    assert(inSam.OpenForRead(input, &samHeader));
+    assert(outSam.OpenForWrite("results/pipelineFail.sam", &samHeader));
+
+    FailProcessor processor;
+    SamRecordPipeline pipeline(2, 1);
+    assert(pipeline.run(inSam, outSam, samHeader, processor) == false);
+    assert(pipeline.getStatus() == SamStatus::FAIL_PARSE);
+    assert(std::string(pipeline.getStatus().getStatusMessage()) ==
+           "FAIL_PARSE: Failed on the 1751 record");
+}
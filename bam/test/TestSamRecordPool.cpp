@@ -17,12 +17,20 @@
 
 #include "TestSamRecordPool.h"
 #include "SamRecordPool.h"
+#include "SamFile.h"
 #include <assert.h>
+#include <string>
+#include <vector>
 
 void testSamRecordPool()
 {
     // Call generic test.
     SamRecordPoolTest::testSamRecordPool();
+    SamRecordPoolTest::testReadRecords("testFiles/testSam.sam", false);
+#ifdef __ZLIB_AVAILABLE__
+    SamRecordPoolTest::testReadRecords("testFiles/testBam.bam", false);
+    SamRecordPoolTest::testReadRecords("testFiles/sortedBam.bam", true);
+#endif
 }
 
 
@@ -97,3 +105,88 @@ void SamRecordPoolTest::testSamRecordPool()
     assert(rec != rec3);
     assert(pool.getRecord() == NULL);
 }
+
+
+// Setup the file for reading, reading by section with filters if
+// readSection is set.
+static void openForReadRecords(SamFile& samIn, SamFileHeader& samHeader,
+                               const char* fileName, bool readSection)
+{
+    assert(samIn.OpenForRead(fileName, &samHeader));
+    if(readSection)
+    {
+        assert(samIn.ReadBamIndex());
+        assert(samIn.SetReadSection("1", 1010, 1500));
+        samIn.SetReadFlags(0, 0x10);
+        samIn.setSortedValidation(SamFile::COORDINATE);
+    }
+}
+
+
+// Read the file in batches and check the records match reading them one
+// at a time.
+void SamRecordPoolTest::testReadRecords(const char* fileName, bool readSection)
+{
+    // Read the expected records one at a time.
+    std::vector<std::string> expected;
+    SamFile samIn;
+    SamFileHeader samHeader;
+    openForReadRecords(samIn, samHeader, fileName, readSection);
+    SamRecord samRecord;
+    while(samIn.ReadRecord(samHeader, samRecord))
+    {
+        expected.push_back(std::string(samRecord.getReadName()) + ":" +
+                           samRecord.getSequence());
+    }
+    assert(!expected.empty());
+
+    for(int batchSize = 1; batchSize <= 4; batchSize++)
+    {
+        SamFile batchIn;
+        openForReadRecords(batchIn, samHeader, fileName, readSection);
+        // Only allow enough records for one batch.
+        SamRecordPool pool(batchSize);
+        std::vector<SamRecord*> batch;
+        unsigned int numRead = 0;
+        int batchRead;
+        while((batchRead = batchIn.ReadRecords(samHeader, pool, batch,
+                                               batchSize)) > 0)
+        {
+            assert(batchRead == (int)batch.size());
+            assert(batchRead <= batchSize);
+            for(unsigned int i = 0; i < batch.size(); i++)
+            {
+                assert(numRead < expected.size());
+                assert(expected[numRead++] ==
+                       std::string(batch[i]->getReadName()) + ":" +
+                       batch[i]->getSequence());
+                pool.releaseRecord(batch[i]);
+            }
+            batch.clear();
+        }
+        assert(batchIn.GetStatus() == SamStatus::NO_MORE_RECS);
+        assert(numRead == expected.size());
+        assert(batchIn.GetCurrentRecordCount() == numRead);
+    }
+
+    // Stops when the pool is out of records.
+    SamFile batchIn;
+    openForReadRecords(batchIn, samHeader, fileName, readSection);
+    SamRecordPool pool(1);
+    std::vector<SamRecord*> batch;
+    assert(batchIn.ReadRecords(samHeader, pool, batch, 10) == 1);
+    assert(batchIn.GetStatus() == SamStatus::SUCCESS);
+    assert(batch.size() == 1);
+    bool caughtException = false;
+    try
+    {
+        assert(batchIn.ReadRecords(samHeader, pool, batch, 10) == 0);
+    }
+    catch(std::exception& e)
+    {
+        caughtException = true;
+    }
+    assert(caughtException);
+    assert(batchIn.GetStatus() == SamStatus::FAIL_MEM);
+    pool.releaseRecord(batch[0]);
+}
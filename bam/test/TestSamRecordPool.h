@@ -24,6 +24,7 @@ class SamRecordPoolTest
 {
 public:
     static void testSamRecordPool();
+    static void testReadRecords(const char* fileName, bool readSection);
 
 private:
 };
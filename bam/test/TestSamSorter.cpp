@@ -0,0 +1,242 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestSamSorter.h"
+#include "SamSorter.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int NUM_RECORDS = 30000;
+
+
+void testSamSorter()
+{
+#ifdef __ZLIB_AVAILABLE__
+    const char* filename = "results/unsorted.bam";
+#else
+    const char* filename = "results/unsorted.sam";
+#endif
+    SamSorterTest::writeFile(filename, NUM_RECORDS);
+    SamSorterTest::testCoordinate(filename, NUM_RECORDS);
+    SamSorterTest::testQueryName(filename, NUM_RECORDS);
+    SamSorterTest::testManyRuns();
+    SamSorterTest::testFailure();
+}
+
+
+// Write records in a random order, with many records at the same
+// positions, some unplaced records (a reference, but no position), and
+// some without a reference.  Read names are in the order written.
+void SamSorterTest::writeFile(const char* filename, int numRecords)
+{
+    SamFileHeader samHeader;
+    assert(samHeader.addHeaderLine("@SQ\tSN:1\tLN:100000"));
+    assert(samHeader.addHeaderLine("@SQ\tSN:2\tLN:100000"));
+    assert(samHeader.addHeaderLine("@SQ\tSN:3\tLN:100000"));
+
+    SamFile outFile;
+    assert(outFile.OpenForWrite(filename, &samHeader));
+
+    SamRecord samRecord;
+    const char* refNames[] = {"1", "2", "3"};
+    char readName[32];
+    srand(1);
+    for(int i = 0; i < numRecords; i++)
+    {
+        samRecord.resetRecord();
+        // Names sort in the opposite order they were written.
+        snprintf(readName, sizeof(readName), "read%06d", numRecords - i);
+        assert(samRecord.setReadName(readName));
+        int type = rand() % 100;
+        if(type == 0)
+        {
+            assert(samRecord.setFlag(4));
+        }
+        else
+        {
+            assert(samRecord.setReferenceName(samHeader,
+                                              refNames[rand() % 3]));
+            if(type == 1)
+            {
+                assert(samRecord.setFlag(4));
+            }
+            else
+            {
+                assert(samRecord.set1BasedPosition(rand() % 2000 + 1));
+                assert(samRecord.setCigar("20M"));
+            }
+        }
+        assert(samRecord.setSequence("ACGTACGTACGTACGTACGT"));
+        assert(outFile.WriteRecord(samHeader, samRecord));
+    }
+    outFile.Close();
+    assert(outFile.GetStatus() == SamStatus::SUCCESS);
+}
+
+
+void SamSorterTest::testCoordinate(const char* filename, int numRecords)
+{
+    // Sort in memory, then in runs of different sizes, which should
+    // give the same result.
+    SamSorter sorter(SamFile::COORDINATE);
+    sorter.setNumThreads(4);
+    assert(sorter.sort(filename, "results/sortedCoord.bam"));
+    assert(sorter.getStatus() == SamStatus::SUCCESS);
+    assert(sorter.getNumRuns() == 0);
+    std::vector<std::string> expected;
+    readSorted("results/sortedCoord.bam", false, expected);
+    assert((int)expected.size() == numRecords);
+
+    uint64_t maxMemory[] = {1000000, 300000};
+    int numThreads[] = {1, 3};
+    for(int i = 0; i < 2; i++)
+    {
+        SamSorter runSorter(SamFile::COORDINATE);
+        runSorter.setMaxMemory(maxMemory[i]);
+        runSorter.setNumThreads(numThreads[i]);
+        runSorter.setTempPrefix("results/sortTemp");
+        assert(runSorter.sort(filename, "results/sortedCoordRuns.bam"));
+        assert(runSorter.getNumRuns() > 1);
+        std::vector<std::string> readNames;
+        readSorted("results/sortedCoordRuns.bam", false, readNames);
+        assert(readNames == expected);
+        // The temporary files were removed.
+        FILE* tempFile = fopen("results/sortTemp.0.bam", "r");
+        assert(tempFile == NULL);
+    }
+
+    // Check records at the same position are in the order they were
+    // in the input, which has descending names.
+    SamFile samFile;
+    SamFileHeader samHeader;
+    SamRecord samRecord;
+    assert(samFile.OpenForRead("results/sortedCoord.bam", &samHeader));
+    assert(strcmp(samHeader.getSortOrder(), "coordinate") == 0);
+    std::string prevName;
+    int32_t prevRefID = -2;
+    int32_t prevPos = -2;
+    int numUnplaced = 0;
+    while(samFile.ReadRecord(samHeader, samRecord))
+    {
+        if((samRecord.getReferenceID() == prevRefID) &&
+           (samRecord.get0BasedPosition() == prevPos))
+        {
+            assert(prevName > samRecord.getReadName());
+        }
+        if((samRecord.getReferenceID() >= 0) &&
+           (samRecord.get0BasedPosition() == -1))
+        {
+            // Unplaced records go before the placed ones.
+            assert((prevRefID != samRecord.getReferenceID()) ||
+                   (prevPos == -1));
+            ++numUnplaced;
+        }
+        prevName = samRecord.getReadName();
+        prevRefID = samRecord.getReferenceID();
+        prevPos = samRecord.get0BasedPosition();
+    }
+    assert(numUnplaced > 0);
+    // Records without a reference are last.
+    assert(prevRefID == -1);
+}
+
+
+void SamSorterTest::testQueryName(const char* filename, int numRecords)
+{
+    SamSorter sorter(SamFile::QUERY_NAME);
+    sorter.setMaxMemory(500000);
+    sorter.setNumThreads(2);
+    assert(sorter.sort(filename, "results/sortedName.sam"));
+    assert(sorter.getNumRuns() > 1);
+    std::vector<std::string> readNames;
+    readSorted("results/sortedName.sam", true, readNames);
+    assert((int)readNames.size() == numRecords);
+    // The names are unique, so the file is the names in order.
+    char readName[32];
+    for(int i = 0; i < numRecords; i++)
+    {
+        snprintf(readName, sizeof(readName), "read%06d", i + 1);
+        assert(readNames[i] == readName);
+    }
+
+    SamFile samFile;
+    SamFileHeader samHeader;
+    assert(samFile.OpenForRead("results/sortedName.sam", &samHeader));
+    assert(strcmp(samHeader.getSortOrder(), "queryname") == 0);
+}
+
+
+void SamSorterTest::testManyRuns()
+{
+    // One record per run, more runs than can be merged at once.
+#ifdef __ZLIB_AVAILABLE__
+    const char* filename = "results/unsortedSmall.bam";
+#else
+    const char* filename = "results/unsortedSmall.sam";
+#endif
+    writeFile(filename, 600);
+    SamSorter sorter(SamFile::COORDINATE);
+    sorter.setMaxMemory(1);
+    sorter.setTempPrefix("results/sortTemp");
+    assert(sorter.sort(filename, "results/sortedSmall.sam"));
+    assert(sorter.getNumRuns() > 600);
+
+    SamSorter expectedSorter(SamFile::COORDINATE);
+    assert(expectedSorter.sort(filename, "results/sortedSmallExpected.sam"));
+    std::vector<std::string> readNames;
+    std::vector<std::string> expected;
+    readSorted("results/sortedSmall.sam", false, readNames);
+    readSorted("results/sortedSmallExpected.sam", false, expected);
+    assert(readNames.size() == 600);
+    assert(readNames == expected);
+}
+
+
+void SamSorterTest::testFailure()
+{
+    SamSorter sorter(SamFile::COORDINATE);
+    assert(!sorter.sort("results/missingSort.bam", "results/missingOut.bam"));
+    assert(sorter.getStatus() == SamStatus::FAIL_IO);
+
+    // Failing to write the temporary files.
+#ifdef __ZLIB_AVAILABLE__
+    sorter.setMaxMemory(100000);
+    sorter.setTempPrefix("results/missingDir/sortTemp");
+    assert(!sorter.sort("results/unsorted.bam", "results/sortFailed.bam"));
+    assert(sorter.getStatus() == SamStatus::FAIL_IO);
+#endif
+}
+
+
+void SamSorterTest::readSorted(const char* filename, bool byName,
+                               std::vector<std::string>& readNames)
+{
+    readNames.clear();
+    SamFile samFile;
+    SamFileHeader samHeader;
+    SamRecord samRecord;
+    assert(samFile.OpenForRead(filename, &samHeader));
+    samFile.setSortedValidation(byName ? SamFile::QUERY_NAME :
+                                SamFile::COORDINATE);
+    while(samFile.ReadRecord(samHeader, samRecord))
+    {
+        readNames.push_back(samRecord.getReadName());
+    }
+    assert(samFile.GetStatus() == SamStatus::NO_MORE_RECS);
+}
@@ -0,0 +1,41 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TEST_SAM_SORTER_H__
+#define __TEST_SAM_SORTER_H__
+
+#include <string>
+#include <vector>
+
+void testSamSorter();
+
+class SamSorterTest
+{
+public:
+    static void writeFile(const char* filename, int numRecords);
+    static void testCoordinate(const char* filename, int numRecords);
+    static void testQueryName(const char* filename, int numRecords);
+    static void testManyRuns();
+    static void testFailure();
+
+private:
+    // Read the file checking it is sorted, returning the read names.
+    static void readSorted(const char* filename, bool byName,
+                           std::vector<std::string>& readNames);
+};
+
+#endif
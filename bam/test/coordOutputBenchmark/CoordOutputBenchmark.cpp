@@ -0,0 +1,142 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compare the speed of SamCoordOutput buffering nearly sorted records in
+// its sorted tree and in bucket windows of different sizes, in records
+// per second.  No output file is set, so the records are released
+// without being written and only the buffering is timed.
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include "SamCoordOutput.h"
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start)
+{
+    return(std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start).count());
+}
+
+
+// Add numRecords records, each shifted up to jitter positions from
+// sorted order (outlierRate percent of them shifted 100 times that),
+// flushing every 1000 records up to the positions that can no longer
+// be added.
+static void benchmark(uint32_t windowSize, int numRecords, int jitter,
+                      int outlierRate, SamFileHeader& header)
+{
+    SamRecordPool pool(-1);
+    SamCoordOutput outputBuffer(pool);
+    outputBuffer.setBucketWindow(windowSize);
+
+    // Generate the positions up front so they are the same each run.
+    std::vector<int32_t> positions(numRecords);
+    srand(1);
+    for(int i = 0; i < numRecords; i++)
+    {
+        int32_t shift = (rand() % (2 * jitter + 1)) - jitter;
+        if(rand() % 100 < outlierRate)
+        {
+            shift *= 100;
+        }
+        positions[i] = i + 100 * jitter + shift;
+    }
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for(int i = 0; i < numRecords; i++)
+    {
+        SamRecord* record = pool.getRecord();
+        record->setReferenceName(header, "1");
+        record->set0BasedPosition(positions[i]);
+        outputBuffer.add(record);
+        if((i % 1000 == 0) && (i >= 100 * jitter))
+        {
+            outputBuffer.flush(0, i - 100 * jitter);
+        }
+    }
+    outputBuffer.flushAll();
+    double seconds = elapsedSeconds(start);
+
+    std::cout << std::setw(10) << windowSize
+              << std::setw(8) << jitter
+              << std::setw(10) << outlierRate
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << numRecords / seconds / 1000000
+              << std::setw(10) << seconds << std::endl;
+}
+
+
+int main(int argc, char** argv)
+{
+    int millions = 10;
+    int jitter = 20;
+    int outlierRate = 1;
+    int opt;
+    while((opt = getopt(argc, argv, "n:j:o:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n':
+                millions = atoi(optarg);
+                break;
+            case 'j':
+                jitter = atoi(optarg);
+                break;
+            case 'o':
+                outlierRate = atoi(optarg);
+                break;
+            default:
+                std::cerr << "Usage: " << argv[0]
+                          << " [-n millions of records] [-j jitter]"
+                          << " [-o outlier percent]\n";
+                return(1);
+        }
+    }
+    if(jitter < 1)
+    {
+        jitter = 1;
+    }
+
+    SamFileHeader header;
+    header.addHeaderLine("@SQ\tSN:1\tLN:2000000000");
+
+    // Flushing without an output file warns each time, so discard it.
+    std::ostringstream discard;
+    std::streambuf* origCerr = std::cerr.rdbuf(discard.rdbuf());
+
+    std::cout << std::setw(10) << "window"
+              << std::setw(8) << "jitter"
+              << std::setw(10) << "outlier%"
+              << std::setw(12) << "Mrecs/s"
+              << std::setw(10) << "seconds" << std::endl;
+
+    uint32_t windowSizes[] = {0, 1024, 4096, 65536};
+    for(unsigned int i = 0; i < sizeof(windowSizes) / sizeof(uint32_t); i++)
+    {
+        benchmark(windowSizes[i], millions * 1000000, jitter, outlierRate,
+                  header);
+        discard.str("");
+    }
+
+    std::cerr.rdbuf(origCerr);
+    return(0);
+}
@@ -0,0 +1,166 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compare the speed of adding records to a pileup a position at a time
+// and record-major (Pileup::setRecordMajor), for the base/quality element
+// types, in millions of pileup entries per second.  The records are
+// generated in memory and the elements are not printed, so only the
+// pileup is timed.
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "Pileup.h"
+#include "PileupElementBaseQual.h"
+#include "PileupElementPooled.h"
+
+static const int READ_LENGTH = 100;
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start)
+{
+    return(std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start).count());
+}
+
+
+// Analyze function that does nothing, so only the pileup is timed.
+template <class PILEUP_TYPE>
+class SkipAnalyze
+{
+public:
+    bool operator() (PILEUP_TYPE& element)
+    {
+        return(true);
+    }
+};
+
+
+// Add numRecords records spaced so each position is covered by about
+// depth reads, cycling through the records' CIGARs.
+template <class PILEUP_TYPE>
+static void benchmark(const char* typeName, bool recordMajor,
+                      std::vector<SamRecord*>& records, int numRecords,
+                      int depth)
+{
+    Pileup<PILEUP_TYPE, SkipAnalyze<PILEUP_TYPE> > pileup;
+    pileup.setRecordMajor(recordMajor);
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    uint64_t numEntries = 0;
+    for(int i = 0; i < numRecords; i++)
+    {
+        SamRecord* record = records[i % records.size()];
+        record->set0BasedPosition((int64_t)i * READ_LENGTH / depth);
+        pileup.processAlignment(*record);
+        numEntries += record->get0BasedAlignmentEnd() -
+            record->get0BasedPosition() + 1;
+    }
+    pileup.flushPileup();
+    double seconds = elapsedSeconds(start);
+
+    std::cout << std::setw(12) << typeName
+              << std::setw(14) << (recordMajor ? "record-major" : "position")
+              << std::setw(8) << depth
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << numEntries / seconds / 1000000
+              << std::setw(10) << seconds << std::endl;
+}
+
+
+int main(int argc, char** argv)
+{
+    double millions = 1;
+    int depth = 500;
+    int opt;
+    while((opt = getopt(argc, argv, "n:d:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n':
+                millions = atof(optarg);
+                break;
+            case 'd':
+                depth = atoi(optarg);
+                break;
+            default:
+                std::cerr << "Usage: " << argv[0]
+                          << " [-n millions of records] [-d depth]\n";
+                return(1);
+        }
+    }
+    if(depth < 1)
+    {
+        depth = 1;
+    }
+    int numRecords = (int)(millions * 1000000);
+
+    SamFileHeader header;
+    header.addHeaderLine("@SQ\tSN:1\tLN:2000000000");
+
+    // Mostly full matches, with some clipped reads and indels.
+    const char* cigars[] = {"100M", "100M", "100M", "100M", "5S95M",
+                            "40M2I58M", "60M3D40M", "90M10S"};
+    int numCigars = sizeof(cigars) / sizeof(const char*);
+    std::vector<SamRecord*> records;
+    std::string sequence(READ_LENGTH, 'A');
+    std::string quality(READ_LENGTH, 'I');
+    const char bases[] = "ACGT";
+    srand(1);
+    for(int i = 0; i < 64; i++)
+    {
+        for(int j = 0; j < READ_LENGTH; j++)
+        {
+            sequence[j] = bases[rand() & 3];
+            quality[j] = '!' + (rand() % 40);
+        }
+        SamRecord* record = new SamRecord();
+        record->setReadName("read");
+        record->setFlag((i & 1) ? 16 : 0);
+        record->setReferenceName(header, "1");
+        record->setMapQuality(60);
+        record->setCigar(cigars[i % numCigars]);
+        record->setSequence(sequence.c_str());
+        record->setQuality(quality.c_str());
+        records.push_back(record);
+    }
+
+    std::cout << std::setw(12) << "element"
+              << std::setw(14) << "mode"
+              << std::setw(8) << "depth"
+              << std::setw(12) << "Mentries/s"
+              << std::setw(10) << "seconds" << std::endl;
+
+    benchmark<PileupElementBaseQual>("BaseQual", false, records, numRecords,
+                                     depth);
+    benchmark<PileupElementBaseQual>("BaseQual", true, records, numRecords,
+                                     depth);
+    benchmark<PileupElementPooled>("Pooled", false, records, numRecords,
+                                   depth);
+    benchmark<PileupElementPooled>("Pooled", true, records, numRecords,
+                                   depth);
+
+    for(unsigned int i = 0; i < records.size(); i++)
+    {
+        delete records[i];
+    }
+    return(0);
+}
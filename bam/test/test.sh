@@ -17,7 +17,10 @@ diff $expected/addedTagToSam.bam results/addedTagToSam.bam && \
 diff $expected/addedTagToSam.sam results/addedTagToSam.sam && \
 diff $expected/testShift.sam results/testShift.sam && \
 diff $expected/testShift.bam results/testShiftFromSam.bam && \
-diff $expected/TestSamCoordOutput.sam results/TestSamCoordOutput.sam
+diff $expected/testShift.sam results/testShiftPipeline.sam && \
+diff $expected/testShift.bam results/testShiftPipeline.bam && \
+diff $expected/TestSamCoordOutput.sam results/TestSamCoordOutput.sam && \
+diff $expected/TestSamCoordOutput.sam results/TestSamCoordOutputBuckets.sam
 else
 ./samTest 2> results/samTest.log && \
 diff $expected/testEqWithBases.sam results/outSamEqBases.sam && \
@@ -41,9 +44,15 @@ diff $expected/addedTagToSam.bam results/addedTagToSam.bam && \
 diff $expected/addedTagToSam.sam results/addedTagToSam.sam && \
 diff $expected/addedTagToBam.sam results/addedTagToBam.sam && \
 diff $expected/addedTagToBam.bam results/addedTagToBam.bam && \
+diff $expected/addedTagToBam.bam results/addedTagToBamThreaded.bam && \
 diff $expected/testShift.sam results/testShift.sam && \
 diff $expected/testShift.bam results/testShift.bam && \
 diff $expected/testShift.sam results/testShiftFromBam.sam && \
 diff $expected/testShift.bam results/testShiftFromSam.bam && \
-diff $expected/TestSamCoordOutput.sam results/TestSamCoordOutput.sam
+diff $expected/testShift.sam results/testShiftPipeline.sam && \
+diff $expected/testShift.bam results/testShiftPipeline.bam && \
+diff testFiles/sortedBam.bam.bai results/indexOnWrite.bam.bai && \
+diff testFiles/sortedBam.bam.bai results/indexOnWriteThreaded.bam.bai && \
+diff $expected/TestSamCoordOutput.sam results/TestSamCoordOutput.sam && \
+diff $expected/TestSamCoordOutput.sam results/TestSamCoordOutputBuckets.sam
 fi
\ No newline at end of file
@@ -0,0 +1,644 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BasePacking.h"
+#include "BaseUtilities.h"
+
+// The SIMD versions are compiled with per function target attributes, so
+// no special compiler flags are needed and the version is picked at runtime.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BASE_PACKING_X86
+#include <immintrin.h>
+#endif
+
+// BAM base codes, indexed by the 4-bit code.
+static const char* ourAsciiBases = "=AC.G...T......N";
+
+// 4-bit code of each character, 0xFF for characters that are not bases.
+struct BasePackTable
+{
+    BasePackTable()
+    {
+        for(int i = 0; i < 256; i++)
+        {
+            codes[i] = 0xFF;
+        }
+        codes[(unsigned char)'='] = 0;
+        codes[(unsigned char)'A'] = codes[(unsigned char)'a'] = 1;
+        codes[(unsigned char)'C'] = codes[(unsigned char)'c'] = 2;
+        codes[(unsigned char)'G'] = codes[(unsigned char)'g'] = 4;
+        codes[(unsigned char)'T'] = codes[(unsigned char)'t'] = 8;
+        codes[(unsigned char)'N'] = codes[(unsigned char)'n'] = 15;
+        codes[(unsigned char)'.'] = 15;
+    }
+    uint8_t codes[256];
+};
+
+static const uint8_t* getPackTable()
+{
+    static const BasePackTable ourPackTable;
+    return(ourPackTable.codes);
+}
+
+
+////////////////////////////////////////////////////////////////////////
+// Scalar versions, also used for the ends that don't fill a SIMD register.
+
+static bool packSequenceScalar(const char* bases, int length, uint8_t* packed)
+{
+    const uint8_t* packTable = getPackTable();
+    bool valid = true;
+    for(int i = 0; i < length; i++)
+    {
+        uint8_t code = packTable[(unsigned char)bases[i]];
+        if(code == 0xFF)
+        {
+            valid = false;
+            code = 0;
+        }
+        if(i & 1)
+        {
+            // Odd number i's go in the lower 4 bits.
+            packed[i/2] |= code;
+        }
+        else
+        {
+            // Even i's go in the upper 4 bits and are always set first.
+            packed[i/2] = code << 4;
+        }
+    }
+    return(valid);
+}
+
+
+static void unpackSequenceScalar(const uint8_t* packed, int length,
+                                 char* bases)
+{
+    for(int i = 0; i < length; i++)
+    {
+        bases[i] = i & 1 ?
+            ourAsciiBases[packed[i / 2] & 0xF] :
+            ourAsciiBases[packed[i / 2] >> 4];
+    }
+}
+
+
+static void packQualityScalar(const char* quality, int length,
+                              uint8_t* packed)
+{
+    for(int i = 0; i < length; i++)
+    {
+        packed[i] = quality[i] - 33;
+    }
+}
+
+
+static bool unpackQualityScalar(const uint8_t* packed, int length,
+                                char* quality)
+{
+    bool qualitySpecified = false;
+    for(int i = 0; i < length; i++)
+    {
+        if(packed[i] != 0xFF)
+        {
+            qualitySpecified = true;
+        }
+        quality[i] = packed[i] + 33;
+    }
+    return(qualitySpecified);
+}
+
+
+static void seqWithEqualsScalar(const char* read, const char* ref, int length,
+                                char* result)
+{
+    for(int i = 0; i < length; i++)
+    {
+        if(!BaseUtilities::isAmbiguous(read[i]) &&
+           !BaseUtilities::isAmbiguous(ref[i]) &&
+           (BaseUtilities::areEqual(read[i], ref[i])))
+        {
+            result[i] = '=';
+        }
+        else
+        {
+            result[i] = read[i];
+        }
+    }
+}
+
+
+static void seqWithoutEqualsScalar(const char* read, const char* ref,
+                                   int length, char* result)
+{
+    for(int i = 0; i < length; i++)
+    {
+        result[i] = BaseUtilities::areEqual(read[i], ref[i]) ? ref[i] : read[i];
+    }
+}
+
+
+#ifdef BASE_PACKING_X86
+////////////////////////////////////////////////////////////////////////
+// SSE4.1 versions, 16 bases at a time.
+//
+// Bases are packed by looking up the code from the low 4 bits of the
+// character and checking that the high 4 bits are valid for those low bits:
+//   '.' 0x2E, '=' 0x3D, A/a 0x41/0x61, C/c 0x43/0x63, G/g 0x47/0x67,
+//   N/n 0x4E/0x6E, T/t 0x54/0x74.
+
+// Code for each low nibble.
+#define PACK_CODES 0, 1, 0, 2, 8, 0, 0, 4, 0, 0, 0, 0, 0, 0, 15, 0
+// Bit for each high nibble: 2 -> 0x1, 3 -> 0x2, ... 7 -> 0x20.
+#define PACK_HIGH_BITS 0, 0, 0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0, 0, 0, 0, 0, 0, 0, 0
+// High nibble bits that are valid for each low nibble.
+#define PACK_VALID_HIGH 0, 0x14, 0, 0x14, 0x28, 0, 0, 0x14, 0, 0, 0, 0, 0, 0x2, 0x15, 0
+#define ASCII_BASES '=', 'A', 'C', '.', 'G', '.', '.', '.', 'T', '.', '.', '.', '.', '.', '.', 'N'
+
+__attribute__((target("sse4.1")))
+static bool packSequenceSse4(const char* bases, int length, uint8_t* packed)
+{
+    const __m128i codes = _mm_setr_epi8(PACK_CODES);
+    const __m128i highBits = _mm_setr_epi8(PACK_HIGH_BITS);
+    const __m128i validHigh = _mm_setr_epi8(PACK_VALID_HIGH);
+    const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    // Multiplies the first of each pair by 16 and the second by 1.
+    const __m128i pairWeights = _mm_set1_epi16(0x0110);
+
+    __m128i invalid = zero;
+    int i = 0;
+    for(; i + 16 <= length; i += 16)
+    {
+        __m128i chars = _mm_loadu_si128((const __m128i*)(bases + i));
+        __m128i low = _mm_and_si128(chars, nibbleMask);
+        __m128i high = _mm_and_si128(_mm_srli_epi16(chars, 4), nibbleMask);
+        __m128i valid = _mm_and_si128(_mm_shuffle_epi8(validHigh, low),
+                                      _mm_shuffle_epi8(highBits, high));
+        __m128i invalidChars = _mm_cmpeq_epi8(valid, zero);
+        invalid = _mm_or_si128(invalid, invalidChars);
+        __m128i code = _mm_andnot_si128(invalidChars,
+                                        _mm_shuffle_epi8(codes, low));
+        __m128i pairs = _mm_maddubs_epi16(code, pairWeights);
+        _mm_storel_epi64((__m128i*)(packed + i / 2),
+                         _mm_packus_epi16(pairs, pairs));
+    }
+    bool result = packSequenceScalar(bases + i, length - i, packed + i / 2);
+    return(result && (_mm_movemask_epi8(invalid) == 0));
+}
+
+
+__attribute__((target("sse4.1")))
+static void unpackSequenceSse4(const uint8_t* packed, int length, char* bases)
+{
+    const __m128i asciiBases = _mm_setr_epi8(ASCII_BASES);
+    const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+
+    int i = 0;
+    for(; i + 32 <= length; i += 32)
+    {
+        __m128i pairs = _mm_loadu_si128((const __m128i*)(packed + i / 2));
+        __m128i high = _mm_and_si128(_mm_srli_epi16(pairs, 4), nibbleMask);
+        __m128i low = _mm_and_si128(pairs, nibbleMask);
+        __m128i first = _mm_shuffle_epi8(asciiBases, high);
+        __m128i second = _mm_shuffle_epi8(asciiBases, low);
+        _mm_storeu_si128((__m128i*)(bases + i),
+                         _mm_unpacklo_epi8(first, second));
+        _mm_storeu_si128((__m128i*)(bases + i + 16),
+                         _mm_unpackhi_epi8(first, second));
+    }
+    unpackSequenceScalar(packed + i / 2, length - i, bases + i);
+}
+
+
+__attribute__((target("sse4.1")))
+static void packQualitySse4(const char* quality, int length, uint8_t* packed)
+{
+    const __m128i offset = _mm_set1_epi8(33);
+    int i = 0;
+    for(; i + 16 <= length; i += 16)
+    {
+        __m128i qual = _mm_loadu_si128((const __m128i*)(quality + i));
+        _mm_storeu_si128((__m128i*)(packed + i), _mm_sub_epi8(qual, offset));
+    }
+    packQualityScalar(quality + i, length - i, packed + i);
+}
+
+
+__attribute__((target("sse4.1")))
+static bool unpackQualitySse4(const uint8_t* packed, int length, char* quality)
+{
+    const __m128i offset = _mm_set1_epi8(33);
+    const __m128i noQuality = _mm_set1_epi8((char)0xFF);
+    __m128i allNoQuality = noQuality;
+    int i = 0;
+    for(; i + 16 <= length; i += 16)
+    {
+        __m128i qual = _mm_loadu_si128((const __m128i*)(packed + i));
+        allNoQuality = _mm_and_si128(allNoQuality,
+                                     _mm_cmpeq_epi8(qual, noQuality));
+        _mm_storeu_si128((__m128i*)(quality + i), _mm_add_epi8(qual, offset));
+    }
+    bool qualitySpecified =
+        unpackQualityScalar(packed + i, length - i, quality + i);
+    return(qualitySpecified || (_mm_movemask_epi8(allNoQuality) != 0xFFFF));
+}
+
+
+// Upper case letters, leave everything else alone (toupper in the C locale).
+__attribute__((target("sse4.1")))
+static inline __m128i toUpperSse4(__m128i chars)
+{
+    __m128i isLower =
+        _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('a' - 1)),
+                      _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), chars));
+    return(_mm_sub_epi8(chars, _mm_and_si128(isLower, _mm_set1_epi8(0x20))));
+}
+
+
+// BaseUtilities::areEqual for each pair of bases.
+__attribute__((target("sse4.1")))
+static inline __m128i areEqualSse4(__m128i read, __m128i ref)
+{
+    const __m128i equals = _mm_set1_epi8('=');
+    return(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(read, equals),
+                                     _mm_cmpeq_epi8(ref, equals)),
+                        _mm_cmpeq_epi8(toUpperSse4(read), toUpperSse4(ref))));
+}
+
+
+// BaseUtilities::isAmbiguous for each base.
+__attribute__((target("sse4.1")))
+static inline __m128i isAmbiguousSse4(__m128i bases)
+{
+    return(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bases, _mm_set1_epi8('N')),
+                                     _mm_cmpeq_epi8(bases, _mm_set1_epi8('n'))),
+                        _mm_cmpeq_epi8(bases, _mm_set1_epi8('.'))));
+}
+
+
+__attribute__((target("sse4.1")))
+static void seqWithEqualsSse4(const char* read, const char* ref, int length,
+                              char* result)
+{
+    int i = 0;
+    for(; i + 16 <= length; i += 16)
+    {
+        __m128i readBases = _mm_loadu_si128((const __m128i*)(read + i));
+        __m128i refBases = _mm_loadu_si128((const __m128i*)(ref + i));
+        __m128i match =
+            _mm_andnot_si128(_mm_or_si128(isAmbiguousSse4(readBases),
+                                          isAmbiguousSse4(refBases)),
+                             areEqualSse4(readBases, refBases));
+        _mm_storeu_si128((__m128i*)(result + i),
+                         _mm_blendv_epi8(readBases, _mm_set1_epi8('='), match));
+    }
+    seqWithEqualsScalar(read + i, ref + i, length - i, result + i);
+}
+
+
+__attribute__((target("sse4.1")))
+static void seqWithoutEqualsSse4(const char* read, const char* ref, int length,
+                                 char* result)
+{
+    int i = 0;
+    for(; i + 16 <= length; i += 16)
+    {
+        __m128i readBases = _mm_loadu_si128((const __m128i*)(read + i));
+        __m128i refBases = _mm_loadu_si128((const __m128i*)(ref + i));
+        _mm_storeu_si128((__m128i*)(result + i),
+                         _mm_blendv_epi8(readBases, refBases,
+                                         areEqualSse4(readBases, refBases)));
+    }
+    seqWithoutEqualsScalar(read + i, ref + i, length - i, result + i);
+}
+
+
+////////////////////////////////////////////////////////////////////////
+// AVX2 versions, 32 bases at a time.  The byte shuffles work within each
+// 128 bit lane, so the lookup tables are repeated in both lanes.
+
+__attribute__((target("avx2")))
+static bool packSequenceAvx2(const char* bases, int length, uint8_t* packed)
+{
+    const __m256i codes = _mm256_setr_epi8(PACK_CODES, PACK_CODES);
+    const __m256i highBits = _mm256_setr_epi8(PACK_HIGH_BITS, PACK_HIGH_BITS);
+    const __m256i validHigh =
+        _mm256_setr_epi8(PACK_VALID_HIGH, PACK_VALID_HIGH);
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i pairWeights = _mm256_set1_epi16(0x0110);
+
+    __m256i invalid = zero;
+    int i = 0;
+    for(; i + 32 <= length; i += 32)
+    {
+        __m256i chars = _mm256_loadu_si256((const __m256i*)(bases + i));
+        __m256i low = _mm256_and_si256(chars, nibbleMask);
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(chars, 4), nibbleMask);
+        __m256i valid = _mm256_and_si256(_mm256_shuffle_epi8(validHigh, low),
+                                         _mm256_shuffle_epi8(highBits, high));
+        __m256i invalidChars = _mm256_cmpeq_epi8(valid, zero);
+        invalid = _mm256_or_si256(invalid, invalidChars);
+        __m256i code = _mm256_andnot_si256(invalidChars,
+                                           _mm256_shuffle_epi8(codes, low));
+        __m256i pairs = _mm256_maddubs_epi16(code, pairWeights);
+        // Packing works per lane, so move the 8 bytes from each lane next
+        // to each other.
+        __m256i packedPairs =
+            _mm256_permute4x64_epi64(_mm256_packus_epi16(pairs, pairs), 0xD8);
+        _mm_storeu_si128((__m128i*)(packed + i / 2),
+                         _mm256_castsi256_si128(packedPairs));
+    }
+    bool result = packSequenceSse4(bases + i, length - i, packed + i / 2);
+    return(result && (_mm256_movemask_epi8(invalid) == 0));
+}
+
+
+__attribute__((target("avx2")))
+static void unpackSequenceAvx2(const uint8_t* packed, int length, char* bases)
+{
+    const __m256i asciiBases = _mm256_setr_epi8(ASCII_BASES, ASCII_BASES);
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+
+    int i = 0;
+    for(; i + 64 <= length; i += 64)
+    {
+        __m256i pairs = _mm256_loadu_si256((const __m256i*)(packed + i / 2));
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(pairs, 4), nibbleMask);
+        __m256i low = _mm256_and_si256(pairs, nibbleMask);
+        __m256i first = _mm256_shuffle_epi8(asciiBases, high);
+        __m256i second = _mm256_shuffle_epi8(asciiBases, low);
+        // Interleaving works per lane, so put the lanes back in order.
+        __m256i lo = _mm256_unpacklo_epi8(first, second);
+        __m256i hi = _mm256_unpackhi_epi8(first, second);
+        _mm256_storeu_si256((__m256i*)(bases + i),
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(bases + i + 32),
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    unpackSequenceSse4(packed + i / 2, length - i, bases + i);
+}
+
+
+__attribute__((target("avx2")))
+static void packQualityAvx2(const char* quality, int length, uint8_t* packed)
+{
+    const __m256i offset = _mm256_set1_epi8(33);
+    int i = 0;
+    for(; i + 32 <= length; i += 32)
+    {
+        __m256i qual = _mm256_loadu_si256((const __m256i*)(quality + i));
+        _mm256_storeu_si256((__m256i*)(packed + i),
+                            _mm256_sub_epi8(qual, offset));
+    }
+    packQualitySse4(quality + i, length - i, packed + i);
+}
+
+
+__attribute__((target("avx2")))
+static bool unpackQualityAvx2(const uint8_t* packed, int length, char* quality)
+{
+    const __m256i offset = _mm256_set1_epi8(33);
+    const __m256i noQuality = _mm256_set1_epi8((char)0xFF);
+    __m256i allNoQuality = noQuality;
+    int i = 0;
+    for(; i + 32 <= length; i += 32)
+    {
+        __m256i qual = _mm256_loadu_si256((const __m256i*)(packed + i));
+        allNoQuality = _mm256_and_si256(allNoQuality,
+                                        _mm256_cmpeq_epi8(qual, noQuality));
+        _mm256_storeu_si256((__m256i*)(quality + i),
+                            _mm256_add_epi8(qual, offset));
+    }
+    bool qualitySpecified =
+        unpackQualitySse4(packed + i, length - i, quality + i);
+    return(qualitySpecified || (_mm256_movemask_epi8(allNoQuality) != -1));
+}
+
+
+__attribute__((target("avx2")))
+static inline __m256i toUpperAvx2(__m256i chars)
+{
+    __m256i isLower =
+        _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('a' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), chars));
+    return(_mm256_sub_epi8(chars,
+                           _mm256_and_si256(isLower, _mm256_set1_epi8(0x20))));
+}
+
+
+__attribute__((target("avx2")))
+static inline __m256i areEqualAvx2(__m256i read, __m256i ref)
+{
+    const __m256i equals = _mm256_set1_epi8('=');
+    return(_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(read, equals),
+                                           _mm256_cmpeq_epi8(ref, equals)),
+                           _mm256_cmpeq_epi8(toUpperAvx2(read),
+                                             toUpperAvx2(ref))));
+}
+
+
+__attribute__((target("avx2")))
+static inline __m256i isAmbiguousAvx2(__m256i bases)
+{
+    return(_mm256_or_si256(
+               _mm256_or_si256(_mm256_cmpeq_epi8(bases, _mm256_set1_epi8('N')),
+                               _mm256_cmpeq_epi8(bases, _mm256_set1_epi8('n'))),
+               _mm256_cmpeq_epi8(bases, _mm256_set1_epi8('.'))));
+}
+
+
+__attribute__((target("avx2")))
+static void seqWithEqualsAvx2(const char* read, const char* ref, int length,
+                              char* result)
+{
+    int i = 0;
+    for(; i + 32 <= length; i += 32)
+    {
+        __m256i readBases = _mm256_loadu_si256((const __m256i*)(read + i));
+        __m256i refBases = _mm256_loadu_si256((const __m256i*)(ref + i));
+        __m256i match =
+            _mm256_andnot_si256(_mm256_or_si256(isAmbiguousAvx2(readBases),
+                                                isAmbiguousAvx2(refBases)),
+                                areEqualAvx2(readBases, refBases));
+        _mm256_storeu_si256((__m256i*)(result + i),
+                            _mm256_blendv_epi8(readBases,
+                                               _mm256_set1_epi8('='), match));
+    }
+    seqWithEqualsSse4(read + i, ref + i, length - i, result + i);
+}
+
+
+__attribute__((target("avx2")))
+static void seqWithoutEqualsAvx2(const char* read, const char* ref, int length,
+                                 char* result)
+{
+    int i = 0;
+    for(; i + 32 <= length; i += 32)
+    {
+        __m256i readBases = _mm256_loadu_si256((const __m256i*)(read + i));
+        __m256i refBases = _mm256_loadu_si256((const __m256i*)(ref + i));
+        _mm256_storeu_si256((__m256i*)(result + i),
+                            _mm256_blendv_epi8(readBases, refBases,
+                                               areEqualAvx2(readBases,
+                                                            refBases)));
+    }
+    seqWithoutEqualsSse4(read + i, ref + i, length - i, result + i);
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////
+// Runtime selection.
+
+struct BasePackingKernels
+{
+    BasePacking::SimdLevel level;
+    bool (*packSequence)(const char*, int, uint8_t*);
+    void (*unpackSequence)(const uint8_t*, int, char*);
+    void (*packQuality)(const char*, int, uint8_t*);
+    bool (*unpackQuality)(const uint8_t*, int, char*);
+    void (*seqWithEquals)(const char*, const char*, int, char*);
+    void (*seqWithoutEquals)(const char*, const char*, int, char*);
+};
+
+static const BasePackingKernels ourScalarKernels =
+{
+    BasePacking::SCALAR, packSequenceScalar, unpackSequenceScalar,
+    packQualityScalar, unpackQualityScalar, seqWithEqualsScalar,
+    seqWithoutEqualsScalar
+};
+
+#ifdef BASE_PACKING_X86
+static const BasePackingKernels ourSse4Kernels =
+{
+    BasePacking::SSE4, packSequenceSse4, unpackSequenceSse4,
+    packQualitySse4, unpackQualitySse4, seqWithEqualsSse4,
+    seqWithoutEqualsSse4
+};
+
+static const BasePackingKernels ourAvx2Kernels =
+{
+    BasePacking::AVX2, packSequenceAvx2, unpackSequenceAvx2,
+    packQualityAvx2, unpackQualityAvx2, seqWithEqualsAvx2,
+    seqWithoutEqualsAvx2
+};
+#endif
+
+// Kernels being used, selected on first use.
+static const BasePackingKernels* ourKernels = NULL;
+
+static const BasePackingKernels* getKernels(BasePacking::SimdLevel level)
+{
+#ifdef BASE_PACKING_X86
+    if(level == BasePacking::AVX2)
+    {
+        return(&ourAvx2Kernels);
+    }
+    if(level == BasePacking::SSE4)
+    {
+        return(&ourSse4Kernels);
+    }
+#endif
+    return(&ourScalarKernels);
+}
+
+
+static inline const BasePackingKernels* kernels()
+{
+    if(ourKernels == NULL)
+    {
+        ourKernels = getKernels(BasePacking::getMaxSimdLevel());
+    }
+    return(ourKernels);
+}
+
+
+BasePacking::SimdLevel BasePacking::getSimdLevel()
+{
+    return(kernels()->level);
+}
+
+
+BasePacking::SimdLevel BasePacking::getMaxSimdLevel()
+{
+#ifdef BASE_PACKING_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return(AVX2);
+    }
+    if(__builtin_cpu_supports("sse4.1"))
+    {
+        return(SSE4);
+    }
+#endif
+    return(SCALAR);
+}
+
+
+bool BasePacking::setSimdLevel(SimdLevel level)
+{
+    if(level > getMaxSimdLevel())
+    {
+        return(false);
+    }
+    kernels();
+    ourKernels = getKernels(level);
+    return(true);
+}
+
+
+bool BasePacking::packSequence(const char* bases, int length, uint8_t* packed)
+{
+    return(kernels()->packSequence(bases, length, packed));
+}
+
+
+void BasePacking::unpackSequence(const uint8_t* packed, int length,
+                                 char* bases)
+{
+    kernels()->unpackSequence(packed, length, bases);
+}
+
+
+void BasePacking::packQuality(const char* quality, int length, uint8_t* packed)
+{
+    kernels()->packQuality(quality, length, packed);
+}
+
+
+bool BasePacking::unpackQuality(const uint8_t* packed, int length,
+                                char* quality)
+{
+    return(kernels()->unpackQuality(packed, length, quality));
+}
+
+
+void BasePacking::seqWithEquals(const char* read, const char* ref, int length,
+                                char* result)
+{
+    kernels()->seqWithEquals(read, ref, length, result);
+}
+
+
+void BasePacking::seqWithoutEquals(const char* read, const char* ref,
+                                   int length, char* result)
+{
+    kernels()->seqWithoutEquals(read, ref, length, result);
+}
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BASE_PACKING_H__
+#define __BASE_PACKING_H__
+
+#include <stdint.h>
+
+/// Conversions between ASCII bases/qualities and their packed BAM forms
+/// (4 bits per base, phred qualities without the +33 offset), and the
+/// comparison of read bases against reference bases used for '='
+/// translation.
+///
+/// On x86, SSE4.1 or AVX2 versions are used when the processor supports
+/// them, otherwise (or on other processors) the scalar versions are used.
+/// All versions produce the same results.
+class BasePacking
+{
+public:
+    /// Instruction sets the conversions can be done with.
+    enum SimdLevel {SCALAR = 0, SSE4 = 1, AVX2 = 2};
+
+    /// Returns the instruction set currently being used.
+    static SimdLevel getSimdLevel();
+
+    /// Returns the best instruction set supported by this processor.
+    static SimdLevel getMaxSimdLevel();
+
+    /// Use the specified instruction set, mainly for testing and
+    /// benchmarking.  Returns false and leaves it unchanged if the
+    /// processor does not support it.  Not thread safe.
+    static bool setSimdLevel(SimdLevel level);
+
+    /// Pack length bases (=ACGTN. in either case) into (length+1)/2 bytes,
+    /// the first base of each pair in the high 4 bits.  Other characters
+    /// are packed as '=' (0).
+    /// \return false if any other characters were found.
+    static bool packSequence(const char* bases, int length, uint8_t* packed);
+
+    /// Unpack length bases from their 4-bit packed form.
+    static void unpackSequence(const uint8_t* packed, int length, char* bases);
+
+    /// Convert length quality characters to phred values (subtract 33).
+    static void packQuality(const char* quality, int length, uint8_t* packed);
+
+    /// Convert length phred values to quality characters (add 33).
+    /// \return false if all values were 0xFF (no quality), true otherwise.
+    static bool unpackQuality(const uint8_t* packed, int length, char* quality);
+
+    /// Set each read base that matches the reference base at the same index
+    /// to '=', see SamQuerySeqWithRef::seqWithEquals for the rules.
+    static void seqWithEquals(const char* read, const char* ref, int length,
+                              char* result);
+
+    /// Set each read base that matches the reference base at the same
+    /// index (including '=') to the reference base, see
+    /// SamQuerySeqWithRef::seqWithoutEquals for the rules.
+    static void seqWithoutEquals(const char* read, const char* ref,
+                                 int length, char* result);
+};
+
+#endif
@@ -76,4 +76,11 @@ void BgzfFileType::setRequireEofBlock(bool requireEofBlock)
     ourRequireEofBlock = requireEofBlock;
 }
 
+
+// Set the codec used for all bgzf files.
+bool BgzfFileType::setCodec(int codec)
+{
+    return(bgzf_set_codec(codec) == 0);
+}
+
 #endif
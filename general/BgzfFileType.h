@@ -156,10 +156,53 @@ public:
         return true;
     }
 
+    // Set the number of worker threads used to decompress the blocks that
+    // follow the current read position, or to compress the blocks being
+    // written.  Blocks are still read/written in order and tell/seek are
+    // unaffected when reading.  0 turns off the worker threads.
+    // Returns true on success, false if threads are not supported.
+    virtual inline bool setNumThreads(int numThreads)
+    {
+        return(bgzf_mt(bgzfHandle, numThreads) == 0);
+    }
+
+    // Keep track of the blocks written from now on, so positions from
+    // tellUncompressed can be converted to tell positions.  Unlike tell,
+    // this works while blocks are still being compressed by worker threads.
+    virtual inline bool trackWrittenBlocks()
+    {
+        return(bgzf_log_blocks(bgzfHandle) == 0);
+    }
+
+    // Get the number of uncompressed bytes written so far.
+    virtual inline int64_t tellUncompressed()
+    {
+        return(bgzf_utell(bgzfHandle));
+    }
+
+    // Convert a position from tellUncompressed to a tell position,
+    // flushing the data if its block has not been written yet.
+    virtual inline int64_t getTellOffset(int64_t uncompressedOffset)
+    {
+        int64_t offset = bgzf_virtual_offset(bgzfHandle, uncompressedOffset);
+        if((offset == -1) && (bgzf_flush(bgzfHandle) == 0))
+        {
+            offset = bgzf_virtual_offset(bgzfHandle, uncompressedOffset);
+        }
+        return(offset);
+    }
+
     // Set whether or not to require the EOF block at the end of the
     // file.  True - require the block.  False - do not require the block.
     static void setRequireEofBlock(bool requireEofBlock);
 
+    // Set the codec used to compress/decompress the blocks of all bgzf
+    // files: BGZF_CODEC_ZLIB or BGZF_CODEC_LIBDEFLATE.  libdeflate is only
+    // available (and is the default) when built with
+    // DEFLATE_BACKEND=libdeflate.  Returns false if the codec is not
+    // available.
+    static bool setCodec(int codec);
+
 protected:
     // A bgzfFile is used.
     BGZF* bgzfHandle;
@@ -0,0 +1,306 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CsiIndex.h"
+#include <stdexcept>
+#include <string.h>
+#include "StringBasics.h"
+
+CsiIndex::CsiIndex()
+    : IndexBase(),
+      myMinShift(0),
+      myDepth(0),
+      myLoffsets(),
+      myRefNames()
+{
+}
+
+
+CsiIndex::~CsiIndex()
+{
+}
+
+
+// Reset the member data for a new index file.
+void CsiIndex::resetIndex()
+{
+    IndexBase::resetIndex();
+    myMinShift = 0;
+    myDepth = 0;
+    myLoffsets.clear();
+    myRefNames.clear();
+}
+
+
+// Read & parse the specified index file.
+StatGenStatus::Status CsiIndex::readIndex(const char* filename)
+{
+    // Reset the index from anything that may previously be set.
+    resetIndex();
+
+    IFILE indexFile = ifopen(filename, "rb");
+
+    // Failed to open the index file.
+    if(indexFile == NULL)
+    {
+        return(StatGenStatus::FAIL_IO);
+    }
+
+    // Read the magic string.
+    char magic[4];
+    if(ifread(indexFile, magic, 4) != 4)
+    {
+        // Failed to read the magic
+        ifclose(indexFile);
+        return(StatGenStatus::FAIL_IO);
+    }
+
+    if (magic[0] != 'C' || magic[1] != 'S' || magic[2] != 'I' || magic[3] != 1)
+    {
+        // Not a CSI Index file.
+        ifclose(indexFile);
+        return(StatGenStatus::FAIL_PARSE);
+    }
+
+    // Read the binning scheme and the auxiliary data.
+    int32_t l_aux = 0;
+    if((ifread(indexFile, &myMinShift, 4) != 4) ||
+       (ifread(indexFile, &myDepth, 4) != 4) ||
+       (ifread(indexFile, &l_aux, 4) != 4))
+    {
+        ifclose(indexFile);
+        return(StatGenStatus::FAIL_IO);
+    }
+    if((myMinShift <= 0) || (myDepth < 0) || (myDepth > MAX_DEPTH) ||
+       ((myMinShift + 3 * myDepth) > 62) || (l_aux < 0))
+    {
+        ifclose(indexFile);
+        return(StatGenStatus::FAIL_PARSE);
+    }
+    std::vector<char> aux(l_aux + 1, '\0');
+    if((l_aux != 0) &&
+       (ifread(indexFile, &(aux[0]), l_aux) != (unsigned int)l_aux))
+    {
+        ifclose(indexFile);
+        return(StatGenStatus::FAIL_IO);
+    }
+
+    // Tabix style auxiliary data is the tabix format configuration (6
+    // int32_t) followed by the length of the names and the names, each
+    // null terminated.
+    static const int32_t TABIX_CONF_SIZE = 28;
+    if(l_aux >= TABIX_CONF_SIZE)
+    {
+        int32_t l_nm = 0;
+        memcpy(&l_nm, &(aux[TABIX_CONF_SIZE - 4]), 4);
+        if((l_nm >= 0) && (l_nm <= l_aux - TABIX_CONF_SIZE))
+        {
+            const char* name = &(aux[TABIX_CONF_SIZE]);
+            const char* namesEnd = name + l_nm;
+            while(name < namesEnd)
+            {
+                myRefNames.push_back(name);
+                name += strlen(name) + 1;
+            }
+        }
+    }
+
+    // Read the number of reference sequences.
+    if(ifread(indexFile, &n_ref, 4) != 4)
+    {
+        // Failed to read.
+        ifclose(indexFile);
+        return(StatGenStatus::FAIL_IO);
+    }
+
+    // Size the references.
+    myRefs.resize(n_ref);
+    myLoffsets.resize(n_ref);
+
+    for(int refIndex = 0; refIndex < n_ref; refIndex++)
+    {
+        // Read each reference.
+        Reference* ref = &(myRefs[refIndex]);
+        
+        // Read the number of bins.
+        if(ifread(indexFile, &(ref->n_bin), 4) != 4)
+        {
+            // Failed to read the number of bins.
+            ifclose(indexFile);
+            return(StatGenStatus::FAIL_PARSE);
+        }
+
+        // Resize the bins.
+        ref->bins.resize(ref->n_bin);
+        myLoffsets[refIndex].resize(ref->n_bin);
+        
+        // Read each bin.
+        for(int binIndex = 0; binIndex < ref->n_bin; binIndex++)
+        {
+            Bin* binPtr = &(ref->bins[binIndex]);
+
+            // Read the bin number, the offset of the first record
+            // overlapping the bin and the number of chunks.
+            if((ifread(indexFile, &(binPtr->bin), 4) != 4) ||
+               (ifread(indexFile, &(myLoffsets[refIndex][binIndex]), 8) != 8) ||
+               (ifread(indexFile, &(binPtr->n_chunk), 4) != 4))
+            {
+                ifclose(indexFile);
+                return(StatGenStatus::FAIL_IO);
+            }
+
+            // Read in the chunks.
+            uint32_t sizeOfChunkList = binPtr->n_chunk * sizeof(Chunk);
+            binPtr->chunks = (Chunk*)malloc(sizeOfChunkList);
+            if(ifread(indexFile, binPtr->chunks, sizeOfChunkList) != sizeOfChunkList)
+            {
+                // Failed to read the chunks.
+                ifclose(indexFile);
+                return(StatGenStatus::FAIL_IO);
+            }
+        }
+    }
+
+    // The number of records with no coordinate may follow, but is not used.
+    ifclose(indexFile);
+
+    // Successfully read the csi index file.
+    return(StatGenStatus::SUCCESS);
+}
+
+
+bool CsiIndex::getStartPos(int32_t refID, int32_t start,
+                           uint64_t& fileStartPos) const
+{
+    fileStartPos = 0;
+    if((refID < 0) || (refID >= n_ref))
+    {
+        // Out of range of the references.
+        return(false);
+    }
+    const Reference& ref = myRefs[refID];
+    const std::vector<uint64_t>& loffsets = myLoffsets[refID];
+
+    // Convert to a 0-based position.
+    int64_t beg = 0;
+    if(start > 1)
+    {
+        beg = start - 1;
+    }
+
+    // Records before the first record overlapping the smallest bin that
+    // contains the start position end before it, so skip them.
+    uint64_t minOffset = 0;
+    int64_t minOffsetBinSize = -1;
+    int64_t binStart = 0;
+    int64_t binEnd = 0;
+    for(int binIndex = 0; binIndex < ref.n_bin; binIndex++)
+    {
+        if(getBinRange(ref.bins[binIndex].bin, binStart, binEnd) &&
+           (binStart <= beg) && (beg < binEnd) &&
+           ((minOffsetBinSize == -1) ||
+            ((binEnd - binStart) < minOffsetBinSize)))
+        {
+            minOffset = loffsets[binIndex];
+            minOffsetBinSize = binEnd - binStart;
+        }
+    }
+
+    // Start at the first chunk that ends after that offset in any bin
+    // that ends after the start position.
+    bool found = false;
+    for(int binIndex = 0; binIndex < ref.n_bin; binIndex++)
+    {
+        const Bin& bin = ref.bins[binIndex];
+        if(!getBinRange(bin.bin, binStart, binEnd) || (binEnd <= beg))
+        {
+            // Not a position bin or ends before the start.
+            continue;
+        }
+        for(int chunkIndex = 0; chunkIndex < bin.n_chunk; chunkIndex++)
+        {
+            const Chunk& chunk = bin.chunks[chunkIndex];
+            if(chunk.chunk_end <= minOffset)
+            {
+                continue;
+            }
+            uint64_t chunkStart = chunk.chunk_beg;
+            if(chunkStart < minOffset)
+            {
+                chunkStart = minOffset;
+            }
+            if(!found || (chunkStart < fileStartPos))
+            {
+                fileStartPos = chunkStart;
+                found = true;
+            }
+        }
+    }
+    return(found);
+}
+
+
+bool CsiIndex::getStartPos(const char* refName, int32_t start,
+                           uint64_t& fileStartPos) const
+{
+    // Look for the reference name in the list.
+    for(unsigned int refID = 0; refID < myRefNames.size(); refID++)
+    {
+        if(myRefNames[refID] == refName)
+        {
+            return(getStartPos(refID, start, fileStartPos));
+        }
+    }
+    // Didn't find the refName, so return false.
+    return(false);
+}
+
+
+const char* CsiIndex::getRefName(unsigned int indexNum) const
+{
+    if(indexNum >= myRefNames.size())
+    {
+        String message = "ERROR: Out of range on CsiIndex::getRefName(";
+        message += indexNum;
+        message += ")";
+        throw(std::runtime_error(message.c_str()));
+        return(NULL);
+    }
+    return(myRefNames[indexNum].c_str());
+}
+
+
+bool CsiIndex::getBinRange(uint32_t bin, int64_t& binStart,
+                           int64_t& binEnd) const
+{
+    // Find the level of the bin, then the positions it covers.
+    uint32_t levelOffset = 0;
+    for(int level = 0; level <= myDepth; level++)
+    {
+        uint32_t nextOffset = levelOffset + (1 << (level * 3));
+        if(bin < nextOffset)
+        {
+            int shift = myMinShift + (myDepth - level) * 3;
+            binStart = (int64_t)(bin - levelOffset) << shift;
+            binEnd = binStart + ((int64_t)1 << shift);
+            return(true);
+        }
+        levelOffset = nextOffset;
+    }
+    // The pseudo bin with the mapped/unmapped counts, or invalid.
+    return(false);
+}
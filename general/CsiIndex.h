@@ -0,0 +1,97 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CSI_INDEX_H__
+#define __CSI_INDEX_H__
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+
+#include "IndexBase.h"
+
+#include "InputFile.h"
+#include "StatGenStatus.h"
+
+/// Reads a CSI index, the binning index used for BCF files and for BGZF
+/// files with references too long for BAI/Tabix.  Unlike those, the bin
+/// size (min shift) and number of levels (depth) are set by the index, and
+/// instead of a linear index each bin stores the offset of the first record
+/// that overlaps it.
+class CsiIndex : public IndexBase
+{
+public:
+    CsiIndex();
+    virtual ~CsiIndex();
+
+    /// Reset the member data for a new index file.
+    void resetIndex();
+
+    // Read & parse the specified index file.
+    /// \param filename the csi index file to be read.
+    /// \return the status of the read.
+    StatGenStatus::Status readIndex(const char* filename);
+
+    /// Get the starting file offset to look for records that end after the
+    /// specified start position.
+    /// \param refID index of the reference (the contig order in the header
+    /// of the indexed file).
+    /// \param start 1-based start position, 0/-1 for the beginning of the
+    /// reference.
+    /// \param fileStartPos set to the virtual file offset to start at.
+    /// \return false if the reference has no records at/after start.
+    bool getStartPos(int32_t refID, int32_t start,
+                     uint64_t& fileStartPos) const;
+
+    /// Get the starting file offset using the reference names that tabix
+    /// style CSI indexes store, returns false if the name is not found.
+    bool getStartPos(const char* refName, int32_t start,
+                     uint64_t& fileStartPos) const;
+
+    /// Return whether or not the index contains reference names.
+    inline bool hasRefNames() const { return(!myRefNames.empty()); }
+
+    /// Return the reference name at the specified index or
+    /// throws an exception if out of range.
+    const char* getRefName(unsigned int indexNum) const;
+
+    /// Get the number of bits in the smallest bin.
+    inline int32_t getMinShift() const { return(myMinShift); }
+
+    /// Get the number of levels below the top bin.
+    inline int32_t getDepth() const { return(myDepth); }
+
+private:
+    // Deepest binning supported, so the bin numbers fit in 32 bits.
+    static const int32_t MAX_DEPTH = 10;
+
+    // Get the first and last (exclusive) 0-based position of a bin, returns
+    // false if it is not a bin of this index's binning scheme.
+    bool getBinRange(uint32_t bin, int64_t& binStart, int64_t& binEnd) const;
+
+    int32_t myMinShift;
+    int32_t myDepth;
+
+    // Offset of the first record overlapping each bin, indexed like the
+    // bins of the reference.
+    std::vector<std::vector<uint64_t> > myLoffsets;
+
+    std::vector<std::string> myRefNames;
+};
+
+
+#endif
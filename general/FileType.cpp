@@ -48,3 +48,50 @@ bool FileType::attemptRecoverySync(bool (*checkSignature)(void *data) , int leng
     return false;
 }
 
+
+//
+// BgzfFileType overloads this method to decompress blocks using
+// worker threads.
+//
+// For all other classes, this is a NOP (fails).
+//
+bool FileType::setNumThreads(int numThreads)
+{
+    return false;
+}
+
+
+//
+// MemoryMapFileType overloads this method to hand out its mapping and
+// ReadAheadFileType to hand out the buffers it read.
+//
+// For all other classes, this is a NOP (fails).
+//
+int FileType::readView(const char*& data, unsigned int size)
+{
+    return -1;
+}
+
+
+//
+// BgzfFileType overloads these methods to convert positions written
+// while blocks are still being compressed to tell positions.
+//
+// For all other classes, these are NOPs (fail).
+//
+bool FileType::trackWrittenBlocks()
+{
+    return false;
+}
+
+
+int64_t FileType::tellUncompressed()
+{
+    return -1;
+}
+
+
+int64_t FileType::getTellOffset(int64_t uncompressedOffset)
+{
+    return -1;
+}
@@ -73,6 +73,36 @@ public:
     //
     virtual bool attemptRecoverySync(bool (*checkSignature)(void *data) , int length);
 
+    // Set the number of worker threads used to process the file's blocks
+    // (0 to process them on the calling thread).
+    // It is implemented only in BgzfFileType, all others return false.
+    virtual bool setNumThreads(int numThreads);
+
+    // Point data at the next bytes of the file without copying them and
+    // advance past them.  Returns the number of bytes available (at most
+    // size), 0 at EOF, or -1 if the file type can't do this, so a size of
+    // 0 checks whether it is supported.
+    // It is implemented only in MemoryMapFileType and ReadAheadFileType,
+    // all others return -1.
+    virtual int readView(const char*& data, unsigned int size);
+
+    // Keep track of the blocks written from now on, so positions from
+    // tellUncompressed can be converted to tell positions with
+    // getTellOffset after their block is written.
+    // Returns false if the file type can't do this.
+    // It is implemented only in BgzfFileType, all others return false.
+    virtual bool trackWrittenBlocks();
+
+    // Get the number of uncompressed bytes written so far.
+    // It is implemented only in BgzfFileType, all others return -1.
+    virtual int64_t tellUncompressed();
+
+    // Convert a position from tellUncompressed to the value tell would
+    // have returned there, flushing the data if it has not been written
+    // yet.  -1 return value indicates an error.
+    // It is implemented only in BgzfFileType, all others return -1.
+    virtual int64_t getTellOffset(int64_t uncompressedOffset);
+
 protected:
     // Set by the InputFile to inform this class if buffering
     // is used.  Maybe used by child clases (bgzf) to disable 
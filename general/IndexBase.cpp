@@ -113,6 +113,26 @@ bool SortedChunkList::mergeOverlapping()
 }
 
 
+// Add the chunks from the other list, keeping the larger end for chunks
+// that start at the same offset.
+void SortedChunkList::add(const SortedChunkList& otherList)
+{
+    std::map<uint64_t, Chunk>::const_iterator otherPos;
+    for(otherPos = otherList.chunkList.begin();
+        otherPos != otherList.chunkList.end(); ++otherPos)
+    {
+        std::pair<std::map<uint64_t, Chunk>::iterator, bool> insertRes =
+            chunkList.insert(*otherPos);
+        if(!insertRes.second &&
+           (insertRes.first->second.chunk_end < otherPos->second.chunk_end))
+        {
+            // Already had a chunk starting here, keep the larger one.
+            insertRes.first->second.chunk_end = otherPos->second.chunk_end;
+        }
+    }
+}
+
+
 IndexBase::IndexBase()
     : n_ref(0)
 {
@@ -139,7 +159,7 @@ void IndexBase::resetIndex()
 int32_t IndexBase::getNumRefs() const
 {
     // Return the number of references.
-    return(myRefs.size());
+    return(n_ref);
 }
 
 
@@ -180,13 +200,32 @@ void IndexBase::getBinsForRegion(uint32_t start, uint32_t end, bool binMap[MAX_N
 }
 
 
+// The basic logic is from samtools reg2bin and the CSI format specification.
+uint32_t IndexBase::getBin(int64_t start, int64_t end, int minShift, int depth)
+{
+    // Offset of the first bin at the current level.
+    uint32_t levelOffset = ((1 << (depth * 3)) - 1) / 7;
+    int shift = minShift;
+    --end;
+    // Start at the smallest bins and move up until start & end share one.
+    for(int level = depth; level > 0; --level)
+    {
+        if((start >> shift) == (end >> shift))
+        {
+            return(levelOffset + (start >> shift));
+        }
+        shift += 3;
+        levelOffset -= 1 << ((level - 1) * 3);
+    }
+    return(0);
+}
+
+
 // Returns the minimum offset of records that cross the 16K block that
 // contains the specified position for the given reference id.
 bool IndexBase::getMinOffsetFromLinearIndex(int32_t refID, uint32_t position,
                                             uint64_t& minOffset) const
 {
-    int32_t linearIndex = position >> LINEAR_INDEX_SHIFT;
-
     minOffset = 0;
 
     if(refID > n_ref)
@@ -194,8 +233,22 @@ bool IndexBase::getMinOffsetFromLinearIndex(int32_t refID, uint32_t position,
         // out of range of the references, return false.
         return(false);
     }
+    return(findMinOffset(myRefs[refID].ioffsets, myRefs[refID].n_intv,
+                         position, minOffset));
+}
+
+
+// Returns the minimum offset from the specified linear index of records
+// that cross the 16K block that contains the specified position.
+bool IndexBase::findMinOffset(const uint64_t* ioffsets, int32_t n_intv,
+                              uint32_t position, uint64_t& minOffset)
+{
+    int32_t linearIndex = position >> LINEAR_INDEX_SHIFT;
+
+    minOffset = 0;
+
     // Check to see if the position is out of range of the linear index.
-    int32_t linearOffsetSize = myRefs[refID].n_intv;
+    int32_t linearOffsetSize = n_intv;
 
     // If there are no entries in the linear index, return false.
     // Or if the linear index is not large enough to include
@@ -208,7 +261,7 @@ bool IndexBase::getMinOffsetFromLinearIndex(int32_t refID, uint32_t position,
     }
 
     // The linear index is specified for this block, so return that value.
-    minOffset = myRefs[refID].ioffsets[linearIndex];
+    minOffset = ioffsets[linearIndex];
     
     // If the offset is 0, go to the previous block that has an offset.
     // This is due to a couple of bugs in older sam tools indexes.
@@ -218,7 +271,7 @@ bool IndexBase::getMinOffsetFromLinearIndex(int32_t refID, uint32_t position,
     // the linear index.
     while((minOffset == 0) && (--linearIndex >= 0))
     {
-        minOffset = myRefs[refID].ioffsets[linearIndex]; 
+        minOffset = ioffsets[linearIndex]; 
     }
 
 
@@ -229,7 +282,7 @@ bool IndexBase::getMinOffsetFromLinearIndex(int32_t refID, uint32_t position,
     linearIndex = 0;
     while((minOffset == 0) && (linearIndex < linearOffsetSize))
     {
-         minOffset = myRefs[refID].ioffsets[linearIndex]; 
+         minOffset = ioffsets[linearIndex]; 
          linearIndex++;
     }
     if(minOffset == 0)
@@ -54,6 +54,9 @@ public:
     void clear();
     bool empty();
     bool mergeOverlapping();
+    // Add the chunks in the other list to this one.  If both lists have a
+    // chunk starting at the same offset, the one that ends later is kept.
+    void add(const SortedChunkList& otherList);
 
 private:
     std::map<uint64_t, Chunk> chunkList;
@@ -80,8 +83,19 @@ public:
 
     // Returns the minimum offset of records that cross the 16K block that
     // contains the specified position for the given reference id.
-    bool getMinOffsetFromLinearIndex(int32_t refID, uint32_t position,
-                                     uint64_t& minOffset) const;
+    virtual bool getMinOffsetFromLinearIndex(int32_t refID, uint32_t position,
+                                             uint64_t& minOffset) const;
+
+    /// Get the bin that contains the specified region.  The default
+    /// minShift & depth are the BAI binning scheme, other values are for
+    /// CSI indexes.
+    /// \param start inclusive 0-based start position of the region.
+    /// \param end exclusive 0-based end position of the region.
+    /// \param minShift number of bits in the smallest bin.
+    /// \param depth number of levels below the top bin.
+    /// \return the bin number.
+    static uint32_t getBin(int64_t start, int64_t end,
+                           int minShift = LINEAR_INDEX_SHIFT, int depth = 5);
 
 protected:
     const static uint32_t MAX_NUM_BINS = 37450; // per specs, at most 37450 bins
@@ -150,6 +164,11 @@ protected:
         static const uint64_t UNSET_MIN_CHUNK_OFFSET = 0xFFFFFFFFFFFFFFFFULL;
     };
 
+    // Returns the minimum offset from the specified linear index of records
+    // that cross the 16K block that contains the specified position.
+    static bool findMinOffset(const uint64_t* ioffsets, int32_t n_intv,
+                              uint32_t position, uint64_t& minOffset);
+
     // Set bins in the region to 1 and all other bins to 0.
     // start is incluive, end is exclusive.
     static void getBinsForRegion(uint32_t start, uint32_t end, bool binMap[MAX_NUM_BINS+1]);
@@ -0,0 +1,496 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IndexBuilder.h"
+
+// Used for myBin when there is no current bin.
+static const uint32_t NO_BIN = 0xFFFFFFFF;
+
+// Used for myPrevRefID before the first record.
+static const int32_t NO_PREV_REF = -2;
+
+// Number of levels below the top bin for BAI and Tabix indexes.
+static const int LINEAR_INDEX_DEPTH = 5;
+
+IndexBuilder::IndexBuilder()
+    : myRefs(),
+      myIsCsi(false),
+      myDepth(LINEAR_INDEX_DEPTH),
+      myFailStatus(StatGenStatus::SUCCESS),
+      myFailMessage(),
+      myPrevRefID(NO_PREV_REF),
+      myPrevStart(-1),
+      myBin(NO_BIN),
+      myChunkStart(0),
+      myPrevEnd(0),
+      myNumNoCoord(0)
+{
+}
+
+
+IndexBuilder::~IndexBuilder()
+{
+}
+
+
+void IndexBuilder::reset(int32_t numRefs, int64_t maxLength, bool csi)
+{
+    myRefs.clear();
+    myRefs.resize(numRefs);
+
+    // Add levels until the bins cover the longest reference.
+    myDepth = LINEAR_INDEX_DEPTH;
+    while(maxLength > ((int64_t)1 << (CSI_MIN_SHIFT + myDepth * 3)))
+    {
+        ++myDepth;
+    }
+    // BAI & Tabix can only be used for the default number of levels.
+    myIsCsi = csi || (myDepth != LINEAR_INDEX_DEPTH);
+
+    myFailStatus = StatGenStatus::SUCCESS;
+    myFailMessage.clear();
+    myPrevRefID = NO_PREV_REF;
+    myPrevStart = -1;
+    myBin = NO_BIN;
+    myChunkStart = 0;
+    myPrevEnd = 0;
+    myNumNoCoord = 0;
+}
+
+
+int32_t IndexBuilder::addRef()
+{
+    myRefs.push_back(Reference());
+    return(myRefs.size() - 1);
+}
+
+
+bool IndexBuilder::addRecord(int32_t refID, int64_t start, int64_t end,
+                             bool mapped,
+                             int64_t recordStart, int64_t recordEnd)
+{
+    if(myFailStatus != StatGenStatus::SUCCESS)
+    {
+        return(false);
+    }
+
+    if((refID < -1) || (refID >= (int32_t)myRefs.size()))
+    {
+        myFailStatus = StatGenStatus::FAIL_PARSE;
+        myFailMessage = "record reference id is not in the header";
+        return(false);
+    }
+
+    if(refID != myPrevRefID)
+    {
+        // Records without a reference must be last, otherwise references
+        // must be in increasing order.
+        if((myPrevRefID == -1) ||
+           ((refID != -1) && (refID < myPrevRefID)))
+        {
+            myFailStatus = StatGenStatus::FAIL_ORDER;
+            myFailMessage = "records are not sorted by coordinate";
+            return(false);
+        }
+        // Done with the previous reference.
+        saveChunk();
+        myPrevStart = -1;
+    }
+    else if((refID != -1) && (start < myPrevStart))
+    {
+        myFailStatus = StatGenStatus::FAIL_ORDER;
+        myFailMessage = "records are not sorted by coordinate";
+        return(false);
+    }
+
+    myPrevRefID = refID;
+
+    if(refID == -1)
+    {
+        // Records without a reference are only counted.
+        ++myNumNoCoord;
+        myPrevEnd = recordEnd;
+        return(true);
+    }
+
+    if(start < 0)
+    {
+        myFailStatus = StatGenStatus::FAIL_PARSE;
+        myFailMessage = "record has a reference id, but no position";
+        return(false);
+    }
+    myPrevStart = start;
+
+    // Records with no alignment length cover their start position.
+    if(end <= start)
+    {
+        end = start + 1;
+    }
+
+    if(end > ((int64_t)1 << (CSI_MIN_SHIFT + myDepth * 3)))
+    {
+        myFailStatus = StatGenStatus::FAIL_PARSE;
+        myFailMessage = "record position is past the end supported by the index";
+        return(false);
+    }
+
+    Reference& ref = myRefs[refID];
+    if((ref.numMapped + ref.numUnmapped) == 0)
+    {
+        ref.offBeg = recordStart;
+    }
+    ref.offEnd = recordEnd;
+    if(mapped)
+    {
+        ++ref.numMapped;
+    }
+    else
+    {
+        ++ref.numUnmapped;
+    }
+
+    uint32_t bin = IndexBase::getBin(start, end, CSI_MIN_SHIFT, myDepth);
+    if(bin != myBin)
+    {
+        // Start a new chunk for this bin.
+        saveChunk();
+        myBin = bin;
+        myChunkStart = recordStart;
+    }
+
+    // Set the linear index for each window the record covers that doesn't
+    // already have an earlier record.
+    uint32_t firstWindow = start >> CSI_MIN_SHIFT;
+    uint32_t lastWindow = (end - 1) >> CSI_MIN_SHIFT;
+    if(ref.linearIndex.size() <= lastWindow)
+    {
+        ref.linearIndex.resize(lastWindow + 1, 0);
+    }
+    for(uint32_t window = firstWindow; window <= lastWindow; window++)
+    {
+        if(ref.linearIndex[window] == 0)
+        {
+            ref.linearIndex[window] = recordStart;
+        }
+    }
+    myPrevEnd = recordEnd;
+    return(true);
+}
+
+
+StatGenStatus::Status IndexBuilder::writeIndex(const char* filename,
+                                               InputFile& dataFile)
+{
+    if(myFailStatus != StatGenStatus::SUCCESS)
+    {
+        return(myFailStatus);
+    }
+
+    // Save the chunk of the last record.
+    saveChunk();
+    myPrevRefID = NO_PREV_REF;
+
+    if(!convertOffsets(dataFile))
+    {
+        myFailStatus = StatGenStatus::FAIL_IO;
+        myFailMessage = "failed to get the file offsets";
+        return(StatGenStatus::FAIL_IO);
+    }
+
+    for(unsigned int i = 0; i < myRefs.size(); i++)
+    {
+        Reference& ref = myRefs[i];
+        std::map<uint32_t, std::vector<Chunk> >::iterator binIter;
+        for(binIter = ref.bins.begin(); binIter != ref.bins.end(); ++binIter)
+        {
+            mergeChunks(binIter->second);
+        }
+        // Windows without a record start at the previous window's record,
+        // like samtools.
+        for(unsigned int j = 1; j < ref.linearIndex.size(); j++)
+        {
+            if(ref.linearIndex[j] == 0)
+            {
+                ref.linearIndex[j] = ref.linearIndex[j-1];
+            }
+        }
+    }
+
+    IFILE indexFile = NULL;
+    if(isIndexCompressed())
+    {
+        indexFile = ifopen(filename, "wb", InputFile::BGZF);
+    }
+    else
+    {
+        indexFile = ifopen(filename, "wb", InputFile::UNCOMPRESSED);
+    }
+    if(indexFile == NULL)
+    {
+        myFailStatus = StatGenStatus::FAIL_IO;
+        myFailMessage = "failed to open the index file";
+        return(StatGenStatus::FAIL_IO);
+    }
+
+    bool success = writeHeader(indexFile) && writeRefs(indexFile);
+    if(ifclose(indexFile) != 0)
+    {
+        success = false;
+    }
+    if(!success)
+    {
+        myFailStatus = StatGenStatus::FAIL_IO;
+        myFailMessage = "failed to write the index file";
+        return(StatGenStatus::FAIL_IO);
+    }
+    return(StatGenStatus::SUCCESS);
+}
+
+
+bool IndexBuilder::writeCsiHeader(IFILE indexFile, const std::string& aux)
+{
+    int32_t minShift = CSI_MIN_SHIFT;
+    int32_t depth = myDepth;
+    int32_t auxLength = aux.size();
+    int32_t numRefs = myRefs.size();
+    return((ifwrite(indexFile, "CSI\1", 4) == 4) &&
+           (ifwrite(indexFile, &minShift, 4) == 4) &&
+           (ifwrite(indexFile, &depth, 4) == 4) &&
+           (ifwrite(indexFile, &auxLength, 4) == 4) &&
+           ((auxLength == 0) ||
+            (ifwrite(indexFile, aux.c_str(), auxLength) ==
+             (unsigned int)auxLength)) &&
+           (ifwrite(indexFile, &numRefs, 4) == 4));
+}
+
+
+void IndexBuilder::saveChunk()
+{
+    if((myPrevRefID < 0) || (myBin == NO_BIN))
+    {
+        // No chunk to save.
+        return;
+    }
+    Chunk chunk;
+    chunk.chunk_beg = myChunkStart;
+    chunk.chunk_end = myPrevEnd;
+    myRefs[myPrevRefID].bins[myBin].push_back(chunk);
+    myBin = NO_BIN;
+}
+
+
+bool IndexBuilder::convertOffsets(InputFile& dataFile)
+{
+    for(unsigned int i = 0; i < myRefs.size(); i++)
+    {
+        Reference& ref = myRefs[i];
+        if((ref.numMapped + ref.numUnmapped) == 0)
+        {
+            continue;
+        }
+        if(!convertOffset(dataFile, ref.offBeg) ||
+           !convertOffset(dataFile, ref.offEnd))
+        {
+            return(false);
+        }
+        std::map<uint32_t, std::vector<Chunk> >::iterator binIter;
+        for(binIter = ref.bins.begin(); binIter != ref.bins.end(); ++binIter)
+        {
+            std::vector<Chunk>& chunks = binIter->second;
+            for(unsigned int j = 0; j < chunks.size(); j++)
+            {
+                if(!convertOffset(dataFile, chunks[j].chunk_beg) ||
+                   !convertOffset(dataFile, chunks[j].chunk_end))
+                {
+                    return(false);
+                }
+            }
+        }
+        for(unsigned int j = 0; j < ref.linearIndex.size(); j++)
+        {
+            // 0 means no record starts in this window.
+            if((ref.linearIndex[j] != 0) &&
+               !convertOffset(dataFile, ref.linearIndex[j]))
+            {
+                return(false);
+            }
+        }
+    }
+    return(true);
+}
+
+
+bool IndexBuilder::convertOffset(InputFile& dataFile, uint64_t& offset)
+{
+    int64_t tellPos = dataFile.getTellPosition(offset);
+    if(tellPos < 0)
+    {
+        return(false);
+    }
+    offset = tellPos;
+    return(true);
+}
+
+
+void IndexBuilder::mergeChunks(std::vector<Chunk>& chunks)
+{
+    if(chunks.empty())
+    {
+        return;
+    }
+    // Like samtools, merge a chunk into the previous one if the previous
+    // one ends in the same BGZF block the chunk starts in.
+    unsigned int prev = 0;
+    for(unsigned int i = 1; i < chunks.size(); i++)
+    {
+        if((chunks[prev].chunk_end >> 16) == (chunks[i].chunk_beg >> 16))
+        {
+            chunks[prev].chunk_end = chunks[i].chunk_end;
+        }
+        else
+        {
+            chunks[++prev] = chunks[i];
+        }
+    }
+    chunks.resize(prev + 1);
+}
+
+
+bool IndexBuilder::writeRefs(IFILE indexFile)
+{
+    int32_t numRefs = myRefs.size();
+    for(int32_t i = 0; i < numRefs; i++)
+    {
+        const Reference& ref = myRefs[i];
+        bool hasRecords = ((ref.numMapped + ref.numUnmapped) != 0);
+        // Add the bin for the mapped/unmapped counts.
+        int32_t numBins = ref.bins.size() + (hasRecords ? 1 : 0);
+        if(ifwrite(indexFile, &numBins, 4) != 4)
+        {
+            return(false);
+        }
+        std::map<uint32_t, std::vector<Chunk> >::const_iterator binIter;
+        for(binIter = ref.bins.begin(); binIter != ref.bins.end(); ++binIter)
+        {
+            uint32_t binNum = binIter->first;
+            if(ifwrite(indexFile, &binNum, 4) != 4)
+            {
+                return(false);
+            }
+            if(myIsCsi)
+            {
+                // CSI has no linear index, instead each bin has the offset
+                // of the first record that covers its first window.
+                uint64_t loffset = binIter->second[0].chunk_beg;
+                uint32_t window = getFirstWindow(binNum);
+                if((window < ref.linearIndex.size()) &&
+                   (ref.linearIndex[window] != 0))
+                {
+                    loffset = ref.linearIndex[window];
+                }
+                if(ifwrite(indexFile, &loffset, 8) != 8)
+                {
+                    return(false);
+                }
+            }
+            if(!writeChunks(indexFile, binIter->second))
+            {
+                return(false);
+            }
+        }
+        if(hasRecords && !writeMetaBin(indexFile, ref))
+        {
+            return(false);
+        }
+
+        if(myIsCsi)
+        {
+            continue;
+        }
+        int32_t numIntervals = ref.linearIndex.size();
+        uint32_t linearIndexSize = numIntervals * sizeof(uint64_t);
+        if(ifwrite(indexFile, &numIntervals, 4) != 4)
+        {
+            return(false);
+        }
+        if((numIntervals != 0) &&
+           (ifwrite(indexFile, &(ref.linearIndex[0]), linearIndexSize) !=
+            linearIndexSize))
+        {
+            return(false);
+        }
+    }
+
+    return(ifwrite(indexFile, &myNumNoCoord, 8) == 8);
+}
+
+
+bool IndexBuilder::writeChunks(IFILE indexFile,
+                               const std::vector<Chunk>& chunks)
+{
+    int32_t numChunks = chunks.size();
+    if(ifwrite(indexFile, &numChunks, 4) != 4)
+    {
+        return(false);
+    }
+    for(int32_t i = 0; i < numChunks; i++)
+    {
+        if((ifwrite(indexFile, &(chunks[i].chunk_beg), 8) != 8) ||
+           (ifwrite(indexFile, &(chunks[i].chunk_end), 8) != 8))
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
+
+
+// The bin after the last real bin holds the start/end of the reference's
+// records and its number of mapped & unmapped records.
+bool IndexBuilder::writeMetaBin(IFILE indexFile, const Reference& ref)
+{
+    uint32_t binNum = ((1 << ((myDepth + 1) * 3)) - 1) / 7 + 1;
+    std::vector<Chunk> chunks(2);
+    chunks[0].chunk_beg = ref.offBeg;
+    chunks[0].chunk_end = ref.offEnd;
+    chunks[1].chunk_beg = ref.numMapped;
+    chunks[1].chunk_end = ref.numUnmapped;
+    uint64_t loffset = 0;
+    if((ifwrite(indexFile, &binNum, 4) != 4) ||
+       (myIsCsi && (ifwrite(indexFile, &loffset, 8) != 8)))
+    {
+        return(false);
+    }
+    return(writeChunks(indexFile, chunks));
+}
+
+
+uint32_t IndexBuilder::getFirstWindow(uint32_t bin) const
+{
+    // Find the level of the bin, then the position of its first window.
+    uint32_t levelOffset = 0;
+    for(int level = 0; level <= myDepth; level++)
+    {
+        uint32_t nextOffset = levelOffset + (1 << (level * 3));
+        if(bin < nextOffset)
+        {
+            return((bin - levelOffset) << ((myDepth - level) * 3));
+        }
+        levelOffset = nextOffset;
+    }
+    return(0);
+}
@@ -0,0 +1,167 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __INDEX_BUILDER_H__
+#define __INDEX_BUILDER_H__
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "IndexBase.h"
+#include "InputFile.h"
+#include "StatGenStatus.h"
+
+/// Base class for building a binning index (BAI, Tabix, or CSI) from the
+/// records of a sorted BGZF file as they are written, so the file does not
+/// need to be read again to index it.
+///
+/// Record offsets are the uncompressed positions of the file being written
+/// (InputFile::getUncompressedPosition), and are converted to BGZF virtual
+/// offsets (InputFile::getTellPosition) when the index is written, so the
+/// file can be compressed by worker threads.  Subclasses write the header
+/// of their index format, this class writes the bins.
+class IndexBuilder
+{
+public:
+    IndexBuilder();
+    virtual ~IndexBuilder();
+
+    /// Add a record that was written to the file.  Records must be
+    /// added in the order they were written.  If they are not coordinate
+    /// sorted, or a record can not be indexed (its reference is not in the
+    /// header or it is past the end the index supports), the index is
+    /// marked as failed and no more records are added.
+    /// \param refID reference id of the record, -1 for no reference.
+    /// \param start inclusive 0-based start position of the record.
+    /// \param end exclusive 0-based end position of the record.
+    /// \param mapped whether or not the record is mapped.
+    /// \param recordStart uncompressed position where the record starts.
+    /// \param recordEnd uncompressed position where the record ends.
+    /// \return true if the record was added, false if the index failed.
+    bool addRecord(int32_t refID, int64_t start, int64_t end, bool mapped,
+                   int64_t recordStart, int64_t recordEnd);
+
+    /// Returns whether or not a CSI index will be written.
+    bool isCsi() const
+    {
+        return(myIsCsi);
+    }
+
+    /// Write the index.  Converts the record positions to offsets in
+    /// dataFile, flushing it, so it must still be open.
+    /// \param filename name of the index file to write.
+    /// \param dataFile file the records were written to.
+    /// \return the status of the write, see getFailMessage for the reason
+    /// if it failed: FAIL_ORDER if the records were not coordinate sorted,
+    /// FAIL_PARSE if a record could not be indexed, FAIL_IO if the index
+    /// could not be written.
+    StatGenStatus::Status writeIndex(const char* filename,
+                                     InputFile& dataFile);
+
+    /// Returns the reason the last addRecord/writeIndex failed.
+    const char* getFailMessage() const
+    {
+        return(myFailMessage.c_str());
+    }
+
+    /// Minimum shift (bits in the smallest bin) used for CSI indexes.
+    static const int CSI_MIN_SHIFT = 14;
+
+protected:
+    /// Reset the builder for a new file.  Picks CSI if csi is set or a
+    /// reference is longer than the linear index formats support.
+    /// \param numRefs number of references, more can be added by addRef.
+    /// \param maxLength length of the longest reference.
+    /// \param csi true to always write a CSI index.
+    void reset(int32_t numRefs, int64_t maxLength, bool csi);
+
+    /// Add a reference, returning its reference id.
+    int32_t addRef();
+
+    /// Get the number of references.
+    int32_t getNumRefs() const
+    {
+        return(myRefs.size());
+    }
+
+    /// Returns whether or not the index file is BGZF compressed.
+    virtual bool isIndexCompressed() const
+    {
+        return(true);
+    }
+
+    /// Write the index format's magic and header up to and including the
+    /// number of references.
+    virtual bool writeHeader(IFILE indexFile) = 0;
+
+    /// Write the CSI header with the specified auxiliary data.
+    bool writeCsiHeader(IFILE indexFile, const std::string& aux);
+
+private:
+    struct Reference
+    {
+        Reference()
+            : offBeg(0), offEnd(0), numMapped(0), numUnmapped(0) {}
+
+        // Chunks for each bin in the order they were written.
+        std::map<uint32_t, std::vector<Chunk> > bins;
+        // Start of the first record for each 16K window, 0 for none.
+        std::vector<uint64_t> linearIndex;
+        // Start of the first record and end of the last record.
+        uint64_t offBeg;
+        uint64_t offEnd;
+        uint64_t numMapped;
+        uint64_t numUnmapped;
+    };
+
+    // Save the chunk for the current bin.
+    void saveChunk();
+
+    // Convert each offset to a virtual offset, returns false on failure.
+    bool convertOffsets(InputFile& dataFile);
+    bool convertOffset(InputFile& dataFile, uint64_t& offset);
+
+    // Merge chunks in a bin that are in the same BGZF block.
+    static void mergeChunks(std::vector<Chunk>& chunks);
+
+    // Write the bins (and linear index unless CSI) of each reference.
+    bool writeRefs(IFILE indexFile);
+    bool writeChunks(IFILE indexFile, const std::vector<Chunk>& chunks);
+    bool writeMetaBin(IFILE indexFile, const Reference& ref);
+
+    // Get the offset of the first window in the specified CSI bin.
+    uint32_t getFirstWindow(uint32_t bin) const;
+
+    std::vector<Reference> myRefs;
+    bool myIsCsi;
+    int myDepth;
+    // Status of the first failure, SUCCESS if none.
+    StatGenStatus::Status myFailStatus;
+    std::string myFailMessage;
+
+    // Values for the record being added.
+    int32_t myPrevRefID;
+    int64_t myPrevStart;
+    uint32_t myBin;
+    int64_t myChunkStart;
+    int64_t myPrevEnd;
+    uint64_t myNumNoCoord;
+};
+
+#endif
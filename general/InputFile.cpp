@@ -22,6 +22,9 @@
 #include "BgzfFileTypeRecovery.h"
 #include "GzipFileType.h"
 #include "UncompressedFileType.h"
+#include "MemoryMapFileType.h"
+#include "BufferFileType.h"
+#include "ReadAheadFileType.h"
 
 #include <stdarg.h>
 
@@ -30,125 +33,201 @@ InputFile::InputFile(const char * filename, const char * mode,
 {
     // XXX duplicate code
     myAttemptRecovery = false;
+    myNumThreads = 0;
+    myNumBuffers = 1;
+    myReadingAhead = false;
+    myOpenForRead = false;
     myFileTypePtr = NULL;
     myBufferIndex = 0;
     myCurrentBufferSize = 0;
     myAllocatedBufferSize = DEFAULT_BUFFER_SIZE;
     myFileBuffer = new char[myAllocatedBufferSize];
+    myReadBuffer = myFileBuffer;
     myFileName.clear();
 
     openFile(filename, mode, compressionMode);
 }
 
 
-int InputFile::readTilChar(const std::string& stopChars, std::string& stringRef)
-{
-    int charRead = 0;
-    size_t pos = std::string::npos;
-    // Loop until the character was not found in the stop characters.
-    while(pos == std::string::npos)
-    {
-        charRead = ifgetc();
+// Default to reading files through the buffer.
+bool InputFile::ourUseMemoryMap = false;
 
-        // First Check for EOF.  If EOF is found, just return -1
-        if(charRead == EOF)
-        {
-            return(-1);
-        }
-        
-        // Try to find the character in the stopChars.
-        pos = stopChars.find(charRead);
 
-        if(pos == std::string::npos)
-        {
-            // Didn't find a stop character and it is not an EOF, 
-            // so add it to the string.
-            stringRef += charRead;
-        }
-    }
+int InputFile::readTilChar(const std::string& stopChars, std::string& stringRef)
+{
+    const char* field = NULL;
+    int length = 0;
+    int pos = scanTilChar(stopChars.data(), stopChars.length(),
+                          field, length, true);
+    stringRef.append(field, length);
     return(pos);
 }
 
 
 int InputFile::readTilChar(const std::string& stopChars)
 {
-    int charRead = 0;
-    size_t pos = std::string::npos;
-    // Loop until the character was not found in the stop characters.
-    while(pos == std::string::npos)
-    {
-        charRead = ifgetc();
-
-        // First Check for EOF.  If EOF is found, just return -1
-        if(charRead == EOF)
-        {
-            return(-1);
-        }
-        
-        // Try to find the character in the stopChars.
-        pos = stopChars.find(charRead);
-    }
-    return(pos);
+    const char* field = NULL;
+    int length = 0;
+    return(scanTilChar(stopChars.data(), stopChars.length(),
+                       field, length, false));
 }
 
 
 int InputFile::discardLine()
 {
-    int charRead = 0;
-    // Loop until the character was not found in the stop characters.
-    while((charRead != EOF) && (charRead != '\n'))
-    {
-        charRead = ifgetc();
-    }
-    // First Check for EOF.  If EOF is found, just return -1
-    if(charRead == EOF)
-    {
-        return(-1);
-    }
-    return(0);
+    const char* field = NULL;
+    int length = 0;
+    return(scanTilChar("\n", 1, field, length, false));
 }
 
 
 int InputFile::readLine(std::string& line)
 {
-    int charRead = 0;
-    while(!ifeof())
+    const char* field = NULL;
+    int length = 0;
+    int pos = scanTilChar("\n", 1, field, length, true);
+    line.append(field, length);
+    return(pos);
+}
+
+
+int InputFile::readTilTab(std::string& field)
+{
+    const char* view = NULL;
+    int length = 0;
+    int pos = scanTilChar("\n\t", 2, view, length, true);
+    field.append(view, length);
+    return(pos);
+}
+
+
+int InputFile::readTilCharView(const std::string& stopChars,
+                               const char*& field, int& length)
+{
+    return(scanTilChar(stopChars.data(), stopChars.length(),
+                       field, length, true));
+}
+
+
+int InputFile::readLineView(const char*& line, int& length)
+{
+    return(scanTilChar("\n", 1, line, length, true));
+}
+
+
+int InputFile::readTilTabView(const char*& field, int& length)
+{
+    return(scanTilChar("\n\t", 2, field, length, true));
+}
+
+
+// Return true if any byte of the word is zero.
+static inline bool hasZeroByte(uint64_t word)
+{
+    return(((word - 0x0101010101010101ULL) & ~word &
+            0x8080808080808080ULL) != 0);
+}
+
+
+// Return a pointer to the first of the stop characters between start and
+// end, or end if there is none.  A single stop character (the common
+// line case) uses memchr, which is vectorized by the C library.  Two stop
+// characters (the tab/newline field case) are searched for 8 bytes at a
+// time by checking each word for a byte equal to either one.
+static inline const char* findStopChar(const char* start, const char* end,
+                                       const char* stopChars, int numStopChars)
+{
+    if(numStopChars == 1)
     {
-        charRead = ifgetc();
-        if(charRead == EOF)
+        const char* pos = (const char*)memchr(start, stopChars[0], end - start);
+        return((pos == NULL) ? end : pos);
+    }
+    if(numStopChars == 2)
+    {
+        char stop0 = stopChars[0];
+        char stop1 = stopChars[1];
+        uint64_t pattern0 = 0x0101010101010101ULL * (unsigned char)stop0;
+        uint64_t pattern1 = 0x0101010101010101ULL * (unsigned char)stop1;
+        uint64_t word;
+        while(end - start >= (int)sizeof(word))
         {
-            return(-1);
+            memcpy(&word, start, sizeof(word));
+            if(hasZeroByte(word ^ pattern0) || hasZeroByte(word ^ pattern1))
+            {
+                // One of these 8 bytes is a stop character.
+                break;
+            }
+            start += sizeof(word);
         }
-        if(charRead == '\n')
+        while((start != end) && (*start != stop0) && (*start != stop1))
         {
-            return(0);
+            ++start;
         }
-        line += charRead;
+        return(start);
     }
-    // Should never get here.
-    return(-1);
+    while((start != end) && (memchr(stopChars, *start, numStopChars) == NULL))
+    {
+        ++start;
+    }
+    return(start);
 }
 
 
-int InputFile::readTilTab(std::string& field)
+int InputFile::scanTilChar(const char* stopChars, int numStopChars,
+                           const char*& field, int& length, bool keepField)
 {
-    int charRead = 0;
-    while(!ifeof())
+    // Scan the buffer a piece at a time rather than character by character.
+    // The field is returned in place unless it crosses a refill, in which
+    // case the pieces are gathered into mySpillBuffer.
+    bool spilled = false;
+    while(loadBuffer())
     {
-        charRead = ifgetc();
-        if(charRead == EOF)
+        const char* start = myReadBuffer + myBufferIndex;
+        const char* end = myReadBuffer + myCurrentBufferSize;
+        const char* pos = findStopChar(start, end, stopChars, numStopChars);
+        myBufferIndex += pos - start;
+        if(pos != end)
         {
-            return(-1);
+            // Found a stop character, skip it.
+            ++myBufferIndex;
+            if(keepField)
+            {
+                if(spilled)
+                {
+                    mySpillBuffer.append(start, pos - start);
+                    field = mySpillBuffer.data();
+                    length = mySpillBuffer.length();
+                }
+                else
+                {
+                    field = start;
+                    length = pos - start;
+                }
+            }
+            return((const char*)memchr(stopChars, *pos, numStopChars) -
+                   stopChars);
         }
-        if(charRead == '\n')
+        if(keepField)
         {
-            return(0);
+            // The field continues into the next buffer, so save what has
+            // been read so far before the buffer is refilled.
+            if(!spilled)
+            {
+                mySpillBuffer.clear();
+                spilled = true;
+            }
+            mySpillBuffer.append(start, pos - start);
         }
-        if(charRead == '\t')
+    }
+    // EOF.
+    if(keepField)
+    {
+        if(!spilled)
         {
-            return(1);
+            mySpillBuffer.clear();
         }
-        field += charRead;
+        field = mySpillBuffer.data();
+        length = mySpillBuffer.length();
     }
     return(-1);
 }
@@ -250,7 +329,7 @@ bool InputFile::openFile(const char * filename, const char * mode,
                 {
                     // The file is a uncompressed, uncompressed file,
                     // so set the myFileTypePtr accordingly.
-                    myFileTypePtr = new UncompressedFileType(filename, mode);
+                    openUncompressedFile(filename, mode);
                 }
             }
         }
@@ -267,14 +346,13 @@ bool InputFile::openFile(const char * filename, const char * mode,
         return false;
     }
 
-    if(myAllocatedBufferSize == 1)
+    if(myNumThreads > 0)
     {
-        myFileTypePtr->setBuffered(false);
-    }
-    else
-    {
-        myFileTypePtr->setBuffered(true);
+        myFileTypePtr->setNumThreads(myNumThreads);
     }
+    myReadingAhead = false;
+    myOpenForRead = ((mode[0] == 'r') || (mode[0] == 'R'));
+    setupBuffering();
     myFileName = filename;
     return true;
 }
@@ -354,7 +432,14 @@ bool InputFile::openFile(const char * filename, const char * mode,
                          InputFile::ifileCompression compressionMode)
 {
     //  No zlib, so it is a uncompressed, uncompressed file.
-    myFileTypePtr = new UncompressedFileType(filename, mode);
+    if((strcmp(filename, "-") == 0) || (mode[0] == 'w') || (mode[0] == 'W'))
+    {
+        myFileTypePtr = new UncompressedFileType(filename, mode);
+    }
+    else
+    {
+        openUncompressedFile(filename, mode);
+    }
 
     if(myFileTypePtr == NULL)
     {
@@ -367,6 +452,32 @@ bool InputFile::openFile(const char * filename, const char * mode,
         myFileTypePtr = NULL;
         return false;
     }
+    if(myNumThreads > 0)
+    {
+        myFileTypePtr->setNumThreads(myNumThreads);
+    }
+    myReadingAhead = false;
+    myOpenForRead = ((mode[0] == 'r') || (mode[0] == 'R'));
+    setupBuffering();
+    myFileName = filename;
+    return true;
+}
+
+#endif
+
+
+void InputFile::setupBuffering()
+{
+#ifdef __PTHREAD_AVAILABLE__
+    if(myReadingAhead)
+    {
+        // Unwrap the file, it is wrapped again below if it should still
+        // read ahead.
+        myFileTypePtr = ((ReadAheadFileType*)myFileTypePtr)->release();
+        myReadingAhead = false;
+    }
+#endif
+
     if(myAllocatedBufferSize == 1)
     {
         myFileTypePtr->setBuffered(false);
@@ -375,11 +486,52 @@ bool InputFile::openFile(const char * filename, const char * mode,
     {
         myFileTypePtr->setBuffered(true);
     }
-    myFileName = filename;
-    return true;
-}
 
+#ifdef __PTHREAD_AVAILABLE__
+    // Memory mapped files (which hand out views) are not read ahead
+    // since they are not copied.
+    const char* view = NULL;
+    if((myNumBuffers > 1) && (myAllocatedBufferSize > 1) && myOpenForRead &&
+       (myFileTypePtr->readView(view, 0) < 0))
+    {
+        myFileTypePtr = new ReadAheadFileType(myFileTypePtr,
+                                              myAllocatedBufferSize,
+                                              myNumBuffers);
+        myFileTypePtr->setBuffered(true);
+        myReadingAhead = true;
+    }
 #endif
+}
+
+
+bool InputFile::openBuffer(const char* data, int64_t length)
+{
+    ifclose();
+    myBufferIndex = 0;
+    myCurrentBufferSize = 0;
+    myFileTypePtr = new BufferFileType(data, length);
+    myFileTypePtr->setBuffered(true);
+    myOpenForRead = true;
+    return(true);
+}
+
+
+void InputFile::openUncompressedFile(const char* filename, const char* mode)
+{
+    if(ourUseMemoryMap && ((mode[0] == 'r') || (mode[0] == 'R')) &&
+       (strstr(filename, "ftp://") != filename) &&
+       (strstr(filename, "http://") != filename))
+    {
+        myFileTypePtr = new MemoryMapFileType(filename);
+        if(myFileTypePtr->isOpen())
+        {
+            return;
+        }
+        // Could not be mapped, so read it normally.
+        delete myFileTypePtr;
+    }
+    myFileTypePtr = new UncompressedFileType(filename, mode);
+}
 
 
 InputFile::~InputFile()
@@ -52,12 +52,17 @@ public:
     InputFile()
     {
         myAttemptRecovery = false;
+        myNumThreads = 0;
+        myNumBuffers = 1;
+        myReadingAhead = false;
+        myOpenForRead = false;
         myFileTypePtr = NULL;
         myBufferIndex = 0;
         myCurrentBufferSize = 0;
         // Default to buffer.
         myAllocatedBufferSize = DEFAULT_BUFFER_SIZE;
         myFileBuffer = new char[myAllocatedBufferSize];
+        myReadBuffer = myFileBuffer;
         myFileName.clear();
     }
 
@@ -78,12 +83,21 @@ public:
     /// This improves performance over reading the file small bits at a time.
     /// Buffering reads disables the tell call for bgzf files.
     /// Any previous values in the buffer will be deleted.
+    /// With more than one buffer, a background thread reads (and
+    /// decompresses) the next buffers of a file opened for reading while
+    /// the current one is being processed.  ifseek/ifrewind drop the
+    /// buffers read ahead and restart reading at the new position.
     /// \param bufferSize number of bytes to read/buffer at a time,
     /// turn off read buffering by setting bufferSize = 1;
-    inline void bufferReads(unsigned int bufferSize = DEFAULT_BUFFER_SIZE)
+    /// \param numBuffers number of buffers, 1 (default) reads on the
+    /// calling thread, 2 for double buffering, 3 for triple buffering, etc.
+    /// Ignored for unbuffered and memory mapped files and without pthreads.
+    inline void bufferReads(unsigned int bufferSize = DEFAULT_BUFFER_SIZE,
+                            unsigned int numBuffers = 1)
     {
         // If the buffer size is the same, do nothing.
-        if(bufferSize == myAllocatedBufferSize)
+        if((bufferSize == myAllocatedBufferSize) &&
+           (numBuffers == myNumBuffers))
         {
             return;
         }
@@ -101,19 +115,77 @@ public:
             bufferSize = 1;
         }
         myFileBuffer = new char[bufferSize];
+        myReadBuffer = myFileBuffer;
         myAllocatedBufferSize = bufferSize;
+        myNumBuffers = numBuffers;
 
         if(myFileTypePtr != NULL)
         {
-            if(bufferSize == 1)
-            {
-                myFileTypePtr->setBuffered(false);
-            }
-            else
-            {
-                myFileTypePtr->setBuffered(true);
-            }
+            setupBuffering();
+        }
+    }
+
+
+    /// Set the number of worker threads used to decompress BGZF blocks ahead
+    /// of the current read position, or to compress the blocks of a file
+    /// being written.  Blocks are still read/written in file order, so
+    /// iftell/ifseek keep working when reading.  Can be called before or
+    /// after the file is opened and applies to any file opened afterwards.
+    /// \param numThreads number of worker threads, 0 to decompress on the
+    /// calling thread (default).
+    /// \return true if the setting could be applied to the open file (or no
+    /// file is open), false if the file type does not support threads.
+    inline bool setNumThreads(int numThreads)
+    {
+        myNumThreads = numThreads;
+        if(myFileTypePtr == NULL)
+        {
+            return(true);
+        }
+        return(myFileTypePtr->setNumThreads(numThreads));
+    }
+
+
+    /// Keep track of the BGZF blocks written from now on, so positions
+    /// from getUncompressedPosition can be converted to iftell positions
+    /// with getTellPosition, even while blocks are still being compressed
+    /// by worker threads.  Only supported for BGZF files opened for writing.
+    /// \return true if the blocks are tracked, false if not supported.
+    inline bool trackWrittenBlocks()
+    {
+        if(myFileTypePtr == NULL)
+        {
+            return(false);
+        }
+        return(myFileTypePtr->trackWrittenBlocks());
+    }
+
+
+    /// Get the number of uncompressed bytes written so far.
+    /// \return uncompressed position, -1 if not supported.
+    inline int64_t getUncompressedPosition()
+    {
+        if(myFileTypePtr == NULL)
+        {
+            return(-1);
+        }
+        return(myFileTypePtr->tellUncompressed());
+    }
+
+
+    /// Convert a position from getUncompressedPosition to the iftell
+    /// position of that point in the file, flushing the data written so
+    /// far if that point has not been written to the file yet.  Requires
+    /// trackWrittenBlocks to have been called before that point was written.
+    /// \param uncompressedPos position from getUncompressedPosition.
+    /// \return iftell position, -1 indicates an error.
+    inline int64_t getTellPosition(int64_t uncompressedPos)
+    {
+        if(myFileTypePtr == NULL)
+        {
+            return(-1);
         }
+        return(myFileTypePtr->getTellOffset(uncompressedPos));
     }
 
 
@@ -139,6 +211,7 @@ public:
         int result = myFileTypePtr->close();
         delete myFileTypePtr;
         myFileTypePtr = NULL;
+        myReadingAhead = false;
         myFileName.clear();
         return result;
     }
@@ -164,7 +237,7 @@ public:
         if (size <= availableBytes)
         {
             //   Just copy from the buffer, increment the index and return.
-            memcpy(buffer, myFileBuffer+myBufferIndex, size);
+            memcpy(buffer, myReadBuffer+myBufferIndex, size);
             // Increment the buffer index.
             myBufferIndex += size;
             returnSize = size;
@@ -177,7 +250,7 @@ public:
             {
                 // Size > availableBytes > 0
                 // Copy the available bytes into the buffer.
-                memcpy(buffer, myFileBuffer+myBufferIndex, availableBytes);
+                memcpy(buffer, myReadBuffer+myBufferIndex, availableBytes);
             }
             // So far availableBytes have been copied into the read buffer.
             returnSize = availableBytes;
@@ -192,8 +265,7 @@ public:
             {
                 // the remaining size is not the full buffer, but read
                 //  a full buffer worth of data anyway.
-                myCurrentBufferSize =
-                    readFromFile(myFileBuffer, myAllocatedBufferSize);
+                myCurrentBufferSize = fillBuffer();
 
                 // Check for an error.
                 if(myCurrentBufferSize <= 0)
@@ -229,7 +301,7 @@ public:
 
                     // Now copy the rest of the bytes into the buffer.
                     memcpy((char*)buffer+availableBytes, 
-                           myFileBuffer, copySize);
+                           myReadBuffer, copySize);
 
                     // set the buffer index to the location after what we are
                     // returning as read.
@@ -317,6 +389,37 @@ public:
     /// \return 1 if tab is found, 0 if new line, and -1 for EOF.
     int readTilTab(std::string& field);
 
+    /// Read until the specified characters without copying, returning which
+    /// character was found causing the stop and -1 for EOF.  field is set to
+    /// point at the read characters (not including the stop char) and length
+    /// to the number of them.  field normally points into this object's read
+    /// buffer; it is only copied if it spans a buffer refill.  The returned
+    /// pointer is only valid until the next read from or seek on this file.
+    /// \param stopChars characters to stop reading when they are hit.
+    /// \param field set to the start of the read characters.
+    /// \param length set to the number of read characters.
+    /// \return index of the character in stopChars that caused it to stop
+    /// reading or -1 for EOF.
+    int readTilCharView(const std::string& stopChars,
+                        const char*& field, int& length);
+
+    /// Read until new line or EOF without copying, returning -1 if EOF is
+    /// found first and 0 if new line is found first.  See readTilCharView
+    /// for how long the returned pointer is valid.
+    /// \param line set to the start of the line (not including the new line).
+    /// \param length set to the number of characters in the line.
+    /// \return 0 if new line and -1 for EOF.
+    int readLineView(const char*& line, int& length);
+
+    /// Read until tab, new line, or EOF without copying, returning -1 if EOF
+    /// is found first, 0 if new line is found first, or 1 if a tab is found
+    /// first.  See readTilCharView for how long the returned pointer is valid.
+    /// \param field set to the start of the field (not including the tab,
+    /// new line, or eof).
+    /// \param length set to the number of characters in the field.
+    /// \return 1 if tab is found, 0 if new line, and -1 for EOF.
+    int readTilTabView(const char*& field, int& length);
+
     /// Get a character from the file.  Read a character from the internal
     /// buffer, or if the end of the buffer has been reached, read from the
     /// file into the buffer and return index 0.
@@ -326,7 +429,7 @@ public:
         if (myBufferIndex >= myCurrentBufferSize)
         {
             // at the last index, read a new buffer.
-            myCurrentBufferSize = readFromFile(myFileBuffer, myAllocatedBufferSize);
+            myCurrentBufferSize = fillBuffer();
             myBufferIndex = 0;
             // If the buffer index is still greater than or equal to the
             // myCurrentBufferSize, then we failed to read the file - return EOF.
@@ -337,7 +440,31 @@ public:
                 return(EOF);
             }
         }
-        return(myFileBuffer[myBufferIndex++]);
+        return(myReadBuffer[myBufferIndex++]);
+    }
+
+    /// Copy up to size characters from the current position without
+    /// consuming them, so the next read still returns them.  Only looks in
+    /// the read buffer (refilling it if it has all been read), so fewer
+    /// characters are copied if the buffer ends first or buffering is
+    /// disabled.  Used to check the magic at the start of a file that may
+    /// not be seekable, like stdin.
+    /// \param buffer the buffer into which the characters are copied.
+    /// \param size the maximum number of characters to copy.
+    /// \return the number of characters copied, 0 at EOF.
+    inline unsigned int ifpeek(void * buffer, unsigned int size)
+    {
+        if(!loadBuffer())
+        {
+            return(0);
+        }
+        unsigned int availableBytes = myCurrentBufferSize - myBufferIndex;
+        if(size > availableBytes)
+        {
+            size = availableBytes;
+        }
+        memcpy(buffer, myReadBuffer + myBufferIndex, size);
+        return(size);
     }
 
     /// Get a line from the file.
@@ -498,6 +625,26 @@ public:
     bool openFile(const char * filename, const char * mode,
                   InputFile::ifileCompression compressionMode);
 
+    /// Open a block of memory for reading as if it were an uncompressed
+    /// file, closing any file that was already open.  The reads scan the
+    /// memory directly without copying it.  The memory must stay valid and
+    /// unchanged until this is closed or another file is opened.
+    /// \param data memory to read.
+    /// \param length number of bytes of data.
+    /// \return true if the memory was opened.
+    bool openBuffer(const char* data, int64_t length);
+
+    /// Set whether uncompressed files opened for reading after this call
+    /// are memory mapped rather than read through a buffer.  Reading then
+    /// scans the mapping directly without copying it.  Only regular,
+    /// non-empty files are mapped, others are read as usual.
+    /// Defaults to false.
+    /// \param useMemoryMap true to memory map uncompressed files.
+    static void setUseMemoryMap(bool useMemoryMap)
+    {
+        ourUseMemoryMap = useMemoryMap;
+    }
+
 protected:
     // Read into a buffer from the file.  Since the buffer is passed in and
     // this would bypass the myFileBuffer used by this class, this method must
@@ -512,6 +659,57 @@ protected:
         return myFileTypePtr->read(buffer, size);
     }
 
+    // Refill the read buffer from the file, returning the number of bytes
+    // now in it.  Memory mapped files point the read buffer at the next
+    // piece of the mapping instead of copying into myFileBuffer.
+    inline int fillBuffer()
+    {
+        if (myFileTypePtr != NULL)
+        {
+            int viewSize = myFileTypePtr->readView(myReadBuffer, MAX_VIEW_SIZE);
+            if(viewSize >= 0)
+            {
+                return(viewSize);
+            }
+        }
+        myReadBuffer = myFileBuffer;
+        return(readFromFile(myFileBuffer, myAllocatedBufferSize));
+    }
+
+    // Make sure there is unread data in the read buffer, refilling it if
+    // it has all been read.  Returns false at EOF.
+    inline bool loadBuffer()
+    {
+        if (myBufferIndex < myCurrentBufferSize)
+        {
+            return(true);
+        }
+        myCurrentBufferSize = fillBuffer();
+        myBufferIndex = 0;
+        if (myCurrentBufferSize <= 0)
+        {
+            myCurrentBufferSize = 0;
+            return(false);
+        }
+        return(true);
+    }
+
+    // Scan for the first of numStopChars stopChars, setting field/length to
+    // the characters before it and returning the index of the stop char
+    // found or -1 for EOF.  If keepField is false, the characters are
+    // skipped and field/length are not set.
+    int scanTilChar(const char* stopChars, int numStopChars,
+                    const char*& field, int& length, bool keepField);
+
+    // Tell the file type whether reads are buffered and wrap it in a
+    // ReadAheadFileType if reads should be done by a background thread
+    // (unwrapping it if they no longer should be).
+    void setupBuffering();
+
+    // Open an uncompressed file, memory mapping it if that is enabled
+    // and the file is being read.
+    void openUncompressedFile(const char* filename, const char* mode);
+
 #ifdef __ZLIB_AVAILABLE__
     // Only necessary with zlib to determine what file type on a new
     // file.  Without zlib, there are only uncompressed files, so a special
@@ -525,6 +723,12 @@ protected:
     // The size of the buffer used by this class.
     static const unsigned int DEFAULT_BUFFER_SIZE = 65536;
 
+    // Largest piece of a memory mapped file handed out at a time, keeps
+    // the buffer indices within an int.
+    static const unsigned int MAX_VIEW_SIZE = 1 << 30;
+
+    static bool ourUseMemoryMap;
+
     // Pointer to a class that interfaces with different file types.
     FileType* myFileTypePtr;
 
@@ -534,6 +738,10 @@ protected:
     // from the file.  The class is then managed to iterate through the buffer.
     char* myFileBuffer;
 
+    // Data currently being read: myFileBuffer or, for memory mapped files,
+    // a piece of the mapping.
+    const char* myReadBuffer;
+
     // Current index into the buffer.  Used to track where we are in reading the
     // file from the buffer.
     int myBufferIndex;
@@ -543,7 +751,22 @@ protected:
     // end of what was read.
     int myCurrentBufferSize;
 
+    // Holds a field returned by the view methods when it spans a refill.
+    std::string mySpillBuffer;
+
     std::string myFileName;
+
+    // Number of worker threads to use for the file, 0 for none.
+    int myNumThreads;
+
+    // Number of buffers to read ahead into, 1 to not read ahead.
+    unsigned int myNumBuffers;
+
+    // Whether myFileTypePtr is a ReadAheadFileType.
+    bool myReadingAhead;
+
+    // Whether the open file was opened for reading.
+    bool myOpenForRead;
 };
 
 
@@ -558,9 +781,12 @@ typedef InputFile* IFILE;
 /// \param compressionMode set the type of file to open for writing or
 /// for reading from stdin (when reading files not from stdin, the compression
 /// type is determined by reading the file).
+/// \param numThreads number of worker threads to use for BGZF files
+/// (see InputFile::setNumThreads), 0 for none.
 /// \return IFILE - pointer to the InputFile object that has been opened.
 inline IFILE ifopen(const char * filename, const char * mode,
-                    InputFile::ifileCompression compressionMode = InputFile::DEFAULT)
+                    InputFile::ifileCompression compressionMode = InputFile::DEFAULT,
+                    int numThreads = 0)
 {
     IFILE file = new InputFile(filename, mode, compressionMode);
     if (!file->isOpen())
@@ -570,6 +796,10 @@ inline IFILE ifopen(const char * filename, const char * mode,
         delete file;
         file = NULL;
     }
+    else if(numThreads > 0)
+    {
+        file->setNumThreads(numThreads);
+    }
     return file;
 }
 
@@ -356,6 +356,16 @@ int MemoryMap::prefetch()
     return sum;
 }
 
+int MemoryMap::adviseSequential()
+{
+#if defined(_WIN32)
+    return 0;
+#else
+    if (!useMemoryMapFlag || data == NULL) return 0;
+    return madvise(data, mapped_length, MADV_SEQUENTIAL);
+#endif
+}
+
 #if defined(TEST)
 //
 // compile test using:
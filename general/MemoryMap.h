@@ -219,6 +219,11 @@ public:
     };
     int prefetch();     // force pages into RAM
 
+    /// Tell the operating system the mapping will be read front to back,
+    /// so it can read ahead aggressively and drop pages already read.
+    /// \return 0 on success.
+    int adviseSequential();
+
     //
     // set or unset use of mmap() call in ::open().
     // This flag must be set before ::open() is called,
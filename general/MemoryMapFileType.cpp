@@ -0,0 +1,45 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/stat.h>
+#include "MemoryMapFileType.h"
+
+MemoryMapFileType::MemoryMapFileType(const char * filename)
+    : myIsOpen(false),
+      myPosition(0),
+      myLength(0)
+{
+    // Only map regular files; pipes and devices can't be mapped and
+    // empty files can't either, so leave those to UncompressedFileType.
+    struct stat fileStat;
+    if((stat(filename, &fileStat) != 0) || !S_ISREG(fileStat.st_mode) ||
+       (fileStat.st_size == 0))
+    {
+        return;
+    }
+
+    // MemoryMap::open returns false on success.
+    if(myMap.open(filename))
+    {
+        return;
+    }
+    myIsOpen = true;
+    myLength = myMap.length();
+
+    // The file is read front to back.
+    myMap.adviseSequential();
+}
@@ -0,0 +1,161 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MEMORYMAPFILETYPE_H__
+#define __MEMORYMAPFILETYPE_H__
+
+#include <stdio.h>
+#include <string.h>
+#include "FileType.h"
+#include "MemoryMap.h"
+
+// Read-only uncompressed file that is memory mapped rather than read
+// through stdio.  readView hands out pointers into the mapping so
+// InputFile can scan the file without copying it into its buffer.
+class MemoryMapFileType : public FileType
+{
+public:
+    MemoryMapFileType()
+    {
+        myIsOpen = false;
+        myPosition = 0;
+        myLength = 0;
+    }
+
+    virtual ~MemoryMapFileType()
+    {
+        close();
+    }
+
+    // Map the specified file for reading.  Fails (isOpen returns false)
+    // for anything but non-empty regular files.
+    MemoryMapFileType(const char * filename);
+
+    bool operator == (void * rhs)
+    {
+        // No two file pointers are the same, so if rhs is not NULL, then
+        // the two pointers are different (false).
+        if (rhs != NULL)
+            return false;
+        return(!myIsOpen);
+    }
+
+    bool operator != (void * rhs)
+    {
+        if (rhs != NULL)
+            return true;
+        return(myIsOpen);
+    }
+
+    // Close the file.
+    inline int close()
+    {
+        if(myIsOpen)
+        {
+            myMap.close();
+            myIsOpen = false;
+        }
+        myPosition = 0;
+        myLength = 0;
+        return 0;
+    }
+
+    // Reset to the beginning of the file.
+    inline void rewind()
+    {
+        myPosition = 0;
+    }
+
+    // Check to see if we have reached the EOF.
+    inline int eof()
+    {
+        return(myPosition >= myLength);
+    }
+
+    // Check to see if the file is open.
+    virtual inline bool isOpen()
+    {
+        return(myIsOpen);
+    }
+
+    // Write to the file - not supported, the mapping is read only.
+    inline unsigned int write(const void * buffer, unsigned int size)
+    {
+        return 0;
+    }
+
+    // Read into a buffer from the file.
+    inline int read(void * buffer, unsigned int size)
+    {
+        const char* data;
+        int numBytes = readView(data, size);
+        memcpy(buffer, data, numBytes);
+        return(numBytes);
+    }
+
+    // Point data at the next bytes of the mapping.
+    virtual inline int readView(const char*& data, unsigned int size)
+    {
+        data = (const char*)myMap.data + myPosition;
+        int64_t available = myLength - myPosition;
+        if(available < (int64_t)size)
+        {
+            size = available;
+        }
+        myPosition += size;
+        return(size);
+    }
+
+    // Get current position in the file.
+    virtual inline int64_t tell()
+    {
+        return(myPosition);
+    }
+
+    // Seek to the specified offset from the origin.
+    // origin can be any of the following:
+    //   SEEK_SET - Beginning of file
+    //   SEEK_CUR - Current position of the file pointer
+    //   SEEK_END - End of file
+    // Returns true on successful seek and false on a failed seek.
+    virtual inline bool seek(int64_t offset, int origin)
+    {
+        int64_t newPosition = offset;
+        if(origin == SEEK_CUR)
+        {
+            newPosition += myPosition;
+        }
+        else if(origin == SEEK_END)
+        {
+            newPosition += myLength;
+        }
+        if((newPosition < 0) || (newPosition > myLength))
+        {
+            return false;
+        }
+        myPosition = newPosition;
+        return true;
+    }
+
+protected:
+    MemoryMap myMap;
+    bool myIsOpen;
+    int64_t myPosition;
+    int64_t myLength;
+};
+
+#endif
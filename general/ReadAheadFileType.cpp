@@ -0,0 +1,395 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReadAheadFileType.h"
+
+#ifdef __PTHREAD_AVAILABLE__
+
+#include <string.h>
+#include <stdexcept>
+
+ReadAheadFileType::ReadAheadFileType(FileType* fileType,
+                                     unsigned int bufferSize,
+                                     unsigned int numBuffers)
+    : myFileType(fileType),
+      myBuffers(NULL),
+      myNumBuffers(numBuffers),
+      myBufferSize(bufferSize),
+      myThreadRunning(false),
+      myStopThread(false)
+{
+    // Need at least one buffer to read while the other is filled.
+    if(myNumBuffers < 2)
+    {
+        myNumBuffers = 2;
+    }
+    myBuffers = new Buffer[myNumBuffers];
+    for(unsigned int i = 0; i < myNumBuffers; i++)
+    {
+        myBuffers[i].data = new char[myBufferSize];
+        myBuffers[i].size = 0;
+        myBuffers[i].endTell = 0;
+    }
+    pthread_mutex_init(&myMutex, NULL);
+    pthread_cond_init(&myFilledCond, NULL);
+    pthread_cond_init(&myFreeCond, NULL);
+
+    // The reader can only use tell if the wrapped file allows it while
+    // buffered (bgzf does not since it can't tell within a buffer).  This
+    // class still needs the wrapped file's position at the end of each
+    // buffer, so the wrapped file itself is treated as unbuffered.
+    myTellSupported = true;
+    try
+    {
+        myFileType->tell();
+    }
+    catch(std::exception& e)
+    {
+        myTellSupported = false;
+    }
+    myFileType->setBuffered(false);
+
+    clearBuffers();
+    startThread();
+}
+
+
+ReadAheadFileType::~ReadAheadFileType()
+{
+    stopThread();
+    delete myFileType;
+    myFileType = NULL;
+    for(unsigned int i = 0; i < myNumBuffers; i++)
+    {
+        delete[] myBuffers[i].data;
+    }
+    delete[] myBuffers;
+    pthread_cond_destroy(&myFreeCond);
+    pthread_cond_destroy(&myFilledCond);
+    pthread_mutex_destroy(&myMutex);
+}
+
+
+int ReadAheadFileType::close()
+{
+    stopThread();
+    clearBuffers();
+    if(myFileType == NULL)
+    {
+        return(EOF);
+    }
+    return(myFileType->close());
+}
+
+
+void ReadAheadFileType::rewind()
+{
+    if(myFileType == NULL)
+    {
+        return;
+    }
+    stopThread();
+    myFileType->rewind();
+    clearBuffers();
+    startThread();
+}
+
+
+int ReadAheadFileType::eof()
+{
+    if(myIndex < myCurrentSize)
+    {
+        return(false);
+    }
+    // Wait to see if there is another buffer, but do not take it since
+    // the caller may still be using the current one.
+    pthread_mutex_lock(&myMutex);
+    while((myNumFilled == 0) && !myDone && myThreadRunning)
+    {
+        pthread_cond_wait(&myFilledCond, &myMutex);
+    }
+    bool atEof = (myNumFilled == 0);
+    pthread_mutex_unlock(&myMutex);
+    return(atEof);
+}
+
+
+bool ReadAheadFileType::isOpen()
+{
+    if(myFileType == NULL)
+    {
+        return(false);
+    }
+    return(myFileType->isOpen());
+}
+
+
+unsigned int ReadAheadFileType::write(const void * buffer, unsigned int size)
+{
+    return(0);
+}
+
+
+int ReadAheadFileType::read(void * buffer, unsigned int size)
+{
+    unsigned int numRead = 0;
+    while((numRead < size) && loadBuffer())
+    {
+        unsigned int copySize = myCurrentSize - myIndex;
+        if(copySize > size - numRead)
+        {
+            copySize = size - numRead;
+        }
+        memcpy((char*)buffer + numRead, myCurrentData + myIndex, copySize);
+        myIndex += copySize;
+        numRead += copySize;
+    }
+    if(numRead == 0)
+    {
+        // Nothing read, so return what the wrapped file returned at EOF.
+        return(myLastRead);
+    }
+    return(numRead);
+}
+
+
+int ReadAheadFileType::readView(const char*& data, unsigned int size)
+{
+    if(!loadBuffer())
+    {
+        return(myLastRead);
+    }
+    unsigned int viewSize = myCurrentSize - myIndex;
+    if(viewSize > size)
+    {
+        viewSize = size;
+    }
+    data = myCurrentData + myIndex;
+    myIndex += viewSize;
+    return(viewSize);
+}
+
+
+int64_t ReadAheadFileType::tell()
+{
+    if(myFileType == NULL)
+    {
+        return(-1);
+    }
+    if(!myTellSupported)
+    {
+        throw std::runtime_error("IFILE: CANNOT use buffered reads and tell for BGZF files");
+    }
+    return(myCurrentEndTell - (myCurrentSize - myIndex));
+}
+
+
+bool ReadAheadFileType::seek(int64_t offset, int origin)
+{
+    if(myFileType == NULL)
+    {
+        return(false);
+    }
+    if((origin == SEEK_CUR) && myTellSupported)
+    {
+        // The wrapped file is ahead of the reader, so make it absolute.
+        offset += tell();
+        origin = SEEK_SET;
+    }
+    stopThread();
+    bool result = myFileType->seek(offset, origin);
+    clearBuffers();
+    startThread();
+    return(result);
+}
+
+
+bool ReadAheadFileType::setNumThreads(int numThreads)
+{
+    if(myFileType == NULL)
+    {
+        return(false);
+    }
+    // Pause reading ahead while the wrapped file is changed.
+    stopThread();
+    bool result = myFileType->setNumThreads(numThreads);
+    startThread();
+    return(result);
+}
+
+
+FileType* ReadAheadFileType::release()
+{
+    stopThread();
+    if((myFileType != NULL) && (myNumFilled > 0))
+    {
+        // Move the wrapped file back to where the reader is.  If the
+        // position within the current buffer isn't known, continue after
+        // it, the same as when InputFile drops its buffer.
+        if(myTellSupported)
+        {
+            myFileType->seek(tell(), SEEK_SET);
+        }
+        else
+        {
+            myFileType->seek(myCurrentEndTell, SEEK_SET);
+        }
+    }
+    FileType* fileType = myFileType;
+    myFileType = NULL;
+    clearBuffers();
+    return(fileType);
+}
+
+
+void* ReadAheadFileType::readAheadThread(void* arg)
+{
+    ((ReadAheadFileType*)arg)->readAhead();
+    return(NULL);
+}
+
+
+void ReadAheadFileType::readAhead()
+{
+    pthread_mutex_lock(&myMutex);
+    while(true)
+    {
+        // Wait for a free buffer.
+        while(!myStopThread && !myDone &&
+              ((myNumFilled + (myHolding ? 1 : 0)) >= myNumBuffers))
+        {
+            pthread_cond_wait(&myFreeCond, &myMutex);
+        }
+        if(myStopThread || myDone)
+        {
+            break;
+        }
+        Buffer& buffer = myBuffers[(myHead + myNumFilled) % myNumBuffers];
+        pthread_mutex_unlock(&myMutex);
+
+        // Only this thread uses the wrapped file while it is running.
+        int readSize = myFileType->read(buffer.data, myBufferSize);
+        int64_t endTell = 0;
+        if(readSize > 0)
+        {
+            endTell = myFileType->tell();
+        }
+
+        pthread_mutex_lock(&myMutex);
+        if(readSize <= 0)
+        {
+            myDone = true;
+            myLastRead = readSize;
+        }
+        else
+        {
+            buffer.size = readSize;
+            buffer.endTell = endTell;
+            ++myNumFilled;
+        }
+        pthread_cond_broadcast(&myFilledCond);
+    }
+    pthread_mutex_unlock(&myMutex);
+}
+
+
+void ReadAheadFileType::startThread()
+{
+    if((myFileType == NULL) || myThreadRunning)
+    {
+        return;
+    }
+    myStopThread = false;
+    if(pthread_create(&myThread, NULL, readAheadThread, this) != 0)
+    {
+        throw(std::runtime_error("IFILE: Failed to start the read ahead thread"));
+    }
+    myThreadRunning = true;
+}
+
+
+void ReadAheadFileType::stopThread()
+{
+    if(!myThreadRunning)
+    {
+        return;
+    }
+    pthread_mutex_lock(&myMutex);
+    myStopThread = true;
+    pthread_cond_broadcast(&myFreeCond);
+    pthread_mutex_unlock(&myMutex);
+    pthread_join(myThread, NULL);
+    myThreadRunning = false;
+}
+
+
+void ReadAheadFileType::clearBuffers()
+{
+    myHead = 0;
+    myNumFilled = 0;
+    myHolding = false;
+    myCurrentData = NULL;
+    myCurrentSize = 0;
+    myIndex = 0;
+    myDone = false;
+    myLastRead = 0;
+    myCurrentEndTell = 0;
+    if(myFileType != NULL)
+    {
+        myCurrentEndTell = myFileType->tell();
+    }
+}
+
+
+bool ReadAheadFileType::loadBuffer()
+{
+    if(myIndex < myCurrentSize)
+    {
+        return(true);
+    }
+    pthread_mutex_lock(&myMutex);
+    if(myHolding)
+    {
+        // Done with the current buffer, so the thread can refill it.
+        myHolding = false;
+        myCurrentData = NULL;
+        myCurrentSize = 0;
+        myIndex = 0;
+        pthread_cond_signal(&myFreeCond);
+    }
+    while((myNumFilled == 0) && !myDone && myThreadRunning)
+    {
+        pthread_cond_wait(&myFilledCond, &myMutex);
+    }
+    if(myNumFilled == 0)
+    {
+        pthread_mutex_unlock(&myMutex);
+        return(false);
+    }
+    Buffer& buffer = myBuffers[myHead];
+    myHead = (myHead + 1) % myNumBuffers;
+    --myNumFilled;
+    myHolding = true;
+    myCurrentData = buffer.data;
+    myCurrentSize = buffer.size;
+    myIndex = 0;
+    myCurrentEndTell = buffer.endTell;
+    pthread_mutex_unlock(&myMutex);
+    return(true);
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __READAHEADFILETYPE_H__
+#define __READAHEADFILETYPE_H__
+
+#ifdef __PTHREAD_AVAILABLE__
+
+#include <pthread.h>
+#include <stdio.h>
+#include "FileType.h"
+
+// Wraps a FileType that is open for reading and uses a background thread
+// to read the next buffers of it while the current one is being
+// processed.  The wrapped file does the actual reading (and decompression
+// for gzip/bgzf), so this works with any of the other file types.
+// Buffers are handed out in order through read/readView, and seek/rewind
+// stop the thread, drop the buffers read ahead, and restart it at the
+// new position.
+class ReadAheadFileType : public FileType
+{
+public:
+    // Take ownership of fileType and start reading ahead of its current
+    // position into numBuffers buffers of bufferSize bytes each.  One
+    // buffer is held by the reader, the others are filled ahead of it.
+    ReadAheadFileType(FileType* fileType, unsigned int bufferSize,
+                      unsigned int numBuffers);
+
+    // Stops the thread and deletes the wrapped file.
+    virtual ~ReadAheadFileType();
+
+    bool operator == (void * rhs)
+    {
+        if(myFileType == NULL)
+        {
+            return(rhs == NULL);
+        }
+        return(*myFileType == rhs);
+    }
+
+    bool operator != (void * rhs)
+    {
+        return(!(*this == rhs));
+    }
+
+    // Close the file.
+    int close();
+
+    // Reset to the beginning of the file.
+    void rewind();
+
+    // Check to see if we have reached the EOF, waiting for the next
+    // buffer if it has not yet been read.
+    int eof();
+
+    // Check to see if the file is open.
+    bool isOpen();
+
+    // Write to the file - not supported, only used for reading.
+    unsigned int write(const void * buffer, unsigned int size);
+
+    // Read into a buffer from the file.
+    int read(void * buffer, unsigned int size);
+
+    // Point data at the next bytes of the current buffer, moving on to
+    // the next buffer once it has all been handed out.  data is valid
+    // until the next read/readView/seek.
+    int readView(const char*& data, unsigned int size);
+
+    // Get current position in the file: the position after the data
+    // handed out so far.  Follows the wrapped file's rules, so it throws
+    // for buffered bgzf files.
+    int64_t tell();
+
+    // Seek to the specified offset from the origin, restarting the read
+    // ahead from there.  SEEK_CUR is relative to tell().
+    bool seek(int64_t offset, int origin);
+
+    // Set the number of worker threads of the wrapped file.
+    bool setNumThreads(int numThreads);
+
+    // Stop reading ahead and return the wrapped file, which the caller then
+    // owns.  The data read ahead is dropped and the wrapped file is moved
+    // back to the position after the data handed out so far (for bgzf,
+    // after the current buffer).  The caller must reset the wrapped
+    // file's buffered setting.  This object is left without a file.
+    FileType* release();
+
+private:
+    struct Buffer
+    {
+        char* data;
+        int size;
+        // Position of the wrapped file after this buffer was read.
+        int64_t endTell;
+    };
+
+    static void* readAheadThread(void* arg);
+    void readAhead();
+
+    // Start/stop the read ahead thread.  Buffers already read are kept,
+    // so stopping and starting again continues where it left off.
+    void startThread();
+    void stopThread();
+
+    // Drop the buffers that were read ahead and reset the position to
+    // the wrapped file's current position.
+    void clearBuffers();
+
+    // Make sure there is unread data in the current buffer, waiting for
+    // the thread to read the next one if necessary.  Returns false at EOF.
+    bool loadBuffer();
+
+    FileType* myFileType;
+
+    Buffer* myBuffers;
+    unsigned int myNumBuffers;
+    unsigned int myBufferSize;
+
+    // Index of the next filled buffer to hand out; filled buffers follow
+    // it in the ring and the one being read precedes it.
+    unsigned int myHead;
+    // Number of filled buffers that have not been handed out.
+    unsigned int myNumFilled;
+    // Whether the reader holds the buffer before myHead.
+    bool myHolding;
+    // Current buffer being read and the position in it.
+    const char* myCurrentData;
+    int myCurrentSize;
+    int myIndex;
+    // Tell of the wrapped file at the end of the current buffer.
+    int64_t myCurrentEndTell;
+
+    // Whether tell can be used while reading ahead, which needs positions
+    // within a buffer to be offsets from its start.
+    bool myTellSupported;
+    // Set when the thread hit EOF or an error, myLastRead is the value
+    // its read returned.
+    bool myDone;
+    int myLastRead;
+
+    pthread_t myThread;
+    bool myThreadRunning;
+    bool myStopThread;
+    pthread_mutex_t myMutex;
+    // Signalled when a buffer is filled or the thread is done.
+    pthread_cond_t myFilledCond;
+    // Signalled when a buffer is freed or the thread should stop.
+    pthread_cond_t myFreeCond;
+};
+
+#endif
+
+#endif
@@ -52,6 +52,10 @@ public:
 
     void rmLast();
 
+    /// Exchange the contents of this vector with another, without copying
+    /// or reallocating any of the entries.
+    void swap(ReusableVector& other);
+
 protected:
     std::vector<DATA_TYPE*> myCont;
     unsigned int myNextEmpty;
@@ -140,4 +144,13 @@ void ReusableVector<DATA_TYPE>::rmLast()
     }
 }
 
+template <class DATA_TYPE>
+void ReusableVector<DATA_TYPE>::swap(ReusableVector& other)
+{
+    myCont.swap(other.myCont);
+    unsigned int nextEmpty = myNextEmpty;
+    myNextEmpty = other.myNextEmpty;
+    other.myNextEmpty = nextEmpty;
+}
+
 #endif
@@ -0,0 +1,168 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compare the speed of the BasePacking conversions with each instruction
+// set the processor supports, in bases per second, for short (150 bp) and
+// long (10 kb) reads.
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "BasePacking.h"
+
+static const char* LEVEL_NAMES[] = {"scalar", "sse4", "avx2"};
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start)
+{
+    return(std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start).count());
+}
+
+
+// Run each conversion over numReads reads of readLength bases, reporting
+// millions of bases per second.
+static void benchmark(BasePacking::SimdLevel level, int readLength,
+                      int numReads)
+{
+    std::vector<char> bases(readLength);
+    std::vector<char> ref(readLength);
+    std::vector<char> quality(readLength);
+    std::vector<char> result(readLength);
+    std::vector<uint8_t> packedBases((readLength + 1) / 2);
+    std::vector<uint8_t> packedQuality(readLength);
+    static const char* chars = "ACGT";
+    srand(1);
+    for(int i = 0; i < readLength; i++)
+    {
+        bases[i] = chars[rand() % 4];
+        // Mostly matches the reference.
+        ref[i] = (rand() % 50) ? bases[i] : chars[rand() % 4];
+        quality[i] = 33 + rand() % 42;
+    }
+
+    BasePacking::setSimdLevel(level);
+    double megabases = (double)readLength * numReads / 1000000;
+    // Keeps the compiler from skipping the work.
+    int check = 0;
+
+    std::cout << std::setw(8) << std::left << LEVEL_NAMES[level]
+              << std::setw(8) << std::right << readLength
+              << std::fixed << std::setprecision(1);
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for(int i = 0; i < numReads; i++)
+    {
+        check += BasePacking::packSequence(&bases[0], readLength,
+                                           &packedBases[0]);
+    }
+    std::cout << std::setw(12) << megabases / elapsedSeconds(start);
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < numReads; i++)
+    {
+        BasePacking::unpackSequence(&packedBases[0], readLength, &result[0]);
+        check += result[i % readLength];
+    }
+    std::cout << std::setw(12) << megabases / elapsedSeconds(start);
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < numReads; i++)
+    {
+        BasePacking::packQuality(&quality[0], readLength, &packedQuality[0]);
+        check += packedQuality[i % readLength];
+    }
+    std::cout << std::setw(12) << megabases / elapsedSeconds(start);
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < numReads; i++)
+    {
+        check += BasePacking::unpackQuality(&packedQuality[0], readLength,
+                                            &result[0]);
+    }
+    std::cout << std::setw(12) << megabases / elapsedSeconds(start);
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < numReads; i++)
+    {
+        BasePacking::seqWithEquals(&bases[0], &ref[0], readLength, &result[0]);
+        check += result[i % readLength];
+    }
+    std::cout << std::setw(12) << megabases / elapsedSeconds(start);
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < numReads; i++)
+    {
+        BasePacking::seqWithoutEquals(&result[0], &ref[0], readLength,
+                                      &bases[0]);
+        check += bases[i % readLength];
+    }
+    std::cout << std::setw(12) << megabases / elapsedSeconds(start);
+
+    std::cout << std::setw(12) << (check & 0xFF) << std::endl;
+}
+
+
+int main(int argc, char** argv)
+{
+    int megabases = 256;
+    int opt;
+    while((opt = getopt(argc, argv, "m:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'm':
+                megabases = atoi(optarg);
+                break;
+            default:
+                std::cerr << "Usage: " << argv[0] << " [-m megabases]\n";
+                return(1);
+        }
+    }
+
+    std::cout << std::setw(8) << std::left << "simd"
+              << std::setw(8) << std::right << "length"
+              << std::setw(12) << "pack Mb/s"
+              << std::setw(12) << "unpack Mb/s"
+              << std::setw(12) << "qual Mb/s"
+              << std::setw(12) << "unqual Mb/s"
+              << std::setw(12) << "toEq Mb/s"
+              << std::setw(12) << "fromEq Mb/s"
+              << std::setw(12) << "check" << std::endl;
+
+    BasePacking::SimdLevel origLevel = BasePacking::getSimdLevel();
+    static const int READ_LENGTHS[] = {150, 10000};
+    for(int lengthIndex = 0; lengthIndex < 2; lengthIndex++)
+    {
+        int readLength = READ_LENGTHS[lengthIndex];
+        int numReads = (int)((double)megabases * 1000000 / readLength);
+        if(numReads < 1)
+        {
+            numReads = 1;
+        }
+        for(int level = BasePacking::SCALAR;
+            level <= BasePacking::getMaxSimdLevel(); level++)
+        {
+            benchmark((BasePacking::SimdLevel)level, readLength, numReads);
+        }
+    }
+    BasePacking::setSimdLevel(origLevel);
+    return(0);
+}
@@ -15,12 +15,18 @@
  *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "BaseUtilitiesTest.h"
+#include "BasePacking.h"
 #include <assert.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
 #include <iostream>
+#include <vector>
 
 int main(int argc, char ** argv)
 {
     testReverseComplement();
+    testBasePacking();
 }
 
 void testReverseComplement()
@@ -39,3 +45,110 @@ void testReverseComplement()
     BaseUtilities::reverseComplement(testString);
     assert(testString == expectedReverse);
 }
+
+
+// Check that each instruction set gives the same results as the scalar
+// versions for lengths that cover the SIMD blocks and the ends.
+void testBasePacking()
+{
+    static const char* chars = "=ACGTNacgtn.ACGTACGTXM*";
+    int numChars = strlen(chars);
+    BasePacking::SimdLevel origLevel = BasePacking::getSimdLevel();
+    srand(1);
+
+    for(int length = 0; length < 300; length++)
+    {
+        std::vector<char> bases(length + 1);
+        std::vector<char> ref(length + 1);
+        std::vector<char> qual(length + 1);
+        std::vector<uint8_t> packedQual(length + 1);
+        // Only include invalid characters in some of the sequences.
+        int charRange = (length % 3 == 0) ? numChars : numChars - 3;
+        for(int i = 0; i < length; i++)
+        {
+            bases[i] = chars[rand() % charRange];
+            ref[i] = (rand() % 2) ? bases[i] : chars[rand() % (numChars - 3)];
+            qual[i] = 33 + rand() % 60;
+            // All qualities are 0xFF for some lengths.
+            packedQual[i] = (length % 4 == 0) ? 0xFF : rand() % 256;
+        }
+
+        // Results from the scalar versions.
+        assert(BasePacking::setSimdLevel(BasePacking::SCALAR));
+        std::vector<uint8_t> expectedPacked((length + 1) / 2 + 1, 0);
+        bool expectedValid = BasePacking::packSequence(&bases[0], length,
+                                                       &expectedPacked[0]);
+        std::vector<char> expectedUnpacked(length + 1, 0);
+        BasePacking::unpackSequence(&expectedPacked[0], length,
+                                    &expectedUnpacked[0]);
+        std::vector<uint8_t> expectedQual(length + 1, 0);
+        BasePacking::packQuality(&qual[0], length, &expectedQual[0]);
+        std::vector<char> expectedQualChars(length + 1, 0);
+        bool expectedQualSpecified =
+            BasePacking::unpackQuality(&packedQual[0], length,
+                                       &expectedQualChars[0]);
+        std::vector<char> expectedEquals(length + 1, 0);
+        BasePacking::seqWithEquals(&bases[0], &ref[0], length,
+                                   &expectedEquals[0]);
+        std::vector<char> expectedBases(length + 1, 0);
+        BasePacking::seqWithoutEquals(&expectedEquals[0], &ref[0], length,
+                                      &expectedBases[0]);
+
+        // Spot check the scalar results.
+        bool valid = true;
+        for(int i = 0; i < length; i++)
+        {
+            if(strchr("XM*", bases[i]) != NULL)
+            {
+                valid = false;
+            }
+        }
+        assert(expectedValid == valid);
+        assert(expectedQualSpecified == ((length % 4 != 0) && (length != 0)));
+        for(int i = 0; i < length; i++)
+        {
+            if(!expectedValid)
+            {
+                break;
+            }
+            char base = toupper(bases[i]);
+            if(base == '.')
+            {
+                base = 'N';
+            }
+            assert(expectedUnpacked[i] == base);
+            assert(expectedQual[i] == qual[i] - 33);
+        }
+
+        for(int level = BasePacking::SSE4;
+            level <= BasePacking::getMaxSimdLevel(); level++)
+        {
+            assert(BasePacking::setSimdLevel((BasePacking::SimdLevel)level));
+            assert(BasePacking::getSimdLevel() == level);
+            std::vector<uint8_t> packed((length + 1) / 2 + 1, 0);
+            assert(BasePacking::packSequence(&bases[0], length, &packed[0]) ==
+                   expectedValid);
+            assert(packed == expectedPacked);
+            std::vector<char> unpacked(length + 1, 0);
+            BasePacking::unpackSequence(&packed[0], length, &unpacked[0]);
+            assert(unpacked == expectedUnpacked);
+            std::vector<uint8_t> packedQuality(length + 1, 0);
+            BasePacking::packQuality(&qual[0], length, &packedQuality[0]);
+            assert(packedQuality == expectedQual);
+            std::vector<char> qualChars(length + 1, 0);
+            assert(BasePacking::unpackQuality(&packedQual[0], length,
+                                              &qualChars[0]) ==
+                   expectedQualSpecified);
+            assert(qualChars == expectedQualChars);
+            std::vector<char> withEquals(length + 1, 0);
+            BasePacking::seqWithEquals(&bases[0], &ref[0], length,
+                                       &withEquals[0]);
+            assert(withEquals == expectedEquals);
+            std::vector<char> withoutEquals(length + 1, 0);
+            BasePacking::seqWithoutEquals(&withEquals[0], &ref[0], length,
+                                          &withoutEquals[0]);
+            assert(withoutEquals == expectedBases);
+        }
+    }
+    assert(BasePacking::setSimdLevel(origLevel));
+}
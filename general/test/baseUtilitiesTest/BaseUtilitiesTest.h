@@ -18,3 +18,4 @@
 #include "BaseUtilities.h"
 
 void testReverseComplement();
+void testBasePacking();
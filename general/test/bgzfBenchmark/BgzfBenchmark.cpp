@@ -0,0 +1,285 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compare the BGZF compression/decompression speed of the available block
+// codecs (zlib and, when built with DEFLATE_BACKEND=libdeflate, libdeflate).
+//
+// Each input file is decompressed and then written and read back with each
+// codec.  Repeating a small file to make up the size would compress far
+// better than real data, so files are used as they are; without files, or
+// with -m, simulated SAM records of the requested size are used instead.
+// The simulated reads are sampled from a random reference with sequencing
+// errors, varying qualities and unique names, so they compress at a ratio
+// close to that of real alignment data.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "InputFile.h"
+#include "BgzfFileType.h"
+
+static const char* TMP_FILE = "results/bgzfBenchmark.bam";
+static const unsigned int CHUNK_SIZE = 1024 * 1024;
+static const int REF_LENGTH = 16 * 1024 * 1024;
+static const int READ_LENGTH = 100;
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start)
+{
+    return(std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start).count());
+}
+
+
+// Read the uncompressed contents of the file.
+static bool readFile(const char* filename, std::string& contents)
+{
+    IFILE file = ifopen(filename, "rb");
+    if(file == NULL)
+    {
+        return(false);
+    }
+    contents.clear();
+    std::vector<char> buffer(CHUNK_SIZE);
+    unsigned int numRead;
+    while((numRead = ifread(file, &(buffer[0]), CHUNK_SIZE)) > 0)
+    {
+        contents.append(&(buffer[0]), numRead);
+    }
+    ifclose(file);
+    return(true);
+}
+
+
+// Small deterministic generator so the simulated data is the same each run.
+class Random
+{
+public:
+    Random(uint64_t seed) : myState(seed) {}
+    uint32_t next(uint32_t range)
+    {
+        myState = myState * 6364136223846793005ULL + 1442695040888963407ULL;
+        return((uint32_t)(myState >> 33) % range);
+    }
+private:
+    uint64_t myState;
+};
+
+
+// Build minMegabytes of SAM records for reads sampled from a random
+// reference, sorted by position.
+static void simulateSam(int minMegabytes, std::string& data)
+{
+    static const char BASES[] = "ACGT";
+    Random random(20260101);
+    std::string reference(REF_LENGTH, 'N');
+    for(int i = 0; i < REF_LENGTH; i++)
+    {
+        reference[i] = BASES[random.next(4)];
+    }
+
+    data = "@HD\tVN:1.6\tSO:coordinate\n@SQ\tSN:1\tLN:";
+    data += std::to_string(REF_LENGTH) + "\n";
+    std::string seq, qual;
+    char line[1024];
+    int pos = 0;
+    for(int readNum = 0;
+        data.length() < (size_t)minMegabytes * 1024 * 1024; readNum++)
+    {
+        pos += random.next(8);
+        if(pos + READ_LENGTH >= REF_LENGTH)
+        {
+            pos = 0;
+        }
+        seq.assign(reference, pos, READ_LENGTH);
+        qual.resize(READ_LENGTH);
+        int mismatches = 0;
+        int q = 30 + random.next(11);
+        for(int i = 0; i < READ_LENGTH; i++)
+        {
+            // Qualities drift down along the read; errors are more
+            // likely at low quality.
+            q += (int)random.next(5) - 2 - (i > 70 ? 1 : 0);
+            q = std::max(2, std::min(41, q));
+            qual[i] = (char)(q + 33);
+            if(random.next(300) < (uint32_t)(45 - q))
+            {
+                seq[i] = BASES[random.next(4)];
+                ++mismatches;
+            }
+        }
+        int flag = (random.next(2) ? 99 : 147);
+        int matePos = pos + 1 + (flag == 99 ? 1 : -1) *
+            (200 + (int)random.next(200));
+        snprintf(line, sizeof(line),
+                 "SIM:1:%d:%d:%d:%d\t%d\t1\t%d\t%d\t%dM\t=\t%d\t%d\t",
+                 1 + readNum / 4000000, 1101 + random.next(1200),
+                 random.next(30000), random.next(30000), flag, pos + 1,
+                 random.next(4) ? 60 : random.next(60), READ_LENGTH,
+                 std::max(1, matePos),
+                 (flag == 99 ? 1 : -1) * (std::abs(matePos - pos) + 99));
+        data += line;
+        data += seq;
+        data += '\t';
+        data += qual;
+        snprintf(line, sizeof(line), "\tNM:i:%d\tAS:i:%d\n",
+                 mismatches, READ_LENGTH - 5 * mismatches);
+        data += line;
+    }
+}
+
+
+// Write and read back the data with the current codec, reporting MB/s.
+static bool benchmark(const char* name, const char* codecName,
+                      const std::string& data, const std::string& writeMode)
+{
+    double megabytes = data.length() / (1024.0 * 1024.0);
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    IFILE file = ifopen(TMP_FILE, writeMode.c_str(), InputFile::BGZF);
+    if(file == NULL)
+    {
+        std::cerr << "Failed to open " << TMP_FILE << " for writing\n";
+        return(false);
+    }
+    for(size_t pos = 0; pos < data.length(); pos += CHUNK_SIZE)
+    {
+        unsigned int len = std::min((size_t)CHUNK_SIZE, data.length() - pos);
+        if(ifwrite(file, data.c_str() + pos, len) != len)
+        {
+            std::cerr << "Failed writing " << TMP_FILE << std::endl;
+            ifclose(file);
+            return(false);
+        }
+    }
+    ifclose(file);
+    double compressSeconds = elapsedSeconds(start);
+
+    std::string readBack;
+    start = std::chrono::steady_clock::now();
+    if(!readFile(TMP_FILE, readBack))
+    {
+        std::cerr << "Failed to open " << TMP_FILE << " for reading\n";
+        return(false);
+    }
+    double decompressSeconds = elapsedSeconds(start);
+
+    if(readBack != data)
+    {
+        std::cerr << codecName << ": data read back from " << TMP_FILE
+                  << " does not match what was written" << std::endl;
+        return(false);
+    }
+
+    struct stat fileStat;
+    uint64_t compressedSize = 0;
+    if(stat(TMP_FILE, &fileStat) == 0)
+    {
+        compressedSize = fileStat.st_size;
+    }
+
+    std::cout << std::setw(30) << std::left << name
+              << std::setw(12) << codecName << std::right << std::fixed
+              << std::setprecision(1)
+              << std::setw(12) << megabytes / compressSeconds
+              << std::setw(12) << megabytes / decompressSeconds
+              << std::setprecision(3)
+              << std::setw(10) << (double)compressedSize / data.length()
+              << std::endl;
+    return(true);
+}
+
+
+int main(int argc, char** argv)
+{
+    int minMegabytes = 0;
+    int level = -1;
+    int opt;
+    while((opt = getopt(argc, argv, "m:l:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'm':
+                minMegabytes = atoi(optarg);
+                break;
+            case 'l':
+                level = atoi(optarg);
+                break;
+            default:
+                std::cerr << "Usage: " << argv[0]
+                          << " [-m minMegabytes] [-l level] [file.bam ...]\n";
+                return(1);
+        }
+    }
+    if((optind >= argc) && (minMegabytes <= 0))
+    {
+        minMegabytes = 64;
+    }
+
+    std::string writeMode = "wb";
+    if((level >= 0) && (level <= 9))
+    {
+        writeMode += (char)('0' + level);
+    }
+
+    std::cout << std::setw(30) << std::left << "file"
+              << std::setw(12) << "codec" << std::right
+              << std::setw(12) << "comp MB/s"
+              << std::setw(12) << "decomp MB/s"
+              << std::setw(10) << "ratio" << std::endl;
+
+    int defaultCodec = bgzf_get_codec();
+    bool success = true;
+    for(int i = (minMegabytes > 0) ? optind - 1 : optind; i < argc; i++)
+    {
+        std::string data;
+        const char* name = "simulated.sam";
+        if(i < optind)
+        {
+            simulateSam(minMegabytes, data);
+        }
+        else
+        {
+            if(!readFile(argv[i], data) || data.empty())
+            {
+                std::cerr << "Failed to read " << argv[i] << std::endl;
+                success = false;
+                continue;
+            }
+            name = strrchr(argv[i], '/');
+            name = (name == NULL) ? argv[i] : name + 1;
+        }
+
+        BgzfFileType::setCodec(BGZF_CODEC_ZLIB);
+        success &= benchmark(name, "zlib", data, writeMode);
+        if(BgzfFileType::setCodec(BGZF_CODEC_LIBDEFLATE))
+        {
+            success &= benchmark(name, "libdeflate", data, writeMode);
+        }
+        BgzfFileType::setCodec(defaultCodec);
+    }
+    unlink(TMP_FILE);
+    return(success ? 0 : 1);
+}
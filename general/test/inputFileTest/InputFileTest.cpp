@@ -17,10 +17,16 @@
 #include "InputFileTest.h"
 #include <assert.h>
 #include <iostream>
+#include <string.h>
+#include <vector>
 #include "StringBasics.h"
 
 void testAdditional(const char *extension);
 void testWrite();
+void testThreads();
+void testMemoryMap();
+void testBuffer();
+void testReadAhead();
 
 
 int main(int argc, char ** argv)
@@ -34,8 +40,16 @@ int main(int argc, char ** argv)
    std::cout << "\nAdditional Tests: " << std::endl;
 
    testAdditional("txt");
+
+   testMemoryMap();
+
+   testBuffer();
+
+   testReadAhead();
 #ifdef __ZLIB_AVAILABLE__
    testAdditional("gz");
+
+   testThreads();
 #endif
 }
 
@@ -1308,4 +1322,396 @@ void testAdditional(const char* extension)
 
     ifclose(testFile);
 
+    // Test the methods that return views into the buffer.
+    testFile = ifopen(fileName.c_str(), "r");
+    assert(testFile != NULL);
+    const char* view = NULL;
+    int length = 0;
+    assert(testFile->readTilCharView(stopChars, view, length) == 0);
+    assert(std::string(view, length) == "AB");
+    assert(testFile->readTilCharView(stopChars, view, length) == 2);
+    assert(std::string(view, length) == "DE");
+    assert(testFile->readTilCharView(stopChars, view, length) == 3);
+    assert(std::string(view, length) == "G\tabcdefg\n1");
+    assert(testFile->readTilChar(stopChars) == 1);
+    assert(testFile->readTilTabView(view, length) == 1);
+    assert(std::string(view, length) == "6");
+    assert(testFile->readTilTabView(view, length) == 0);
+    assert(std::string(view, length) == "hijklm");
+    assert(testFile->readTilTabView(view, length) == 0);
+    assert(std::string(view, length) == "1");
+    assert(testFile->readTilTabView(view, length) == 1);
+    assert(std::string(view, length) == "NOP");
+    assert(testFile->readLineView(view, length) == 0);
+    assert(std::string(view, length) == "QRST\tUVW");
+    assert(testFile->readTilTabView(view, length) == 0);
+    assert(length == 0);
+    assert(testFile->discardLine() == 0);
+    assert(testFile->readLineView(view, length) == -1);
+    assert(std::string(view, length) == "@#$");
+    assert(testFile->readTilTabView(view, length) == -1);
+    assert(length == 0);
+    ifclose(testFile);
+
+    // Fields that span buffer refills are returned whole.
+    fileName = "data/InputFileTestLarge.";
+    fileName += extension;
+    testFile = ifopen(fileName.c_str(), "r");
+    IFILE smallBufferFile = ifopen(fileName.c_str(), "r");
+    assert(testFile != NULL);
+    assert(smallBufferFile != NULL);
+    smallBufferFile->bufferReads(7);
+    int result = 0;
+    while(result != -1)
+    {
+        buffer.clear();
+        result = testFile->readTilTab(buffer);
+        assert(smallBufferFile->readTilTabView(view, length) == result);
+        assert(std::string(view, length) == buffer);
+    }
+    ifclose(testFile);
+    ifclose(smallBufferFile);
+}
+
+
+void testThreads()
+{
+    std::cout << "\nThreaded BgzfFileType Tests:" << std::endl;
+
+    // The large file spans multiple bgzf blocks, verify reading it with
+    // worker threads gives the same contents as the uncompressed file.
+    IFILE txtFile = ifopen("data/InputFileTestLarge.txt", "r");
+    IFILE bgzfFile = ifopen("data/InputFileTestLarge.bam", "r",
+                            InputFile::DEFAULT, 2);
+    assert(txtFile != NULL);
+    assert(bgzfFile != NULL);
+    int txtChar = 0;
+    int numChars = 0;
+    do
+    {
+        txtChar = ifgetc(txtFile);
+        assert(ifgetc(bgzfFile) == txtChar);
+        ++numChars;
+    } while(txtChar != EOF);
+    assert(numChars == 65542);
+    assert(ifeof(bgzfFile));
+    ifclose(txtFile);
+    ifclose(bgzfFile);
+    std::cout << "  Passed threaded read" << std::endl;
+
+    // Seek within and across blocks while the workers read ahead.
+    bgzfFile = ifopen("data/InputFileTestLarge.bam", "r");
+    assert(bgzfFile != NULL);
+    bgzfFile->disableBuffering();
+    assert(bgzfFile->setNumThreads(3));
+    char buffer[65536];
+    assert(ifread(bgzfFile, buffer, 65536) == 65536);
+    int64_t secondBlockPos = iftell(bgzfFile);
+    assert(secondBlockPos != 0);
+    assert(ifread(bgzfFile, buffer, 100) == 5);
+    std::string lastChars(buffer, 5);
+    assert(ifseek(bgzfFile, 0, SEEK_SET));
+    assert(ifread(bgzfFile, buffer, 4) == 4);
+    assert(ifseek(bgzfFile, secondBlockPos, SEEK_SET));
+    assert(ifread(bgzfFile, buffer, 5) == 5);
+    assert(lastChars == std::string(buffer, 5));
+
+    // Turning off the threads continues reading serially.
+    assert(ifseek(bgzfFile, 0, SEEK_SET));
+    assert(ifread(bgzfFile, buffer, 65534) == 65534);
+    assert(bgzfFile->setNumThreads(0));
+    assert(ifread(bgzfFile, buffer, 100) == 7);
+    assert(lastChars == std::string(buffer + 2, 5));
+    ifclose(bgzfFile);
+    std::cout << "  Passed threaded seek" << std::endl;
+
+    // Write a file that spans many blocks with and without worker threads,
+    // the compressed files should be identical.
+    std::string contents;
+    for(int i = 0; contents.length() < 1000000; i++)
+    {
+        contents += "Line ";
+        contents += std::to_string(i);
+        contents += " of the threaded write test\n";
+    }
+    IFILE serialFile = ifopen("results/serialWrite.bam", "w", InputFile::BGZF);
+    IFILE threadedFile = ifopen("results/threadedWrite.bam", "w",
+                                InputFile::BGZF, 3);
+    assert(serialFile != NULL);
+    assert(threadedFile != NULL);
+    // Write in uneven pieces so block boundaries fall mid-write.
+    for(unsigned int pos = 0; pos < contents.length(); pos += 7777)
+    {
+        unsigned int len = contents.length() - pos;
+        if(len > 7777)
+        {
+            len = 7777;
+        }
+        assert(ifwrite(serialFile, contents.c_str() + pos, len) == len);
+        assert(ifwrite(threadedFile, contents.c_str() + pos, len) == len);
+    }
+    assert(ifclose(serialFile) == 0);
+    assert(ifclose(threadedFile) == 0);
+    std::cout << "  Passed threaded write" << std::endl;
+
+    // Blocks of data that does not compress are split into two blocks the
+    // same way as serial writing, and read back the same.
+    std::string noise;
+    unsigned int state = 12345;
+    for(int i = 0; i < 300000; i++)
+    {
+        state = state * 1103515245 + 12345;
+        noise += (char)(state >> 16);
+    }
+    serialFile = ifopen("results/serialNoise.bam", "w", InputFile::BGZF);
+    threadedFile = ifopen("results/threadedNoise.bam", "w",
+                          InputFile::BGZF, 2);
+    assert(serialFile != NULL);
+    assert(threadedFile != NULL);
+    for(unsigned int pos = 0; pos < noise.length(); pos += 7777)
+    {
+        unsigned int len = noise.length() - pos;
+        if(len > 7777)
+        {
+            len = 7777;
+        }
+        assert(ifwrite(serialFile, noise.c_str() + pos, len) == len);
+        assert(ifwrite(threadedFile, noise.c_str() + pos, len) == len);
+    }
+    assert(ifclose(serialFile) == 0);
+    assert(ifclose(threadedFile) == 0);
+    bgzfFile = ifopen("results/threadedNoise.bam", "r");
+    assert(bgzfFile != NULL);
+    std::string readNoise(noise.length() + 1, 0);
+    assert(ifread(bgzfFile, &(readNoise[0]), noise.length() + 1) ==
+           noise.length());
+    readNoise.resize(noise.length());
+    assert(readNoise == noise);
+    ifclose(bgzfFile);
+    std::cout << "  Passed threaded write of incompressible data" << std::endl;
+}
+
+
+void testMemoryMap()
+{
+    std::cout << "\nMemoryMapFileType Tests:" << std::endl;
+
+    InputFile::setUseMemoryMap(true);
+
+    // Read lines and fields straight from the mapping.
+    IFILE mappedFile = ifopen("data/InputFileTest.txt", "r");
+    assert(mappedFile != NULL);
+    std::string field;
+    assert(mappedFile->readTilTab(field) == 0);
+    assert(field == "ABCDabcd1234");
+    field.clear();
+    assert(mappedFile->readLine(field) == 0);
+    assert(field == "EFGefg567");
+    assert(ifgetc(mappedFile) == 'h');
+    assert(iftell(mappedFile) == 24);
+    field.clear();
+    assert(mappedFile->readLine(field) == -1);
+    assert(field == "ijklHIJKL8910");
+    assert(ifeof(mappedFile));
+    assert(ifgetc(mappedFile) == EOF);
+
+    // Seek back and read the rest with ifread.
+    assert(ifseek(mappedFile, 13, SEEK_SET));
+    char buffer[100];
+    assert(ifread(mappedFile, buffer, 100) == 24);
+    assert(std::string(buffer, 24) == IFILE_Test::TEST_FILE_CONTENTS.substr(13));
+    ifrewind(mappedFile);
+    assert(ifgetc(mappedFile) == 'A');
+    ifclose(mappedFile);
+    std::cout << "  Passed mapped read" << std::endl;
+
+    // A larger file matches reading it through the buffer.
+    mappedFile = ifopen("data/InputFileTestLarge.txt", "r");
+    InputFile::setUseMemoryMap(false);
+    IFILE txtFile = ifopen("data/InputFileTestLarge.txt", "r");
+    assert(mappedFile != NULL);
+    assert(txtFile != NULL);
+    std::string mappedLine;
+    std::string txtLine;
+    int mappedResult = 0;
+    int txtResult = 0;
+    while(mappedResult != -1)
+    {
+        mappedLine.clear();
+        txtLine.clear();
+        mappedResult = mappedFile->readTilTab(mappedLine);
+        txtResult = txtFile->readTilTab(txtLine);
+        assert(mappedResult == txtResult);
+        assert(mappedLine == txtLine);
+    }
+    ifclose(mappedFile);
+    ifclose(txtFile);
+    std::cout << "  Passed mapped read of large file" << std::endl;
+}
+
+
+void testBuffer()
+{
+    std::cout << "\nBufferFileType Tests:" << std::endl;
+
+    // Read lines and fields straight from memory.
+    InputFile bufferFile;
+    const std::string& contents = IFILE_Test::TEST_FILE_CONTENTS;
+    assert(bufferFile.openBuffer(contents.data(), contents.size()));
+    assert(bufferFile.isOpen());
+    const char* view = NULL;
+    int length = 0;
+    assert(bufferFile.readTilTabView(view, length) == 0);
+    assert(std::string(view, length) == "ABCDabcd1234");
+    assert(view == contents.data());
+    std::string field;
+    assert(bufferFile.readLine(field) == 0);
+    assert(field == "EFGefg567");
+    char peek[20];
+    assert(bufferFile.ifpeek(peek, 4) == 4);
+    assert(std::string(peek, 4) == "hijk");
+    assert(bufferFile.ifpeek(peek, 20) == 14);
+    assert(ifgetc(&bufferFile) == 'h');
+    assert(iftell(&bufferFile) == 24);
+    assert(bufferFile.readLineView(view, length) == -1);
+    assert(std::string(view, length) == "ijklHIJKL8910");
+    assert(ifeof(&bufferFile));
+    assert(ifgetc(&bufferFile) == EOF);
+
+    // Seek back and read the rest with ifread.
+    assert(ifseek(&bufferFile, 13, SEEK_SET));
+    char buffer[100];
+    assert(ifread(&bufferFile, buffer, 100) == 24);
+    assert(std::string(buffer, 24) == contents.substr(13));
+
+    // Opening another block replaces the first.
+    std::string lines = "line1\nline2\n";
+    assert(bufferFile.openBuffer(lines.data(), lines.size()));
+    field.clear();
+    assert(bufferFile.readLine(field) == 0);
+    assert(field == "line1");
+    assert(bufferFile.readLineView(view, length) == 0);
+    assert(std::string(view, length) == "line2");
+    assert(ifeof(&bufferFile));
+
+    // Fields of every length up to past two words, so the tab/newline
+    // search finds stop characters at each offset within a word.  The
+    // field bytes include ones that differ from a tab or newline only in
+    // the high bit.
+    std::string fieldLines;
+    std::vector<std::string> expected;
+    for(int len = 0; len < 20; len++)
+    {
+        std::string value;
+        for(int i = 0; i < len; i++)
+        {
+            value += (char)((i % 3 == 0) ? ('\t' | 0x80) :
+                            ((i % 3 == 1) ? ('\n' | 0x80) : 'a' + i));
+        }
+        expected.push_back(value);
+        fieldLines += value;
+        fieldLines += (len % 5 == 4) ? '\n' : '\t';
+    }
+    assert(bufferFile.openBuffer(fieldLines.data(), fieldLines.size()));
+    for(unsigned int i = 0; i < expected.size(); i++)
+    {
+        int result = bufferFile.readTilTabView(view, length);
+        assert(result == ((i % 5 == 4) ? 0 : 1));
+        assert(std::string(view, length) == expected[i]);
+    }
+    bufferFile.ifclose();
+    assert(!bufferFile.isOpen());
+    std::cout << "  Passed buffer read" << std::endl;
+}
+
+
+void testReadAhead()
+{
+    std::cout << "\nReadAheadFileType Tests:" << std::endl;
+
+    std::vector<std::string> extensions;
+    extensions.push_back("txt");
+#ifdef __ZLIB_AVAILABLE__
+    extensions.push_back("gz");
+    extensions.push_back("bam");
+#endif
+
+    // Reading ahead returns the same data as reading on this thread,
+    // both field by field and with reads bigger than the buffers.
+    std::string field;
+    std::string aheadField;
+    char buffer[1000];
+    char aheadBuffer[1000];
+    for(unsigned int i = 0; i < extensions.size(); i++)
+    {
+        std::string fileName = "data/InputFileTestLarge." + extensions[i];
+        IFILE file = ifopen(fileName.c_str(), "r");
+        IFILE aheadFile = ifopen(fileName.c_str(), "r");
+        assert(file != NULL);
+        assert(aheadFile != NULL);
+        file->bufferReads(100);
+        aheadFile->bufferReads(100, 3);
+        int result = 0;
+        while(result != -1)
+        {
+            field.clear();
+            aheadField.clear();
+            result = file->readTilTab(field);
+            assert(aheadFile->readTilTab(aheadField) == result);
+            assert(aheadField == field);
+            unsigned int readSize = ifread(file, buffer, 1000);
+            assert(ifread(aheadFile, aheadBuffer, 1000) == readSize);
+            assert(memcmp(buffer, aheadBuffer, readSize) == 0);
+        }
+        assert(ifeof(aheadFile));
+
+        // Rewind and read it again.
+        ifrewind(file);
+        ifrewind(aheadFile);
+        assert(!ifeof(aheadFile));
+        assert(ifread(file, buffer, 1000) == 1000);
+        assert(ifread(aheadFile, aheadBuffer, 1000) == 1000);
+        assert(memcmp(buffer, aheadBuffer, 1000) == 0);
+
+        // Stop reading ahead part way through, which continues after the
+        // buffer being read, just like changing the buffer size does.
+        assert(ifgetc(file) == ifgetc(aheadFile));
+        file->bufferReads(1);
+        aheadFile->bufferReads(1);
+        result = 0;
+        while(result != -1)
+        {
+            field.clear();
+            aheadField.clear();
+            result = file->readTilTab(field);
+            assert(aheadFile->readTilTab(aheadField) == result);
+            assert(aheadField == field);
+        }
+        ifclose(file);
+        ifclose(aheadFile);
+    }
+    std::cout << "  Passed read ahead" << std::endl;
+
+    // Tell and seek within an uncompressed file.
+    IFILE aheadFile = ifopen("data/InputFileTestLarge.txt", "r");
+    assert(aheadFile != NULL);
+    aheadFile->bufferReads(64, 2);
+    assert(iftell(aheadFile) == 0);
+    assert(ifread(aheadFile, buffer, 10) == 10);
+    assert(iftell(aheadFile) == 10);
+    assert(ifread(aheadFile, buffer, 500) == 500);
+    assert(iftell(aheadFile) == 510);
+    assert(ifread(aheadFile, buffer, 100) == 100);
+    assert(ifseek(aheadFile, 510, SEEK_SET));
+    assert(iftell(aheadFile) == 510);
+    assert(ifread(aheadFile, aheadBuffer, 100) == 100);
+    assert(memcmp(buffer, aheadBuffer, 100) == 0);
+    assert(ifseek(aheadFile, -100, SEEK_CUR));
+    assert(ifread(aheadFile, aheadBuffer, 100) == 100);
+    assert(memcmp(buffer, aheadBuffer, 100) == 0);
+    assert(ifseek(aheadFile, 65541, SEEK_SET));
+    assert(ifgetc(aheadFile) == EOF);
+    assert(ifeof(aheadFile));
+    ifclose(aheadFile);
+    std::cout << "  Passed read ahead seek" << std::endl;
 }
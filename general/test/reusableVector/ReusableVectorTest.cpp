@@ -35,7 +35,7 @@ void ReusableVectorTest::test()
 {
     assert(ReusableVectorTestDataType::ourNumDestructs == 0);
     testReuse();
-    assert(ReusableVectorTestDataType::ourNumDestructs == 8);
+    assert(ReusableVectorTestDataType::ourNumDestructs == 9);
 }
 
 
@@ -161,6 +161,20 @@ void ReusableVectorTest::testReuse()
     assert(dataPtr->myValue == 7);
     assert(dataPtr->ourValue == 8);
     assert(testVector.size() == 5);
+
+    // Swap the vectors, the entries move without being reallocated.
+    testVector.swap(testVector2);
+    assert(testVector.size() == 3);
+    assert(testVector2.size() == 5);
+    assert(testVector.get(0).myValue == 3);
+    assert(testVector.get(2).myValue == 6);
+    assert(testInvalidGetIndex(testVector, 3));
+    assert(testVector2.get(0).myValue == 0);
+    assert(testVector2.get(4).myValue == 7);
+    assert(testInvalidGetIndex(testVector2, 5));
+    dataPtr = &(testVector.getNextEmpty());
+    assert(dataPtr->myValue == 8);
+    assert(dataPtr->ourValue == 9);
 }
 
 
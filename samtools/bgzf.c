@@ -29,6 +29,12 @@
 #include <unistd.h>
 #include <assert.h>
 #include <sys/types.h>
+#ifdef __PTHREAD_AVAILABLE__
+#include <pthread.h>
+#endif
+#ifdef __LIBDEFLATE_AVAILABLE__
+#include <libdeflate.h>
+#endif
 #include "bgzf.h"
 
 #ifdef _USE_KNETFILE
@@ -100,6 +106,33 @@ static inline void packInt32(uint8_t *buffer, uint32_t value)
 	buffer[3] = value >> 24;
 }
 
+/* libdeflate state kept for the life of a BGZF handle or a worker thread,
+ * so it is not allocated and freed for every block.  Only one thread may
+ * use a codec_t at a time. */
+typedef struct {
+	int level;
+#ifdef __LIBDEFLATE_AVAILABLE__
+	struct libdeflate_compressor *compressor;
+	struct libdeflate_decompressor *decompressor;
+#endif
+} codec_t;
+
+static void codec_init(codec_t *codec, int level)
+{
+	memset(codec, 0, sizeof(codec_t));
+	codec->level = level;
+}
+
+static void codec_free(codec_t *codec)
+{
+#ifdef __LIBDEFLATE_AVAILABLE__
+	if (codec->compressor) libdeflate_free_compressor(codec->compressor);
+	if (codec->decompressor) libdeflate_free_decompressor(codec->decompressor);
+	codec->compressor = 0;
+	codec->decompressor = 0;
+#endif
+}
+
 static BGZF *bgzf_read_init()
 {
 	BGZF *fp;
@@ -107,6 +140,8 @@ static BGZF *bgzf_read_init()
 	fp->open_mode = 'r';
 	fp->uncompressed_block = malloc(BGZF_BLOCK_SIZE);
 	fp->compressed_block = malloc(BGZF_BLOCK_SIZE);
+	fp->codec = malloc(sizeof(codec_t));
+	codec_init((codec_t*)fp->codec, -1);
 #ifdef BGZF_CACHE
 	fp->cache = kh_init(cache);
 #endif
@@ -122,6 +157,8 @@ static BGZF *bgzf_write_init(int compress_level) // compress_level==-1 for the d
 	fp->compressed_block = malloc(BGZF_BLOCK_SIZE);
 	fp->compress_level = compress_level < 0? Z_DEFAULT_COMPRESSION : compress_level; // Z_DEFAULT_COMPRESSION==-1
 	if (fp->compress_level > 9) fp->compress_level = Z_DEFAULT_COMPRESSION;
+	fp->codec = malloc(sizeof(codec_t));
+	codec_init((codec_t*)fp->codec, fp->compress_level);
 	return fp;
 }
 // get the compress level from the mode string
@@ -185,60 +222,221 @@ BGZF *bgzf_dopen(int fd, const char *mode)
 	return fp;
 }
 
-// Deflate the block in fp->uncompressed_block into fp->compressed_block. Also adds an extra field that stores the compressed block length.
-static int deflate_block(BGZF *fp, int block_length)
+/* Block codec.  BGZF blocks are always fully buffered, so when libdeflate is
+ * available at build time its whole-buffer functions are used instead of
+ * streaming zlib.  Both produce standard raw deflate data. */
+#ifdef __LIBDEFLATE_AVAILABLE__
+static int g_codec = BGZF_CODEC_LIBDEFLATE;
+#else
+static int g_codec = BGZF_CODEC_ZLIB;
+#endif
+
+int bgzf_set_codec(int codec)
+{
+	if (codec == BGZF_CODEC_ZLIB) {
+		g_codec = codec;
+		return 0;
+	}
+#ifdef __LIBDEFLATE_AVAILABLE__
+	if (codec == BGZF_CODEC_LIBDEFLATE) {
+		g_codec = codec;
+		return 0;
+	}
+#endif
+	return -1;
+}
+
+int bgzf_get_codec(void)
+{
+	return g_codec;
+}
+
+typedef struct {
+	int n, m;
+	int64_t *uaddr, *caddr; // uncompressed and compressed address of each block
+	int64_t uend, cend; // addresses following the last block
+} block_log_t;
+
+// Add a block that was written to the file to the block log if there is one.
+static void log_block(BGZF *fp, int64_t uaddr, int ulength, int64_t caddr, int clength)
+{
+	block_log_t *log = (block_log_t*)fp->block_log;
+	if (log == 0) return;
+	if (log->n == log->m) {
+		log->m = log->m? log->m << 1 : 1024;
+		log->uaddr = realloc(log->uaddr, log->m * sizeof(int64_t));
+		log->caddr = realloc(log->caddr, log->m * sizeof(int64_t));
+	}
+	log->uaddr[log->n] = uaddr;
+	log->caddr[log->n] = caddr;
+	++log->n;
+	log->uend = uaddr + ulength;
+	log->cend = caddr + clength;
+}
+
+int bgzf_log_blocks(BGZF *fp)
+{
+	block_log_t *log;
+	if (fp == 0 || fp->open_mode != 'w') return -1;
+	if (fp->block_log) return 0;
+	log = calloc(1, sizeof(block_log_t));
+	// Data written before now is not logged.
+	log->uend = -1;
+	fp->block_log = log;
+	return 0;
+}
+
+int64_t bgzf_utell(BGZF *fp)
+{
+	return fp->uncompressed_address + fp->block_offset;
+}
+
+int64_t bgzf_virtual_offset(BGZF *fp, int64_t uoffset)
+{
+	block_log_t *log = (block_log_t*)fp->block_log;
+	int lo, hi, mid;
+	if (log == 0) return -1;
+	if (uoffset == log->uend) return log->cend << 16;
+	if (log->n == 0 || uoffset > log->uend || uoffset < log->uaddr[0]) return -1;
+	// Find the last block starting at or before uoffset.
+	lo = 0; hi = log->n - 1;
+	while (lo < hi) {
+		mid = (lo + hi + 1) >> 1;
+		if (log->uaddr[mid] <= uoffset) lo = mid;
+		else hi = mid - 1;
+	}
+	return log->caddr[lo] << 16 | (uoffset - log->uaddr[lo]);
+}
+
+static void free_block_log(BGZF *fp)
+{
+	block_log_t *log = (block_log_t*)fp->block_log;
+	if (log == 0) return;
+	free(log->uaddr);
+	free(log->caddr);
+	free(log);
+	fp->block_log = 0;
+}
+
+// Compress length bytes of src into dst as raw deflate data.  Returns the
+// compressed length, 0 if it does not fit in dst_length bytes and -1 on error.
+static int deflate_raw(codec_t *codec, const uint8_t *src, int length, uint8_t *dst, int dst_length)
+{
+	int status, level = codec->level;
+	z_stream zs;
+#ifdef __LIBDEFLATE_AVAILABLE__
+	// The empty EOF block is left to zlib so it matches the standard
+	// EOF marker byte for byte.
+	if (g_codec == BGZF_CODEC_LIBDEFLATE && length > 0) {
+		// libdeflate has no default level; use zlib's.
+		if (codec->compressor == 0
+				&& (codec->compressor = libdeflate_alloc_compressor(level < 0? 6 : level)) == 0)
+			return -1;
+		return (int)libdeflate_deflate_compress(codec->compressor, src, length, dst, dst_length);
+	}
+#endif
+	zs.zalloc = NULL;
+	zs.zfree = NULL;
+	zs.next_in = (Bytef*)src;
+	zs.avail_in = length;
+	zs.next_out = dst;
+	zs.avail_out = dst_length;
+	status = deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY); // -15 to disable zlib header/footer
+	if (status != Z_OK) return -1;
+	status = deflate(&zs, Z_FINISH);
+	if (status != Z_STREAM_END) { // not compressed enough
+		deflateEnd(&zs);
+		return status == Z_OK? 0 : -1;
+	}
+	if (deflateEnd(&zs) != Z_OK) return -1;
+	return zs.total_out;
+}
+
+// Decompress the raw deflate data in src into dst.  Returns the
+// uncompressed length or -1 on error.
+static int inflate_raw(codec_t *codec, const uint8_t *src, int length, uint8_t *dst, int dst_length)
 {
-	uint8_t *buffer = fp->compressed_block;
+	z_stream zs;
+#ifdef __LIBDEFLATE_AVAILABLE__
+	if (g_codec == BGZF_CODEC_LIBDEFLATE) {
+		size_t uncompressed_length;
+		if (codec->decompressor == 0
+				&& (codec->decompressor = libdeflate_alloc_decompressor()) == 0)
+			return -1;
+		if (libdeflate_deflate_decompress(codec->decompressor, src, length, dst, dst_length,
+					&uncompressed_length) != LIBDEFLATE_SUCCESS)
+			return -1;
+		return (int)uncompressed_length;
+	}
+#endif
+	zs.zalloc = NULL;
+	zs.zfree = NULL;
+	zs.next_in = (Bytef*)src;
+	zs.avail_in = length;
+	zs.next_out = dst;
+	zs.avail_out = dst_length;
+	if (inflateInit2(&zs, -15) != Z_OK) return -1;
+	if (inflate(&zs, Z_FINISH) != Z_STREAM_END) {
+		inflateEnd(&zs);
+		return -1;
+	}
+	if (inflateEnd(&zs) != Z_OK) return -1;
+	return zs.total_out;
+}
+
+static inline uint32_t block_crc32(const uint8_t *data, int length)
+{
+#ifdef __LIBDEFLATE_AVAILABLE__
+	return libdeflate_crc32(0, data, length);
+#else
+	return crc32(crc32(0L, NULL, 0L), data, length);
+#endif
+}
+
+// Deflate *input_length bytes of src into a single BGZF block in dst, which
+// must hold BGZF_BLOCK_SIZE bytes.  If the data does not compress enough to
+// fit, less input is used; *input_length is set to the number of bytes that
+// went into the block.  Does not touch the BGZF handle, so it is safe to call
+// from the worker threads with their own codec.
+static int deflate_buffer(codec_t *codec, const uint8_t *src, int *input_length, uint8_t *dst)
+{
+	uint8_t *buffer = dst;
 	int buffer_size = BGZF_BLOCK_SIZE;
-	int input_length = block_length;
 	int compressed_length = 0;
-	int remaining;
-	uint32_t crc;
 
-	assert(block_length <= BGZF_BLOCK_SIZE); // guaranteed by the caller
+	assert(*input_length <= BGZF_BLOCK_SIZE); // guaranteed by the caller
 	memcpy(buffer, g_magic, BLOCK_HEADER_LENGTH); // the last two bytes are a place holder for the length of the block
 	while (1) { // loop to retry for blocks that do not compress enough
-		int status;
-		z_stream zs;
-		zs.zalloc = NULL;
-		zs.zfree = NULL;
-		zs.next_in = fp->uncompressed_block;
-		zs.avail_in = input_length;
-		zs.next_out = (void*)&buffer[BLOCK_HEADER_LENGTH];
-		zs.avail_out = buffer_size - BLOCK_HEADER_LENGTH - BLOCK_FOOTER_LENGTH;
-		status = deflateInit2(&zs, fp->compress_level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY); // -15 to disable zlib header/footer
-		if (status != Z_OK) {
-			fp->errcode |= BGZF_ERR_ZLIB;
-			return -1;
-		}
-		status = deflate(&zs, Z_FINISH);
-		if (status != Z_STREAM_END) { // not compressed enough
-			deflateEnd(&zs); // reset the stream
-			if (status == Z_OK) { // reduce the size and recompress
-				input_length -= 1024;
-				assert(input_length > 0); // logically, this should not happen
-				continue;
-			}
-			fp->errcode |= BGZF_ERR_ZLIB;
-			return -1;
-		}
-		if (deflateEnd(&zs) != Z_OK) {
-			fp->errcode |= BGZF_ERR_ZLIB;
-			return -1;
+		compressed_length = deflate_raw(codec, src, *input_length, &buffer[BLOCK_HEADER_LENGTH],
+				buffer_size - BLOCK_HEADER_LENGTH - BLOCK_FOOTER_LENGTH);
+		if (compressed_length < 0) return -1;
+		if (compressed_length == 0) { // reduce the size and recompress
+			*input_length -= 1024;
+			assert(*input_length > 0); // logically, this should not happen
+			continue;
 		}
-		compressed_length = zs.total_out;
 		compressed_length += BLOCK_HEADER_LENGTH + BLOCK_FOOTER_LENGTH;
 		assert(compressed_length <= BGZF_BLOCK_SIZE);
 		break;
 	}
 
-	assert(compressed_length > 0);
 	packInt16((uint8_t*)&buffer[16], compressed_length - 1); // write the compressed_length; -1 to fit 2 bytes
-	crc = crc32(0L, NULL, 0L);
-	crc = crc32(crc, fp->uncompressed_block, input_length);
-	packInt32((uint8_t*)&buffer[compressed_length-8], crc);
-	packInt32((uint8_t*)&buffer[compressed_length-4], input_length);
+	packInt32((uint8_t*)&buffer[compressed_length-8], block_crc32(src, *input_length));
+	packInt32((uint8_t*)&buffer[compressed_length-4], *input_length);
+	return compressed_length;
+}
 
+// Deflate the block in fp->uncompressed_block into fp->compressed_block. Also adds an extra field that stores the compressed block length.
+static int deflate_block(BGZF *fp, int block_length)
+{
+	int input_length = block_length;
+	int compressed_length, remaining;
+
+	compressed_length = deflate_buffer((codec_t*)fp->codec, fp->uncompressed_block, &input_length, fp->compressed_block);
+	if (compressed_length < 0) {
+		fp->errcode |= BGZF_ERR_ZLIB;
+		return -1;
+	}
 	remaining = block_length - input_length;
 	if (remaining > 0) {
 		assert(remaining <= input_length);
@@ -248,31 +446,22 @@ static int deflate_block(BGZF *fp, int block_length)
 	return compressed_length;
 }
 
+// Inflate the compressed block in src (including its header) into dst, which
+// must hold BGZF_BLOCK_SIZE bytes.  Does not touch the BGZF handle, so it is
+// safe to call from the worker threads with their own codec.
+static int inflate_buffer(codec_t *codec, uint8_t *src, int block_length, uint8_t *dst)
+{
+	if (block_length < BLOCK_HEADER_LENGTH + BLOCK_FOOTER_LENGTH) return -1;
+	return inflate_raw(codec, src + BLOCK_HEADER_LENGTH,
+			block_length - BLOCK_HEADER_LENGTH - BLOCK_FOOTER_LENGTH, dst, BGZF_BLOCK_SIZE);
+}
+
 // Inflate the block in fp->compressed_block into fp->uncompressed_block
 static int inflate_block(BGZF* fp, int block_length)
 {
-	z_stream zs;
-	zs.zalloc = NULL;
-	zs.zfree = NULL;
-	zs.next_in = fp->compressed_block + 18;
-	zs.avail_in = block_length - 16;
-	zs.next_out = fp->uncompressed_block;
-	zs.avail_out = BGZF_BLOCK_SIZE;
-
-	if (inflateInit2(&zs, -15) != Z_OK) {
-		fp->errcode |= BGZF_ERR_ZLIB;
-		return -1;
-	}
-	if (inflate(&zs, Z_FINISH) != Z_STREAM_END) {
-		inflateEnd(&zs);
-		fp->errcode |= BGZF_ERR_ZLIB;
-		return -1;
-	}
-	if (inflateEnd(&zs) != Z_OK) {
-		fp->errcode |= BGZF_ERR_ZLIB;
-		return -1;
-	}
-	return zs.total_out;
+	int count = inflate_buffer((codec_t*)fp->codec, fp->compressed_block, block_length, fp->uncompressed_block);
+	if (count < 0) fp->errcode |= BGZF_ERR_ZLIB;
+	return count;
 }
 
 static int check_header(const uint8_t *header)
@@ -342,25 +531,19 @@ static int load_block_from_cache(BGZF *fp, int64_t block_address) {return 0;}
 static void cache_block(BGZF *fp, int size) {}
 #endif
 
-int bgzf_read_block(BGZF *fp)
+// Read the next compressed block from the file into compressed_block.
+// Returns the length of the block, 0 at the end of the file and -1 on error.
+static int read_compressed_block(BGZF *fp, uint8_t *compressed_block)
 {
-	uint8_t header[BLOCK_HEADER_LENGTH], *compressed_block;
-	int count, size = 0, block_length, remaining;
-	int64_t block_address;
-	block_address = _bgzf_tell((_bgzf_file_t)fp->fp);
-	if (load_block_from_cache(fp, block_address)) return 0;
+	uint8_t header[BLOCK_HEADER_LENGTH];
+	int count, block_length, remaining;
 	count = _bgzf_read(fp->fp, header, sizeof(header));
-	if (count == 0) { // no data read
-		fp->block_length = 0;
-		return 0;
-	}
+	if (count == 0) return 0; // no data read
 	if (count != sizeof(header) || !check_header(header)) {
 		fp->errcode |= BGZF_ERR_HEADER;
 		return -1;
 	}
-	size = count;
 	block_length = unpackInt16((uint8_t*)&header[16]) + 1; // +1 because when writing this number, we used "-1"
-	compressed_block = (uint8_t*)fp->compressed_block;
 	memcpy(compressed_block, header, BLOCK_HEADER_LENGTH);
 	remaining = block_length - BLOCK_HEADER_LENGTH;
 	count = _bgzf_read(fp->fp, &compressed_block[BLOCK_HEADER_LENGTH], remaining);
@@ -368,7 +551,361 @@ int bgzf_read_block(BGZF *fp)
 		fp->errcode |= BGZF_ERR_IO;
 		return -1;
 	}
-	size += count;
+	return block_length;
+}
+
+#ifdef __PTHREAD_AVAILABLE__
+/* Multi-threaded block processing.  When reading, the calling thread keeps a
+ * ring of slots filled with the compressed blocks that follow the current
+ * one, and the worker threads inflate them.  When writing, each full
+ * uncompressed block is queued in the ring, the workers deflate it, and the
+ * calling thread writes the results out.  Slots are always consumed from the
+ * head of the ring, so blocks are returned or written in file order. */
+
+#define BGZF_MT_SLOTS_PER_THREAD 4
+
+enum { MT_EMPTY = 0, MT_QUEUED, MT_WORKING, MT_DONE };
+
+typedef struct {
+	int state;
+	int compressed_length, uncompressed_length;
+	int64_t block_address;
+	uint8_t *compressed_block, *uncompressed_block;
+	// When writing, the uncompressed address of the slot and the lengths
+	// of the first block if the data spilled into a second one.
+	int64_t uncompressed_address;
+	int first_compressed_length, first_uncompressed_length;
+} mt_slot_t;
+
+typedef struct {
+	int open_mode, compress_level;
+	int n_threads, n_slots;
+	int head, n_used; // next slot to hand out and the number of slots in use
+	int eof, errcode; // no more blocks will be read; error that stopped reading
+	int shutdown;
+	int64_t next_address; // address of the block following the last consumed one
+	mt_slot_t *slots;
+	pthread_t *threads;
+	pthread_mutex_t lock;
+	pthread_cond_t work_cond, done_cond;
+} mt_state_t;
+
+// Deflate the uncompressed data of a slot into its compressed buffer, which
+// holds two blocks: data that does not compress enough to fit in one block
+// spills into a second one, exactly as bgzf_flush() splits it when writing
+// serially.  Returns the total compressed length.
+static int mt_deflate_slot(codec_t *codec, mt_slot_t *s)
+{
+	int input_used = 0, output_used = 0, input_length, length;
+	while (input_used < s->uncompressed_length) {
+		input_length = s->uncompressed_length - input_used;
+		length = deflate_buffer(codec, s->uncompressed_block + input_used, &input_length,
+				s->compressed_block + output_used);
+		if (length < 0) return -1;
+		if (output_used == 0) {
+			s->first_compressed_length = length;
+			s->first_uncompressed_length = input_length;
+		}
+		input_used += input_length;
+		output_used += length;
+	}
+	return output_used;
+}
+
+static void *mt_worker(void *data)
+{
+	mt_state_t *mt = (mt_state_t*)data;
+	mt_slot_t *s;
+	int i, length;
+	codec_t codec; // this thread's own codec, reused for all of its blocks
+	codec_init(&codec, mt->compress_level);
+	pthread_mutex_lock(&mt->lock);
+	while (!mt->shutdown) {
+		// Work on the queued block closest to the head of the ring.
+		for (i = 0, s = 0; i < mt->n_used; ++i) {
+			s = &mt->slots[(mt->head + i) % mt->n_slots];
+			if (s->state == MT_QUEUED) break;
+		}
+		if (i == mt->n_used) {
+			pthread_cond_wait(&mt->work_cond, &mt->lock);
+			continue;
+		}
+		s->state = MT_WORKING;
+		pthread_mutex_unlock(&mt->lock);
+		if (mt->open_mode == 'w') {
+			length = mt_deflate_slot(&codec, s);
+		} else {
+			length = inflate_buffer(&codec, s->compressed_block, s->compressed_length, s->uncompressed_block);
+		}
+		pthread_mutex_lock(&mt->lock);
+		if (mt->open_mode == 'w') s->compressed_length = length;
+		else s->uncompressed_length = length;
+		s->state = MT_DONE;
+		pthread_cond_broadcast(&mt->done_cond);
+	}
+	pthread_mutex_unlock(&mt->lock);
+	codec_free(&codec);
+	return 0;
+}
+
+// Read compressed blocks into the free slots of the ring and queue them
+// for the workers.
+static void mt_read_fill(BGZF *fp)
+{
+	mt_state_t *mt = (mt_state_t*)fp->mt;
+	mt_slot_t *s;
+	int length;
+	while (!mt->eof && mt->n_used < mt->n_slots) {
+		// Free slots are never looked at by the workers, so the slot can
+		// be filled without holding the lock.
+		s = &mt->slots[(mt->head + mt->n_used) % mt->n_slots];
+		s->block_address = _bgzf_tell((_bgzf_file_t)fp->fp);
+		length = read_compressed_block(fp, s->compressed_block);
+		if (length <= 0) {
+			// End of file or an error; errors are reported once the
+			// blocks in front of it have been handed out.
+			mt->eof = 1;
+			mt->errcode = fp->errcode;
+			fp->errcode = 0;
+			break;
+		}
+		s->compressed_length = length;
+		pthread_mutex_lock(&mt->lock);
+		s->state = MT_QUEUED;
+		++mt->n_used;
+		pthread_cond_signal(&mt->work_cond);
+		pthread_mutex_unlock(&mt->lock);
+	}
+}
+
+// Drop the first count slots of the ring, waiting for any that are
+// currently being worked on.
+static void mt_discard(mt_state_t *mt, int count)
+{
+	mt_slot_t *s;
+	pthread_mutex_lock(&mt->lock);
+	while (count-- > 0 && mt->n_used > 0) {
+		s = &mt->slots[mt->head];
+		while (s->state == MT_WORKING)
+			pthread_cond_wait(&mt->done_cond, &mt->lock);
+		s->state = MT_EMPTY;
+		mt->head = (mt->head + 1) % mt->n_slots;
+		--mt->n_used;
+	}
+	pthread_mutex_unlock(&mt->lock);
+}
+
+// Hand out the block at the head of the ring.
+static int mt_read_block(BGZF *fp)
+{
+	mt_state_t *mt = (mt_state_t*)fp->mt;
+	mt_slot_t *s;
+	void *tmp;
+	mt_read_fill(fp);
+	if (mt->n_used == 0) {
+		if (mt->errcode) {
+			fp->errcode |= mt->errcode;
+			return -1;
+		}
+		fp->block_length = 0; // end of file
+		return 0;
+	}
+	s = &mt->slots[mt->head];
+	pthread_mutex_lock(&mt->lock);
+	while (s->state != MT_DONE)
+		pthread_cond_wait(&mt->done_cond, &mt->lock);
+	pthread_mutex_unlock(&mt->lock);
+	if (s->uncompressed_length < 0) {
+		fp->errcode |= BGZF_ERR_ZLIB;
+		return -1;
+	}
+	// Swap buffers rather than copying the block.
+	tmp = fp->uncompressed_block;
+	fp->uncompressed_block = s->uncompressed_block;
+	s->uncompressed_block = tmp;
+	if (fp->block_length != 0) fp->block_offset = 0; // Do not reset offset if this read follows a seek.
+	fp->block_address = s->block_address;
+	fp->block_length = s->uncompressed_length;
+	mt->next_address = s->block_address + s->compressed_length;
+	mt_discard(mt, 1);
+	// Keep the workers busy while the caller consumes this block.
+	mt_read_fill(fp);
+	return 0;
+}
+
+// Move the read position to the block at block_address, reusing the blocks
+// already read ahead if it is one of them.
+static int mt_seek(BGZF *fp, int64_t block_address)
+{
+	mt_state_t *mt = (mt_state_t*)fp->mt;
+	int i;
+	for (i = 0; i < mt->n_used; ++i)
+		if (mt->slots[(mt->head + i) % mt->n_slots].block_address == block_address) break;
+	mt_discard(mt, i);
+	if (mt->n_used > 0) return 0;
+	mt->eof = mt->errcode = 0;
+	return _bgzf_seek((_bgzf_file_t)fp->fp, block_address, SEEK_SET);
+}
+
+// Write the finished blocks at the head of the ring to the file, waiting
+// until at least min_count slots have been written; -1 waits for all of them.
+static int mt_write_blocks(BGZF *fp, int min_count)
+{
+	mt_state_t *mt = (mt_state_t*)fp->mt;
+	mt_slot_t *s;
+	int written = 0;
+	while (mt->n_used > 0) {
+		s = &mt->slots[mt->head];
+		pthread_mutex_lock(&mt->lock);
+		if (s->state != MT_DONE && min_count >= 0 && written >= min_count) {
+			pthread_mutex_unlock(&mt->lock);
+			break;
+		}
+		while (s->state != MT_DONE)
+			pthread_cond_wait(&mt->done_cond, &mt->lock);
+		pthread_mutex_unlock(&mt->lock);
+		if (s->compressed_length < 0) {
+			fp->errcode |= BGZF_ERR_ZLIB;
+			return -1;
+		}
+		if (fwrite(s->compressed_block, 1, s->compressed_length, fp->fp) != s->compressed_length) {
+			fp->errcode |= BGZF_ERR_IO; // possibly truncated file
+			return -1;
+		}
+		log_block(fp, s->uncompressed_address, s->first_uncompressed_length,
+				fp->block_address, s->first_compressed_length);
+		if (s->first_compressed_length < s->compressed_length) {
+			log_block(fp, s->uncompressed_address + s->first_uncompressed_length,
+					s->uncompressed_length - s->first_uncompressed_length,
+					fp->block_address + s->first_compressed_length,
+					s->compressed_length - s->first_compressed_length);
+		}
+		fp->block_address += s->compressed_length;
+		mt_discard(mt, 1);
+		++written;
+	}
+	return 0;
+}
+
+// Hand the full uncompressed block over to the workers and write out any
+// blocks that have already been compressed.
+static int mt_queue_block(BGZF *fp)
+{
+	mt_state_t *mt = (mt_state_t*)fp->mt;
+	mt_slot_t *s;
+	void *tmp;
+	if (mt->n_used == mt->n_slots && mt_write_blocks(fp, 1) != 0) return -1;
+	s = &mt->slots[(mt->head + mt->n_used) % mt->n_slots];
+	// Swap buffers rather than copying the block.
+	tmp = fp->uncompressed_block;
+	fp->uncompressed_block = s->uncompressed_block;
+	s->uncompressed_block = tmp;
+	s->uncompressed_length = fp->block_offset;
+	s->uncompressed_address = fp->uncompressed_address;
+	fp->uncompressed_address += fp->block_offset;
+	fp->block_offset = 0;
+	pthread_mutex_lock(&mt->lock);
+	s->state = MT_QUEUED;
+	++mt->n_used;
+	pthread_cond_signal(&mt->work_cond);
+	pthread_mutex_unlock(&mt->lock);
+	return mt_write_blocks(fp, 0);
+}
+
+static void mt_destroy(BGZF *fp)
+{
+	mt_state_t *mt = (mt_state_t*)fp->mt;
+	int i;
+	if (mt == 0) return;
+	// Blocks that were already handed to the workers still need writing.
+	if (mt->open_mode == 'w') mt_write_blocks(fp, -1);
+	pthread_mutex_lock(&mt->lock);
+	mt->shutdown = 1;
+	pthread_cond_broadcast(&mt->work_cond);
+	pthread_mutex_unlock(&mt->lock);
+	for (i = 0; i < mt->n_threads; ++i) pthread_join(mt->threads[i], 0);
+	// Put the file back at the block following the current one, so
+	// serial reading can continue where the ring left off.
+	if (fp->open_mode == 'r' && mt->n_used > 0)
+		_bgzf_seek((_bgzf_file_t)fp->fp, mt->slots[mt->head].block_address, SEEK_SET);
+	for (i = 0; i < mt->n_slots; ++i) {
+		free(mt->slots[i].compressed_block);
+		free(mt->slots[i].uncompressed_block);
+	}
+	pthread_mutex_destroy(&mt->lock);
+	pthread_cond_destroy(&mt->work_cond);
+	pthread_cond_destroy(&mt->done_cond);
+	free(mt->slots);
+	free(mt->threads);
+	free(mt);
+	fp->mt = 0;
+}
+
+int bgzf_mt(BGZF *fp, int n_threads)
+{
+	mt_state_t *mt;
+	int i;
+	if (fp == 0) return -1;
+	mt_destroy(fp);
+	if (n_threads <= 0) return 0;
+	mt = calloc(1, sizeof(mt_state_t));
+	mt->open_mode = fp->open_mode;
+	mt->compress_level = fp->compress_level;
+	mt->n_threads = n_threads;
+	mt->n_slots = n_threads * BGZF_MT_SLOTS_PER_THREAD;
+	mt->next_address = _bgzf_tell((_bgzf_file_t)fp->fp);
+	mt->slots = calloc(mt->n_slots, sizeof(mt_slot_t));
+	for (i = 0; i < mt->n_slots; ++i) {
+		// A written block that does not compress may take two blocks.
+		mt->slots[i].compressed_block = malloc(fp->open_mode == 'w'? 2 * BGZF_BLOCK_SIZE : BGZF_BLOCK_SIZE);
+		mt->slots[i].uncompressed_block = malloc(BGZF_BLOCK_SIZE);
+	}
+	pthread_mutex_init(&mt->lock, 0);
+	pthread_cond_init(&mt->work_cond, 0);
+	pthread_cond_init(&mt->done_cond, 0);
+	mt->threads = calloc(n_threads, sizeof(pthread_t));
+	fp->mt = mt;
+	for (i = 0; i < n_threads; ++i) {
+		if (pthread_create(&mt->threads[i], 0, mt_worker, mt) != 0) {
+			mt->n_threads = i;
+			mt_destroy(fp);
+			return -1;
+		}
+	}
+	return 0;
+}
+#else
+static int mt_read_block(BGZF *fp) { return -1; }
+static int mt_seek(BGZF *fp, int64_t block_address) { return -1; }
+static int mt_write_blocks(BGZF *fp, int min_count) { return -1; }
+static int mt_queue_block(BGZF *fp) { return -1; }
+static void mt_destroy(BGZF *fp) {}
+int bgzf_mt(BGZF *fp, int n_threads) { return n_threads > 0? -1 : 0; }
+#endif
+
+// Address of the block following the one that was last loaded.
+static inline int64_t next_block_address(BGZF *fp)
+{
+#ifdef __PTHREAD_AVAILABLE__
+	if (fp->mt) return ((mt_state_t*)fp->mt)->next_address;
+#endif
+	return _bgzf_tell((_bgzf_file_t)fp->fp);
+}
+
+int bgzf_read_block(BGZF *fp)
+{
+	int count, size = 0, block_length;
+	int64_t block_address;
+	if (fp->mt) return mt_read_block(fp);
+	block_address = _bgzf_tell((_bgzf_file_t)fp->fp);
+	if (load_block_from_cache(fp, block_address)) return 0;
+	block_length = read_compressed_block(fp, fp->compressed_block);
+	if (block_length < 0) return -1;
+	if (block_length == 0) { // no data read
+		fp->block_length = 0;
+		return 0;
+	}
+	size = block_length;
 	if ((count = inflate_block(fp, block_length)) < 0) return -1;
 	if (fp->block_length != 0) fp->block_offset = 0; // Do not reset offset if this read follows a seek.
 	fp->block_address = block_address;
@@ -399,7 +936,7 @@ ssize_t bgzf_read(BGZF *fp, void *data, ssize_t length)
 		bytes_read += copy_length;
 	}
 	if (fp->block_offset == fp->block_length) {
-		fp->block_address = _bgzf_tell((_bgzf_file_t)fp->fp);
+		fp->block_address = next_block_address(fp);
 		fp->block_offset = fp->block_length = 0;
 	}
 	return bytes_read;
@@ -408,14 +945,22 @@ ssize_t bgzf_read(BGZF *fp, void *data, ssize_t length)
 int bgzf_flush(BGZF *fp)
 {
 	assert(fp->open_mode == 'w');
+	if (fp->mt) {
+		if (fp->block_offset > 0 && mt_queue_block(fp) != 0) return -1;
+		return mt_write_blocks(fp, -1);
+	}
 	while (fp->block_offset > 0) {
-		int block_length;
+		int block_length, input_length = fp->block_offset;
 		block_length = deflate_block(fp, fp->block_offset);
 		if (block_length < 0) return -1;
 		if (fwrite(fp->compressed_block, 1, block_length, fp->fp) != block_length) {
 			fp->errcode |= BGZF_ERR_IO; // possibly truncated file
 			return -1;
 		}
+		// deflate_block moved anything that did not fit to the start.
+		input_length -= fp->block_offset;
+		log_block(fp, fp->uncompressed_address, input_length, fp->block_address, block_length);
+		fp->uncompressed_address += input_length;
 		fp->block_address += block_length;
 	}
 	return 0;
@@ -424,7 +969,7 @@ int bgzf_flush(BGZF *fp)
 int bgzf_flush_try(BGZF *fp, ssize_t size)
 {
 	if (fp->block_offset + size > BGZF_BLOCK_SIZE)
-		return bgzf_flush(fp);
+		return fp->mt? mt_queue_block(fp) : bgzf_flush(fp);
 	return -1;
 }
 
@@ -442,7 +987,7 @@ ssize_t bgzf_write(BGZF *fp, const void *data, ssize_t length)
 		fp->block_offset += copy_length;
 		input += copy_length;
 		bytes_written += copy_length;
-		if (fp->block_offset == block_length && bgzf_flush(fp)) break;
+		if (fp->block_offset == block_length && (fp->mt? mt_queue_block(fp) : bgzf_flush(fp))) break;
 	}
 	return bytes_written;
 }
@@ -464,11 +1009,15 @@ int bgzf_close(BGZF* fp)
 			return -1;
 		}
 	}
+	mt_destroy(fp);
 	ret = fp->open_mode == 'w'? fclose(fp->fp) : _bgzf_close(fp->fp);
 	if (ret != 0) return -1;
 	free(fp->uncompressed_block);
 	free(fp->compressed_block);
+	codec_free((codec_t*)fp->codec);
+	free(fp->codec);
 	free_cache(fp);
+	free_block_log(fp);
 	free(fp);
 	return 0;
 }
@@ -513,7 +1062,7 @@ int64_t bgzf_seek(BGZF* fp, int64_t pos, int where)
 	}
 	block_offset = pos & 0xFFFF;
 	block_address = pos >> 16;
-	if (_bgzf_seek(fp->fp, block_address, SEEK_SET) < 0) {
+	if ((fp->mt? mt_seek(fp, block_address) : _bgzf_seek(fp->fp, block_address, SEEK_SET)) < 0) {
 		fp->errcode |= BGZF_ERR_IO;
 		return -1;
 	}
@@ -544,7 +1093,7 @@ int bgzf_getc(BGZF *fp)
 	}
 	c = ((unsigned char*)fp->uncompressed_block)[fp->block_offset++];
     if (fp->block_offset == fp->block_length) {
-        fp->block_address = _bgzf_tell((_bgzf_file_t)fp->fp);
+        fp->block_address = next_block_address(fp);
         fp->block_offset = 0;
         fp->block_length = 0;
     }
@@ -558,13 +1107,15 @@ int bgzf_getc(BGZF *fp)
 int bgzf_getline(BGZF *fp, int delim, kstring_t *str)
 {
 	int l, state = 0;
-	unsigned char *buf = (unsigned char*)fp->uncompressed_block;
+	unsigned char *buf;
 	str->l = 0;
 	do {
 		if (fp->block_offset >= fp->block_length) {
 			if (bgzf_read_block(fp) != 0) { state = -2; break; }
 			if (fp->block_length == 0) { state = -1; break; }
 		}
+		// Reload since reading a block may swap in a new buffer.
+		buf = (unsigned char*)fp->uncompressed_block;
 		for (l = fp->block_offset; l < fp->block_length && buf[l] != delim; ++l);
 		if (l < fp->block_length) state = 1;
 		l -= fp->block_offset;
@@ -577,7 +1128,7 @@ int bgzf_getline(BGZF *fp, int delim, kstring_t *str)
 		str->l += l;
 		fp->block_offset += l + 1;
 		if (fp->block_offset >= fp->block_length) {
-			fp->block_address = _bgzf_tell((_bgzf_file_t)fp->fp);
+			fp->block_address = next_block_address(fp);
 			fp->block_offset = 0;
 			fp->block_length = 0;
 		} 
@@ -41,6 +41,9 @@
 #define BGZF_ERR_IO     4
 #define BGZF_ERR_MISUSE 8
 
+#define BGZF_CODEC_ZLIB       0
+#define BGZF_CODEC_LIBDEFLATE 1
+
 typedef struct {
     int open_mode:8, compress_level:8, errcode:16;
     int cache_size;
@@ -49,6 +52,10 @@ typedef struct {
     void *uncompressed_block, *compressed_block;
     void *cache; // a pointer to a hash table
     void *fp; // actual file handler; FILE* on writing; FILE* or knetFile* on reading
+    void *mt; // multi-threading state; NULL when blocks are processed serially
+    int64_t uncompressed_address; // uncompressed offset of uncompressed_block on writing
+    void *block_log; // addresses of the written blocks; NULL unless bgzf_log_blocks() was called
+    void *codec; // compressor/decompressor state reused for every block of the file
 } BGZF;
 
 #ifndef KSTRING_T
@@ -190,6 +197,77 @@ BGZF* dummy();
 	 */
 	int bgzf_read_block(BGZF *fp);
 
+	/**
+	 * Use a pool of worker threads to process BGZF blocks.  On reading, the
+	 * calling thread reads compressed blocks ahead of the current position
+	 * and the workers inflate them in parallel; blocks are still returned in
+	 * file order, so bgzf_tell()/bgzf_seek() keep working.  On writing, each
+	 * full block is deflated by the workers and written in order by the
+	 * calling thread; bgzf_flush() and bgzf_close() wait for the pending
+	 * blocks.  The file contents, and so the block layout and virtual
+	 * offsets, match serial compression byte for byte; like the serial
+	 * writer, a block that does not compress is written as two blocks.
+	 * While blocks are pending, bgzf_tell() lags behind on a file being
+	 * written, see bgzf_log_blocks().  May be called at any point after
+	 * opening the file.  Only effective when compiled with
+	 * -D__PTHREAD_AVAILABLE__.
+	 *
+	 * @param fp         BGZF file handler
+	 * @param n_threads  number of worker threads; 0 to process blocks on the
+	 *                   calling thread (default)
+	 * @return           0 on success and -1 on error
+	 */
+	int bgzf_mt(BGZF *fp, int n_threads);
+
+	/**
+	 * Select the codec used to compress and decompress BGZF blocks for all
+	 * files.  BGZF_CODEC_LIBDEFLATE compresses and decompresses each block
+	 * with a single whole-buffer call and is only available when compiled
+	 * with -D__LIBDEFLATE_AVAILABLE__, in which case it is the default;
+	 * otherwise BGZF_CODEC_ZLIB is used.  Should be set before any files
+	 * are opened.
+	 *
+	 * @param codec  BGZF_CODEC_ZLIB or BGZF_CODEC_LIBDEFLATE
+	 * @return       0 on success and -1 if the codec is not available
+	 */
+	int bgzf_set_codec(int codec);
+
+	/**
+	 * Return the codec currently used for BGZF blocks.
+	 */
+	int bgzf_get_codec(void);
+
+	/**
+	 * Keep the compressed and uncompressed address of each block written
+	 * from now on, so offsets from bgzf_utell() can be converted to virtual
+	 * file offsets with bgzf_virtual_offset() once their block is written.
+	 * Unlike bgzf_tell(), this works while blocks are still pending with
+	 * bgzf_mt() and for blocks that had to be split because they did not
+	 * compress.
+	 *
+	 * @param fp  BGZF file handler opened for writing
+	 * @return    0 on success and -1 on error
+	 */
+	int bgzf_log_blocks(BGZF *fp);
+
+	/**
+	 * Return the number of uncompressed bytes written to the file so far.
+	 */
+	int64_t bgzf_utell(BGZF *fp);
+
+	/**
+	 * Convert an offset returned by bgzf_utell() to a virtual file offset.
+	 * An offset at the end of the last written block converts to the start
+	 * of the next block.
+	 *
+	 * @param fp       BGZF file handler passed to bgzf_log_blocks()
+	 * @param uoffset  uncompressed offset returned by bgzf_utell()
+	 * @return         virtual file offset; -1 if the block containing
+	 *                 _uoffset_ was not logged or has not been written yet
+	 *                 (bgzf_flush() writes it)
+	 */
+	int64_t bgzf_virtual_offset(BGZF *fp, int64_t uoffset);
+
 #ifdef __cplusplus
 }
 #endif
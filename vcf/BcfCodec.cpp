@@ -0,0 +1,920 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BcfCodec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+
+// Magic at the start of a BCF file, version 2.2.
+static const char BCF_MAGIC[5] = {'B', 'C', 'F', 2, 2};
+// Size of the fixed fields at the start of a record's shared data.
+static const unsigned int BCF_FIXED_SIZE = 24;
+// Typed value count that means the count follows as a typed integer.
+static const int BCF_OVERFLOW_COUNT = 15;
+// Smallest values of each integer type that are not reserved.
+static const int32_t BCF_INT8_MIN = -120;
+static const int32_t BCF_INT16_MIN = -32760;
+
+BcfCodec::BcfCodec()
+    : myDictionary(),
+      myNumHeaderSamples(0),
+      myRefID(-1),
+      myStatus(),
+      myShared(),
+      myIndiv(),
+      myText(),
+      mySharedOut(),
+      myIndivOut(),
+      mySampleText(),
+      myTextFile()
+{
+}
+
+
+BcfCodec::~BcfCodec()
+{
+}
+
+
+bool BcfCodec::isBcf(IFILE filePtr)
+{
+    char magic[sizeof(BCF_MAGIC)];
+    if((filePtr == NULL) ||
+       (filePtr->ifpeek(magic, sizeof(magic)) != sizeof(magic)))
+    {
+        return(false);
+    }
+    // Any BCF2 minor version.
+    return(memcmp(magic, BCF_MAGIC, sizeof(magic) - 1) == 0);
+}
+
+
+bool BcfCodec::readHeader(IFILE filePtr, VcfHeader& header)
+{
+    myStatus = StatGenStatus::SUCCESS;
+    myDictionary.reset();
+    myRefID = -1;
+
+    char magic[sizeof(BCF_MAGIC)];
+    if((ifread(filePtr, magic, sizeof(magic)) != sizeof(magic)) ||
+       (memcmp(magic, BCF_MAGIC, sizeof(magic) - 1) != 0))
+    {
+        myStatus.setStatus(StatGenStatus::FAIL_PARSE,
+                           "Error reading BCF header, not a BCF2 file.");
+        return(false);
+    }
+    uint32_t textLength = 0;
+    if(ifread(filePtr, &textLength, sizeof(textLength)) != sizeof(textLength))
+    {
+        myStatus.setStatus(StatGenStatus::FAIL_IO,
+                           "Error reading BCF header length.");
+        return(false);
+    }
+    myText.resize(textLength);
+    if((textLength != 0) &&
+       (ifread(filePtr, &(myText[0]), textLength) != textLength))
+    {
+        myStatus.setStatus(StatGenStatus::FAIL_IO,
+                           "Error reading BCF header text.");
+        return(false);
+    }
+
+    // The text is the VCF header, null terminated.
+    myTextFile.openBuffer(myText.c_str(), strlen(myText.c_str()));
+    bool success = header.read(&myTextFile);
+    myTextFile.ifclose();
+    if(!success)
+    {
+        myStatus = header.getStatus();
+        return(false);
+    }
+    myDictionary.set(header);
+    myNumHeaderSamples = header.getNumSamples();
+    return(true);
+}
+
+
+bool BcfCodec::writeHeader(IFILE filePtr, VcfHeader& header)
+{
+    myStatus = StatGenStatus::SUCCESS;
+    myDictionary.set(header);
+    myNumHeaderSamples = header.getNumSamples();
+
+    myText.clear();
+    for(int i = 0; i < header.getNumMetaLines(); i++)
+    {
+        myText += header.getMetaLine(i);
+        myText += '\n';
+    }
+    const char* headerLine = header.getHeaderLine();
+    if(headerLine != NULL)
+    {
+        myText += headerLine;
+        myText += '\n';
+    }
+    uint32_t textLength = myText.size() + 1;
+    if((ifwrite(filePtr, BCF_MAGIC, sizeof(BCF_MAGIC)) != sizeof(BCF_MAGIC)) ||
+       (ifwrite(filePtr, &textLength, sizeof(textLength)) !=
+        sizeof(textLength)) ||
+       (ifwrite(filePtr, myText.c_str(), textLength) != textLength))
+    {
+        myStatus.setStatus(StatGenStatus::FAIL_IO,
+                           "Failed writing BCF header.");
+        return(false);
+    }
+    return(true);
+}
+
+
+bool BcfCodec::readRecord(IFILE filePtr, VcfRecord& record, bool siteOnly,
+                          VcfRecordDiscardRules& discardRules,
+                          VcfSubsetSamples* sampleSubset)
+{
+    myStatus = StatGenStatus::SUCCESS;
+    myRefID = -1;
+    record.reset();
+    if(filePtr == NULL)
+    {
+        myStatus.setStatus(StatGenStatus::FAIL_ORDER,
+                           "Error reading BCF record before opening the file.");
+        return(false);
+    }
+
+    // Loop until a record that is not discarded by id is read.
+    while(true)
+    {
+        uint32_t lengths[2];
+        unsigned int numRead = ifread(filePtr, lengths, sizeof(lengths));
+        if(numRead == 0)
+        {
+            // EOF.
+            return(false);
+        }
+        if((numRead != sizeof(lengths)) || (lengths[0] < BCF_FIXED_SIZE))
+        {
+            return(failParse("Error reading BCF record, truncated record."));
+        }
+        myShared.resize(lengths[0]);
+        myIndiv.resize(lengths[1] + 1);
+        if((ifread(filePtr, &(myShared[0]), lengths[0]) != lengths[0]) ||
+           ((lengths[1] != 0) &&
+            (ifread(filePtr, &(myIndiv[0]), lengths[1]) != lengths[1])))
+        {
+            return(failParse("Error reading BCF record, truncated record."));
+        }
+
+        const uint8_t* pos = &(myShared[0]);
+        const uint8_t* end = pos + lengths[0];
+        int32_t chrom;
+        int32_t pos0;
+        uint32_t qualBits;
+        uint32_t numAlleleInfo;
+        uint32_t numFormatSample;
+        memcpy(&chrom, pos, 4);
+        memcpy(&pos0, pos + 4, 4);
+        memcpy(&qualBits, pos + 12, 4);
+        memcpy(&numAlleleInfo, pos + 16, 4);
+        memcpy(&numFormatSample, pos + 20, 4);
+        pos += BCF_FIXED_SIZE;
+
+        // The id, checked first so discarded records are not decoded.
+        BcfTypedValues typed;
+        if(!readTyped(pos, end, typed))
+        {
+            return(failParse("Error reading BCF record ID."));
+        }
+        myText.clear();
+        BcfTypedValues::appendValues(typed.values, typed.type, typed.count,
+                                     myText);
+        if(myText.empty())
+        {
+            myText = ".";
+        }
+        if(discardRules.discardForID(myText))
+        {
+            continue;
+        }
+        record.setID(myText.c_str());
+
+        const char* chromName = myDictionary.getContig(chrom);
+        if(chromName == NULL)
+        {
+            return(failParse("Error reading BCF record, CHROM is not a contig in the header."));
+        }
+        myRefID = chrom;
+        record.setChrom(chromName);
+        record.set1BasedPosition(pos0 + 1);
+        if(qualBits == BcfTypedValues::FLOAT_MISSING)
+        {
+            record.setQual(".");
+        }
+        else
+        {
+            float qual;
+            memcpy(&qual, &qualBits, 4);
+            myText.clear();
+            BcfTypedValues::appendFloat(qual, myText);
+            record.setQual(myText.c_str());
+        }
+
+        // REF and the comma separated ALTs.
+        int numAlleles = numAlleleInfo >> 16;
+        myText.clear();
+        for(int i = 0; i < numAlleles; i++)
+        {
+            if(!readTyped(pos, end, typed))
+            {
+                return(failParse("Error reading BCF record alleles."));
+            }
+            if(i == 0)
+            {
+                BcfTypedValues::appendValues(typed.values, typed.type,
+                                             typed.count, myText);
+                record.setRef(myText.c_str());
+                myText.clear();
+                continue;
+            }
+            if(i != 1)
+            {
+                myText += ',';
+            }
+            BcfTypedValues::appendValues(typed.values, typed.type,
+                                         typed.count, myText);
+        }
+        record.setAlt((numAlleles > 1) ? myText.c_str() : ".");
+
+        // FILTER as dictionary indices.
+        if(!readTyped(pos, end, typed))
+        {
+            return(failParse("Error reading BCF record FILTER."));
+        }
+        myText.clear();
+        int filterSize = BcfTypedValues::getTypeSize(typed.type);
+        for(int i = 0; i < typed.count; i++)
+        {
+            const char* filter = myDictionary.getString(
+                BcfTypedValues::getInt(typed.values + i * filterSize,
+                                       typed.type));
+            if(filter == NULL)
+            {
+                return(failParse("Error reading BCF record, FILTER is not in the header."));
+            }
+            if(i != 0)
+            {
+                myText += ';';
+            }
+            myText += filter;
+        }
+        record.getFilter().setFilter(myText.empty() ? "." : myText.c_str());
+
+        // INFO key/value pairs.
+        int numInfo = numAlleleInfo & 0xFFFF;
+        for(int i = 0; i < numInfo; i++)
+        {
+            int32_t keyIndex;
+            if(!readTypedInt(pos, end, keyIndex) ||
+               !readTyped(pos, end, typed))
+            {
+                return(failParse("Error reading BCF record INFO."));
+            }
+            const char* key = myDictionary.getString(keyIndex);
+            if(key == NULL)
+            {
+                return(failParse("Error reading BCF record, INFO is not in the header."));
+            }
+            if(myDictionary.getInfoType(keyIndex) == BcfDictionary::TYPE_FLAG)
+            {
+                // Writers may follow the spec's recommendation of a 1
+                // element INT8 for a present flag, but it is just the key.
+                record.getInfo().setString(key, "");
+                continue;
+            }
+            // Converted to text only if it is accessed as a string.
+            record.getInfo().setTyped(key, typed.type, typed.count,
+                                      typed.values);
+        }
+
+        int numFormat = numFormatSample >> 24;
+        int numSamples = numFormatSample & 0xFFFFFF;
+        if(!siteOnly && (numFormat != 0) &&
+           !decodeSamples(record, numFormat, numSamples, sampleSubset))
+        {
+            // Status was set.
+            return(false);
+        }
+        return(true);
+    }
+}
+
+
+bool BcfCodec::decodeSamples(VcfRecord& record, int numFormat, int numSamples,
+                             VcfSubsetSamples* sampleSubset)
+{
+    const uint8_t* pos = &(myIndiv[0]);
+    const uint8_t* end = pos + myIndiv.size() - 1;
+    myFormatKeys.resize(numFormat);
+    myFormatNames.resize(numFormat);
+    myFormatValues.resize(numFormat);
+    int gtField = -1;
+    for(int i = 0; i < numFormat; i++)
+    {
+        if(!readTypedInt(pos, end, myFormatKeys[i]) ||
+           !readTyped(pos, end, myFormatValues[i], numSamples) ||
+           (myDictionary.getString(myFormatKeys[i]) == NULL))
+        {
+            return(failParse("Error reading BCF record FORMAT."));
+        }
+        myFormatNames[i] = myDictionary.getString(myFormatKeys[i]);
+        if(strcmp(myFormatNames[i], "GT") == 0)
+        {
+            gtField = i;
+        }
+    }
+    const BcfTypedValues* gt =
+        (gtField == -1) ? NULL : &(myFormatValues[gtField]);
+    if((gt != NULL) && (gt->count != 0) && !BcfTypedValues::isInt(gt->type))
+    {
+        return(failParse("Error reading BCF record, GT is not an integer."));
+    }
+
+    VcfRecordGenotype& genotype = record.getGenotypeInfo();
+    if(!VcfRecordGenotype::isGTMatrixMode())
+    {
+        // Keep the typed values, converting a sample's values to text
+        // only when they are accessed.
+        genotype.readTyped(myFormatNames, myFormatValues, numSamples,
+                           sampleSubset);
+        return(true);
+    }
+
+    // Decode the GT typed array directly.
+    if((gt != NULL) && (gt->count == 0))
+    {
+        gt = NULL;
+    }
+    try
+    {
+        genotype.readTypedGT((gt == NULL) ? NULL : gt->values,
+                             (gt == NULL) ? 1 :
+                             BcfTypedValues::getTypeSize(gt->type),
+                             (gt == NULL) ? 0 : gt->count,
+                             numSamples, sampleSubset);
+    }
+    catch(std::exception& e)
+    {
+        myText = "Failed parsing the BCF Genotype Fields - ";
+        myText += e.what();
+        return(failParse(myText.c_str()));
+    }
+    return(true);
+}
+
+
+bool BcfCodec::writeRecord(IFILE filePtr, VcfRecord& record, bool siteOnly)
+{
+    myStatus = StatGenStatus::SUCCESS;
+    if(filePtr == NULL)
+    {
+        myStatus.setStatus(StatGenStatus::FAIL_ORDER,
+                           "Error writing BCF record before opening the file.");
+        return(false);
+    }
+
+    int32_t chrom = myDictionary.getContigIndex(record.getChromStr());
+    if(chrom < 0)
+    {
+        return(failParse("Error writing BCF record, CHROM is not a contig in the header."));
+    }
+
+    // The reference length is from INFO END if it is set.
+    int32_t pos0 = record.get1BasedPosition() - 1;
+    int32_t refLength = record.get1BasedEndPosition() - pos0;
+    uint32_t qualBits = BcfTypedValues::FLOAT_MISSING;
+    std::string qualStr = record.getQualStr();
+    if(!qualStr.empty() && (qualStr != "."))
+    {
+        float qual = record.getQual();
+        memcpy(&qualBits, &qual, 4);
+    }
+
+    mySharedOut.clear();
+    putInt32(mySharedOut, chrom);
+    putInt32(mySharedOut, pos0);
+    putInt32(mySharedOut, refLength);
+    putInt32(mySharedOut, qualBits);
+    // Allele/info and format/sample counts are filled in at the end.
+    putInt32(mySharedOut, 0);
+    putInt32(mySharedOut, 0);
+
+    std::string id = record.getIDStr();
+    putTypedString(mySharedOut, (id == ".") ? "" : id);
+
+    putTypedString(mySharedOut, record.getRefStr());
+    int numAlts = record.getNumAlts();
+    for(int i = 1; i <= numAlts; i++)
+    {
+        putTypedString(mySharedOut, record.getAlleles(i));
+    }
+
+    // FILTER as dictionary indices.
+    const std::string& filter = record.getFilter().getString();
+    myInts.clear();
+    if(!filter.empty() && (filter != "."))
+    {
+        size_t start = 0;
+        while(start <= filter.size())
+        {
+            size_t filterEnd = filter.find(';', start);
+            if(filterEnd == std::string::npos)
+            {
+                filterEnd = filter.size();
+            }
+            int index = 
+                myDictionary.getStringIndex(filter.substr(start,
+                                                          filterEnd - start));
+            if(index < 0)
+            {
+                return(failParse("Error writing BCF record, FILTER is not in the header."));
+            }
+            myInts.push_back(index);
+            start = filterEnd + 1;
+        }
+    }
+    if(myInts.empty())
+    {
+        putTypeDescriptor(mySharedOut, BcfTypedValues::BCF_TYPE_NULL, 0);
+    }
+    else
+    {
+        putTypedInts(mySharedOut, myInts, myInts.size());
+    }
+
+    int numInfo = 0;
+    if(!encodeInfo(record, mySharedOut, numInfo))
+    {
+        return(false);
+    }
+
+    // The samples.
+    myIndivOut.clear();
+    VcfRecordGenotype& genotype = record.getGenotypeInfo();
+    int numFormat = 0;
+    int numSamples = myNumHeaderSamples;
+    if(!siteOnly && (genotype.getNumSamples() != 0) &&
+       (genotype.getNumFormatFields() != 0))
+    {
+        numFormat = genotype.getNumFormatFields();
+        numSamples = genotype.getNumSamples();
+        if(!encodeFormat(record, myIndivOut))
+        {
+            return(false);
+        }
+    }
+
+    uint32_t numAlleleInfo = ((numAlts + 1) << 16) | numInfo;
+    uint32_t numFormatSample = (numFormat << 24) | numSamples;
+    memcpy(&(mySharedOut[16]), &numAlleleInfo, 4);
+    memcpy(&(mySharedOut[20]), &numFormatSample, 4);
+
+    uint32_t lengths[2] = {(uint32_t)mySharedOut.size(),
+                           (uint32_t)myIndivOut.size()};
+    if((ifwrite(filePtr, lengths, sizeof(lengths)) != sizeof(lengths)) ||
+       (ifwrite(filePtr, mySharedOut.data(), lengths[0]) != lengths[0]) ||
+       (ifwrite(filePtr, myIndivOut.data(), lengths[1]) != lengths[1]))
+    {
+        myStatus.setStatus(StatGenStatus::FAIL_IO,
+                           "Failed writing BCF record.");
+        return(false);
+    }
+    return(true);
+}
+
+
+bool BcfCodec::encodeInfo(VcfRecord& record, std::string& buffer,
+                          int& numInfo)
+{
+    VcfRecordInfo& info = record.getInfo();
+    numInfo = 0;
+    for(int i = 0; i < info.getNumInfoFields(); i++)
+    {
+        std::pair<std::string, std::string> infoPair = info.getInfoPair(i);
+        if((infoPair.first == ".") && infoPair.second.empty())
+        {
+            // Empty INFO.
+            continue;
+        }
+        int index = myDictionary.getStringIndex(infoPair.first);
+        BcfDictionary::ValueType type = myDictionary.getInfoType(index);
+        if(type == BcfDictionary::TYPE_UNDEFINED)
+        {
+            return(failParse("Error writing BCF record, INFO is not in the header."));
+        }
+        putTypedInt(buffer, index);
+        ++numInfo;
+        if((type == BcfDictionary::TYPE_FLAG) || infoPair.second.empty())
+        {
+            putTypeDescriptor(buffer, BcfTypedValues::BCF_TYPE_NULL, 0);
+        }
+        else if(type == BcfDictionary::TYPE_INTEGER)
+        {
+            myInts.clear();
+            if(!BcfTypedValues::parseInts(infoPair.second, myInts))
+            {
+                return(failParse("Error writing BCF record, INFO Integer is not a number."));
+            }
+            putTypedInts(buffer, myInts, myInts.size());
+        }
+        else if(type == BcfDictionary::TYPE_FLOAT)
+        {
+            myFloats.clear();
+            if(!BcfTypedValues::parseFloats(infoPair.second, myFloats))
+            {
+                return(failParse("Error writing BCF record, INFO Float is not a number."));
+            }
+            putTypedFloats(buffer, myFloats, myFloats.size());
+        }
+        else
+        {
+            putTypedString(buffer, infoPair.second);
+        }
+    }
+    return(true);
+}
+
+
+bool BcfCodec::encodeFormat(VcfRecord& record, std::string& buffer)
+{
+    VcfRecordGenotype& genotype = record.getGenotypeInfo();
+    int numSamples = genotype.getNumSamples();
+    for(int fieldIndex = 0; fieldIndex < genotype.getNumFormatFields();
+        fieldIndex++)
+    {
+        const std::string& key = *(genotype.getFormatField(fieldIndex));
+        int index = myDictionary.getStringIndex(key);
+        BcfDictionary::ValueType type = myDictionary.getFormatType(index);
+        if(type == BcfDictionary::TYPE_UNDEFINED)
+        {
+            return(failParse("Error writing BCF record, FORMAT is not in the header."));
+        }
+        putTypedInt(buffer, index);
+
+        if(key != "GT")
+        {
+            if(!encodeFormatValues(genotype, fieldIndex, key, type, buffer))
+            {
+                return(false);
+            }
+            continue;
+        }
+
+        // Each GT allele is ((allele + 1) << 1 | phased), 0 if missing.
+        int ploidy = 0;
+        for(int sampleNum = 0; sampleNum < numSamples; sampleNum++)
+        {
+            if(genotype.getNumGTs(sampleNum) > ploidy)
+            {
+                ploidy = genotype.getNumGTs(sampleNum);
+            }
+        }
+        myPadded.clear();
+        for(int sampleNum = 0; sampleNum < numSamples; sampleNum++)
+        {
+            int numGTs = 0;
+            if(fieldIndex < genotype.getNumSampleFields(sampleNum))
+            {
+                numGTs = genotype.getNumGTs(sampleNum);
+            }
+            int32_t phased = genotype.isPhased(sampleNum) ? 1 : 0;
+            for(int i = 0; i < ploidy; i++)
+            {
+                if(i >= numGTs)
+                {
+                    myPadded.push_back(BcfTypedValues::INT32_VECTOR_END);
+                    continue;
+                }
+                int allele = genotype.getGT(sampleNum, i);
+                int32_t value = (allele < 0) ? 0 : ((allele + 1) << 1);
+                if(i != 0)
+                {
+                    value |= phased;
+                }
+                myPadded.push_back(value);
+            }
+        }
+        putTypedInts(buffer, myPadded, ploidy);
+    }
+    return(true);
+}
+
+
+bool BcfCodec::encodeFormatValues(VcfRecordGenotype& genotype,
+                                  int fieldIndex, const std::string& key,
+                                  BcfDictionary::ValueType type,
+                                  std::string& buffer)
+{
+    int numSamples = genotype.getNumSamples();
+    myCounts.resize(numSamples);
+    myInts.clear();
+    myFloats.clear();
+    mySampleText.clear();
+    int maxCount = 0;
+
+    // Parse every sample's values, then pad them to the same number.
+    for(int sampleNum = 0; sampleNum < numSamples; sampleNum++)
+    {
+        const std::string* value = NULL;
+        if(fieldIndex < genotype.getNumSampleFields(sampleNum))
+        {
+            value = genotype.getString(key, sampleNum);
+        }
+        size_t prevSize = 0;
+        if(value == NULL)
+        {
+            myCounts[sampleNum] = 0;
+            continue;
+        }
+        if(type == BcfDictionary::TYPE_INTEGER)
+        {
+            prevSize = myInts.size();
+            if(!BcfTypedValues::parseInts(*value, myInts))
+            {
+                return(failParse("Error writing BCF record, FORMAT Integer is not a number."));
+            }
+            myCounts[sampleNum] = myInts.size() - prevSize;
+        }
+        else if(type == BcfDictionary::TYPE_FLOAT)
+        {
+            prevSize = myFloats.size();
+            if(!BcfTypedValues::parseFloats(*value, myFloats))
+            {
+                return(failParse("Error writing BCF record, FORMAT Float is not a number."));
+            }
+            myCounts[sampleNum] = myFloats.size() - prevSize;
+        }
+        else
+        {
+            mySampleText += *value;
+            myCounts[sampleNum] = value->size();
+        }
+        if(myCounts[sampleNum] > maxCount)
+        {
+            maxCount = myCounts[sampleNum];
+        }
+    }
+
+    size_t valueIndex = 0;
+    if(type == BcfDictionary::TYPE_INTEGER)
+    {
+        myPadded.clear();
+        for(int sampleNum = 0; sampleNum < numSamples; sampleNum++)
+        {
+            myPadded.insert(myPadded.end(), myInts.begin() + valueIndex,
+                            myInts.begin() + valueIndex + myCounts[sampleNum]);
+            myPadded.resize(myPadded.size() + maxCount - myCounts[sampleNum],
+                            BcfTypedValues::INT32_VECTOR_END);
+            valueIndex += myCounts[sampleNum];
+        }
+        putTypedInts(buffer, myPadded, maxCount);
+    }
+    else if(type == BcfDictionary::TYPE_FLOAT)
+    {
+        myPaddedFloats.clear();
+        for(int sampleNum = 0; sampleNum < numSamples; sampleNum++)
+        {
+            myPaddedFloats.insert(myPaddedFloats.end(),
+                                  myFloats.begin() + valueIndex,
+                                  myFloats.begin() + valueIndex +
+                                  myCounts[sampleNum]);
+            myPaddedFloats.resize(myPaddedFloats.size() + maxCount -
+                                  myCounts[sampleNum],
+                                  BcfTypedValues::FLOAT_VECTOR_END);
+            valueIndex += myCounts[sampleNum];
+        }
+        putTypedFloats(buffer, myPaddedFloats, maxCount);
+    }
+    else
+    {
+        // Strings are padded with nulls.
+        putTypeDescriptor(buffer, BcfTypedValues::BCF_TYPE_CHAR, maxCount);
+        for(int sampleNum = 0; sampleNum < numSamples; sampleNum++)
+        {
+            buffer.append(mySampleText, valueIndex, myCounts[sampleNum]);
+            buffer.append(maxCount - myCounts[sampleNum], '\0');
+            valueIndex += myCounts[sampleNum];
+        }
+    }
+    return(true);
+}
+
+
+bool BcfCodec::failParse(const char* message)
+{
+    myStatus.setStatus(StatGenStatus::FAIL_PARSE, message);
+    return(false);
+}
+
+
+bool BcfCodec::readTyped(const uint8_t*& pos, const uint8_t* end,
+                         BcfTypedValues& typed, int numVectors)
+{
+    if(pos >= end)
+    {
+        return(false);
+    }
+    typed.type = *pos & 0xF;
+    typed.count = *pos >> 4;
+    ++pos;
+    if(typed.count == BCF_OVERFLOW_COUNT)
+    {
+        if(!readTypedInt(pos, end, typed.count) || (typed.count < 0))
+        {
+            return(false);
+        }
+    }
+    int typeSize = BcfTypedValues::getTypeSize(typed.type);
+    if(typeSize < 0)
+    {
+        return(false);
+    }
+    typed.values = pos;
+    int64_t numBytes = (int64_t)typed.count * numVectors * typeSize;
+    if(numBytes > end - pos)
+    {
+        return(false);
+    }
+    pos += numBytes;
+    return(true);
+}
+
+
+bool BcfCodec::readTypedInt(const uint8_t*& pos, const uint8_t* end,
+                            int32_t& value)
+{
+    BcfTypedValues typed;
+    if(!readTyped(pos, end, typed) || (typed.count != 1) ||
+       !BcfTypedValues::isInt(typed.type))
+    {
+        return(false);
+    }
+    value = BcfTypedValues::getInt(typed.values, typed.type);
+    return(true);
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+void BcfCodec::putInt32(std::string& buffer, int32_t value)
+{
+    buffer.append((const char*)&value, 4);
+}
+
+
+void BcfCodec::putTypeDescriptor(std::string& buffer, int type, int count)
+{
+    if(count < BCF_OVERFLOW_COUNT)
+    {
+        buffer += (char)((count << 4) | type);
+        return;
+    }
+    buffer += (char)((BCF_OVERFLOW_COUNT << 4) | type);
+    putTypedInt(buffer, count);
+}
+
+
+void BcfCodec::putTypedInt(std::string& buffer, int32_t value)
+{
+    if((value >= BCF_INT8_MIN) && (value <= INT8_MAX))
+    {
+        buffer += (char)((1 << 4) | BcfTypedValues::BCF_TYPE_INT8);
+        buffer += (char)value;
+    }
+    else if((value >= BCF_INT16_MIN) && (value <= INT16_MAX))
+    {
+        int16_t value16 = value;
+        buffer += (char)((1 << 4) | BcfTypedValues::BCF_TYPE_INT16);
+        buffer.append((const char*)&value16, 2);
+    }
+    else
+    {
+        buffer += (char)((1 << 4) | BcfTypedValues::BCF_TYPE_INT32);
+        putInt32(buffer, value);
+    }
+}
+
+
+void BcfCodec::putTypedString(std::string& buffer, const std::string& value)
+{
+    putTypeDescriptor(buffer, BcfTypedValues::BCF_TYPE_CHAR, value.size());
+    buffer += value;
+}
+
+
+void BcfCodec::putTypedInts(std::string& buffer,
+                            const std::vector<int32_t>& values,
+                            int numPerSample)
+{
+    int type = getIntType(values);
+    putTypeDescriptor(buffer, type, numPerSample);
+    // Map the missing and end of vector values to those of the type.
+    int32_t missing = BcfTypedValues::getMissing(type);
+    for(size_t i = 0; i < values.size(); i++)
+    {
+        int32_t value = values[i];
+        if(value == BcfTypedValues::INT32_MISSING)
+        {
+            value = missing;
+        }
+        else if(value == BcfTypedValues::INT32_VECTOR_END)
+        {
+            value = missing + 1;
+        }
+        if(type == BcfTypedValues::BCF_TYPE_INT8)
+        {
+            buffer += (char)value;
+        }
+        else if(type == BcfTypedValues::BCF_TYPE_INT16)
+        {
+            int16_t value16 = value;
+            buffer.append((const char*)&value16, 2);
+        }
+        else
+        {
+            putInt32(buffer, value);
+        }
+    }
+}
+
+
+void BcfCodec::putTypedFloats(std::string& buffer,
+                              const std::vector<uint32_t>& values,
+                              int numPerSample)
+{
+    putTypeDescriptor(buffer, BcfTypedValues::BCF_TYPE_FLOAT, numPerSample);
+    if(!values.empty())
+    {
+        buffer.append((const char*)&(values[0]), values.size() * 4);
+    }
+}
+
+
+int BcfCodec::getIntType(const std::vector<int32_t>& values)
+{
+    int32_t minValue = 0;
+    int32_t maxValue = 0;
+    for(size_t i = 0; i < values.size(); i++)
+    {
+        int32_t value = values[i];
+        if((value == BcfTypedValues::INT32_MISSING) ||
+           (value == BcfTypedValues::INT32_VECTOR_END))
+        {
+            continue;
+        }
+        if(value < minValue)
+        {
+            minValue = value;
+        }
+        if(value > maxValue)
+        {
+            maxValue = value;
+        }
+    }
+    if((minValue >= BCF_INT8_MIN) && (maxValue <= INT8_MAX))
+    {
+        return(BcfTypedValues::BCF_TYPE_INT8);
+    }
+    if((minValue >= BCF_INT16_MIN) && (maxValue <= INT16_MAX))
+    {
+        return(BcfTypedValues::BCF_TYPE_INT16);
+    }
+    return(BcfTypedValues::BCF_TYPE_INT32);
+}
+
+
+
+
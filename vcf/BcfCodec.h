@@ -0,0 +1,158 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BCF_CODEC_H__
+#define __BCF_CODEC_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "InputFile.h"
+#include "VcfHeader.h"
+#include "VcfRecord.h"
+#include "VcfRecordDiscardRules.h"
+#include "VcfSubsetSamples.h"
+#include "BcfDictionary.h"
+#include "BcfTypedValues.h"
+
+/// Reads and writes the BCF2 (version 2.2) binary encoding of VCF, so
+/// VcfFileReader/VcfFileWriter can handle BCF files with the same VcfHeader
+/// and VcfRecord objects they use for text VCF.
+///
+/// Records are decoded into VcfRecord through its setters, so all record,
+/// INFO, and genotype accessors work the same as for text VCF, including
+/// sample subsetting and the genotype modes of VcfRecordGenotype.  INFO and
+/// FORMAT values are kept as their typed arrays and only converted to text
+/// when a string accessor asks for them, and the getInts/getFloats
+/// accessors read them straight from the typed arrays.  In GT matrix mode,
+/// GT is decoded straight from its typed array into the VcfGenotypeMatrix.
+class BcfCodec
+{
+public:
+    BcfCodec();
+    ~BcfCodec();
+
+    /// Return whether or not the file starts with the BCF2 magic, without
+    /// consuming it.
+    static bool isBcf(IFILE filePtr);
+
+    /// Read the magic and the header, setting up the dictionaries.
+    /// \param filePtr BCF file opened for reading.
+    /// \param header header to read the header text into.
+    /// \return true = success; false = failure, see getStatus.
+    bool readHeader(IFILE filePtr, VcfHeader& header);
+
+    /// Write the magic and the header, setting up the dictionaries.
+    /// \param filePtr BCF file opened for writing.
+    /// \param header header to write.
+    /// \return true = success; false = failure, see getStatus.
+    bool writeHeader(IFILE filePtr, VcfHeader& header);
+
+    /// Read the next record that is not discarded by the id rules.
+    /// \param filePtr BCF file positioned at the start of a record.
+    /// \param record record to populate.
+    /// \param siteOnly true to skip the FORMAT and samples.
+    /// \param discardRules rules used to skip records by id.
+    /// \param sampleSubset pointer to optional subsetting information.
+    /// \return true if a record was read, false at EOF or on failure (the
+    /// status is only set on failure).
+    bool readRecord(IFILE filePtr, VcfRecord& record, bool siteOnly,
+                    VcfRecordDiscardRules& discardRules,
+                    VcfSubsetSamples* sampleSubset);
+
+    /// Write the record.  Its CHROM, FILTER, INFO, and FORMAT keys must be
+    /// defined in the header that was written.
+    /// \param filePtr BCF file opened for writing.
+    /// \param record record to write.
+    /// \param siteOnly true to not write the FORMAT and samples.
+    /// \return true = success; false = failure, see getStatus.
+    bool writeRecord(IFILE filePtr, VcfRecord& record, bool siteOnly);
+
+    /// Get the dictionaries of the last header read/written.
+    inline const BcfDictionary& getDictionary() const { return(myDictionary); }
+
+    /// Get the contig dictionary index of the last record read, -1 if none.
+    inline int32_t getRefID() const { return(myRefID); }
+
+    /// Get the status of the last call that sets status.
+    inline const StatGenStatus& getStatus() const { return(myStatus); }
+
+private:
+    BcfCodec(const BcfCodec& codec);
+    BcfCodec& operator=(const BcfCodec& codec);
+
+    // Read a typed value descriptor and skip its values (count values for
+    // each of numVectors vectors), returns false if it is not valid or runs
+    // past end.
+    static bool readTyped(const uint8_t*& pos, const uint8_t* end,
+                          BcfTypedValues& typed, int numVectors = 1);
+    // Read a typed single integer.
+    static bool readTypedInt(const uint8_t*& pos, const uint8_t* end,
+                             int32_t& value);
+
+    // Encoding helpers, appending to buffer.
+    static void putInt32(std::string& buffer, int32_t value);
+    static void putTypeDescriptor(std::string& buffer, int type, int count);
+    static void putTypedInt(std::string& buffer, int32_t value);
+    static void putTypedString(std::string& buffer, const std::string& value);
+    static void putTypedInts(std::string& buffer,
+                             const std::vector<int32_t>& values,
+                             int numPerSample);
+    static void putTypedFloats(std::string& buffer,
+                               const std::vector<uint32_t>& values,
+                               int numPerSample);
+    static int getIntType(const std::vector<int32_t>& values);
+
+    bool encodeInfo(VcfRecord& record, std::string& buffer, int& numInfo);
+    bool encodeFormat(VcfRecord& record, std::string& buffer);
+    // Encode the values of one FORMAT key for every sample, padding each
+    // sample's values to the same number with the end of vector value.
+    bool encodeFormatValues(VcfRecordGenotype& genotype, int fieldIndex,
+                            const std::string& key,
+                            BcfDictionary::ValueType type,
+                            std::string& buffer);
+    bool decodeSamples(VcfRecord& record, int numFormat, int numSamples,
+                       VcfSubsetSamples* sampleSubset);
+
+    // Set a parse failure on the status, returns false.
+    bool failParse(const char* message);
+
+    BcfDictionary myDictionary;
+    int myNumHeaderSamples;
+    int32_t myRefID;
+
+    StatGenStatus myStatus;
+
+    // Buffers reused for each record.
+    std::vector<uint8_t> myShared;
+    std::vector<uint8_t> myIndiv;
+    std::string myText;
+    std::string mySharedOut;
+    std::string myIndivOut;
+    std::string mySampleText;
+    InputFile myTextFile;
+    std::vector<int32_t> myInts;
+    std::vector<uint32_t> myFloats;
+    std::vector<int32_t> myPadded;
+    std::vector<uint32_t> myPaddedFloats;
+    std::vector<int> myCounts;
+    std::vector<int32_t> myFormatKeys;
+    std::vector<const char*> myFormatNames;
+    std::vector<BcfTypedValues> myFormatValues;
+};
+
+#endif
@@ -0,0 +1,307 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BcfDictionary.h"
+#include <stdlib.h>
+#include <string.h>
+
+BcfDictionary::BcfDictionary()
+    : myStrings(),
+      myInfoTypes(),
+      myFormatTypes(),
+      myStringIndices(),
+      myContigs(),
+      myContigIndices(),
+      myMaxContigLength(0)
+{
+}
+
+
+BcfDictionary::~BcfDictionary()
+{
+}
+
+
+void BcfDictionary::set(VcfHeader& header)
+{
+    reset();
+
+    // PASS is always the first filter.
+    addEntry(myStrings, myStringIndices, "PASS", 0);
+
+    std::string key;
+    std::string id;
+    std::string type;
+    int idx = -1;
+    int64_t length = 0;
+    for(int i = 0; i < header.getNumMetaLines(); i++)
+    {
+        if(!parseMetaLine(header.getMetaLine(i), key, id, type, idx, length))
+        {
+            // Not a dictionary line.
+            continue;
+        }
+        if(key == "contig")
+        {
+            addEntry(myContigs, myContigIndices, id, idx);
+            if(length > myMaxContigLength)
+            {
+                myMaxContigLength = length;
+            }
+            continue;
+        }
+        bool info = (key == "INFO");
+        bool format = (key == "FORMAT");
+        if(!info && !format && (key != "FILTER"))
+        {
+            // Not a dictionary line.
+            continue;
+        }
+        int index = addEntry(myStrings, myStringIndices, id, idx);
+        myInfoTypes.resize(myStrings.size(), TYPE_UNDEFINED);
+        myFormatTypes.resize(myStrings.size(), TYPE_UNDEFINED);
+        if(info)
+        {
+            myInfoTypes[index] = getValueType(type);
+        }
+        else if(format)
+        {
+            myFormatTypes[index] = getValueType(type);
+        }
+    }
+    myInfoTypes.resize(myStrings.size(), TYPE_UNDEFINED);
+    myFormatTypes.resize(myStrings.size(), TYPE_UNDEFINED);
+}
+
+
+void BcfDictionary::reset()
+{
+    myStrings.clear();
+    myInfoTypes.clear();
+    myFormatTypes.clear();
+    myStringIndices.clear();
+    myContigs.clear();
+    myContigIndices.clear();
+    myMaxContigLength = 0;
+}
+
+
+int BcfDictionary::getStringIndex(const std::string& id) const
+{
+    std::map<std::string, int>::const_iterator iter =
+        myStringIndices.find(id);
+    if(iter == myStringIndices.end())
+    {
+        return(-1);
+    }
+    return(iter->second);
+}
+
+
+const char* BcfDictionary::getString(int index) const
+{
+    if((index < 0) || (index >= (int)myStrings.size()) ||
+       myStrings[index].empty())
+    {
+        return(NULL);
+    }
+    return(myStrings[index].c_str());
+}
+
+
+int BcfDictionary::getContigIndex(const std::string& name) const
+{
+    std::map<std::string, int>::const_iterator iter =
+        myContigIndices.find(name);
+    if(iter == myContigIndices.end())
+    {
+        return(-1);
+    }
+    return(iter->second);
+}
+
+
+const char* BcfDictionary::getContig(int index) const
+{
+    if((index < 0) || (index >= (int)myContigs.size()) ||
+       myContigs[index].empty())
+    {
+        return(NULL);
+    }
+    return(myContigs[index].c_str());
+}
+
+
+BcfDictionary::ValueType BcfDictionary::getInfoType(int index) const
+{
+    if((index < 0) || (index >= (int)myInfoTypes.size()))
+    {
+        return(TYPE_UNDEFINED);
+    }
+    return(myInfoTypes[index]);
+}
+
+
+BcfDictionary::ValueType BcfDictionary::getFormatType(int index) const
+{
+    if((index < 0) || (index >= (int)myFormatTypes.size()))
+    {
+        return(TYPE_UNDEFINED);
+    }
+    return(myFormatTypes[index]);
+}
+
+
+int BcfDictionary::addEntry(std::vector<std::string>& ids,
+                            std::map<std::string, int>& indices,
+                            const std::string& id, int idx)
+{
+    std::map<std::string, int>::iterator iter = indices.find(id);
+    if(iter != indices.end())
+    {
+        // Already in the dictionary.
+        return(iter->second);
+    }
+    if((idx < 0) || ((idx < (int)ids.size()) && !ids[idx].empty()))
+    {
+        // No index specified (or it is taken), so add it to the end.
+        idx = ids.size();
+    }
+    if(idx >= (int)ids.size())
+    {
+        ids.resize(idx + 1);
+    }
+    ids[idx] = id;
+    indices[id] = idx;
+    return(idx);
+}
+
+
+bool BcfDictionary::parseMetaLine(const char* line, std::string& key,
+                                  std::string& id, std::string& type,
+                                  int& idx, int64_t& length)
+{
+    key.clear();
+    id.clear();
+    type.clear();
+    idx = -1;
+    length = 0;
+
+    // Find the key, ##KEY=<
+    if((line[0] != '#') || (line[1] != '#'))
+    {
+        return(false);
+    }
+    const char* keyEnd = strchr(line + 2, '=');
+    if((keyEnd == NULL) || (keyEnd[1] != '<'))
+    {
+        // Not a structured meta line.
+        return(false);
+    }
+    key.assign(line + 2, keyEnd - (line + 2));
+
+    // Loop through the attributes, NAME=VALUE separated by ',', where
+    // the value may be quoted.
+    const char* pos = keyEnd + 2;
+    std::string name;
+    std::string value;
+    while((*pos != '\0') && (*pos != '>'))
+    {
+        const char* nameEnd = pos;
+        while((*nameEnd != '=') && (*nameEnd != ',') &&
+              (*nameEnd != '>') && (*nameEnd != '\0'))
+        {
+            ++nameEnd;
+        }
+        name.assign(pos, nameEnd - pos);
+        value.clear();
+        pos = nameEnd;
+        if(*pos == '=')
+        {
+            ++pos;
+            bool quoted = (*pos == '"');
+            if(quoted)
+            {
+                ++pos;
+            }
+            while(*pos != '\0')
+            {
+                if(quoted)
+                {
+                    if(*pos == '"')
+                    {
+                        ++pos;
+                        break;
+                    }
+                    if((*pos == '\\') && (pos[1] != '\0'))
+                    {
+                        ++pos;
+                    }
+                }
+                else if((*pos == ',') || (*pos == '>'))
+                {
+                    break;
+                }
+                value += *pos;
+                ++pos;
+            }
+        }
+        if(name == "ID")
+        {
+            id = value;
+        }
+        else if(name == "Type")
+        {
+            type = value;
+        }
+        else if(name == "IDX")
+        {
+            idx = atoi(value.c_str());
+        }
+        else if(name == "length")
+        {
+            length = atoll(value.c_str());
+        }
+        if(*pos == ',')
+        {
+            ++pos;
+        }
+    }
+    return(!id.empty());
+}
+
+
+BcfDictionary::ValueType BcfDictionary::getValueType(const std::string& type)
+{
+    if(type == "Integer")
+    {
+        return(TYPE_INTEGER);
+    }
+    if(type == "Float")
+    {
+        return(TYPE_FLOAT);
+    }
+    if(type == "Flag")
+    {
+        return(TYPE_FLAG);
+    }
+    if((type == "String") || (type == "Character"))
+    {
+        return(TYPE_STRING);
+    }
+    return(TYPE_UNDEFINED);
+}
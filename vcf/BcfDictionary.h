@@ -0,0 +1,120 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BCF_DICTIONARY_H__
+#define __BCF_DICTIONARY_H__
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "VcfHeader.h"
+
+/// The BCF2 dictionaries of a VCF header: BCF records refer to FILTER,
+/// INFO, and FORMAT keys by their index in the string dictionary and to
+/// CHROM by its index in the contig dictionary.
+///
+/// The string dictionary starts with PASS, followed by the IDs of the
+/// ##FILTER, ##INFO, and ##FORMAT lines in header order, with an ID shared
+/// by several of them getting one index.  The contig dictionary is the IDs
+/// of the ##contig lines in order.  A line with an IDX attribute is put at
+/// that index instead.
+class BcfDictionary
+{
+public:
+    /// Type of the values of an INFO or FORMAT key.
+    enum ValueType
+        {
+            TYPE_UNDEFINED = 0,
+            TYPE_FLAG,
+            TYPE_INTEGER,
+            TYPE_FLOAT,
+            TYPE_STRING
+        };
+
+    BcfDictionary();
+    ~BcfDictionary();
+
+    /// Build the dictionaries from the meta lines of the specified header.
+    void set(VcfHeader& header);
+
+    /// Clear the dictionaries.
+    void reset();
+
+    /// Get the string dictionary index of the specified FILTER/INFO/FORMAT
+    /// ID, or -1 if it is not in the header.
+    int getStringIndex(const std::string& id) const;
+
+    /// Get the FILTER/INFO/FORMAT ID at the specified index, or NULL if
+    /// there is none.
+    const char* getString(int index) const;
+
+    /// Get the number of entries in the string dictionary.
+    inline int getNumStrings() const { return(myStrings.size()); }
+
+    /// Get the contig dictionary index of the specified chromosome, or -1 if
+    /// it is not in the header.
+    int getContigIndex(const std::string& name) const;
+
+    /// Get the chromosome at the specified index, or NULL if there is none.
+    const char* getContig(int index) const;
+
+    /// Get the number of entries in the contig dictionary.
+    inline int getNumContigs() const { return(myContigs.size()); }
+
+    /// Get the longest length attribute of the ##contig lines, 0 if none
+    /// have a length.
+    inline int64_t getMaxContigLength() const { return(myMaxContigLength); }
+
+    /// Get the Type of the INFO key at the specified index, TYPE_UNDEFINED
+    /// if it is not an INFO key.
+    ValueType getInfoType(int index) const;
+
+    /// Get the Type of the FORMAT key at the specified index, TYPE_UNDEFINED
+    /// if it is not a FORMAT key.
+    ValueType getFormatType(int index) const;
+
+private:
+    BcfDictionary(const BcfDictionary& dictionary);
+    BcfDictionary& operator=(const BcfDictionary& dictionary);
+
+    // Get the index of the id in the dictionary, adding it at idx (or at
+    // the end if idx is -1) if it is not already there.
+    static int addEntry(std::vector<std::string>& ids,
+                        std::map<std::string, int>& indices,
+                        const std::string& id, int idx);
+
+    // Parse a ##KEY=<ID=...,...> line, setting the key and the ID, Type,
+    // IDX, and length attributes (idx is -1 and length is 0 if not set).
+    // Returns false if it is not a structured line with an ID.
+    static bool parseMetaLine(const char* line, std::string& key,
+                              std::string& id, std::string& type, int& idx,
+                              int64_t& length);
+
+    static ValueType getValueType(const std::string& type);
+
+    std::vector<std::string> myStrings;
+    std::vector<ValueType> myInfoTypes;
+    std::vector<ValueType> myFormatTypes;
+    std::map<std::string, int> myStringIndices;
+
+    std::vector<std::string> myContigs;
+    std::map<std::string, int> myContigIndices;
+    int64_t myMaxContigLength;
+};
+
+#endif
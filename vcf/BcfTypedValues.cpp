@@ -0,0 +1,361 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BcfTypedValues.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const int32_t BcfTypedValues::INT32_MISSING = INT32_MIN;
+const int32_t BcfTypedValues::INT32_VECTOR_END = INT32_MIN + 1;
+const uint32_t BcfTypedValues::FLOAT_MISSING = 0x7F800001;
+const uint32_t BcfTypedValues::FLOAT_VECTOR_END = 0x7F800002;
+
+
+int BcfTypedValues::getTypeSize(int type)
+{
+    switch(type)
+    {
+        case BCF_TYPE_NULL:
+            return(0);
+        case BCF_TYPE_INT8:
+        case BCF_TYPE_CHAR:
+            return(1);
+        case BCF_TYPE_INT16:
+            return(2);
+        case BCF_TYPE_INT32:
+        case BCF_TYPE_FLOAT:
+            return(4);
+        default:
+            return(-1);
+    }
+}
+
+
+int32_t BcfTypedValues::getInt(const uint8_t* value, int type)
+{
+    if(type == BCF_TYPE_INT8)
+    {
+        return((int8_t)*value);
+    }
+    if(type == BCF_TYPE_INT16)
+    {
+        int16_t value16;
+        memcpy(&value16, value, 2);
+        return(value16);
+    }
+    int32_t value32;
+    memcpy(&value32, value, 4);
+    return(value32);
+}
+
+
+int32_t BcfTypedValues::getMissing(int type)
+{
+    return((int32_t)(~(uint32_t)0 << (getTypeSize(type) * 8 - 1)));
+}
+
+
+bool BcfTypedValues::hasValues(const uint8_t* values, int type, int count)
+{
+    if(count <= 0)
+    {
+        return(false);
+    }
+    if(type == BCF_TYPE_CHAR)
+    {
+        return(values[0] != '\0');
+    }
+    if(type == BCF_TYPE_FLOAT)
+    {
+        uint32_t bits;
+        memcpy(&bits, values, 4);
+        return(bits != FLOAT_VECTOR_END);
+    }
+    if(!isInt(type))
+    {
+        return(false);
+    }
+    return(getInt(values, type) != getMissing(type) + 1);
+}
+
+
+bool BcfTypedValues::appendValues(const uint8_t* values, int type, int count,
+                            std::string& text)
+{
+    if(type == BCF_TYPE_CHAR)
+    {
+        // Up to the first null.
+        const uint8_t* nullPos = (const uint8_t*)memchr(values, '\0', count);
+        size_t length = (nullPos == NULL) ? count : (nullPos - values);
+        text.append((const char*)values, length);
+        return(length != 0);
+    }
+    if(type == BCF_TYPE_FLOAT)
+    {
+        int i = 0;
+        for(i = 0; i < count; i++)
+        {
+            uint32_t bits;
+            memcpy(&bits, values + i * 4, 4);
+            if(bits == FLOAT_VECTOR_END)
+            {
+                break;
+            }
+            if(i != 0)
+            {
+                text += ',';
+            }
+            if(bits == FLOAT_MISSING)
+            {
+                text += '.';
+            }
+            else
+            {
+                float value;
+                memcpy(&value, &bits, 4);
+                appendFloat(value, text);
+            }
+        }
+        return(i != 0);
+    }
+    if(!isInt(type))
+    {
+        // No values.
+        return(false);
+    }
+    int typeSize = getTypeSize(type);
+    int32_t missing = getMissing(type);
+    int i = 0;
+    for(i = 0; i < count; i++)
+    {
+        int32_t value = getInt(values + i * typeSize, type);
+        if(value == missing + 1)
+        {
+            // End of the vector.
+            break;
+        }
+        if(i != 0)
+        {
+            text += ',';
+        }
+        if(value == missing)
+        {
+            text += '.';
+        }
+        else
+        {
+            text += std::to_string((long long int)value);
+        }
+    }
+    return(i != 0);
+}
+
+
+bool BcfTypedValues::appendGT(const uint8_t* values, int type, int count,
+                        std::string& text)
+{
+    if(!isInt(type))
+    {
+        // No values.
+        return(false);
+    }
+    int typeSize = getTypeSize(type);
+    int32_t missing = getMissing(type);
+    int i = 0;
+    for(i = 0; i < count; i++)
+    {
+        int32_t value = getInt(values + i * typeSize, type);
+        if((value == missing + 1) || ((value == missing) && (i != 0)))
+        {
+            // End of the vector.
+            break;
+        }
+        if(i != 0)
+        {
+            text += (value & 1) ? '|' : '/';
+        }
+        int allele = (value >> 1) - 1;
+        if((value == missing) || (allele < 0))
+        {
+            text += '.';
+        }
+        else
+        {
+            text += std::to_string((long long int)allele);
+        }
+    }
+    return(i != 0);
+}
+
+
+void BcfTypedValues::appendFloat(float value, std::string& text)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%g", value);
+    text += buffer;
+}
+
+bool BcfTypedValues::getInts(const uint8_t* values, int type, int count,
+                             std::vector<int32_t>& ints)
+{
+    if(!isInt(type))
+    {
+        return(false);
+    }
+    int typeSize = getTypeSize(type);
+    int32_t missing = getMissing(type);
+    for(int i = 0; i < count; i++)
+    {
+        int32_t value = getInt(values + i * typeSize, type);
+        if(value == missing + 1)
+        {
+            // End of the vector.
+            break;
+        }
+        ints.push_back((value == missing) ? INT32_MISSING : value);
+    }
+    return(true);
+}
+
+
+bool BcfTypedValues::getFloats(const uint8_t* values, int type, int count,
+                               std::vector<float>& floats)
+{
+    if(isInt(type))
+    {
+        // Integer values read as floats, like text values would be.
+        std::vector<int32_t> ints;
+        getInts(values, type, count, ints);
+        for(unsigned int i = 0; i < ints.size(); i++)
+        {
+            if(ints[i] == INT32_MISSING)
+            {
+                float value;
+                memcpy(&value, &FLOAT_MISSING, 4);
+                floats.push_back(value);
+            }
+            else
+            {
+                floats.push_back(ints[i]);
+            }
+        }
+        return(true);
+    }
+    if(type != BCF_TYPE_FLOAT)
+    {
+        return(false);
+    }
+    for(int i = 0; i < count; i++)
+    {
+        uint32_t bits;
+        memcpy(&bits, values + i * 4, 4);
+        if(bits == FLOAT_VECTOR_END)
+        {
+            break;
+        }
+        float value;
+        memcpy(&value, &bits, 4);
+        floats.push_back(value);
+    }
+    return(true);
+}
+
+
+bool BcfTypedValues::parseInts(const std::string& text,
+                         std::vector<int32_t>& values)
+{
+    const char* pos = text.c_str();
+    while(true)
+    {
+        if((pos[0] == '.') && ((pos[1] == ',') || (pos[1] == '\0')))
+        {
+            values.push_back(INT32_MISSING);
+            ++pos;
+        }
+        else
+        {
+            char* valueEnd = NULL;
+            long value = strtol(pos, &valueEnd, 10);
+            if((valueEnd == pos) || ((*valueEnd != ',') && (*valueEnd != '\0')) ||
+               (value <= INT32_VECTOR_END) || (value > INT32_MAX))
+            {
+                return(false);
+            }
+            values.push_back(value);
+            pos = valueEnd;
+        }
+        if(*pos == '\0')
+        {
+            return(true);
+        }
+        // Skip the ','.
+        ++pos;
+    }
+}
+
+
+bool BcfTypedValues::parseFloats(const std::string& text,
+                           std::vector<uint32_t>& values)
+{
+    const char* pos = text.c_str();
+    while(true)
+    {
+        if((pos[0] == '.') && ((pos[1] == ',') || (pos[1] == '\0')))
+        {
+            values.push_back(FLOAT_MISSING);
+            ++pos;
+        }
+        else
+        {
+            char* valueEnd = NULL;
+            float value = strtof(pos, &valueEnd);
+            if((valueEnd == pos) || ((*valueEnd != ',') && (*valueEnd != '\0')))
+            {
+                return(false);
+            }
+            uint32_t bits;
+            memcpy(&bits, &value, 4);
+            values.push_back(bits);
+            pos = valueEnd;
+        }
+        if(*pos == '\0')
+        {
+            return(true);
+        }
+        // Skip the ','.
+        ++pos;
+    }
+}
+
+
+bool BcfTypedValues::parseFloats(const std::string& text,
+                                 std::vector<float>& values)
+{
+    std::vector<uint32_t> bits;
+    if(!parseFloats(text, bits))
+    {
+        return(false);
+    }
+    size_t prevSize = values.size();
+    values.resize(prevSize + bits.size());
+    if(!bits.empty())
+    {
+        memcpy(&(values[prevSize]), &(bits[0]), bits.size() * 4);
+    }
+    return(true);
+}
@@ -0,0 +1,130 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BCF_TYPED_VALUES_H__
+#define __BCF_TYPED_VALUES_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/// The BCF2 typed values of an INFO or FORMAT key (type, number of values,
+/// and where they are), with helpers for the types, missing and end of
+/// vector values, and conversion between typed values and ints, floats,
+/// or the VCF text of the values.
+class BcfTypedValues
+{
+public:
+    /// The BCF2 type of typed values.
+    enum BcfType
+        {
+            BCF_TYPE_NULL = 0,
+            BCF_TYPE_INT8 = 1,
+            BCF_TYPE_INT16 = 2,
+            BCF_TYPE_INT32 = 3,
+            BCF_TYPE_FLOAT = 5,
+            BCF_TYPE_CHAR = 7
+        };
+
+    /// Missing and end of vector values of ints (smaller integer types
+    /// are mapped to these) and of floats (as their bits, the missing
+    /// value is a NaN).
+    static const int32_t INT32_MISSING;
+    static const int32_t INT32_VECTOR_END;
+    static const uint32_t FLOAT_MISSING;
+    static const uint32_t FLOAT_VECTOR_END;
+
+    BcfTypedValues()
+        : type(BCF_TYPE_NULL), count(0), values(NULL)
+    {}
+
+    /// Type of the values (BcfType).
+    int type;
+    /// Number of values, per sample for a FORMAT key.
+    int count;
+    /// The first value, the values of each sample follow each other for a
+    /// FORMAT key.
+    const uint8_t* values;
+
+    /// Get the size of a value of the specified type, -1 if it is not a
+    /// valid type.
+    static int getTypeSize(int type);
+
+    /// Return whether or not the type is one of the integer types.
+    static inline bool isInt(int type)
+    {
+        return((type >= BCF_TYPE_INT8) && (type <= BCF_TYPE_INT32));
+    }
+
+    /// Get the value of an integer type.
+    static int32_t getInt(const uint8_t* value, int type);
+
+    /// Get the missing value of an integer type (the end of vector value
+    /// is one more).
+    static int32_t getMissing(int type);
+
+    /// Return whether or not there are any values before the end of vector
+    /// (for strings, before the first null).
+    static bool hasValues(const uint8_t* values, int type, int count);
+
+    /// Append the values to the string as VCF text, separating numbers
+    /// with ',' and writing missing values as '.'.
+    /// \return false if there were no values before the end of vector.
+    static bool appendValues(const uint8_t* values, int type, int count,
+                             std::string& text);
+
+    /// Append GT values (((allele + 1) << 1) | phased) to the string as
+    /// VCF text, such as 0|1.
+    /// \return false if there were no values before the end of vector.
+    static bool appendGT(const uint8_t* values, int type, int count,
+                         std::string& text);
+
+    static void appendFloat(float value, std::string& text);
+
+    /// Append the values up to the end of vector to ints, with missing
+    /// values as INT32_MISSING.
+    /// \return false if the type is not an integer type.
+    static bool getInts(const uint8_t* values, int type, int count,
+                        std::vector<int32_t>& ints);
+
+    /// Append the values up to the end of vector to floats, with missing
+    /// values as NaN.  Integer values are converted to float.
+    /// \return false if the type is not float or an integer type.
+    static bool getFloats(const uint8_t* values, int type, int count,
+                          std::vector<float>& floats);
+
+    /// Append a VCF text list of integers separated by ',' to values, with
+    /// missing ('.') values as INT32_MISSING.
+    /// \return false if a value is not an integer.
+    static bool parseInts(const std::string& text,
+                          std::vector<int32_t>& values);
+
+    /// Append a VCF text list of floats separated by ',' to values as their
+    /// bits, with missing ('.') values as FLOAT_MISSING.
+    /// \return false if a value is not a number.
+    static bool parseFloats(const std::string& text,
+                            std::vector<uint32_t>& values);
+
+    /// Append a VCF text list of floats separated by ',' to values, with
+    /// missing ('.') values as NaN.
+    /// \return false if a value is not a number.
+    static bool parseFloats(const std::string& text,
+                            std::vector<float>& values);
+};
+
+#endif
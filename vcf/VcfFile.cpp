@@ -23,7 +23,10 @@ VcfFile::VcfFile()
 {
   myFilePtr = NULL;
   mySiteOnly = false;
+  myNumThreads = 0;
+  myCompressionLevel = -1;
   myNumRecords = 0;
+  myIsBcf = false;
 }
 
 VcfFile::~VcfFile()
@@ -44,7 +47,17 @@ bool VcfFile::open(const char* filename, const char* mode,
     // Reset for any previously operated on files.
     reset();
 
-    myFilePtr = ifopen(filename, mode, compressionMode);
+    std::string openMode = mode;
+    if(((mode[0] == 'w') || (mode[0] == 'W')) &&
+       (compressionMode == InputFile::BGZF) &&
+       (myCompressionLevel >= 0) && (myCompressionLevel <= 9))
+    {
+        // Pass the compression level to bgzf through the mode.
+        openMode += (char)('0' + myCompressionLevel);
+    }
+
+    myFilePtr = ifopen(filename, openMode.c_str(), compressionMode,
+                       myNumThreads);
 
     if(myFilePtr == NULL)
     {
@@ -79,4 +92,5 @@ void VcfFile::reset()
         myFilePtr = NULL;
     }
     myNumRecords = 0;
+    myIsBcf = false;
 }
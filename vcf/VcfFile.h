@@ -22,6 +22,7 @@
 
 #include "InputFile.h"
 #include "VcfHeader.h"
+#include "BcfCodec.h"
 
 /// This header file provides interface to read/write VCF files.
 class VcfFile {
@@ -40,7 +41,7 @@ public:
     virtual bool open(const char* filename, VcfHeader& header) = 0;
     
     /// Close the file if it is open.
-    void close();
+    virtual void close();
 
     /// When set to true, read only the first 8 columns, skipping the format
     /// and genotype fields, so when reading do not store them, and when
@@ -49,6 +50,30 @@ public:
     /// \param siteOnly process only the first 8 columns
     void setSiteOnly(bool siteOnly) {mySiteOnly = siteOnly;}
 
+    /// Set the number of worker threads used to decompress (when reading) or
+    /// compress (when writing) BGZF files.  Records are still processed in
+    /// file order.  Applies to the open file and to files opened afterwards.
+    /// This setting is maintained even when the file is reset/closed.
+    /// \param numThreads number of worker threads, 0 to process the blocks
+    /// on the calling thread (default).
+    void setNumThreads(int numThreads)
+    {
+        myNumThreads = numThreads;
+        if(myFilePtr != NULL)
+        {
+            myFilePtr->setNumThreads(numThreads);
+        }
+    }
+
+    /// Set the compression level (0-9) used for BGZF files opened for
+    /// writing after this call, -1 for the default level.
+    /// This setting is maintained even when the file is reset/closed.
+    /// \param compressionLevel zlib compression level.
+    void setCompressionLevel(int compressionLevel)
+    {
+        myCompressionLevel = compressionLevel;
+    }
+
     /// Get the number of VCF records that have been processed (read/written)
     /// so far including any filtered records.
     int getNumRecords() {return(myNumRecords);}
@@ -59,6 +84,9 @@ public:
     //        return(myStatus.getStatus());
     //    }
 
+    /// Return whether or not the open file is BCF rather than text VCF.
+    bool isBcf() const {return(myIsBcf);}
+
     /// Get the filename that is currently opened.
     /// \return filename associated with this class
     const char* getFileName() const
@@ -85,9 +113,16 @@ protected:
 
     bool mySiteOnly;
 
+    int myNumThreads;
+    int myCompressionLevel;
+
     // Number of records read/written so far.  Child classes need to set this.
     int myNumRecords;
 
+    // Set if the open file is BCF, which is read/written by myBcfCodec.
+    bool myIsBcf;
+    BcfCodec myBcfCodec;
+
 private:
     VcfFile(const VcfFile& vcfFile);
     VcfFile& operator=(const VcfFile& vcfFile);
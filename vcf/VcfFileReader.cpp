@@ -22,6 +22,7 @@
 VcfFileReader::VcfFileReader()
     : VcfFile(),
       myVcfIndex(NULL),
+      myCsiIndex(NULL),
       myNewSection(false),
       mySectionChrom(""),
       mySection1BasedStartPos(-1),
@@ -36,7 +37,10 @@ VcfFileReader::VcfFileReader()
       myMinorAlleleCountSubset(NULL),
       myDiscardRules(0),
       myNumKeptRecords(0),
-      myTotalRead(0)
+      myTotalRead(0),
+      myNumParseThreads(0),
+      myParser(NULL),
+      myParsing(false)
 {
   myFilePtr = NULL;
 }
@@ -45,6 +49,11 @@ VcfFileReader::VcfFileReader()
 VcfFileReader::~VcfFileReader() 
 {
     resetFile();
+    if(myParser != NULL)
+    {
+        delete myParser;
+        myParser = NULL;
+    }
 }
 
 
@@ -56,8 +65,19 @@ bool VcfFileReader::open(const char* filename, VcfHeader& header)
     myStatus = StatGenStatus::SUCCESS;
     if(VcfFile::open(filename, "r"))
     {
+        myIsBcf = BcfCodec::isBcf(myFilePtr);
+        if(myIsBcf)
+        {
+            // Successfully opened a BCF file, so read the header.
+            if(!myBcfCodec.readHeader(myFilePtr, header))
+            {
+                // Failed, so copy the status.
+                myStatus = myBcfCodec.getStatus();
+                return(false);
+            }
+        }
         // Successfully opened, so read the header.
-        if(!header.read(myFilePtr))
+        else if(!header.read(myFilePtr))
         {
             // Failed, so copy the status.
             myStatus = header.getStatus();
@@ -110,11 +130,24 @@ bool VcfFileReader::readVcfIndex(const char* vcfIndexFilename)
         delete myVcfIndex;
         myVcfIndex = NULL;
     }
+    if(myCsiIndex != NULL)
+    {
+        delete myCsiIndex;
+        myCsiIndex = NULL;
+    }
 
     // Create a new vcf index.
     myVcfIndex = new Tabix();
     StatGenStatus::Status indexStat = myVcfIndex->readIndex(vcfIndexFilename);
 
+    if(indexStat == StatGenStatus::FAIL_PARSE)
+    {
+        // Not a tabix index, so check for CSI.
+        delete myVcfIndex;
+        myVcfIndex = NULL;
+        return(readCsiIndex(vcfIndexFilename));
+    }
+
     if(indexStat != StatGenStatus::SUCCESS)
     {
         std::string errorMessage = "Failed to read the vcf Index file: ";
@@ -140,6 +173,37 @@ bool VcfFileReader::readVcfIndex(const char* vcfIndexFilename)
 }
 
 
+bool VcfFileReader::readCsiIndex(const char* csiIndexFilename)
+{
+    myCsiIndex = new CsiIndex();
+    StatGenStatus::Status indexStat = myCsiIndex->readIndex(csiIndexFilename);
+
+    if(indexStat != StatGenStatus::SUCCESS)
+    {
+        std::string errorMessage = "Failed to read the vcf Index file: ";
+        errorMessage += csiIndexFilename;
+        delete myCsiIndex;
+        myCsiIndex = NULL;
+        myStatus.setStatus(indexStat, errorMessage.c_str());
+        return(false);
+    }
+
+    // BCF records are found by contig index, VCF by name.
+    if(!myIsBcf && !myCsiIndex->hasRefNames())
+    {
+        std::string errorMessage = "ERROR: CSI file has no reference names: ";
+        errorMessage += csiIndexFilename;
+        delete myCsiIndex;
+        myCsiIndex = NULL;
+        myStatus.setStatus(StatGenStatus::FAIL_PARSE, errorMessage.c_str());
+        return(false);
+    }
+
+    myStatus = StatGenStatus::SUCCESS;
+    return(true);
+}
+
+
 // Read VCF Index file.
 bool VcfFileReader::readVcfIndex()
 {
@@ -157,6 +221,12 @@ bool VcfFileReader::readVcfIndex()
     const char* vcfBaseName = myFilePtr->getFileName();
     
     std::string indexName = vcfBaseName;
+    if(myIsBcf)
+    {
+        // BCF files are indexed by CSI.
+        indexName += ".csi";
+        return(readVcfIndex(indexName.c_str()));
+    }
     indexName += ".tbi";
 
     bool foundFile = true;
@@ -211,6 +281,13 @@ const Tabix* VcfFileReader::getVcfIndex()
 }
 
 
+// return a pointer to the CSI Index file.
+const CsiIndex* VcfFileReader::getCsiIndex()
+{
+    return(myCsiIndex);
+}
+
+
 bool VcfFileReader::readRecord(VcfRecord& record, VcfSubsetSamples* subset)
 {
     myStatus = StatGenStatus::SUCCESS;
@@ -225,7 +302,7 @@ bool VcfFileReader::readRecord(VcfRecord& record, VcfSubsetSamples* subset)
     bool searchChrom = false;
     if(myNewSection)
     {
-        if(myVcfIndex != NULL)
+        if((myVcfIndex != NULL) || (myCsiIndex != NULL))
         {
             // Have an index file so use
             if(!processNewSection())
@@ -250,13 +327,32 @@ bool VcfFileReader::readRecord(VcfRecord& record, VcfSubsetSamples* subset)
         }
     }
 
+    if(!myParsing && (myNumParseThreads > 0) && (myFilePtr != NULL) &&
+       !myIsBcf)
+    {
+        // Start parsing on other threads, falling back to this thread if
+        // they can't be started.
+        if((myParser != NULL) &&
+           (myParser->getNumWorkers() != myNumParseThreads))
+        {
+            delete myParser;
+            myParser = NULL;
+        }
+        if(myParser == NULL)
+        {
+            myParser = new VcfParallelParser(myNumParseThreads);
+        }
+        myParsing = myParser->start(myFilePtr, mySiteOnly,
+                                    myRecordDiscardRules, subsetPtr, *this);
+    }
+
     // Keep looping until a desired record is found.
     bool recordFound = false;
+    bool discard = false;
     while(!recordFound)
     {
-        if(!record.read(myFilePtr, mySiteOnly, myRecordDiscardRules, subsetPtr))
+        if(!readNextRecord(record, subsetPtr, discard))
         {
-            myStatus = record.getStatus();
             myTotalRead += myRecordDiscardRules.getNumDiscarded();
             myNumRecords += myRecordDiscardRules.getNumDiscarded();
             myRecordDiscardRules.clearNumDiscarded();
@@ -315,94 +411,106 @@ bool VcfFileReader::readRecord(VcfRecord& record, VcfSubsetSamples* subset)
         myNumRecords += myRecordDiscardRules.getNumDiscarded();
         myRecordDiscardRules.clearNumDiscarded();
         
-        // Record successfully read, so check to see if it is discarded.
-        if((myDiscardRules & DISCARD_NON_PHASED) && !record.allPhased())
-        {
-            // Not all samples are phased, so discard this record.
-            continue;
-        }
-        if((myDiscardRules & DISCARD_MISSING_GT) &&
-           !record.hasAllGenotypeAlleles())
+        // Record successfully read, so check to see if it is discarded
+        // (the parse threads already checked).
+        if(myParsing ? discard : discardRecord(record))
         {
-            // discard missing GTs and this record had missing alleles,
-            // so keep reading.
-            continue;
-        }
-        if((myDiscardRules & DISCARD_FILTERED) && 
-           !(record.getFilter().passedAllFilters()))
-        {
-            // Record was filtered, so discard it.
-            continue;
-        }
-        if((myDiscardRules & DISCARD_MULTIPLE_ALTS) &&
-           (record.getNumAlts() > 1))
-        {
-            // Record had multiple alternates, so discard.
             continue;
         }
 
-        // Check allele counts for discarding.
-        if(myMinAltAlleleCount != UNSET_MIN_ALT_ALLELE_COUNT)
+        // Record was not discarded.
+        recordFound = true;
+    }
+
+    // Increment the number of kept records.
+    ++myNumKeptRecords;
+    return(true);
+}
+
+
+bool VcfFileReader::discardRecord(VcfRecord& record)
+{
+    if((myDiscardRules & DISCARD_NON_PHASED) && !record.allPhased())
+    {
+        // Not all samples are phased, so discard this record.
+        return(true);
+    }
+    if((myDiscardRules & DISCARD_MISSING_GT) &&
+       !record.hasAllGenotypeAlleles())
+    {
+        // discard missing GTs and this record had missing alleles.
+        return(true);
+    }
+    if((myDiscardRules & DISCARD_FILTERED) && 
+       !(record.getFilter().passedAllFilters()))
+    {
+        // Record was filtered, so discard it.
+        return(true);
+    }
+    if((myDiscardRules & DISCARD_MULTIPLE_ALTS) &&
+       (record.getNumAlts() > 1))
+    {
+        // Record had multiple alternates, so discard.
+        return(true);
+    }
+
+    // Check allele counts for discarding.
+    if(myMinAltAlleleCount != UNSET_MIN_ALT_ALLELE_COUNT)
+    {
+        // Count the number of alternates.
+        int32_t altCount = 0;
+        for(int sampleNum = 0; sampleNum < record.getNumSamples(); 
+            sampleNum++)
         {
-            // Count the number of alternates.
-            int32_t altCount = 0;
-            for(int sampleNum = 0; sampleNum < record.getNumSamples(); 
-                sampleNum++)
-            {
-                if((myAltAlleleCountSubset != NULL) &&
-                   !(myAltAlleleCountSubset->keep(sampleNum)))
-                {
-                    // Skip this sample.
-                    continue;
-                }
-                for(int gtNum = 0; gtNum < record.getNumGTs(sampleNum); gtNum++)
-                {
-                    if(record.getGT(sampleNum, gtNum) > 0)
-                    {
-                        // Alternate, so increment the count.
-                        ++altCount;
-                    }
-                }
-            }
-            if(altCount < myMinAltAlleleCount)
+            if((myAltAlleleCountSubset != NULL) &&
+               !(myAltAlleleCountSubset->keep(sampleNum)))
             {
-                // Not enough alternates so continue to the next sample.
+                // Skip this sample.
                 continue;
             }
-        }
-
-        // Check to see if the minimum alternate allele count is met.
-        if(myMinMinorAlleleCount != UNSET_MIN_MINOR_ALLELE_COUNT)
-        {
-            // Get the number of possible alternates.
-            unsigned int numAlts = record.getNumAlts();
-
-            // Verify that each allele has the min count.
-            bool failMinorAlleleCount = false;
-            for(unsigned int i = 0; i <= numAlts; i++)
+            for(int gtNum = 0; gtNum < record.getNumGTs(sampleNum); gtNum++)
             {
-                if(record.getAlleleCount(i, myMinorAlleleCountSubset) 
-                   < myMinMinorAlleleCount)
+                if(record.getGT(sampleNum, gtNum) > 0)
                 {
-                    // Not enough of one gt, so not ok.
-                    failMinorAlleleCount = true;
-                    break;
+                    // Alternate, so increment the count.
+                    ++altCount;
                 }
             }
-            if(failMinorAlleleCount)
+        }
+        if(altCount < myMinAltAlleleCount)
+        {
+            // Not enough alternates, so discard.
+            return(true);
+        }
+    }
+
+    // Check to see if the minimum alternate allele count is met.
+    if(myMinMinorAlleleCount != UNSET_MIN_MINOR_ALLELE_COUNT)
+    {
+        // Get the number of possible alternates.
+        unsigned int numAlts = record.getNumAlts();
+
+        // Verify that each allele has the min count.
+        bool failMinorAlleleCount = false;
+        for(unsigned int i = 0; i <= numAlts; i++)
+        {
+            if(record.getAlleleCount(i, myMinorAlleleCountSubset) 
+               < myMinMinorAlleleCount)
             {
-                // not enough alleles, so continue to the next record.
-                continue;
+                // Not enough of one gt, so not ok.
+                failMinorAlleleCount = true;
+                break;
             }
         }
-
-        // Record was not discarded.
-        recordFound = true;
+        if(failMinorAlleleCount)
+        {
+            // not enough alleles, so discard.
+            return(true);
+        }
     }
 
-    // Increment the number of kept records.
-    ++myNumKeptRecords;
-    return(true);
+    // Record was not discarded.
+    return(false);
 }
 
 
@@ -429,6 +537,12 @@ bool VcfFileReader::set1BasedReadSection(const char* chromName,
 // return: int - true = EOF; false = not eof.
 bool VcfFileReader::isEOF()
 {
+    if(myParsing)
+    {
+        // The parse threads are reading the file, so check if they have
+        // returned everything.
+        return(myParser->isEOF());
+    }
     if (myFilePtr != NULL)
     {
         // File Pointer is set, so return if eof.
@@ -483,6 +597,7 @@ void VcfFileReader::rmDiscardMinMinorAlleleCount()
 
 void VcfFileReader::resetFile()
 {
+    stopParsing();
     myRecordDiscardRules.reset(),
     mySampleSubset.reset();
     myUseSubset = false;
@@ -499,15 +614,23 @@ void VcfFileReader::resetFile()
         delete myVcfIndex;
         myVcfIndex = NULL;
     }
+    if(myCsiIndex != NULL)
+    {
+        delete myCsiIndex;
+        myCsiIndex = NULL;
+    }
 }
 
 
 bool VcfFileReader::processNewSection()
 {
     myNewSection = false;
+
+    // Records parsed ahead are not in the new section.
+    stopParsing();
     
     // Check to see if the index file has been read.
-    if(myVcfIndex == NULL)
+    if((myVcfIndex == NULL) && (myCsiIndex == NULL))
     {
         myStatus.setStatus(StatGenStatus::FAIL_ORDER, 
                            "Cannot read section since there is no index file open");
@@ -528,9 +651,27 @@ bool VcfFileReader::processNewSection()
 
     uint64_t startPos = 0;
     // Find where this section starts in the file.
-    if(!myVcfIndex->getStartPos(mySectionChrom.c_str(),
-                                mySection1BasedStartPos, 
-                                startPos))
+    bool found = false;
+    if(myVcfIndex != NULL)
+    {
+        found = myVcfIndex->getStartPos(mySectionChrom.c_str(),
+                                        mySection1BasedStartPos, 
+                                        startPos);
+    }
+    else if(myIsBcf)
+    {
+        // BCF indexes refer to the contigs by their dictionary index.
+        found = myCsiIndex->getStartPos(
+            myBcfCodec.getDictionary().getContigIndex(mySectionChrom),
+            mySection1BasedStartPos, startPos);
+    }
+    else
+    {
+        found = myCsiIndex->getStartPos(mySectionChrom.c_str(),
+                                        mySection1BasedStartPos, 
+                                        startPos);
+    }
+    if(!found)
     {
         // Didn't find the position.
         myStatus = StatGenStatus::NO_MORE_RECS;
@@ -549,3 +690,46 @@ bool VcfFileReader::processNewSection()
     }
     return(true);
 }
+
+
+bool VcfFileReader::readNextRecord(VcfRecord& record,
+                                   VcfSubsetSamples* subset, bool& discard)
+{
+    if(myParsing)
+    {
+        int numIDDiscards = 0;
+        bool success = myParser->next(record, numIDDiscards, discard);
+        myRecordDiscardRules.addNumDiscarded(numIDDiscards);
+        if(!success)
+        {
+            myStatus = myParser->getStatus();
+        }
+        return(success);
+    }
+    if(myIsBcf)
+    {
+        if(!myBcfCodec.readRecord(myFilePtr, record, mySiteOnly,
+                                  myRecordDiscardRules, subset))
+        {
+            myStatus = myBcfCodec.getStatus();
+            return(false);
+        }
+        return(true);
+    }
+    if(!record.read(myFilePtr, mySiteOnly, myRecordDiscardRules, subset))
+    {
+        myStatus = record.getStatus();
+        return(false);
+    }
+    return(true);
+}
+
+
+void VcfFileReader::stopParsing()
+{
+    if(myParsing)
+    {
+        myParser->stop();
+        myParsing = false;
+    }
+}
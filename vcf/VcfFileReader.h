@@ -24,7 +24,9 @@
 #include "VcfRecord.h"
 #include "VcfRecordDiscardRules.h"
 #include "VcfSubsetSamples.h"
+#include "VcfParallelParser.h"
 #include "Tabix.h"
+#include "CsiIndex.h"
 
 #ifdef __GXX_EXPERIMENTAL_CXX0X__
 #include <unordered_set>
@@ -49,6 +51,8 @@ public:
     virtual ~VcfFileReader();
 
     /// Open the vcf file with the specified filename for reading.
+    /// BCF2 files are detected by their magic and read into the same header
+    /// and record objects as text VCF.
     /// This method does no sample subsetting.
     /// \param  filename the vcf file to open for reading.
     /// \param header to be read from the file
@@ -78,6 +82,7 @@ public:
 
     /// Read the specified vcf index file.  It must be read prior to setting a
     /// read section, for seeking and reading portions of a vcf file.
+    /// It may be a Tabix or a CSI index (BCF files are indexed by CSI).
     /// \param filename the name of the vcf index file to be read.
     /// \return true = success; false = failure.
     bool readVcfIndex(const char * filename);
@@ -89,6 +94,7 @@ public:
     /// VCF filename as a base name for the index file.
     /// First it tries filename.vcf.tbi. If that fails, it tries
     /// it without the .vcf extension, filename.tbi.
+    /// For BCF files, it reads filename.bcf.csi.
     /// \return true = success; false = failure.
     bool readVcfIndex();
 
@@ -97,14 +103,32 @@ public:
     /// index has not been read.
     const Tabix* getVcfIndex();
 
+    /// Get the CSI index (it must have already been read).
+    /// \return a const pointer to the CSI index, or NULL if a CSI index
+    /// has not been read.
+    const CsiIndex* getCsiIndex();
+
     /// Read the next Vcf record from the file until a line passes all
     /// discard rules (if any) or until the end of the file is found..
     /// \param record record to populate with the next record.
     /// \param subset ptr to subset of samples to keep.  This overrides
-    ///         mySampleSubset that may have been set at open.
+    ///         mySampleSubset that may have been set at open.  When parsing
+    ///         on multiple threads, the subset passed to the first read
+    ///         (of the file or of a new section) is used until the next one.
     /// \return true if successful, false if not.
     bool readRecord(VcfRecord& record, VcfSubsetSamples* subset = NULL);
 
+    /// Set the number of worker threads used to parse records, with one more
+    /// thread reading the lines ahead of them (not used for BCF files).  Records are still returned
+    /// in file order, with the discard rules and sample subsetting applied
+    /// by the workers, so neither can be changed while reading a file or
+    /// section.  Applies from the next read of a file or section; without
+    /// pthreads records are always parsed on the calling thread.
+    /// This setting is maintained even when the file is reset/closed.
+    /// \param numThreads number of parse threads, 0 to parse the records
+    /// on the calling thread (default).
+    void setNumParseThreads(int numThreads) { myNumParseThreads = numThreads; }
+
     /// Only read the specified chromosome when readRecord is called.
     /// If an index is not used, the read section can only be set prior to 
     /// reading any records.
@@ -203,6 +227,12 @@ public:
     /// Remove the discard rule for minimum alternate allele count.
     void rmDiscardMinMinorAlleleCount();
 
+    /// Return whether or not the discard rules set by setDiscardRules and
+    /// the minimum allele counts discard the specified record (the id rules
+    /// are applied while reading).  Called from the parse threads, so it
+    /// only reads the rules.
+    bool discardRecord(VcfRecord& record);
+
     //@}
 
 protected: 
@@ -215,11 +245,24 @@ private:
     static const int32_t UNSET_MIN_MINOR_ALLELE_COUNT = -1;
     static const int32_t UNSET_MIN_ALT_ALLELE_COUNT = -1;
 
+    // Read the specified file as a CSI index, setting the status on failure.
+    bool readCsiIndex(const char* csiIndexFilename);
+
     // Set1BasedReadSection was called so process the section prior to reading.
     bool processNewSection();
 
+    // Read the next record from the file or the parse threads, setting the
+    // status on failure.  When the parse threads are used, discard is set
+    // to whether or not discardRecord is true for the record.
+    bool readNextRecord(VcfRecord& record, VcfSubsetSamples* subset,
+                        bool& discard);
+
+    // Stop the parse threads if they are running.
+    void stopParsing();
+
     // New section information.
     Tabix* myVcfIndex;
+    CsiIndex* myCsiIndex;
     bool myNewSection;
     std::string mySectionChrom;
     int32_t mySection1BasedStartPos;
@@ -242,6 +285,11 @@ private:
     // Number of records read/written so far that were not discarded.
     int myNumKeptRecords;
     int myTotalRead;
+
+    int myNumParseThreads;
+    VcfParallelParser* myParser;
+    // Set while records are being read through myParser.
+    bool myParsing;
 };
 
 #endif
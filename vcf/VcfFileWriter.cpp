@@ -18,15 +18,23 @@
  */
 
 #include "VcfFileWriter.h"
+#include <string.h>
 
 VcfFileWriter::VcfFileWriter()
-    : VcfFile()
+    : VcfFile(),
+      myGenerateIndex(false),
+      myGenerateCsi(false),
+      myIsIndexing(false),
+      myIndexBuilder()
 {
 }
 
 
 VcfFileWriter::~VcfFileWriter() 
 {
+    // Write the index while the file is still open, any failure is lost.
+    std::string indexError;
+    writeIndex(indexError);
 }
 
 
@@ -34,10 +42,43 @@ bool VcfFileWriter::open(const char* filename, VcfHeader& header,
                          InputFile::ifileCompression compressionMode)
 {
     myStatus = StatGenStatus::SUCCESS;
+
+    // Write BCF if the filename ends in .bcf.
+    size_t nameLength = strlen(filename);
+    bool bcf = ((nameLength >= 4) &&
+                (strcmp(filename + nameLength - 4, ".bcf") == 0));
+    if(bcf && (compressionMode != InputFile::UNCOMPRESSED))
+    {
+        // BCF is only BGZF compressed.
+        compressionMode = InputFile::BGZF;
+    }
+
     if(VcfFile::open(filename, "w", compressionMode))
     {
+        myIsBcf = bcf;
+        // Keep track of the BGZF blocks so the index can be built as the
+        // records are written.  Can't index stdout.
+        if(myGenerateIndex && (compressionMode == InputFile::BGZF) &&
+           (filename[0] != '-'))
+        {
+            myIsIndexing = myFilePtr->trackWrittenBlocks();
+            if(myIsIndexing)
+            {
+                myIndexBuilder.reset(header, myIsBcf, myGenerateCsi);
+            }
+        }
+        if(myIsBcf)
+        {
+            // Successfully opened, so write the BCF header.
+            if(!myBcfCodec.writeHeader(myFilePtr, header))
+            {
+                // Failed, so copy the status.
+                myStatus = myBcfCodec.getStatus();
+                return(false);
+            }
+        }
         // Successfully opened, so write the header.
-        if(!header.write(myFilePtr))
+        else if(!header.write(myFilePtr))
         {
             // Failed, so copy the status.
             myStatus = header.getStatus();
@@ -63,11 +104,86 @@ bool VcfFileWriter::open(const char* filename, VcfHeader& header)
 
 bool VcfFileWriter::writeRecord(VcfRecord& record)
 {
-    if(!record.write(myFilePtr, mySiteOnly))
+    int64_t recordStart = 0;
+    if(myIsIndexing)
+    {
+        recordStart = myFilePtr->getUncompressedPosition();
+    }
+    if(myIsBcf)
+    {
+        if(!myBcfCodec.writeRecord(myFilePtr, record, mySiteOnly))
+        {
+            myStatus = myBcfCodec.getStatus();
+            return(false);
+        }
+    }
+    else if(!record.write(myFilePtr, mySiteOnly))
     {
         myStatus = record.getStatus();
         return(false);
     }
     ++myNumRecords;
+    if(myIsIndexing)
+    {
+        // If the record is out of order, the builder stops and the
+        // failure is reported when the file is closed.
+        myIndexBuilder.addRecord(record.getChromStr(),
+                                 record.get1BasedPosition(),
+                                 record.get1BasedEndPosition(),
+                                 recordStart,
+                                 myFilePtr->getUncompressedPosition());
+    }
     return(true);
 }
+
+
+void VcfFileWriter::close()
+{
+    // Write the index while the file is still open.
+    std::string indexError;
+    StatGenStatus::Status indexStatus = writeIndex(indexError);
+
+    VcfFile::close();
+
+    if(indexStatus != StatGenStatus::SUCCESS)
+    {
+        myStatus.setStatus(indexStatus, indexError.c_str());
+    }
+}
+
+
+void VcfFileWriter::resetFile()
+{
+    // Write the index if one is being built and it was not written by
+    // close.  Any failure is lost since the file is being reset.
+    std::string indexError;
+    writeIndex(indexError);
+}
+
+
+StatGenStatus::Status VcfFileWriter::writeIndex(std::string& errorMessage)
+{
+    if(!myIsIndexing)
+    {
+        return(StatGenStatus::SUCCESS);
+    }
+    myIsIndexing = false;
+    if(myFilePtr == NULL)
+    {
+        // Nothing was written, so there is nothing to index.
+        return(StatGenStatus::SUCCESS);
+    }
+
+    std::string indexName = myFilePtr->getFileName();
+    indexName += myIndexBuilder.getExtension();
+    StatGenStatus::Status status =
+        myIndexBuilder.writeIndex(indexName.c_str(), *myFilePtr);
+    if(status != StatGenStatus::SUCCESS)
+    {
+        errorMessage = "Failed to write the vcf index file ";
+        errorMessage += indexName;
+        errorMessage += ": ";
+        errorMessage += myIndexBuilder.getFailMessage();
+    }
+    return(status);
+}
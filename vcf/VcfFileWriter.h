@@ -22,6 +22,7 @@
 
 #include "VcfFile.h"
 #include "VcfRecord.h"
+#include "VcfIndexBuilder.h"
 
 /// This header file provides interface to read/write VCF files.
 class VcfFileWriter : public VcfFile
@@ -34,6 +35,10 @@ public:
     virtual ~VcfFileWriter();
 
     /// Open the vcf file with the specified filename for writing.
+    /// A filename ending in ".bcf" is written as BCF2 rather than text,
+    /// BGZF compressed unless compressionMode is UNCOMPRESSED.  The CHROM,
+    /// FILTER, INFO, and FORMAT values of records written to a BCF file must
+    /// be defined in the header.
     /// \param filename the vcf file to open for writing.
     /// \param header to be written the file
     /// \param compressionMode type of compression to use for writing
@@ -53,10 +58,44 @@ public:
     /// \return true if successfully wrote, false if not.
     bool writeRecord(VcfRecord& record);
 
+    /// Close the file if it is open, first writing the index if one is
+    /// being generated.  If the index could not be written, the status is
+    /// set (throwing an exception unless the error handling was changed).
+    virtual void close();
+
+    /// Generate an index for BGZF compressed files as they are written, so a
+    /// separate indexing pass is not needed.  The index is written to the
+    /// filename plus ".tbi" when the file is closed, or plus ".csi" for BCF,
+    /// if csi is set, or if a contig is too long for Tabix.  If the records
+    /// are not sorted, no index is written and close sets the status to
+    /// FAIL_ORDER.  If a record can not be indexed (its contig is not in
+    /// the header, or its position is past the end the index supports,
+    /// e.g. past 2^29 for Tabix with no ##contig lengths to pick CSI), no
+    /// index is written and close sets the status to FAIL_PARSE.  Applies to files opened for writing after this call (not
+    /// uncompressed files or stdout), and is carried over between files.
+    /// \param genIndex set to true if an index should be generated.
+    /// \param csi set to true to write a CSI rather than Tabix index for
+    /// text VCF.
+    void generateIndex(bool genIndex, bool csi = false)
+    {
+        myGenerateIndex = genIndex;
+        myGenerateCsi = csi;
+    }
+
 protected: 
-    virtual void resetFile() {}
+    virtual void resetFile();
 
 private:
+    // Write the index if one is being generated, setting errorMessage on
+    // failure.
+    StatGenStatus::Status writeIndex(std::string& errorMessage);
+
+    bool myGenerateIndex;
+    bool myGenerateCsi;
+    // Whether or not an index is being built for the open file.
+    bool myIsIndexing;
+    VcfIndexBuilder myIndexBuilder;
+
     VcfFileWriter(const VcfFileWriter& vcfFileWriter);
     VcfFileWriter& operator=(const VcfFileWriter& vcfFileWriter);
 };
@@ -41,10 +41,25 @@ public:
     inline void reset() { myGenotypeSubFields.reset(); internal_reset(); }
     void clear() {reset(); }
 
+    /// Exchange the subfields with another field.
+    inline void swap(VcfGenotypeField& other)
+    { myGenotypeSubFields.swap(other.myGenotypeSubFields); }
+
     /// Get the number of genotype format fields there are.
     /// \return the number of genotype format fields.
     inline int getNumFields() { return(myGenotypeSubFields.size()); }
 
+    /// Get the genotype subfield at the specified index.
+    /// \return pointer to the subfield, or NULL if out of range.
+    inline const std::string* getField(int index)
+    {
+        if((index < 0) || (index >= myGenotypeSubFields.size()))
+        {
+            return(NULL);
+        }
+        return(&(myGenotypeSubFields.get(index)));
+    }
+
 protected:
     enum SUBFIELD_READ_STATUS {
         MORE_SUBFIELDS = 0,
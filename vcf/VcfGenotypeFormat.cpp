@@ -17,6 +17,7 @@
 
 #include "VcfGenotypeFormat.h"
 #include "VcfRecordGenotype.h"
+#include <string.h>
 
 VcfGenotypeFormat::VcfGenotypeFormat()
     : VcfGenotypeField(),
@@ -68,6 +69,54 @@ bool VcfGenotypeFormat::read(IFILE filePtr)
 }
 
 
+void VcfGenotypeFormat::readTyped(const std::vector<const char*>& keys,
+                                  const std::vector<BcfTypedValues>& values,
+                                  int numSamples)
+{
+    // Clear out any previously set values.
+    reset();
+    size_t numBytes = 0;
+    for(unsigned int i = 0; i < keys.size(); i++)
+    {
+        std::string& nextType = myGenotypeSubFields.getNextEmpty();
+        nextType = keys[i];
+        // Check if this field should be read/stored.
+        if(!VcfRecordGenotype::storeField(nextType))
+        {
+            // Do not read/store this field.
+            myStoreIndices.push_back(false);
+            myGenotypeSubFields.rmLast();
+            continue;
+        }
+        // Check if this is GT.
+        if(nextType == "GT")
+        {
+            myGTIndex = i;
+        }
+        myStoreIndices.push_back(true);
+        myTyped.push_back(values[i]);
+        numBytes += (size_t)values[i].count * numSamples *
+            BcfTypedValues::getTypeSize(values[i].type);
+    }
+
+    // Copy the values of the stored fields.
+    myTypedBuffer.resize(numBytes);
+    numBytes = 0;
+    for(unsigned int i = 0; i < myTyped.size(); i++)
+    {
+        BcfTypedValues& typed = myTyped[i];
+        size_t fieldBytes = (size_t)typed.count * numSamples *
+            BcfTypedValues::getTypeSize(typed.type);
+        if(fieldBytes != 0)
+        {
+            memcpy(&(myTypedBuffer[numBytes]), typed.values, fieldBytes);
+        }
+        typed.values = myTypedBuffer.data() + numBytes;
+        numBytes += fieldBytes;
+    }
+}
+
+
 int VcfGenotypeFormat::getIndex(const std::string& key)
 {
     //  Search for this field of the genotypeFormat.
@@ -94,8 +143,21 @@ bool VcfGenotypeFormat::storeIndex(unsigned int index)
 }
 
 
+void VcfGenotypeFormat::swap(VcfGenotypeFormat& other)
+{
+    VcfGenotypeField::swap(other);
+    int gtIndex = myGTIndex;
+    myGTIndex = other.myGTIndex;
+    other.myGTIndex = gtIndex;
+    myStoreIndices.swap(other.myStoreIndices);
+    myTyped.swap(other.myTyped);
+    myTypedBuffer.swap(other.myTypedBuffer);
+}
+
+
 void VcfGenotypeFormat::internal_reset()
 {
     myGTIndex = GENOTYPE_INDEX_NA;
     myStoreIndices.clear();
+    myTyped.clear();
 }
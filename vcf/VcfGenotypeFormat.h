@@ -20,6 +20,7 @@
 #define __VCF_GENOTYPE_FORMAT_H__
 
 #include "VcfGenotypeField.h"
+#include "BcfTypedValues.h"
 
 /// This header file provides interface to read/write VCF files.
 class VcfGenotypeFormat : public VcfGenotypeField
@@ -38,6 +39,27 @@ public:
     /// \return true if a tab ended the field, false if it was \n or EOF.
     bool read(IFILE filePtr);
 
+    /// Set the format from the FORMAT keys of a BCF2 record, copying the
+    /// typed values of the stored keys for every sample so the samples can
+    /// convert their values when they are accessed.
+    /// \param keys the FORMAT keys.
+    /// \param values the typed values of each key, count per sample.
+    /// \param numSamples number of samples in the values.
+    void readTyped(const std::vector<const char*>& keys,
+                   const std::vector<BcfTypedValues>& values,
+                   int numSamples);
+
+    /// Get the typed values of the stored field at the specified index,
+    /// or NULL if the format was not read with readTyped.
+    inline const BcfTypedValues* getTyped(int index)
+    {
+        if((index < 0) || (index >= (int)myTyped.size()))
+        {
+            return(NULL);
+        }
+        return(&(myTyped[index]));
+    }
+
     /// Get the index of the specified key.
     /// \param key to find the index for.
     /// \return index of the specified key or GENOTYPE_INDEX_NA if the key
@@ -54,6 +76,9 @@ public:
     /// of stored fields.
     int getOrigNumFields() { return(myStoreIndices.size()); }
 
+    /// Exchange the contents of this format with another.
+    void swap(VcfGenotypeFormat& other);
+
 protected:
     /// reset the sample for a new entry.
     virtual void internal_reset();
@@ -67,6 +92,11 @@ private:
     // Set when reading the format by checking the readFields in
     // VcfRecordGenotype and queried when reading the samples fields.
     std::vector<bool> myStoreIndices;
+
+    // Typed values of the stored fields when read from BCF, pointing into
+    // myTypedBuffer.
+    std::vector<BcfTypedValues> myTyped;
+    std::vector<uint8_t> myTypedBuffer;
 };
 
 #endif
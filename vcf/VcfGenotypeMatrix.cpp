@@ -0,0 +1,561 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VcfGenotypeMatrix.h"
+#include "VcfGenotypeSample.h"
+#include <string.h>
+#include <algorithm>
+#include <stdexcept>
+
+// Number of alleles a sample may have: the count is stored in a uint8_t.
+static const int MAX_NUM_ALLELES = 255;
+// Number of samples to initially allocate room for.
+static const int MIN_CAPACITY = 64;
+
+VcfGenotypeMatrix::VcfGenotypeMatrix()
+    : myHasGT(false),
+      myNumSamples(0),
+      myCapacity(0),
+      myPacked(true),
+      myPloidy(PACKED_PLOIDY),
+      myPackedAlleles(),
+      myAlleles(),
+      myNumAlleles(),
+      myMissing(),
+      myPhased(),
+      myUnphased(),
+      myScratchAlleles(),
+      myScratchMissing()
+{
+    grow(MIN_CAPACITY);
+}
+
+
+VcfGenotypeMatrix::~VcfGenotypeMatrix()
+{
+}
+
+
+void VcfGenotypeMatrix::parse(const char* columns, int length,
+                              VcfSubsetSamples* subsetInfo)
+{
+    // Clear out any previously set values.
+    reset();
+
+    const char* end = columns + length;
+
+    // Find the GT in the FORMAT column.
+    const char* formatEnd = (const char*)memchr(columns, '\t', length);
+    bool moreSamples = (formatEnd != NULL);
+    if(formatEnd == NULL)
+    {
+        // No samples, just the FORMAT.
+        formatEnd = end;
+    }
+    int gtIndex = -1;
+    int subFieldIndex = 0;
+    const char* pos = columns;
+    while(pos <= formatEnd)
+    {
+        const char* subFieldEnd =
+            (const char*)memchr(pos, ':', formatEnd - pos);
+        if(subFieldEnd == NULL)
+        {
+            subFieldEnd = formatEnd;
+        }
+        if((subFieldEnd - pos == 2) && (pos[0] == 'G') && (pos[1] == 'T'))
+        {
+            gtIndex = subFieldIndex;
+            break;
+        }
+        ++subFieldIndex;
+        pos = subFieldEnd + 1;
+    }
+    myHasGT = (gtIndex != -1);
+
+    // Decode each kept sample.  Skipped samples just cost finding the tab.
+    int sampleIndex = 0;
+    pos = formatEnd + 1;
+    while(moreSamples)
+    {
+        const char* columnEnd = (const char*)memchr(pos, '\t', end - pos);
+        if(columnEnd == NULL)
+        {
+            // Last sample on the line.
+            columnEnd = end;
+            moreSamples = false;
+        }
+        if((subsetInfo == NULL) || subsetInfo->keep(sampleIndex))
+        {
+            parseSample(pos, columnEnd, gtIndex);
+        }
+        ++sampleIndex;
+        pos = columnEnd + 1;
+    }
+}
+
+
+void VcfGenotypeMatrix::parseTyped(const uint8_t* values, int valueSize,
+                                   int numValues, int numSamples,
+                                   VcfSubsetSamples* subsetInfo)
+{
+    // Clear out any previously set values.
+    reset();
+    myHasGT = (values != NULL);
+
+    // The smallest value of the type means missing, the next one marks the
+    // end of a sample's values.
+    int32_t missing = (int32_t)(~(uint32_t)0 << (valueSize * 8 - 1));
+    int32_t vectorEnd = missing + 1;
+    if(numValues > MAX_NUM_ALLELES)
+    {
+        throw(std::runtime_error("VCF GT contains too many alleles."));
+    }
+
+    for(int sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+    {
+        if((subsetInfo != NULL) && !subsetInfo->keep(sampleIndex))
+        {
+            continue;
+        }
+        int sampleNum = addSample();
+        if(values == NULL)
+        {
+            // No GT in this record.
+            continue;
+        }
+
+        const uint8_t* sampleValues =
+            values + (size_t)sampleIndex * numValues * valueSize;
+        int numAlleles = 0;
+        bool phased = false;
+        bool unphased = false;
+        for(int i = 0; i < numValues; i++)
+        {
+            int32_t value;
+            if(valueSize == 1)
+            {
+                value = (int8_t)sampleValues[i];
+            }
+            else if(valueSize == 2)
+            {
+                int16_t value16;
+                memcpy(&value16, sampleValues + i * 2, 2);
+                value = value16;
+            }
+            else
+            {
+                memcpy(&value, sampleValues + i * 4, 4);
+            }
+            if((value == vectorEnd) || ((value == missing) && (i != 0)))
+            {
+                break;
+            }
+            if(i != 0)
+            {
+                // The phase of each allele after the first says how it is
+                // separated from the one before it.
+                if(value & 1)
+                {
+                    phased = true;
+                }
+                else
+                {
+                    unphased = true;
+                }
+            }
+            int allele = (value >> 1) - 1;
+            if((value == missing) || (allele < 0))
+            {
+                allele = VcfGenotypeSample::MISSING_GT;
+            }
+            storeAllele(sampleNum, numAlleles, allele);
+            myNumAlleles[sampleNum] = ++numAlleles;
+        }
+        if(phased)
+        {
+            setBit(myPhased, sampleNum);
+        }
+        if(unphased)
+        {
+            setBit(myUnphased, sampleNum);
+        }
+    }
+}
+
+
+bool VcfGenotypeMatrix::write(IFILE filePtr)
+{
+    if(!myHasGT)
+    {
+        // No GT to write.
+        return(true);
+    }
+
+    std::string columns = "\tGT";
+    for(int sampleNum = 0; sampleNum < myNumSamples; sampleNum++)
+    {
+        columns += '\t';
+        int numAlleles = myNumAlleles[sampleNum];
+        char phaseChar = isPhased(sampleNum) ? '|' : '/';
+        for(int i = 0; i < numAlleles; i++)
+        {
+            if(i != 0)
+            {
+                columns += phaseChar;
+            }
+            int allele = getGT(sampleNum, i);
+            if(allele == VcfGenotypeSample::MISSING_GT)
+            {
+                columns += '.';
+            }
+            else
+            {
+                columns += std::to_string((long long int)allele);
+            }
+        }
+    }
+    return(ifwrite(filePtr, columns.c_str(), columns.size()) ==
+           columns.size());
+}
+
+
+void VcfGenotypeMatrix::reset()
+{
+    myHasGT = false;
+    myNumSamples = 0;
+    myPacked = true;
+    myPloidy = PACKED_PLOIDY;
+    std::fill(myPackedAlleles.begin(), myPackedAlleles.end(), 0);
+    std::fill(myMissing.begin(), myMissing.end(), 0);
+    std::fill(myPhased.begin(), myPhased.end(), 0);
+    std::fill(myUnphased.begin(), myUnphased.end(), 0);
+}
+
+
+void VcfGenotypeMatrix::swap(VcfGenotypeMatrix& other)
+{
+    std::swap(myHasGT, other.myHasGT);
+    std::swap(myNumSamples, other.myNumSamples);
+    std::swap(myCapacity, other.myCapacity);
+    std::swap(myPacked, other.myPacked);
+    std::swap(myPloidy, other.myPloidy);
+    myPackedAlleles.swap(other.myPackedAlleles);
+    myAlleles.swap(other.myAlleles);
+    myNumAlleles.swap(other.myNumAlleles);
+    myMissing.swap(other.myMissing);
+    myPhased.swap(other.myPhased);
+    myUnphased.swap(other.myUnphased);
+}
+
+
+int VcfGenotypeMatrix::getGT(int sampleNum, unsigned int gtIndex) const
+{
+    if((sampleNum < 0) || (sampleNum >= myNumSamples) ||
+       (gtIndex >= myNumAlleles[sampleNum]))
+    {
+        // Out of range.
+        return(VcfGenotypeSample::INVALID_GT);
+    }
+    if(!myPacked)
+    {
+        return(myAlleles[sampleNum * myPloidy + gtIndex]);
+    }
+    int slot = sampleNum * PACKED_PLOIDY + gtIndex;
+    if(getBit(myMissing, slot))
+    {
+        return(VcfGenotypeSample::MISSING_GT);
+    }
+    return((myPackedAlleles[slot >> 5] >> ((slot & 31) << 1)) & 3);
+}
+
+
+void VcfGenotypeMatrix::setGT(int sampleNum, unsigned int gtIndex, int newGt)
+{
+    if((sampleNum < 0) || (sampleNum >= myNumSamples))
+    {
+        throw(std::runtime_error("setGT called with out of range sample."));
+    }
+    if(gtIndex >= myNumAlleles[sampleNum])
+    {
+        throw(std::runtime_error("VCF setGT called with out of range GT index."));
+    }
+    storeAllele(sampleNum, gtIndex, newGt);
+}
+
+
+int VcfGenotypeMatrix::getNumGTs(int sampleNum) const
+{
+    if((sampleNum < 0) || (sampleNum >= myNumSamples))
+    {
+        // Out of range sample index, no GTs.
+        return(0);
+    }
+    return(myNumAlleles[sampleNum]);
+}
+
+
+bool VcfGenotypeMatrix::isPhased(int sampleNum) const
+{
+    if((sampleNum < 0) || (sampleNum >= myNumSamples))
+    {
+        // Out of range sample index.
+        return(false);
+    }
+    return(getBit(myPhased, sampleNum));
+}
+
+
+bool VcfGenotypeMatrix::isUnphased(int sampleNum) const
+{
+    if((sampleNum < 0) || (sampleNum >= myNumSamples))
+    {
+        // Out of range sample index.
+        return(false);
+    }
+    return(getBit(myUnphased, sampleNum));
+}
+
+
+bool VcfGenotypeMatrix::hasAllGenotypeAlleles(int sampleNum) const
+{
+    if((sampleNum < 0) || (sampleNum >= myNumSamples) ||
+       (myNumAlleles[sampleNum] == 0))
+    {
+        // Out of range sample index or no GT.
+        return(false);
+    }
+    int slot = sampleNum * myPloidy;
+    for(int i = 0; i < myNumAlleles[sampleNum]; i++)
+    {
+        if(getBit(myMissing, slot + i))
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
+
+
+bool VcfGenotypeMatrix::allPhased() const
+{
+    // Bits past the last sample are always clear, so compare whole words.
+    int numWords = (myNumSamples + 63) >> 6;
+    for(int i = 0; i < numWords; i++)
+    {
+        uint64_t expected = ~(uint64_t)0;
+        if((i == numWords - 1) && ((myNumSamples & 63) != 0))
+        {
+            expected = ((uint64_t)1 << (myNumSamples & 63)) - 1;
+        }
+        if((myPhased[i] != expected) || (myUnphased[i] != 0))
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
+
+
+bool VcfGenotypeMatrix::allUnphased() const
+{
+    int numWords = (myNumSamples + 63) >> 6;
+    for(int i = 0; i < numWords; i++)
+    {
+        uint64_t expected = ~(uint64_t)0;
+        if((i == numWords - 1) && ((myNumSamples & 63) != 0))
+        {
+            expected = ((uint64_t)1 << (myNumSamples & 63)) - 1;
+        }
+        if((myUnphased[i] != expected) || (myPhased[i] != 0))
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
+
+
+bool VcfGenotypeMatrix::hasAllGenotypeAlleles() const
+{
+    for(int i = 0; i < myNumSamples; i++)
+    {
+        if(myNumAlleles[i] == 0)
+        {
+            // No GT for this sample.
+            return(false);
+        }
+    }
+    // Only the slots of decoded alleles can have their missing bit set.
+    int numWords = (myNumSamples * myPloidy + 63) >> 6;
+    for(int i = 0; i < numWords; i++)
+    {
+        if(myMissing[i] != 0)
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
+
+
+void VcfGenotypeMatrix::parseSample(const char* start, const char* end,
+                                    int gtIndex)
+{
+    int sampleNum = addSample();
+
+    if(gtIndex < 0)
+    {
+        // No GT in this record.
+        return;
+    }
+
+    // Skip to the GT subfield.
+    for(int i = 0; i < gtIndex; i++)
+    {
+        const char* colon = (const char*)memchr(start, ':', end - start);
+        if(colon == NULL)
+        {
+            // This sample stops before its GT, so GT is missing.
+            storeAllele(sampleNum, 0, VcfGenotypeSample::MISSING_GT);
+            myNumAlleles[sampleNum] = 1;
+            return;
+        }
+        start = colon + 1;
+    }
+
+    // Decode the alleles until the end of the GT.
+    int numAlleles = 0;
+    bool phased = false;
+    bool unphased = false;
+    while((start != end) && (*start != ':'))
+    {
+        char ch = *start;
+        int allele = 0;
+        if((ch >= '0') && (ch <= '9'))
+        {
+            do
+            {
+                allele = allele * 10 + (ch - '0');
+                ++start;
+            }
+            while((start != end) && ((ch = *start) >= '0') && (ch <= '9'));
+        }
+        else if(ch == '.')
+        {
+            allele = VcfGenotypeSample::MISSING_GT;
+            ++start;
+        }
+        else if(ch == '|')
+        {
+            phased = true;
+            ++start;
+            continue;
+        }
+        else if(ch == '/')
+        {
+            unphased = true;
+            ++start;
+            continue;
+        }
+        else
+        {
+            throw(std::runtime_error("VCF GT contains an invalid character."));
+        }
+
+        if(numAlleles == MAX_NUM_ALLELES)
+        {
+            throw(std::runtime_error("VCF GT contains too many alleles."));
+        }
+        storeAllele(sampleNum, numAlleles, allele);
+        myNumAlleles[sampleNum] = ++numAlleles;
+    }
+
+    if(phased)
+    {
+        setBit(myPhased, sampleNum);
+    }
+    if(unphased)
+    {
+        setBit(myUnphased, sampleNum);
+    }
+}
+
+
+int VcfGenotypeMatrix::addSample()
+{
+    int sampleNum = myNumSamples;
+    if(sampleNum == myCapacity)
+    {
+        grow(sampleNum + 1);
+    }
+    ++myNumSamples;
+    myNumAlleles[sampleNum] = 0;
+    if(!myPacked)
+    {
+        int32_t* slots = &(myAlleles[sampleNum * myPloidy]);
+        std::fill(slots, slots + myPloidy, VcfGenotypeSample::INVALID_GT);
+    }
+    return(sampleNum);
+}
+
+
+void VcfGenotypeMatrix::grow(int numSamples)
+{
+    int capacity = std::max(std::max(numSamples, myCapacity * 2),
+                            MIN_CAPACITY);
+    myPackedAlleles.resize((capacity * PACKED_PLOIDY + 31) >> 5, 0);
+    if(!myPacked)
+    {
+        myAlleles.resize(capacity * myPloidy, VcfGenotypeSample::INVALID_GT);
+    }
+    myNumAlleles.resize(capacity, 0);
+    // A previous record may have left the missing map larger than needed.
+    size_t missingWords = (capacity * myPloidy + 63) >> 6;
+    if(myMissing.size() < missingWords)
+    {
+        myMissing.resize(missingWords, 0);
+    }
+    myPhased.resize((capacity + 63) >> 6, 0);
+    myUnphased.resize((capacity + 63) >> 6, 0);
+    myCapacity = capacity;
+}
+
+
+void VcfGenotypeMatrix::changeLayout(int ploidy)
+{
+    ploidy = std::max(ploidy, myPloidy);
+    myScratchAlleles.assign(myCapacity * ploidy, VcfGenotypeSample::INVALID_GT);
+    myScratchMissing.assign((myCapacity * ploidy + 63) >> 6, 0);
+    for(int sampleNum = 0; sampleNum < myNumSamples; sampleNum++)
+    {
+        for(int i = 0; i < myNumAlleles[sampleNum]; i++)
+        {
+            int slot = sampleNum * ploidy + i;
+            int allele = getGT(sampleNum, i);
+            myScratchAlleles[slot] = allele;
+            if(allele < 0)
+            {
+                setBit(myScratchMissing, slot);
+            }
+        }
+    }
+    myAlleles.swap(myScratchAlleles);
+    myMissing.swap(myScratchMissing);
+    myPacked = false;
+    myPloidy = ploidy;
+}
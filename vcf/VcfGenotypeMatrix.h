@@ -0,0 +1,245 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __VCF_GENOTYPE_MATRIX_H__
+#define __VCF_GENOTYPE_MATRIX_H__
+
+#include <stdint.h>
+#include <vector>
+#include "InputFile.h"
+#include "VcfSubsetSamples.h"
+
+/// Columnar store of just the GT alleles of every sample in one VCF record,
+/// decoded straight from the raw genotype columns without building a
+/// VcfGenotypeSample per sample.
+///
+/// While every allele index is 3 or less and no sample has more than two
+/// alleles, the alleles are packed 2 bits apiece, two per sample, into
+/// getPackedAlleles().  Otherwise the record falls back to one int32_t per
+/// allele in getAlleles() with getPloidy() entries per sample.  In both
+/// layouts, allele j of sample s is at slot (s * getPloidy() + j), and the
+/// slot's bit in getMissing() is set if the allele was '.'.  The phased and
+/// unphased bitmaps have one bit per sample, set if a '|' or '/' separated
+/// that sample's alleles.  Bit i of a bitmap is (map[i/64] >> (i%64)) & 1.
+class VcfGenotypeMatrix
+{
+public:
+    /// Number of alleles stored per sample in the packed layout.
+    static const int PACKED_PLOIDY = 2;
+    /// Largest allele index that fits in the packed layout.
+    static const int MAX_PACKED_ALLELE = 3;
+
+    /// Default Constructor, initializes the variables.
+    VcfGenotypeMatrix();
+
+    /// Destructor
+    ~VcfGenotypeMatrix();
+
+    /// Decode the GT of each sample from the FORMAT and sample columns of a
+    /// record.  Only GT is looked at: the other subfields are not stored or
+    /// validated.  Throws an exception if a GT contains invalid characters.
+    /// \param columns the FORMAT column followed by the tab separated sample
+    /// columns (not including the new line).
+    /// \param length number of characters in columns.
+    /// \param subsetInfo pointer to optional subsetting information.
+    void parse(const char* columns, int length,
+               VcfSubsetSamples* subsetInfo = NULL);
+
+    /// Decode the GT of each sample from a BCF2 typed GT array without
+    /// converting it to text.  Each value is ((allele + 1) << 1 | phased),
+    /// 0 for a missing allele, and a sample's values after its last allele
+    /// are the end of vector value.
+    /// \param values little endian values, numValues for each sample in
+    /// sample order, or NULL if the record has no GT.
+    /// \param valueSize bytes per value: 1, 2, or 4.
+    /// \param numValues number of values per sample.
+    /// \param numSamples number of samples in the record.
+    /// \param subsetInfo pointer to optional subsetting information.
+    void parseTyped(const uint8_t* values, int valueSize, int numValues,
+                    int numSamples, VcfSubsetSamples* subsetInfo = NULL);
+
+    /// Write the genotypes as a GT only FORMAT and sample columns, including
+    /// the leading tab.  Nothing is written if the record had no GT.
+    /// \param filePtr IFILE to write to.
+    /// \return true if the columns were successfully written.
+    bool write(IFILE filePtr);
+
+    /// Reset the matrix for a new record, keeping the allocated memory.
+    void reset();
+
+    /// Exchange the genotypes (and allocated memory) with another matrix.
+    void swap(VcfGenotypeMatrix& other);
+
+    /// Return whether or not the record had a GT in its FORMAT.
+    inline bool hasGT() const { return(myHasGT); }
+
+    /// Get the number of samples.
+    inline int getNumSamples() const { return(myNumSamples); }
+
+    /// Return true if the alleles are in the 2 bit packed layout, false if
+    /// they are one int32_t per allele.
+    inline bool isPacked() const { return(myPacked); }
+
+    /// Get the number of allele slots per sample: PACKED_PLOIDY when packed,
+    /// otherwise the largest number of alleles of any sample.
+    inline int getPloidy() const { return(myPloidy); }
+
+    /// Get the 2 bit packed alleles, 32 per word, or NULL if not packed.
+    /// Slot i is (words[i/32] >> (2*(i%32))) & 3.  Missing alleles and
+    /// slots past a sample's number of alleles are 0.
+    inline const uint64_t* getPackedAlleles() const
+    { return(myPacked ? &(myPackedAlleles[0]) : NULL); }
+
+    /// Get the int32_t alleles, or NULL if packed.  Missing alleles are
+    /// VcfGenotypeSample::MISSING_GT and slots past a sample's number of
+    /// alleles are VcfGenotypeSample::INVALID_GT.
+    inline const int32_t* getAlleles() const
+    { return(myPacked ? NULL : &(myAlleles[0])); }
+
+    /// Get the number of alleles of each sample (0 if it has no GT).
+    inline const uint8_t* getNumAlleles() const { return(&(myNumAlleles[0])); }
+
+    /// Get the bitmap of missing alleles, one bit per allele slot.
+    inline const uint64_t* getMissing() const { return(&(myMissing[0])); }
+
+    /// Get the bitmap of samples whose alleles are separated by a '|'.
+    inline const uint64_t* getPhased() const { return(&(myPhased[0])); }
+
+    /// Get the bitmap of samples whose alleles are separated by a '/'.
+    inline const uint64_t* getUnphased() const { return(&(myUnphased[0])); }
+
+    /// Return the allele at the specified index of the sample's GT,
+    /// VcfGenotypeSample::MISSING_GT if it is '.', and
+    /// VcfGenotypeSample::INVALID_GT if the sample or index is out of range.
+    int getGT(int sampleNum, unsigned int gtIndex) const;
+
+    /// Set the allele at the specified index of the sample's GT, switching to
+    /// the int32_t layout if it does not fit in 2 bits.  Throws an exception
+    /// if the sample or index is out of range.
+    void setGT(int sampleNum, unsigned int gtIndex, int newGt);
+
+    /// Return the number of alleles in the sample's GT.
+    int getNumGTs(int sampleNum) const;
+
+    /// Return true if a '|' separated the sample's alleles.
+    bool isPhased(int sampleNum) const;
+
+    /// Return true if a '/' separated the sample's alleles.
+    bool isUnphased(int sampleNum) const;
+
+    /// Return true if the sample has a GT with no missing alleles.
+    bool hasAllGenotypeAlleles(int sampleNum) const;
+
+    /// Return true if all samples are phased and none are unphased.
+    bool allPhased() const;
+
+    /// Return true if all samples are unphased and none are phased.
+    bool allUnphased() const;
+
+    /// Return true if all samples have a GT with no missing alleles.
+    bool hasAllGenotypeAlleles() const;
+
+private:
+    VcfGenotypeMatrix(const VcfGenotypeMatrix& matrix);
+    VcfGenotypeMatrix& operator=(const VcfGenotypeMatrix& matrix);
+
+    static inline bool getBit(const std::vector<uint64_t>& bits, int index)
+    { return((bits[index >> 6] >> (index & 63)) & 1); }
+    static inline void setBit(std::vector<uint64_t>& bits, int index)
+    { bits[index >> 6] |= (uint64_t)1 << (index & 63); }
+    static inline void clearBit(std::vector<uint64_t>& bits, int index)
+    { bits[index >> 6] &= ~((uint64_t)1 << (index & 63)); }
+
+    // Store an allele of the last parsed sample (or of an already parsed
+    // sample when setting), changing the layout if it does not fit.
+    inline void storeAllele(int sampleNum, int gtIndex, int allele)
+    {
+        if(myPacked && (allele <= MAX_PACKED_ALLELE) &&
+           (gtIndex < PACKED_PLOIDY))
+        {
+            int slot = sampleNum * PACKED_PLOIDY + gtIndex;
+            uint64_t& word = myPackedAlleles[slot >> 5];
+            int shift = (slot & 31) << 1;
+            word &= ~((uint64_t)3 << shift);
+            if(allele < 0)
+            {
+                setBit(myMissing, slot);
+            }
+            else
+            {
+                clearBit(myMissing, slot);
+                word |= (uint64_t)allele << shift;
+            }
+            return;
+        }
+        if(gtIndex >= myPloidy)
+        {
+            // Need more slots per sample.
+            changeLayout(gtIndex + 1);
+        }
+        else if(myPacked)
+        {
+            // Allele is too big to pack.
+            changeLayout(myPloidy);
+        }
+        int slot = sampleNum * myPloidy + gtIndex;
+        myAlleles[slot] = allele;
+        if(allele < 0)
+        {
+            setBit(myMissing, slot);
+        }
+        else
+        {
+            clearBit(myMissing, slot);
+        }
+    }
+
+    // Decode the GT of one sample column, appending it to the matrix.
+    void parseSample(const char* start, const char* end, int gtIndex);
+
+    // Start a new sample with no alleles, returning its index.
+    int addSample();
+
+    // Allocate room for at least the specified number of samples.
+    void grow(int numSamples);
+
+    // Move the alleles into the int32_t layout with the specified number
+    // of slots per sample.
+    void changeLayout(int ploidy);
+
+    // Set if the FORMAT contained GT.
+    bool myHasGT;
+    int myNumSamples;
+    // Number of samples there is room for.
+    int myCapacity;
+    bool myPacked;
+    int myPloidy;
+
+    std::vector<uint64_t> myPackedAlleles;
+    std::vector<int32_t> myAlleles;
+    std::vector<uint8_t> myNumAlleles;
+    std::vector<uint64_t> myMissing;
+    std::vector<uint64_t> myPhased;
+    std::vector<uint64_t> myUnphased;
+
+    // Reused when changing layouts.
+    std::vector<int32_t> myScratchAlleles;
+    std::vector<uint64_t> myScratchMissing;
+};
+
+#endif
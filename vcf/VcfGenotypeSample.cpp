@@ -17,15 +17,26 @@
 
 #include "VcfGenotypeSample.h"
 #include <stdlib.h>
+#include <string.h>
 #include <sstream>
 
 const int VcfGenotypeSample::INVALID_GT = -1;
 const int VcfGenotypeSample::MISSING_GT = -2;
 const std::string VcfGenotypeSample::MISSING_FIELD = ".";
 
+// Get the typed values of the specified sample.
+static inline const uint8_t* getSampleValues(const BcfTypedValues& typed,
+                                             int sampleIndex)
+{
+    return(typed.values + (size_t)sampleIndex * typed.count *
+           BcfTypedValues::getTypeSize(typed.type));
+}
+
 VcfGenotypeSample::VcfGenotypeSample()
     : VcfGenotypeField(),
       myFormatPtr(NULL),
+      myTypedSample(-1),
+      myTextPending(),
       myPhased(false),
       myUnphased(false),
       myHasAllGenotypeAlleles(false),
@@ -133,12 +144,140 @@ bool VcfGenotypeSample::read(IFILE filePtr, VcfGenotypeFormat& format)
 }
 
 
+void VcfGenotypeSample::read(const char* sample, int length,
+                             VcfGenotypeFormat& format)
+{
+    // Clear out any previously set values.
+    reset();
+    
+    myFormatPtr = &format;
+
+    int gtIndex = format.getGTIndex();
+    int numFields = format.getOrigNumFields();
+
+    // Split the column into subfields.
+    const char* end = sample + length;
+    const char* start = sample;
+    int subFieldIndex = 0;
+    bool moreSubFields = true;
+    while(moreSubFields)
+    {
+        const char* subFieldEnd = (const char*)memchr(start, ':', end - start);
+        if(subFieldEnd == NULL)
+        {
+            subFieldEnd = end;
+            moreSubFields = false;
+        }
+        if((subFieldIndex < numFields) && format.storeIndex(subFieldIndex))
+        {
+            myGenotypeSubFields.getNextEmpty().assign(start,
+                                                      subFieldEnd - start);
+            // Check if this is the GT field.
+            if(subFieldIndex == gtIndex)
+            {
+                // There is a GT field, so set that all GT fields are there.
+                // if any are missing it will be turned back to false.
+                myHasAllGenotypeAlleles = true;
+                for(const char* gtPos = start; gtPos != subFieldEnd; gtPos++)
+                {
+                    if(*gtPos == '|')
+                    {
+                        myPhased = true;
+                    }
+                    else if(*gtPos == '/')
+                    {
+                        myUnphased = true;
+                    }
+                    else if(*gtPos == '.')
+                    {
+                        myHasAllGenotypeAlleles = false;
+                    }
+                }
+            }
+        }
+        start = subFieldEnd + 1;
+        ++subFieldIndex;
+    }
+
+    // subFieldIndex contains the number of fields in this sample.
+    if(subFieldIndex > numFields)
+    {
+        throw(std::runtime_error("VCF Number of Fields in a Sample does not match the Format."));
+    }
+    else if(subFieldIndex < numFields)
+    {
+        // If there are no fields for this sample, enter the missing value.
+        if(myGenotypeSubFields.size() == 0)
+        {
+            myGenotypeSubFields.getNextEmpty() = MISSING_FIELD;
+        }
+    }
+}
+
+
+void VcfGenotypeSample::readTyped(int sampleIndex, VcfGenotypeFormat& format)
+{
+    // Clear out any previously set values.
+    reset();
+
+    myFormatPtr = &format;
+    myTypedSample = sampleIndex;
+
+    // Trailing fields the sample does not have are left off, like a VCF
+    // sample with fewer fields than the format.  Other fields it does not
+    // have are '.'.
+    int numFields = format.getNumFields();
+    int numPresent = 0;
+    for(int i = 0; i < numFields; i++)
+    {
+        const BcfTypedValues* typed = format.getTyped(i);
+        if(BcfTypedValues::hasValues(getSampleValues(*typed, sampleIndex),
+                                     typed->type, typed->count))
+        {
+            numPresent = i + 1;
+        }
+    }
+    if((numPresent == 0) && (numFields != 0))
+    {
+        // No fields, so it is missing.
+        numPresent = 1;
+    }
+
+    // The fields are converted to text when they are accessed.
+    myTextPending.assign(numPresent, true);
+    for(int i = 0; i < numPresent; i++)
+    {
+        myGenotypeSubFields.getNextEmpty();
+    }
+
+    // Decode GT so the GT accessors do not need its text.
+    int gtIndex = format.getIndex("GT");
+    if((gtIndex != VcfGenotypeFormat::GENOTYPE_INDEX_NA) &&
+       (gtIndex < numPresent))
+    {
+        const BcfTypedValues* typed = format.getTyped(gtIndex);
+        const uint8_t* values = getSampleValues(*typed, sampleIndex);
+        if(BcfTypedValues::hasValues(values, typed->type, typed->count))
+        {
+            readTypedGT(values, *typed);
+        }
+    }
+}
+
+
 bool VcfGenotypeSample::write(IFILE filePtr)
 {
     if(myNewGT)
     {
         updateGTString();
     }
+    for(unsigned int i = 0; i < myTextPending.size(); i++)
+    {
+        if(myTextPending[i])
+        {
+            convertTyped(i);
+        }
+    }
     return(VcfGenotypeField::write(filePtr));
 }
 
@@ -164,6 +303,10 @@ const std::string* VcfGenotypeSample::getString(const std::string& key)
         {
             updateGTString();
         }
+        else if(getPendingTyped(index) != NULL)
+        {
+            convertTyped(index);
+        }
         return(&(myGenotypeSubFields.get(index)));
     }
     // key was not found, so return NULL.
@@ -183,6 +326,10 @@ bool VcfGenotypeSample::setString(const std::string& key, const std::string& val
     {
         // Found the type, so set it.
         myGenotypeSubFields.get(index) = value;
+        if(index < (int)myTextPending.size())
+        {
+            myTextPending[index] = false;
+        }
 
         if(key == "GT")
         {
@@ -212,6 +359,75 @@ bool VcfGenotypeSample::setString(const std::string& key, const std::string& val
 }
 
 
+bool VcfGenotypeSample::getInts(const std::string& key,
+                                std::vector<int32_t>& values)
+{
+    values.clear();
+    if((myFormatPtr == NULL) || (key == "GT"))
+    {
+        // GT is read with getGT.
+        return(false);
+    }
+    int index = myFormatPtr->getIndex(key);
+    if(index == VcfGenotypeFormat::GENOTYPE_INDEX_NA)
+    {
+        // key was not found.
+        return(false);
+    }
+    const BcfTypedValues* typed = getPendingTyped(index);
+    if(typed == NULL)
+    {
+        const std::string* text = getString(key);
+        return((text != NULL) && BcfTypedValues::parseInts(*text, values));
+    }
+    const uint8_t* sampleValues = getSampleValues(*typed, myTypedSample);
+    if(!BcfTypedValues::hasValues(sampleValues, typed->type, typed->count))
+    {
+        // Not set for this sample, so it is missing.
+        values.push_back(BcfTypedValues::INT32_MISSING);
+        return(true);
+    }
+    return(BcfTypedValues::getInts(sampleValues, typed->type, typed->count,
+                                   values));
+}
+
+
+bool VcfGenotypeSample::getFloats(const std::string& key,
+                                  std::vector<float>& values)
+{
+    values.clear();
+    if((myFormatPtr == NULL) || (key == "GT"))
+    {
+        // GT is read with getGT.
+        return(false);
+    }
+    int index = myFormatPtr->getIndex(key);
+    if(index == VcfGenotypeFormat::GENOTYPE_INDEX_NA)
+    {
+        // key was not found.
+        return(false);
+    }
+    const BcfTypedValues* typed = getPendingTyped(index);
+    if(typed == NULL)
+    {
+        const std::string* text = getString(key);
+        return((text != NULL) && BcfTypedValues::parseFloats(*text, values));
+    }
+    const uint8_t* sampleValues = getSampleValues(*typed, myTypedSample);
+    if(!BcfTypedValues::hasValues(sampleValues, typed->type, typed->count))
+    {
+        // Not set for this sample, so it is missing.
+        uint32_t missing = BcfTypedValues::FLOAT_MISSING;
+        float value;
+        memcpy(&value, &missing, 4);
+        values.push_back(value);
+        return(true);
+    }
+    return(BcfTypedValues::getFloats(sampleValues, typed->type, typed->count,
+                                     values));
+}
+
+
 int VcfGenotypeSample::getGT(unsigned int index)
 {
     if(myGTs.empty())
@@ -275,6 +491,8 @@ int VcfGenotypeSample::getNumGTs()
 void VcfGenotypeSample::internal_reset()
 {
     myFormatPtr = NULL;
+    myTypedSample = -1;
+    myTextPending.clear();
     myPhased = false;
     myUnphased = false;
     myHasAllGenotypeAlleles = false;
@@ -350,7 +568,90 @@ void VcfGenotypeSample::updateGTString()
                 }
                 myGenotypeSubFields.get(index) = gtSS.str();
                 myNewGT = false;
+                if(index < (int)myTextPending.size())
+                {
+                    myTextPending[index] = false;
+                }
+            }
+        }
+    }
+}
+
+
+const BcfTypedValues* VcfGenotypeSample::getPendingTyped(int index)
+{
+    if((index < 0) || (index >= (int)myTextPending.size()) ||
+       !myTextPending[index])
+    {
+        return(NULL);
+    }
+    return(myFormatPtr->getTyped(index));
+}
+
+
+void VcfGenotypeSample::convertTyped(int index)
+{
+    const BcfTypedValues* typed = myFormatPtr->getTyped(index);
+    const uint8_t* values = getSampleValues(*typed, myTypedSample);
+    std::string& text = myGenotypeSubFields.get(index);
+    text.clear();
+    bool present = false;
+    if(*(myFormatPtr->getField(index)) == "GT")
+    {
+        present = BcfTypedValues::appendGT(values, typed->type, typed->count,
+                                           text);
+    }
+    else
+    {
+        present = BcfTypedValues::appendValues(values, typed->type,
+                                               typed->count, text);
+    }
+    if(!present)
+    {
+        text = MISSING_FIELD;
+    }
+    myTextPending[index] = false;
+}
+
+
+void VcfGenotypeSample::readTypedGT(const uint8_t* values,
+                                    const BcfTypedValues& typed)
+{
+    // There is a GT field, so set that all GT fields are there.
+    // if any are missing it will be turned back to false.
+    myHasAllGenotypeAlleles = true;
+    int typeSize = BcfTypedValues::getTypeSize(typed.type);
+    int32_t missing = BcfTypedValues::getMissing(typed.type);
+    for(int i = 0; i < typed.count; i++)
+    {
+        // Each allele is ((allele + 1) << 1 | phased), 0 if missing.
+        int32_t value = BcfTypedValues::getInt(values + i * typeSize,
+                                               typed.type);
+        if((value == missing + 1) || ((value == missing) && (i != 0)))
+        {
+            // End of the vector.
+            break;
+        }
+        if(i != 0)
+        {
+            if(value & 1)
+            {
+                myPhased = true;
             }
+            else
+            {
+                myUnphased = true;
+            }
+        }
+        int allele = (value >> 1) - 1;
+        if((value == missing) || (allele < 0))
+        {
+            myGTs.push_back(MISSING_GT);
+            myHasAllGenotypeAlleles = false;
+        }
+        else
+        {
+            myGTs.push_back(allele);
         }
     }
 }
@@ -41,6 +41,18 @@ public:
     /// \return true if a tab ended the field, false if it was \n or EOF.
     bool read(IFILE filePtr, VcfGenotypeFormat& format);
 
+    /// Read this sample from a copy of its column.
+    /// \param sample the sample's column (not including the \t or \n).
+    /// \param length number of characters in the column.
+    /// \param format the VCF Genotype Format field description.
+    void read(const char* sample, int length, VcfGenotypeFormat& format);
+
+    /// Set this sample from the typed values of a BCF2 record, which are
+    /// only converted to text when a field is accessed as a string.
+    /// \param sampleIndex index of the sample in the record.
+    /// \param format the format, read with VcfGenotypeFormat::readTyped.
+    void readTyped(int sampleIndex, VcfGenotypeFormat& format);
+
     virtual bool write(IFILE filePtr);
 
     /// Get a pointer to the string containing the value associated with the
@@ -55,6 +67,22 @@ public:
     /// false if not.
     bool setString(const std::string& key, const std::string& value);
 
+    /// Get the values of the specified key as integers, with missing ('.')
+    /// values as BcfTypedValues::INT32_MISSING.  Values read from BCF are
+    /// taken from their typed array without going through text.
+    /// \param key to get the values for, not GT (see getGT).
+    /// \param values set to the values of the key.
+    /// \return true if the key was found and its values are integers.
+    bool getInts(const std::string& key, std::vector<int32_t>& values);
+
+    /// Get the values of the specified key as floats, with missing ('.')
+    /// values as NaN.  Values read from BCF are taken from their typed
+    /// array without going through text.
+    /// \param key to get the values for, not GT (see getGT).
+    /// \param values set to the values of the key.
+    /// \return true if the key was found and its values are numbers.
+    bool getFloats(const std::string& key, std::vector<float>& values);
+
     inline bool isPhased()              { return(myPhased); }
     inline bool isUnphased()            { return(myUnphased); }
     inline bool hasAllGenotypeAlleles() { return(myHasAllGenotypeAlleles); }
@@ -72,6 +100,10 @@ public:
     /// Return the number of GT fields for this sample.
     int getNumGTs();
 
+    /// Set the format this sample was read with, used when the format
+    /// moves to another record.
+    inline void setFormat(VcfGenotypeFormat& format) { myFormatPtr = &format; }
+
 protected:
     /// reset the sample for a new entry.
     virtual void internal_reset();
@@ -84,8 +116,21 @@ private:
 
     void updateGTString();
 
+    // Get the typed values of the field at the specified index if they
+    // have not been converted to text, otherwise NULL.
+    const BcfTypedValues* getPendingTyped(int index);
+    // Convert the typed values of the field at the specified index to text.
+    void convertTyped(int index);
+    // Set the GTs and phasing from the typed GT values.
+    void readTypedGT(const uint8_t* values, const BcfTypedValues& typed);
+
     VcfGenotypeFormat* myFormatPtr;
 
+    // Index of the sample in its BCF record, -1 if not read from BCF.
+    int myTypedSample;
+    // Whether each field still needs its typed values converted to text.
+    std::vector<bool> myTextPending;
+
     bool myPhased;
     bool myUnphased;
     bool myHasAllGenotypeAlleles;
@@ -0,0 +1,131 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VcfIndexBuilder.h"
+#include "Tabix.h"
+
+VcfIndexBuilder::VcfIndexBuilder()
+    : IndexBuilder(),
+      myDictionary(),
+      myIsBcf(false),
+      myRefNames(),
+      myRefIDs(),
+      myPrevChrom(),
+      myPrevRefID(-1)
+{
+}
+
+
+VcfIndexBuilder::~VcfIndexBuilder()
+{
+}
+
+
+void VcfIndexBuilder::reset(VcfHeader& header, bool bcf, bool csi)
+{
+    myDictionary.set(header);
+    myIsBcf = bcf;
+    myRefNames.clear();
+    myRefIDs.clear();
+    myPrevChrom.clear();
+    myPrevRefID = -1;
+
+    // BCF records refer to all the contigs in the header, text VCF
+    // chromosomes are added as they are written.
+    int32_t numRefs = 0;
+    if(myIsBcf)
+    {
+        numRefs = myDictionary.getNumContigs();
+    }
+    IndexBuilder::reset(numRefs, myDictionary.getMaxContigLength(),
+                        csi || bcf);
+}
+
+
+bool VcfIndexBuilder::addRecord(const char* chrom,
+                                int start1Based, int end1Based,
+                                int64_t recordStart, int64_t recordEnd)
+{
+    // Look up the reference id when the chromosome changes.
+    if((myPrevRefID < 0) || (myPrevChrom != chrom))
+    {
+        myPrevChrom = chrom;
+        if(myIsBcf)
+        {
+            myPrevRefID = myDictionary.getContigIndex(myPrevChrom);
+        }
+        else
+        {
+            std::map<std::string, int32_t>::iterator iter =
+                myRefIDs.find(myPrevChrom);
+            if(iter != myRefIDs.end())
+            {
+                // Seen before, so the records are out of order and
+                // IndexBuilder will fail.
+                myPrevRefID = iter->second;
+            }
+            else
+            {
+                myPrevRefID = addRef();
+                myRefIDs[myPrevChrom] = myPrevRefID;
+                myRefNames.push_back(myPrevChrom);
+            }
+        }
+    }
+
+    // Tabix uses the 0-based half open interval of the record.
+    return(IndexBuilder::addRecord(myPrevRefID, start1Based - 1, end1Based,
+                                   true, recordStart, recordEnd));
+}
+
+
+bool VcfIndexBuilder::writeHeader(IFILE indexFile)
+{
+    if(myIsBcf)
+    {
+        // BCF CSI indexes have no auxiliary data.
+        return(writeCsiHeader(indexFile, ""));
+    }
+    std::string conf;
+    getTabixConf(conf);
+    if(isCsi())
+    {
+        return(writeCsiHeader(indexFile, conf));
+    }
+    int32_t numRefs = getNumRefs();
+    return((ifwrite(indexFile, "TBI\1", 4) == 4) &&
+           (ifwrite(indexFile, &numRefs, 4) == 4) &&
+           (ifwrite(indexFile, conf.c_str(), conf.size()) == conf.size()));
+}
+
+
+void VcfIndexBuilder::getTabixConf(std::string& conf)
+{
+    // The format, the sequence, begin, and end columns (end is not a
+    // column for VCF), the meta character, the number of lines to skip,
+    // and the length of the names.
+    std::string names;
+    for(unsigned int i = 0; i < myRefNames.size(); i++)
+    {
+        names += myRefNames[i];
+        names += '\0';
+    }
+    int32_t values[7] = {Tabix::FORMAT_VCF, 1, 2, 0, '#', 0,
+                         (int32_t)names.size()};
+    conf.assign((const char*)values, sizeof(values));
+    conf += names;
+}
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __VCF_INDEX_BUILDER_H__
+#define __VCF_INDEX_BUILDER_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "IndexBuilder.h"
+#include "BcfDictionary.h"
+
+/// Builds a Tabix index (or CSI) from the records of a sorted BGZF
+/// compressed VCF or BCF file as they are written, so the file does not
+/// need to be read again to index it.  See IndexBuilder for writing the
+/// index.
+///
+/// Text VCF is indexed by Tabix, or by CSI with the Tabix configuration
+/// and chromosome names if requested or if a contig is longer than Tabix
+/// supports.  Chromosomes are numbered in the order they are first written.
+/// BCF is always indexed by CSI, numbering the chromosomes by their index
+/// in the contig dictionary.
+class VcfIndexBuilder : public IndexBuilder
+{
+public:
+    VcfIndexBuilder();
+    ~VcfIndexBuilder();
+
+    /// Reset the builder for a new file.
+    /// \param header header of the file being written, used for the contig
+    /// lengths, and the contig indexes of BCF files.
+    /// \param bcf true if the file is BCF, false if it is text VCF.
+    /// \param csi true to write a CSI index for text VCF even if the contigs
+    /// are short enough for Tabix.
+    void reset(VcfHeader& header, bool bcf, bool csi);
+
+    /// Add a record that was written to the file.  Records must be
+    /// added in the order they were written.  If they are not sorted, the
+    /// index is marked as failed and no more records are added.
+    /// \param chrom chromosome of the record.
+    /// \param start1Based 1-based position of the record.
+    /// \param end1Based inclusive 1-based end position of the record.
+    /// \param recordStart uncompressed position where the record starts.
+    /// \param recordEnd uncompressed position where the record ends.
+    /// \return true if the record was added, false if the index failed.
+    bool addRecord(const char* chrom, int start1Based, int end1Based,
+                   int64_t recordStart, int64_t recordEnd);
+
+    /// Returns the index file extension, ".tbi" or ".csi".
+    const char* getExtension() const
+    {
+        return(isCsi() ? ".csi" : ".tbi");
+    }
+
+protected:
+    virtual bool writeHeader(IFILE indexFile);
+
+private:
+    // Get the Tabix configuration and chromosome names.
+    void getTabixConf(std::string& conf);
+
+    BcfDictionary myDictionary;
+    bool myIsBcf;
+
+    // Names of the chromosomes of text VCF in the order they were written.
+    std::vector<std::string> myRefNames;
+    std::map<std::string, int32_t> myRefIDs;
+
+    // The chromosome of the previous record.
+    std::string myPrevChrom;
+    int32_t myPrevRefID;
+};
+
+#endif
@@ -0,0 +1,499 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include "VcfParallelParser.h"
+#include "VcfFileReader.h"
+
+
+VcfParallelParser::Batch::~Batch()
+{
+    for(unsigned int i = 0; i < records.size(); i++)
+    {
+        delete records[i];
+    }
+}
+
+
+VcfParallelParser::VcfParallelParser(int numWorkers, int batchSize,
+                                     int maxBatches)
+    : myNumWorkers(numWorkers),
+      myBatchSize(batchSize),
+      myMaxBatches(maxBatches),
+      myFilePtr(NULL),
+      mySiteOnly(false),
+      myIDRules(NULL),
+      mySubset(NULL),
+      myReader(NULL),
+      myCurrent(NULL),
+      myCurrentIndex(0),
+      myNextReadSequence(0),
+      myNextReturnSequence(0),
+      myNumInFlight(0),
+      myReadDone(false),
+      myStopping(false),
+      myRunning(false),
+      myFailed(false),
+      myStatus(ErrorHandler::RETURN)
+{
+    if(myNumWorkers < 1)
+    {
+        myNumWorkers = 1;
+    }
+    if(myBatchSize < 1)
+    {
+        myBatchSize = 1;
+    }
+    if(myMaxBatches < 1)
+    {
+        // Enough for each worker to have one batch and one queued, plus
+        // one being read and one being returned.
+        myMaxBatches = 2 * myNumWorkers + 2;
+    }
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_init(&myMutex, NULL);
+    pthread_cond_init(&myWorkCond, NULL);
+    pthread_cond_init(&myReadyCond, NULL);
+    pthread_cond_init(&myFreeCond, NULL);
+#endif
+}
+
+
+VcfParallelParser::~VcfParallelParser()
+{
+    stop();
+    for(unsigned int i = 0; i < myFreeBatches.size(); i++)
+    {
+        delete myFreeBatches[i];
+    }
+    myFreeBatches.clear();
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_cond_destroy(&myFreeCond);
+    pthread_cond_destroy(&myReadyCond);
+    pthread_cond_destroy(&myWorkCond);
+    pthread_mutex_destroy(&myMutex);
+#endif
+}
+
+
+bool VcfParallelParser::start(IFILE filePtr, bool siteOnly,
+                              VcfRecordDiscardRules& idRules,
+                              VcfSubsetSamples* subset, VcfFileReader& reader)
+{
+    stop();
+
+    myFilePtr = filePtr;
+    mySiteOnly = siteOnly;
+    myIDRules = &idRules;
+    mySubset = subset;
+    myReader = &reader;
+    myCurrent = NULL;
+    myCurrentIndex = 0;
+    myNextReadSequence = 0;
+    myNextReturnSequence = 0;
+    myNumInFlight = 0;
+    myReadDone = false;
+    myStopping = false;
+    myFailed = false;
+    myStatus = StatGenStatus::SUCCESS;
+
+#ifdef __PTHREAD_AVAILABLE__
+    if(pthread_create(&myReaderId, NULL, readerThread, this) != 0)
+    {
+        return(false);
+    }
+    myRunning = true;
+    myWorkerIds.resize(myNumWorkers);
+    int numWorkers = 0;
+    for(; numWorkers < myNumWorkers; numWorkers++)
+    {
+        if(pthread_create(&myWorkerIds[numWorkers], NULL,
+                          workerThread, this) != 0)
+        {
+            break;
+        }
+    }
+    myWorkerIds.resize(numWorkers);
+    if(numWorkers == 0)
+    {
+        stop();
+        return(false);
+    }
+    return(true);
+#else
+    return(false);
+#endif
+}
+
+
+void VcfParallelParser::stop()
+{
+    if(!myRunning)
+    {
+        return;
+    }
+#ifdef __PTHREAD_AVAILABLE__
+    lock();
+    myStopping = true;
+    pthread_cond_broadcast(&myWorkCond);
+    pthread_cond_broadcast(&myReadyCond);
+    pthread_cond_broadcast(&myFreeCond);
+    unlock();
+
+    pthread_join(myReaderId, NULL);
+    for(unsigned int i = 0; i < myWorkerIds.size(); i++)
+    {
+        pthread_join(myWorkerIds[i], NULL);
+    }
+    myWorkerIds.clear();
+#endif
+
+    // Drop anything that was not returned.
+    while(!myWorkQueue.empty())
+    {
+        myFreeBatches.push_back(myWorkQueue.front());
+        myWorkQueue.pop_front();
+    }
+    for(std::map<uint64_t, Batch*>::iterator iter = myReadyQueue.begin();
+        iter != myReadyQueue.end(); iter++)
+    {
+        myFreeBatches.push_back(iter->second);
+    }
+    myReadyQueue.clear();
+    if(myCurrent != NULL)
+    {
+        myFreeBatches.push_back(myCurrent);
+        myCurrent = NULL;
+    }
+    myNumInFlight = 0;
+    myRunning = false;
+}
+
+
+bool VcfParallelParser::next(VcfRecord& record, int& numIDDiscards,
+                             bool& discard)
+{
+    numIDDiscards = 0;
+    discard = false;
+    myStatus = StatGenStatus::SUCCESS;
+    while(!myFailed &&
+          ((myCurrent == NULL) || (myCurrentIndex >= myCurrent->numRecords)))
+    {
+        if(myCurrent != NULL)
+        {
+            numIDDiscards += myCurrent->numTrailingDiscards;
+            if(myCurrent->failed)
+            {
+                // Parsing stopped at a failed record, so the failure is
+                // returned from now on.
+                myFailed = true;
+                break;
+            }
+        }
+        lock();
+        bool moreBatches = nextBatch();
+        unlock();
+        if(!moreBatches)
+        {
+            return(false);
+        }
+    }
+    if(myFailed)
+    {
+        if(myCurrent->failMessage.empty())
+        {
+            myStatus = myCurrent->failStatus;
+            return(false);
+        }
+        throw(std::runtime_error(myCurrent->failMessage));
+    }
+
+    int index = myCurrentIndex++;
+    numIDDiscards += myCurrent->numIDDiscards[index];
+    if(myCurrent->blank[index])
+    {
+        // read reports a blank line as no record.
+        return(false);
+    }
+    discard = myCurrent->discard[index];
+    record.swap(*(myCurrent->records[index]));
+    return(true);
+}
+
+
+bool VcfParallelParser::isEOF()
+{
+    if((myCurrent != NULL) && (myCurrentIndex < myCurrent->numRecords))
+    {
+        return(false);
+    }
+    lock();
+#ifdef __PTHREAD_AVAILABLE__
+    // Wait until the next batch is parsed or there are no more.
+    while((myReadyQueue.find(myNextReturnSequence) == myReadyQueue.end()) &&
+          !(myReadDone && (myNumInFlight == (myCurrent == NULL ? 0 : 1))) &&
+          !myStopping)
+    {
+        pthread_cond_wait(&myReadyCond, &myMutex);
+    }
+#endif
+    bool eof = (myReadyQueue.find(myNextReturnSequence) == myReadyQueue.end());
+    unlock();
+    return(eof);
+}
+
+
+void VcfParallelParser::parseBatch(Batch& batch,
+                                   VcfRecordDiscardRules& idRules,
+                                   InputFile& batchFile)
+{
+    batch.numRecords = 0;
+    batch.numIDDiscards.clear();
+    batch.discard.clear();
+    batch.blank.clear();
+    batch.numTrailingDiscards = 0;
+    batch.failed = false;
+    batch.failMessage.clear();
+
+    batchFile.openBuffer(batch.text.data(), batch.text.size());
+    while(!ifeof(&batchFile))
+    {
+        if(batch.numRecords == (int)batch.records.size())
+        {
+            batch.records.push_back(new VcfRecord());
+        }
+        VcfRecord& record = *(batch.records[batch.numRecords]);
+        bool success = false;
+        bool discard = false;
+        try
+        {
+            success = record.read(&batchFile, mySiteOnly, idRules, mySubset);
+            if(success)
+            {
+                discard = myReader->discardRecord(record);
+            }
+        }
+        catch(std::exception& e)
+        {
+            batch.failMessage = e.what();
+            success = false;
+        }
+        int numIDDiscards = idRules.getNumDiscarded();
+        idRules.clearNumDiscarded();
+
+        if(!batch.failMessage.empty() ||
+           (!success && (record.getStatus() != StatGenStatus::SUCCESS)))
+        {
+            // Stop at the failure.
+            batch.failed = true;
+            batch.failStatus = record.getStatus();
+            batch.numTrailingDiscards = numIDDiscards;
+            break;
+        }
+        if(!success && ifeof(&batchFile))
+        {
+            // Hit the end of the batch after discarding records by id.
+            batch.numTrailingDiscards = numIDDiscards;
+            break;
+        }
+        batch.numIDDiscards.push_back(numIDDiscards);
+        batch.discard.push_back(discard);
+        batch.blank.push_back(!success);
+        ++batch.numRecords;
+    }
+    batchFile.ifclose();
+}
+
+
+bool VcfParallelParser::nextBatch()
+{
+    if(myCurrent != NULL)
+    {
+        myFreeBatches.push_back(myCurrent);
+        myCurrent = NULL;
+        --myNumInFlight;
+#ifdef __PTHREAD_AVAILABLE__
+        pthread_cond_signal(&myFreeCond);
+#endif
+    }
+    std::map<uint64_t, Batch*>::iterator iter;
+#ifdef __PTHREAD_AVAILABLE__
+    while(((iter = myReadyQueue.find(myNextReturnSequence)) ==
+           myReadyQueue.end()) &&
+          !(myReadDone && (myNumInFlight == 0)) && !myStopping)
+    {
+        pthread_cond_wait(&myReadyCond, &myMutex);
+    }
+#else
+    iter = myReadyQueue.find(myNextReturnSequence);
+#endif
+    if(iter == myReadyQueue.end())
+    {
+        // No more batches.
+        return(false);
+    }
+    myCurrent = iter->second;
+    myCurrentIndex = 0;
+    myReadyQueue.erase(iter);
+    ++myNextReturnSequence;
+    return(true);
+}
+
+
+void VcfParallelParser::lock()
+{
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_lock(&myMutex);
+#endif
+}
+
+
+void VcfParallelParser::unlock()
+{
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_mutex_unlock(&myMutex);
+#endif
+}
+
+
+#ifdef __PTHREAD_AVAILABLE__
+void* VcfParallelParser::readerThread(void* arg)
+{
+    ((VcfParallelParser*)arg)->reader();
+    return(NULL);
+}
+
+
+void* VcfParallelParser::workerThread(void* arg)
+{
+    ((VcfParallelParser*)arg)->worker();
+    return(NULL);
+}
+
+
+void VcfParallelParser::reader()
+{
+    bool endOfFile = false;
+    while(!endOfFile)
+    {
+        lock();
+        while((myNumInFlight >= myMaxBatches) && !myStopping)
+        {
+            pthread_cond_wait(&myFreeCond, &myMutex);
+        }
+        if(myStopping)
+        {
+            unlock();
+            break;
+        }
+        Batch* batch = NULL;
+        if(myFreeBatches.empty())
+        {
+            batch = new Batch;
+        }
+        else
+        {
+            batch = myFreeBatches.back();
+            myFreeBatches.pop_back();
+        }
+        unlock();
+
+        // Read whole lines into the batch.  A batch does not end on a
+        // blank line so read can tell it from the end of the batch.
+        batch->text.clear();
+        int numLines = 0;
+        const char* line = NULL;
+        int length = 0;
+        while(true)
+        {
+            int result = myFilePtr->readLineView(line, length);
+            if((result != 0) && (length == 0))
+            {
+                endOfFile = true;
+                break;
+            }
+            batch->text.append(line, length);
+            batch->text += '\n';
+            if(result != 0)
+            {
+                // The last line did not end with a new line.
+                endOfFile = true;
+                break;
+            }
+            if((length != 0) &&
+               ((++numLines >= myBatchSize) ||
+                (batch->text.size() >= (unsigned int)MAX_BATCH_BYTES)))
+            {
+                break;
+            }
+        }
+
+        lock();
+        if(batch->text.empty())
+        {
+            myFreeBatches.push_back(batch);
+        }
+        else
+        {
+            batch->sequence = myNextReadSequence++;
+            ++myNumInFlight;
+            myWorkQueue.push_back(batch);
+            pthread_cond_signal(&myWorkCond);
+        }
+        unlock();
+    }
+
+    lock();
+    myReadDone = true;
+    pthread_cond_broadcast(&myWorkCond);
+    pthread_cond_broadcast(&myReadyCond);
+    unlock();
+}
+
+
+void VcfParallelParser::worker()
+{
+    // Each worker keeps its own count of the records discarded by id.
+    VcfRecordDiscardRules idRules;
+    idRules.shareIDs(*myIDRules);
+    InputFile batchFile;
+
+    lock();
+    while(true)
+    {
+        while(myWorkQueue.empty() && !myReadDone && !myStopping)
+        {
+            pthread_cond_wait(&myWorkCond, &myMutex);
+        }
+        if(myStopping || myWorkQueue.empty())
+        {
+            // Stopped or there is nothing left to parse.
+            break;
+        }
+        Batch* batch = myWorkQueue.front();
+        myWorkQueue.pop_front();
+        unlock();
+
+        parseBatch(*batch, idRules, batchFile);
+
+        lock();
+        myReadyQueue[batch->sequence] = batch;
+        pthread_cond_broadcast(&myReadyCond);
+    }
+    unlock();
+}
+#endif
@@ -0,0 +1,205 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __VCF_PARALLEL_PARSER_H__
+#define __VCF_PARALLEL_PARSER_H__
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#ifdef __PTHREAD_AVAILABLE__
+#include <pthread.h>
+#endif
+#include "InputFile.h"
+#include "StatGenStatus.h"
+#include "VcfRecord.h"
+#include "VcfRecordDiscardRules.h"
+#include "VcfSubsetSamples.h"
+
+class VcfFileReader;
+
+/// Parses the records of a VCF file on a pool of worker threads for
+/// VcfFileReader, handing them back in file order.
+///
+/// A reader thread splits the file into batches of whole lines and the
+/// workers parse each batch with VcfRecord::read (through
+/// InputFile::openBuffer), applying the id discard rules, sample subsetting,
+/// and the reader's other discard rules.  next() then swaps each parsed
+/// record into the caller's record, so no fields are copied.  At most
+/// maxBatches batches are being read, parsed, or waiting at once, so memory
+/// use is bounded no matter how large the file is.
+///
+/// Only available with pthreads.
+class VcfParallelParser
+{
+public:
+    /// Default maximum number of lines in each batch.
+    static const int DEFAULT_BATCH_SIZE = 1000;
+    /// A batch is also ended once it has this many bytes.
+    static const int MAX_BATCH_BYTES = 1024 * 1024;
+
+    /// Constructor.
+    /// \param numWorkers number of worker threads to parse records with.
+    /// \param batchSize maximum number of lines handed to a worker at a time.
+    /// \param maxBatches maximum number of batches being read, parsed, or
+    /// waiting to be returned at once, 0 for 2 per worker plus 2.
+    VcfParallelParser(int numWorkers, int batchSize = DEFAULT_BATCH_SIZE,
+                      int maxBatches = 0);
+
+    /// Destructor, stops the threads if they are running.
+    ~VcfParallelParser();
+
+    /// Start parsing the records from the current position of the file.
+    /// The file, rules, subset, and reader must not be used or changed by
+    /// anything else until stop() is called.
+    /// \param filePtr file to read the records from.
+    /// \param siteOnly only store the first 8 columns.
+    /// \param idRules rules to discard records by their id.
+    /// \param subset pointer to sample subset information, NULL for none.
+    /// \param reader reader whose discardRecord is checked for each record.
+    /// \return true if the threads were started.
+    bool start(IFILE filePtr, bool siteOnly, VcfRecordDiscardRules& idRules,
+               VcfSubsetSamples* subset, VcfFileReader& reader);
+
+    /// Stop and wait for the threads, dropping any records that have not
+    /// been returned.  The file is left partway through, so it must be
+    /// seeked or closed before it is read again.
+    void stop();
+
+    /// Get the number of worker threads.
+    int getNumWorkers() { return(myNumWorkers); }
+
+    /// Return whether or not the threads are running.
+    bool isRunning() { return(myRunning); }
+
+    /// Get the next record, in file order, swapping it into record.
+    /// \param record record to populate with the next record.
+    /// \param numIDDiscards set to the number of records discarded by id
+    /// since the previous call.
+    /// \param discard set to whether or not the reader's discard rules
+    /// discard the record.
+    /// \return true if a record was returned, false if not, in which case
+    /// getStatus is SUCCESS at the end of the records (or at a blank line)
+    /// and the failure if a record failed to parse.  A parse failure that
+    /// threw an exception is rethrown here.  Once a record fails, every
+    /// later call fails the same way.
+    bool next(VcfRecord& record, int& numIDDiscards, bool& discard);
+
+    /// Return whether or not every record has been returned by next,
+    /// waiting for the reader thread if it has not yet found out.
+    bool isEOF();
+
+    /// Returns the status of the last call to next.
+    const StatGenStatus& getStatus() { return(myStatus); }
+
+private:
+    VcfParallelParser(const VcfParallelParser& other);
+    VcfParallelParser& operator=(const VcfParallelParser& other);
+
+    struct Batch
+    {
+        Batch() : numRecords(0), failStatus(ErrorHandler::RETURN) {}
+        ~Batch();
+
+        uint64_t sequence;
+        // The lines to parse.
+        std::string text;
+        // The parsed records, reused by later batches.
+        std::vector<VcfRecord*> records;
+        int numRecords;
+        // Number of records discarded by id before each record.
+        std::vector<int> numIDDiscards;
+        // Whether or not the reader's discard rules discard each record.
+        std::vector<bool> discard;
+        // Whether or not each record is a blank line, which read reports
+        // as no record.
+        std::vector<bool> blank;
+        // Records discarded by id after the last record.
+        int numTrailingDiscards;
+        // Set if parsing stopped on a failed record, with the exception
+        // message if it threw one, otherwise its status.
+        bool failed;
+        std::string failMessage;
+        StatGenStatus failStatus;
+    };
+
+    // Parse the lines of the batch into its records, reading them through
+    // batchFile.
+    void parseBatch(Batch& batch, VcfRecordDiscardRules& idRules,
+                    InputFile& batchFile);
+
+#ifdef __PTHREAD_AVAILABLE__
+    static void* readerThread(void* arg);
+    static void* workerThread(void* arg);
+    void reader();
+    void worker();
+#endif
+
+    // Release the batch being returned and move to the next one, returning
+    // false if there are no more.  Must be called with the lock held.
+    bool nextBatch();
+
+    void lock();
+    void unlock();
+
+    int myNumWorkers;
+    int myBatchSize;
+    int myMaxBatches;
+
+    // Settings of the current run.
+    IFILE myFilePtr;
+    bool mySiteOnly;
+    VcfRecordDiscardRules* myIDRules;
+    VcfSubsetSamples* mySubset;
+    VcfFileReader* myReader;
+
+    std::vector<Batch*> myFreeBatches;
+    // Batches waiting to be parsed.
+    std::deque<Batch*> myWorkQueue;
+    // Parsed batches waiting to be returned, by sequence.
+    std::map<uint64_t, Batch*> myReadyQueue;
+    // The batch records are being returned from and the next index in it.
+    Batch* myCurrent;
+    int myCurrentIndex;
+    uint64_t myNextReadSequence;
+    uint64_t myNextReturnSequence;
+    // Number of batches that are queued, being parsed, or being returned.
+    int myNumInFlight;
+    bool myReadDone;
+    bool myStopping;
+    bool myRunning;
+    bool myFailed;
+
+    StatGenStatus myStatus;
+
+#ifdef __PTHREAD_AVAILABLE__
+    pthread_t myReaderId;
+    std::vector<pthread_t> myWorkerIds;
+    pthread_mutex_t myMutex;
+    // Signalled when there is work, or the reading is done.
+    pthread_cond_t myWorkCond;
+    // Signalled when a batch is parsed, or the reading is done.
+    pthread_cond_t myReadyCond;
+    // Signalled when a batch is released.
+    pthread_cond_t myFreeCond;
+#endif
+};
+
+#endif
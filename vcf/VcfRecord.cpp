@@ -290,6 +290,30 @@ void VcfRecord::reset()
 }
 
 
+void VcfRecord::swap(VcfRecord& other)
+{
+    myChrom.swap(other.myChrom);
+    int pos = my1BasedPosNum;
+    my1BasedPosNum = other.my1BasedPosNum;
+    other.my1BasedPosNum = pos;
+    myID.swap(other.myID);
+    myRef.swap(other.myRef);
+    myAlt.swap(other.myAlt);
+    float qual = myQualNum;
+    myQualNum = other.myQualNum;
+    other.myQualNum = qual;
+    myQual.swap(other.myQual);
+    myFilter.swap(other.myFilter);
+    myInfo.swap(other.myInfo);
+    myGenotype.swap(other.myGenotype);
+    myAltArray.swap(other.myAltArray);
+    myAlleleCount.swap(other.myAlleleCount);
+    StatGenStatus status = myStatus;
+    myStatus = other.myStatus;
+    other.myStatus = status;
+}
+
+
 // Return the error after a failed call.
 const StatGenStatus& VcfRecord::getStatus()
 {
@@ -297,6 +321,17 @@ const StatGenStatus& VcfRecord::getStatus()
 }
 
 
+int VcfRecord::get1BasedEndPosition()
+{
+    const std::string* endStr = myInfo.getString("END");
+    if((endStr != NULL) && !endStr->empty())
+    {
+        return(atoi(endStr->c_str()));
+    }
+    return(my1BasedPosNum + myRef.size() - 1);
+}
+
+
 const char* VcfRecord::getAlleles(unsigned int index)
 {
     if(index == 0)
@@ -420,24 +455,7 @@ int VcfRecord::getAlleleCount(unsigned int index,
 
 bool VcfRecord::readTilTab(IFILE filePtr, std::string& stringRef)
 {
-    int charRead = 0;
-    while(1)
-    {
-        charRead = ifgetc(filePtr);
-        
-        if((charRead == '\n') || (charRead == EOF))
-        {
-            // Didn't find a tab, found a '\n' or eof
-            // It still populated the string with values up
-            // until the tab.
-            return(false);
-        }
-        if(charRead == '\t')
-        {
-            // hit the tab character, so exit the loop.
-            break;
-        }
-        stringRef += charRead;
-    }
-    return(true);
+    // Returns 1 if it hit the tab character.  Otherwise it found a '\n' or
+    // eof, but it still populated the string with values up until then.
+    return(filePtr->readTilTab(stringRef) == 1);
 }
@@ -61,6 +61,10 @@ public:
     /// Reset this header, preparing for a new one.
     void reset();
 
+    /// Exchange the contents of this record with another one without
+    /// copying the fields or samples.
+    void swap(VcfRecord& other);
+
     /// Returns the status associated with the last method that sets the status.
     /// \return StatGenStatus of the last command that sets status.
     const StatGenStatus& getStatus();
@@ -76,6 +80,9 @@ public:
     const char* getIDStr() {return(myID.c_str());}
     const char* getRefStr() {return(myRef.c_str());}
     int getNumRefBases() {return(myRef.size());}
+    /// Return the 1-based inclusive end position of the record: INFO END
+    /// if it is set, otherwise the position of the last reference base.
+    int get1BasedEndPosition();
     const char* getAltStr() {return(myAlt.c_str());}
     /// Return a pointer to the alleles at the specified index with index 0
     /// being the reference string for this position and index 1 starting
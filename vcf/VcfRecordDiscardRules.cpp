@@ -22,6 +22,7 @@ void VcfRecordDiscardRules::reset()
     myExcludeIDs.clear();
     myIncludeIDs.clear();
     myNumDiscarded = 0;
+    myIDRules = this;
 }
 
 
@@ -39,9 +40,11 @@ bool VcfRecordDiscardRules::setIncludeIDs(const char* filename)
 
 bool VcfRecordDiscardRules::discardForID(std::string& myID)
 {
-    if(!myExcludeIDs.empty())
+    const IDList& excludeIDs = myIDRules->myExcludeIDs;
+    const IDList& includeIDs = myIDRules->myIncludeIDs;
+    if(!excludeIDs.empty())
     {
-        if(myExcludeIDs.find(myID) != myExcludeIDs.end())
+        if(excludeIDs.find(myID) != excludeIDs.end())
         {
             // The ID is in the exclude list,
             // so return true, discard the record.
@@ -50,9 +53,9 @@ bool VcfRecordDiscardRules::discardForID(std::string& myID)
             return(true);
         }
     }
-    else if(!myIncludeIDs.empty())
+    else if(!includeIDs.empty())
     {
-        if(myIncludeIDs.find(myID) == myIncludeIDs.end())
+        if(includeIDs.find(myID) == includeIDs.end())
         {
             // The ID is not in the include list,
             // so return false, discard the record.
@@ -38,7 +38,8 @@ public:
     VcfRecordDiscardRules()
         : myExcludeIDs(),
           myIncludeIDs(),
-          myNumDiscarded(0)
+          myNumDiscarded(0),
+          myIDRules(this)
     {}
 
     ~VcfRecordDiscardRules()
@@ -49,6 +50,7 @@ public:
 
     int getNumDiscarded() { return(myNumDiscarded); }
     void clearNumDiscarded() { myNumDiscarded = 0; }
+    void addNumDiscarded(int numDiscarded) { myNumDiscarded += numDiscarded; }
 
     ///////////////////////
     /// @name  Set the discard rules.
@@ -62,6 +64,12 @@ public:
     /// in the passed in filename.
     /// Returns false, if the file could not be read.
     bool setIncludeIDs(const char* filename);
+
+    /// Check IDs against the exclude/include ids of the specified rules
+    /// rather than this object's own, keeping a separate discard count.
+    /// Used so several threads can share one copy of the id lists.  The
+    /// specified rules must not be changed or destroyed while in use.
+    void shareIDs(VcfRecordDiscardRules& rules) { myIDRules = &rules; }
     //@}
 
     
@@ -88,6 +96,8 @@ private:
     IDList myExcludeIDs;
     IDList myIncludeIDs;
     int myNumDiscarded;
+    // Rules whose id lists are checked, this object unless shared.
+    VcfRecordDiscardRules* myIDRules;
 };
 
 #endif
@@ -30,8 +30,8 @@ bool VcfRecordFilter::read(IFILE filePtr)
     static const std::string fieldStopCharsNoParse = "\n\t";
     static const int tabPos = 1;
 
-    static std::string fieldStopChars = fieldStopCharsNoParse;
-    fieldStopChars += FILTER_DELIM;
+    static const std::string fieldStopChars =
+        fieldStopCharsNoParse + FILTER_DELIM;
 
     // The start of the first character in stopChars that means there is more
     // filter info in the format field, so continue reading the format field.
@@ -76,6 +76,13 @@ void VcfRecordFilter::reset()
 }
 
 
+void VcfRecordFilter::swap(VcfRecordFilter& other)
+{
+    myFilterString.swap(other.myFilterString);
+    myFilterVector.swap(other.myFilterVector);
+}
+
+
 bool VcfRecordFilter::passedAllFilters()
 {
     static std::string pass("PASS");
@@ -60,6 +60,10 @@ public:
     const std::string& getString(int index);
 
     void clear() {reset();}
+
+    /// Exchange the contents of this filter with another.
+    void swap(VcfRecordFilter& other);
+
     void setFilter(const char* filter);
 
     void addFilter(const char* filter);
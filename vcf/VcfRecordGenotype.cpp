@@ -18,8 +18,11 @@
  */
 #include "VcfRecordGenotype.h"
 #include <stdlib.h>
+#include <string.h>
 
 std::set <std::string> VcfRecordGenotype::ourStoreFields;
+bool VcfRecordGenotype::ourGTMatrixMode = false;
+bool VcfRecordGenotype::ourLazyMode = false;
 
 
 void VcfRecordGenotype::storeAllFields()
@@ -44,6 +47,11 @@ bool VcfRecordGenotype::storeField(std::string& field)
 }
 
 VcfRecordGenotype::VcfRecordGenotype()
+    : myLazy(false),
+      myTyped(false),
+      myRawSamples(),
+      myRawSampleInfo(),
+      myUseGTMatrix(false)
 {
     reset();
 }
@@ -74,6 +82,17 @@ bool VcfRecordGenotype::read(IFILE filePtr, VcfSubsetSamples* subsetInfo)
         // End of file, just return false.
         return(false);
     }
+
+    if(ourGTMatrixMode)
+    {
+        // Decode the GTs straight out of the read buffer.
+        const char* columns = NULL;
+        int length = 0;
+        filePtr->readLineView(columns, length);
+        myGTMatrix.parse(columns, length, subsetInfo);
+        myUseGTMatrix = true;
+        return(false);
+    }
     
     // Read the format.
     if(!myFormat.read(filePtr))
@@ -82,6 +101,41 @@ bool VcfRecordGenotype::read(IFILE filePtr, VcfSubsetSamples* subsetInfo)
         return(false);
     }
 
+    if(ourLazyMode)
+    {
+        // Keep a copy of the sample columns and just find where each kept
+        // sample starts and ends.  They are parsed when they are accessed.
+        myLazy = true;
+        const char* columns = NULL;
+        int length = 0;
+        filePtr->readLineView(columns, length);
+        myRawSamples.assign(columns, length);
+        const char* start = myRawSamples.data();
+        const char* end = start + length;
+        const char* pos = start;
+        int sampleIndex = 0;
+        bool moreSamples = true;
+        while(moreSamples)
+        {
+            const char* columnEnd = (const char*)memchr(pos, '\t', end - pos);
+            if(columnEnd == NULL)
+            {
+                // Last sample on the line.
+                columnEnd = end;
+                moreSamples = false;
+            }
+            if((subsetInfo == NULL) || subsetInfo->keep(sampleIndex))
+            {
+                RawSample raw = {(int)(pos - start), (int)(columnEnd - start),
+                                 -1};
+                myRawSampleInfo.push_back(raw);
+            }
+            ++sampleIndex;
+            pos = columnEnd + 1;
+        }
+        return(false);
+    }
+
    // Read all the samples until the end of the line.
     VcfGenotypeSample* nextSample = NULL;
     bool moreSamples = true;
@@ -126,10 +180,48 @@ bool VcfRecordGenotype::read(IFILE filePtr, VcfSubsetSamples* subsetInfo)
 }
 
 
+void VcfRecordGenotype::readTypedGT(const uint8_t* values, int valueSize,
+                                    int numValues, int numSamples,
+                                    VcfSubsetSamples* subsetInfo)
+{
+    reset();
+    myGTMatrix.parseTyped(values, valueSize, numValues, numSamples,
+                          subsetInfo);
+    myUseGTMatrix = true;
+}
+
+
+void VcfRecordGenotype::readTyped(const std::vector<const char*>& keys,
+                                  const std::vector<BcfTypedValues>& values,
+                                  int numSamples,
+                                  VcfSubsetSamples* subsetInfo)
+{
+    reset();
+    myFormat.readTyped(keys, values, numSamples);
+
+    // Each kept sample is set from the typed values when it is accessed.
+    myLazy = true;
+    myTyped = true;
+    for(int sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+    {
+        if((subsetInfo == NULL) || subsetInfo->keep(sampleIndex))
+        {
+            RawSample raw = {sampleIndex, sampleIndex, -1};
+            myRawSampleInfo.push_back(raw);
+        }
+    }
+}
+
+
 bool VcfRecordGenotype::write(IFILE filePtr)
 {
     bool status = true;
 
+    if(myUseGTMatrix)
+    {
+        return(myGTMatrix.write(filePtr));
+    }
+
     // Check if there are any fields to write.
     if(myFormat.getNumFields() == 0)
     {
@@ -141,9 +233,23 @@ bool VcfRecordGenotype::write(IFILE filePtr)
     status &= myFormat.write(filePtr);
 
     // Loop through and write each sample.
-    for(int i = 0; i < mySamples.size(); i++)
+    bool allFieldsStored =
+        (myFormat.getNumFields() == myFormat.getOrigNumFields());
+    for(int i = 0; i < getNumSamples(); i++)
     {
-        status &= mySamples.get(i).write(filePtr);
+        if(myLazy && !myTyped && allFieldsStored &&
+           (myRawSampleInfo[i].parsed == -1) &&
+           (myRawSampleInfo[i].end != myRawSampleInfo[i].start))
+        {
+            // Not parsed, so write the sample just as it was read.
+            int length = myRawSampleInfo[i].end - myRawSampleInfo[i].start;
+            status &= (ifwrite(filePtr, "\t", 1) == 1);
+            status &= (ifwrite(filePtr, 
+                               myRawSamples.data() + myRawSampleInfo[i].start,
+                               length) == (unsigned int)length);
+            continue;
+        }
+        status &= getSample(i)->write(filePtr);
     }
     return(status);
 }
@@ -153,19 +259,60 @@ void VcfRecordGenotype::reset()
 {
     myFormat.reset();
     mySamples.reset();
+    // The matrix is reset when it is next parsed.
+    myUseGTMatrix = false;
+    myLazy = false;
+    myTyped = false;
+    myRawSampleInfo.clear();
+}
+
+
+void VcfRecordGenotype::swap(VcfRecordGenotype& other)
+{
+    myFormat.swap(other.myFormat);
+    mySamples.swap(other.mySamples);
+    // The samples point to the format of the record they were read in.
+    for(int i = 0; i < mySamples.size(); i++)
+    {
+        mySamples.get(i).setFormat(myFormat);
+    }
+    for(int i = 0; i < other.mySamples.size(); i++)
+    {
+        other.mySamples.get(i).setFormat(other.myFormat);
+    }
+
+    bool flag = myLazy;
+    myLazy = other.myLazy;
+    other.myLazy = flag;
+    flag = myTyped;
+    myTyped = other.myTyped;
+    other.myTyped = flag;
+    myRawSamples.swap(other.myRawSamples);
+    myRawSampleInfo.swap(other.myRawSampleInfo);
+
+    flag = myUseGTMatrix;
+    myUseGTMatrix = other.myUseGTMatrix;
+    other.myUseGTMatrix = flag;
+    myGTMatrix.swap(other.myGTMatrix);
 }
 
 
 const std::string* VcfRecordGenotype::getString(const std::string& key, 
                                                 int sampleNum)
 {
-    if(sampleNum >= mySamples.size())
+    if(myUseGTMatrix)
+    {
+        // Only GT was decoded.
+        return(NULL);
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
     {
         // Out of range sample index.
         return(NULL);
     }
     // Get the field from the sample.
-    return(mySamples.get(sampleNum).getString(key));
+    return(sample->getString(key));
 }
 
 
@@ -173,60 +320,163 @@ bool VcfRecordGenotype::setString(const std::string& key,
                                   int sampleNum, 
                                   const std::string& value)
 {
-    if(sampleNum >= mySamples.size())
+    if(myUseGTMatrix)
+    {
+        // Only GT was decoded.
+        return(false);
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
     {
         // Out of range sample index.
         return(NULL);
     }
     // Set the field in the sample.
-    return(mySamples.get(sampleNum).setString(key, value));
+    return(sample->setString(key, value));
+}
+
+
+bool VcfRecordGenotype::getInts(const std::string& key, int sampleNum,
+                                std::vector<int32_t>& values)
+{
+    values.clear();
+    if(myUseGTMatrix)
+    {
+        // Only GT was decoded.
+        return(false);
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
+    {
+        // Out of range sample index.
+        return(false);
+    }
+    return(sample->getInts(key, values));
+}
+
+
+bool VcfRecordGenotype::getFloats(const std::string& key, int sampleNum,
+                                  std::vector<float>& values)
+{
+    values.clear();
+    if(myUseGTMatrix)
+    {
+        // Only GT was decoded.
+        return(false);
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
+    {
+        // Out of range sample index.
+        return(false);
+    }
+    return(sample->getFloats(key, values));
+}
+
+
+int VcfRecordGenotype::getNumFormatFields()
+{
+    if(myUseGTMatrix)
+    {
+        return(myGTMatrix.hasGT() ? 1 : 0);
+    }
+    return(myFormat.getNumFields());
+}
+
+
+const std::string* VcfRecordGenotype::getFormatField(int index)
+{
+    static const std::string gtKey = "GT";
+    if(myUseGTMatrix)
+    {
+        return((myGTMatrix.hasGT() && (index == 0)) ? &gtKey : NULL);
+    }
+    return(myFormat.getField(index));
+}
+
+
+int VcfRecordGenotype::getNumSampleFields(int sampleNum)
+{
+    if(myUseGTMatrix)
+    {
+        return(((sampleNum >= 0) && (sampleNum < getNumSamples())) ? 
+               getNumFormatFields() : 0);
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
+    {
+        // Out of range sample index.
+        return(0);
+    }
+    return(sample->getNumFields());
 }
 
 
 int VcfRecordGenotype::getGT(int sampleNum, unsigned int gtIndex)
 {
-    if(sampleNum >= mySamples.size())
+    if(myUseGTMatrix)
+    {
+        return(myGTMatrix.getGT(sampleNum, gtIndex));
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
     {
         // Out of range sample index.
         return(VcfGenotypeSample::INVALID_GT);
     }
     // Get the field from the sample.
-    return(mySamples.get(sampleNum).getGT(gtIndex));
+    return(sample->getGT(gtIndex));
 
 }
 
 
 void VcfRecordGenotype::setGT(int sampleNum, unsigned int gtIndex, int newGt)
 {
-    if(sampleNum >= mySamples.size())
+    if(myUseGTMatrix)
+    {
+        myGTMatrix.setGT(sampleNum, gtIndex, newGt);
+        return;
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
     {
         // Out of range sample index.
         throw(std::runtime_error("setGT called with out of range sample."));
     }
     // Set the field for the sample.
-    mySamples.get(sampleNum).setGT(gtIndex, newGt);
+    sample->setGT(gtIndex, newGt);
 
 }
 
 
 int VcfRecordGenotype::getNumGTs(int sampleNum)
 {
-    if(sampleNum >= mySamples.size())
+    if(myUseGTMatrix)
+    {
+        return(myGTMatrix.getNumGTs(sampleNum));
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
     {
         // Out of range sample index, no GTs.
         return(0);
     }
     // Get the field from the sample.
-    return(mySamples.get(sampleNum).getNumGTs());
+    return(sample->getNumGTs());
 
 }
 
 
 bool VcfRecordGenotype::allPhased()
 {
-    for(int i = 0; i < mySamples.size(); i++)
+    if(myUseGTMatrix)
     {
-        if(!mySamples.get(i).isPhased() || mySamples.get(i).isUnphased())
+        return(myGTMatrix.allPhased());
+    }
+    for(int i = 0; i < getNumSamples(); i++)
+    {
+        VcfGenotypeSample* sample = getSample(i);
+        if(!sample->isPhased() || sample->isUnphased())
         {
             // found a sample that is not phased or is unphased, so
             // return false.
@@ -240,9 +490,14 @@ bool VcfRecordGenotype::allPhased()
 
 bool VcfRecordGenotype::allUnphased()
 {
-    for(int i = 0; i < mySamples.size(); i++)
+    if(myUseGTMatrix)
+    {
+        return(myGTMatrix.allUnphased());
+    }
+    for(int i = 0; i < getNumSamples(); i++)
     {
-        if(!mySamples.get(i).isUnphased() || mySamples.get(i).isPhased())
+        VcfGenotypeSample* sample = getSample(i);
+        if(!sample->isUnphased() || sample->isPhased())
         {
             // found a sample that is not unphased or is phased, so
             // return false.
@@ -256,9 +511,13 @@ bool VcfRecordGenotype::allUnphased()
 
 bool VcfRecordGenotype::hasAllGenotypeAlleles()
 {
-    for(int i = 0; i < mySamples.size(); i++)
+    if(myUseGTMatrix)
+    {
+        return(myGTMatrix.hasAllGenotypeAlleles());
+    }
+    for(int i = 0; i < getNumSamples(); i++)
     {
-        if(!mySamples.get(i).hasAllGenotypeAlleles())
+        if(!getSample(i)->hasAllGenotypeAlleles())
         {
             // found a sample that does not have all genotype alleles, so
             // return false.
@@ -272,32 +531,74 @@ bool VcfRecordGenotype::hasAllGenotypeAlleles()
 
 bool VcfRecordGenotype::isPhased(int sampleNum)
 {
-    if(sampleNum >= mySamples.size())
+    if(myUseGTMatrix)
+    {
+        return(myGTMatrix.isPhased(sampleNum));
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
     {
         // Out of range sample index.
         return(false);
     }
-    return(mySamples.get(sampleNum).isPhased());
+    return(sample->isPhased());
 }
 
 
 bool VcfRecordGenotype::isUnphased(int sampleNum)
 {
-    if(sampleNum >= mySamples.size())
+    if(myUseGTMatrix)
+    {
+        return(myGTMatrix.isUnphased(sampleNum));
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
     {
         // Out of range sample index.
         return(false);
     }
-    return(mySamples.get(sampleNum).isUnphased());
+    return(sample->isUnphased());
 }
 
 
 bool VcfRecordGenotype::hasAllGenotypeAlleles(int sampleNum)
 {
-    if(sampleNum >= mySamples.size())
+    if(myUseGTMatrix)
+    {
+        return(myGTMatrix.hasAllGenotypeAlleles(sampleNum));
+    }
+    VcfGenotypeSample* sample = getSample(sampleNum);
+    if(sample == NULL)
     {
         // Out of range sample index.
         return(false);
     }
-    return(mySamples.get(sampleNum).hasAllGenotypeAlleles());
+    return(sample->hasAllGenotypeAlleles());
+}
+
+
+VcfGenotypeSample* VcfRecordGenotype::getLazySample(int sampleNum)
+{
+    if((sampleNum < 0) || (sampleNum >= (int)myRawSampleInfo.size()))
+    {
+        // Out of range sample index.
+        return(NULL);
+    }
+    RawSample& raw = myRawSampleInfo[sampleNum];
+    if(raw.parsed == -1)
+    {
+        // First access to this sample, so parse it.
+        VcfGenotypeSample& sample = mySamples.getNextEmpty();
+        if(myTyped)
+        {
+            sample.readTyped(raw.start, myFormat);
+        }
+        else
+        {
+            sample.read(myRawSamples.data() + raw.start, raw.end - raw.start,
+                        myFormat);
+        }
+        raw.parsed = mySamples.size() - 1;
+    }
+    return(&(mySamples.get(raw.parsed)));
 }
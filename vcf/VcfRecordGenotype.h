@@ -27,6 +27,7 @@
 #include "VcfSubsetSamples.h"
 #include "VcfGenotypeFormat.h"
 #include "VcfGenotypeSample.h"
+#include "VcfGenotypeMatrix.h"
 
 /// This header file provides interface to read/write VCF files.
 class VcfRecordGenotype : public VcfRecordField
@@ -43,6 +44,25 @@ public:
     /// Return true if the specified field has been set to be stored.
     static bool storeField(std::string& field);
 
+    /// When reading, decode only GT into a VcfGenotypeMatrix instead of
+    /// storing each sample's fields.  The GT accessors of this class then
+    /// read from the matrix, getString returns NULL, setString returns false,
+    /// and write only writes GT.  Off by default.
+    static void setGTMatrixMode(bool gtMatrix) { ourGTMatrixMode = gtMatrix; }
+
+    /// Return whether or not records are read into a VcfGenotypeMatrix.
+    static bool isGTMatrixMode() { return(ourGTMatrixMode); }
+
+    /// When reading, keep the raw sample columns and only parse a sample
+    /// when one of its fields is first accessed, so untouched samples are
+    /// never parsed.  Errors in a sample's fields are then reported by
+    /// throwing an exception from the accessor rather than by a failed read.
+    /// GT matrix mode takes precedence if both are set.  Off by default.
+    static void setLazyMode(bool lazy) { ourLazyMode = lazy; }
+
+    /// Return whether or not samples are parsed when they are accessed.
+    static bool isLazyMode() { return(ourLazyMode); }
+
     /// Default Constructor, initializes the variables.
     VcfRecordGenotype();
 
@@ -62,6 +82,24 @@ public:
     /// returns false since this is the last field on the line).
     bool read(IFILE filePtr, VcfSubsetSamples* subsetInfo);
 
+    /// Set the genotypes of a BCF2 record with only GT, decoding its typed
+    /// GT array straight into the genotype matrix (for GT matrix mode).
+    /// See VcfGenotypeMatrix::parseTyped for the parameters.
+    void readTypedGT(const uint8_t* values, int valueSize, int numValues,
+                     int numSamples, VcfSubsetSamples* subsetInfo);
+
+    /// Set the genotypes of a BCF2 record from the typed values of its
+    /// FORMAT keys.  The values of the stored keys are copied, and a
+    /// sample's values are only converted to text when they are accessed
+    /// as strings, whether or not lazy mode is set.
+    /// \param keys the FORMAT keys.
+    /// \param values the typed values of each key, count per sample.
+    /// \param numSamples number of samples in the record.
+    /// \param subsetInfo pointer to optional subsetting information.
+    void readTyped(const std::vector<const char*>& keys,
+                   const std::vector<BcfTypedValues>& values,
+                   int numSamples, VcfSubsetSamples* subsetInfo);
+
     /// Write the genotype field to the file, without printing the
     // starting/trailing '\t'.
     /// \param filePtr IFILE to write to.
@@ -74,6 +112,10 @@ public:
     /// reset the field for a new entry.
     void clear() {reset();}
 
+    /// Exchange the contents of this genotype field with another, without
+    /// copying the samples.
+    void swap(VcfRecordGenotype& other);
+
     /// Get a pointer to the string containing the value associated with the
     /// specified key for the specified sample
     /// (the pointer will be invalid if the field is changed/reset).  
@@ -89,6 +131,41 @@ public:
     bool setString(const std::string& key, int sampleNum, 
                    const std::string& value);
 
+    /// Get the values of the specified key for the specified sample as
+    /// integers, with missing ('.') values as BcfTypedValues::INT32_MISSING.
+    /// Values read from BCF are taken from their typed array without
+    /// going through text.
+    /// \param key to get the values for, not GT (see getGT).
+    /// \param sampleNum which sample to get the values for (starts at 0).
+    /// \param values set to the values of the key.
+    /// \return true if the sample and key were found and the values are
+    /// integers.
+    bool getInts(const std::string& key, int sampleNum,
+                 std::vector<int32_t>& values);
+
+    /// Get the values of the specified key for the specified sample as
+    /// floats, with missing ('.') values as NaN.  Values read from BCF are
+    /// taken from their typed array without going through text.
+    /// \param key to get the values for.
+    /// \param sampleNum which sample to get the values for (starts at 0).
+    /// \param values set to the values of the key.
+    /// \return true if the sample and key were found and the values are
+    /// numbers.
+    bool getFloats(const std::string& key, int sampleNum,
+                   std::vector<float>& values);
+
+    /// Get the number of FORMAT subfields stored for this record (just GT,
+    /// if it has one, when it was read into the genotype matrix).
+    int getNumFormatFields();
+
+    /// Get the key of the stored FORMAT subfield at the specified index,
+    /// or NULL if out of range.
+    const std::string* getFormatField(int index);
+
+    /// Get the number of the stored FORMAT subfields that the specified
+    /// sample has, since a sample may leave off trailing subfields.
+    int getNumSampleFields(int sampleNum);
+
     int getGT(int sampleNum, unsigned int gtIndex);
     void setGT(int sampleNum, unsigned int gtIndex, int newGt);
 
@@ -123,7 +200,25 @@ public:
     bool hasAllGenotypeAlleles(int sampleNum);
 
     /// Get the number of samples.
-    inline int getNumSamples() const { return(mySamples.size()); }
+    inline int getNumSamples() const
+    {
+        if(myUseGTMatrix)
+        {
+            return(myGTMatrix.getNumSamples());
+        }
+        if(myLazy)
+        {
+            return((int)myRawSampleInfo.size());
+        }
+        return(mySamples.size());
+    }
+
+    /// Return true if this record was read into the genotype matrix.
+    inline bool usesGTMatrix() const { return(myUseGTMatrix); }
+
+    /// Get the genotype matrix, only populated if usesGTMatrix() is true.
+    inline const VcfGenotypeMatrix& getGTMatrix() const
+    { return(myGTMatrix); }
 
 protected:
 
@@ -133,9 +228,49 @@ private:
 
     // Fields that should be stored when reading for all records.
     static std::set<std::string> ourStoreFields;
+    // Whether or not to read records into the genotype matrix.
+    static bool ourGTMatrixMode;
+    // Whether or not to parse samples when they are accessed.
+    static bool ourLazyMode;
+
+    // Get the specified sample, parsing it if it has not been, or NULL if
+    // the sample number is out of range.
+    inline VcfGenotypeSample* getSample(int sampleNum)
+    {
+        if(myLazy)
+        {
+            return(getLazySample(sampleNum));
+        }
+        if((sampleNum < 0) || (sampleNum >= mySamples.size()))
+        {
+            return(NULL);
+        }
+        return(&(mySamples.get(sampleNum)));
+    }
+    VcfGenotypeSample* getLazySample(int sampleNum);
+
+    // Location of a lazily read sample within myRawSamples (or for BCF,
+    // start is the sample's index in the record) and its index in
+    // mySamples once it is parsed (-1 until then).
+    struct RawSample
+    {
+        int start;
+        int end;
+        int parsed;
+    };
 
     VcfGenotypeFormat myFormat;
+    // Parsed samples: in sample order, or in access order if lazy.
     ReusableVector<VcfGenotypeSample> mySamples;
+
+    bool myLazy;
+    // Whether the lazy samples are typed values in myFormat.
+    bool myTyped;
+    std::string myRawSamples;
+    std::vector<RawSample> myRawSampleInfo;
+
+    bool myUseGTMatrix;
+    VcfGenotypeMatrix myGTMatrix;
 };
 
 #endif
@@ -93,7 +93,8 @@ bool VcfRecordInfo::write(IFILE filePtr)
             ++numExpected;
         }
         InfoElement& info = myInfo.get(i);
-        if(info.value.empty())
+        const std::string& value = info.getValue();
+        if(value.empty())
         {
             // No value, just a key.
             numWritten += ifprintf(filePtr, "%s", info.key.c_str());
@@ -103,8 +104,8 @@ bool VcfRecordInfo::write(IFILE filePtr)
         {
             // write the key & the value.
             numWritten += ifprintf(filePtr, "%s=%s", info.key.c_str(),
-                                  info.value.c_str());
-            numExpected += info.key.size() + info.value.size() + 1;
+                                  value.c_str());
+            numExpected += info.key.size() + value.size() + 1;
         }
     }
     return(numWritten == numExpected);
@@ -120,41 +121,46 @@ void VcfRecordInfo::reset()
 void VcfRecordInfo::setString(const char* key, const char* stringVal)
 {
     // Check if the field is already there.
-    int infoSize = myInfo.size();
-    for(int i = 0; i < infoSize; i++)
+    InfoElement* info = find(key);
+    if(info == NULL)
     {
-        InfoElement& info = myInfo.get(i);
-        if(info.key.compare(key) == 0)
-        {
-            // Set the value and return.
-            info.value = stringVal;
-            return;
-        }
+        // Not found, so add a new entry.
+        info = &(myInfo.getNextEmpty());
+        info->key = key;
     }
-
-    // Not found, so add a new entry.
-    InfoElement& newElement = myInfo.getNextEmpty();
-    newElement.key = key;
-    newElement.value = stringVal;
+    info->value = stringVal;
+    info->isTyped = false;
 }
 
 
-const std::string* VcfRecordInfo::getString(const char* key)
+void VcfRecordInfo::setTyped(const char* key, int type, int count,
+                             const uint8_t* values)
 {
     // Check if the field is already there.
-    int infoSize = myInfo.size();
-    for(int i = 0; i < infoSize; i++)
+    InfoElement* info = find(key);
+    if(info == NULL)
     {
-        InfoElement& info = myInfo.get(i);
-        if(info.key.compare(key) == 0)
-        {
-            // Found, so return the value.
-            return(&(info.value));
-        }
+        // Not found, so add a new entry.
+        info = &(myInfo.getNextEmpty());
+        info->key = key;
     }
+    int numBytes = count * BcfTypedValues::getTypeSize(type);
+    info->typedValues.assign(values, values + ((numBytes > 0) ? numBytes : 0));
+    info->typedType = type;
+    info->typedCount = count;
+    info->isTyped = true;
+}
 
-    // Not found, so return NULL..
-    return(NULL);
+
+const std::string* VcfRecordInfo::getString(const char* key)
+{
+    InfoElement* info = find(key);
+    if(info == NULL)
+    {
+        // Not found, so return NULL..
+        return(NULL);
+    }
+    return(&(info->getValue()));
 }
 
 
@@ -166,7 +172,7 @@ const std::string* VcfRecordInfo::getString(int index)
         return(NULL);
     }
 
-    return(&(myInfo.get(index).value));
+    return(&(myInfo.get(index).getValue()));
 }
 
 std::pair<std::string, std::string> VcfRecordInfo::getInfoPair(int index) const
@@ -174,8 +180,74 @@ std::pair<std::string, std::string> VcfRecordInfo::getInfoPair(int index) const
     if (index < myInfo.size())
     {
         InfoElement& e = myInfo.get(index);
-        return std::pair<std::string, std::string>(e.key, e.value);
+        return std::pair<std::string, std::string>(e.key, e.getValue());
     }
 
     return std::pair<std::string, std::string>();
-}
\ No newline at end of file
+}
+
+
+bool VcfRecordInfo::getInts(const char* key, std::vector<int32_t>& values)
+{
+    values.clear();
+    InfoElement* info = find(key);
+    if(info == NULL)
+    {
+        return(false);
+    }
+    if(info->isTyped)
+    {
+        return(BcfTypedValues::getInts(info->typedValues.data(),
+                                       info->typedType, info->typedCount,
+                                       values) &&
+               !values.empty());
+    }
+    return(BcfTypedValues::parseInts(info->value, values));
+}
+
+
+bool VcfRecordInfo::getFloats(const char* key, std::vector<float>& values)
+{
+    values.clear();
+    InfoElement* info = find(key);
+    if(info == NULL)
+    {
+        return(false);
+    }
+    if(info->isTyped)
+    {
+        return(BcfTypedValues::getFloats(info->typedValues.data(),
+                                         info->typedType, info->typedCount,
+                                         values) &&
+               !values.empty());
+    }
+    return(BcfTypedValues::parseFloats(info->value, values));
+}
+
+
+VcfRecordInfo::InfoElement* VcfRecordInfo::find(const char* key) const
+{
+    int infoSize = myInfo.size();
+    for(int i = 0; i < infoSize; i++)
+    {
+        InfoElement& info = myInfo.get(i);
+        if(info.key.compare(key) == 0)
+        {
+            return(&info);
+        }
+    }
+    return(NULL);
+}
+
+
+const std::string& VcfRecordInfo::InfoElement::getValue()
+{
+    if(isTyped)
+    {
+        value.clear();
+        BcfTypedValues::appendValues(typedValues.data(), typedType,
+                                     typedCount, value);
+        isTyped = false;
+    }
+    return(value);
+}
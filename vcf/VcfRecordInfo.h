@@ -26,6 +26,7 @@
 
 #include "VcfRecordField.h"
 #include "ReusableVector.h"
+#include "BcfTypedValues.h"
 
 /// This header file provides interface to read/write VCF files.
 class VcfRecordInfo : public VcfRecordField
@@ -54,6 +55,9 @@ public:
     /// reset the field for a new entry.
     void clear() {reset();}
 
+    /// Exchange the contents of this info field with another.
+    void swap(VcfRecordInfo& other) { myInfo.swap(other.myInfo); }
+
     int getNumInfoFields() const { return(myInfo.size()); }
 
     /// Set the string value associated with the specified key.  
@@ -63,6 +67,16 @@ public:
     /// was found, but does not have a value.
     void setString(const char* key, const char* stringVal);
 
+    /// Set the value associated with the specified key to BCF2 typed
+    /// values, which are copied and only converted to text when the value
+    /// is accessed as a string.
+    /// \param key to set the value for.
+    /// \param type BCF2 type of the values (BcfTypedValues::BcfType).
+    /// \param count number of values.
+    /// \param values the first of the typed values.
+    void setTyped(const char* key, int type, int count,
+                  const uint8_t* values);
+
     /// Get a pointer to the string containing the value associated with the
     /// specified key (the pointer will be invalid if the field is
     /// changed/reset).  
@@ -89,6 +103,22 @@ public:
     /// must be in range.
     std::pair<std::string, std::string> getInfoPair(int index) const;
 
+    /// Get the values associated with the specified key as integers, with
+    /// missing ('.') values as BcfTypedValues::INT32_MISSING.  Values read
+    /// from BCF are taken from their typed array without going through
+    /// text.
+    /// \param key to get the values for.
+    /// \param values set to the values of the key.
+    /// \return true if the key was found and its values are integers.
+    bool getInts(const char* key, std::vector<int32_t>& values);
+
+    /// Get the values associated with the specified key as floats, with
+    /// missing ('.') values as NaN.  Values read from BCF are taken from
+    /// their typed array without going through text.
+    /// \param key to get the values for.
+    /// \param values set to the values of the key.
+    /// \return true if the key was found and its values are numbers.
+    bool getFloats(const char* key, std::vector<float>& values);
 
 
 protected:
@@ -102,14 +132,26 @@ private:
     class InfoElement
     {
     public:
-        InfoElement() {key.clear(); value.clear();}
+        InfoElement() : typedType(0), typedCount(0), isTyped(false) {}
 
         std::string key;
         std::string value;
+        // BCF2 typed values, converted to value the first time it is
+        // accessed, while isTyped is set.
+        std::vector<uint8_t> typedValues;
+        int typedType;
+        int typedCount;
+        bool isTyped;
+
+        void clear() {key.clear(); value.clear(); isTyped = false;}
 
-        void clear() {key.clear(); value.clear();}
+        // Get the value, converting the typed values to text if needed.
+        const std::string& getValue();
     };
 
+    // Find the element for the specified key, NULL if it is not found.
+    InfoElement* find(const char* key) const;
+
     ReusableVector<InfoElement> myInfo;
 };
 
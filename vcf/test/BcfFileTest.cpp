@@ -0,0 +1,545 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BcfFileTest.h"
+#include "VcfFileReader.h"
+#include "VcfFileWriter.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Assert that two records read from different formats have the same
+// contents.
+static void assertSameRecord(VcfRecord& expected, VcfRecord& record)
+{
+    assert(strcmp(expected.getChromStr(), record.getChromStr()) == 0);
+    assert(expected.get1BasedPosition() == record.get1BasedPosition());
+    assert(strcmp(expected.getIDStr(), record.getIDStr()) == 0);
+    assert(strcmp(expected.getRefStr(), record.getRefStr()) == 0);
+    assert(strcmp(expected.getAltStr(), record.getAltStr()) == 0);
+    assert(strcmp(expected.getQualStr(), record.getQualStr()) == 0);
+    assert(expected.getFilter().getString() == record.getFilter().getString());
+    // Text VCF reads an empty INFO column as a "." key, BCF has no keys.
+    VcfRecordInfo& expectedInfo = expected.getInfo();
+    VcfRecordInfo& info = record.getInfo();
+    if((expectedInfo.getNumInfoFields() == 1) &&
+       (expectedInfo.getInfoPair(0).first == "."))
+    {
+        assert(info.getNumInfoFields() == 0);
+    }
+    else
+    {
+        assert(expectedInfo.getNumInfoFields() == info.getNumInfoFields());
+        for(int i = 0; i < info.getNumInfoFields(); i++)
+        {
+            assert(expectedInfo.getInfoPair(i) == info.getInfoPair(i));
+        }
+    }
+    VcfRecordGenotype& expectedGT = expected.getGenotypeInfo();
+    VcfRecordGenotype& gt = record.getGenotypeInfo();
+    assert(expected.getNumSamples() == record.getNumSamples());
+    for(int i = 0; i < record.getNumSamples(); i++)
+    {
+        assert(expected.getNumGTs(i) == record.getNumGTs(i));
+        for(int j = 0; j < record.getNumGTs(i); j++)
+        {
+            assert(expected.getGT(i, j) == record.getGT(i, j));
+        }
+        assert(expectedGT.isPhased(i) == gt.isPhased(i));
+        assert(expectedGT.isUnphased(i) == gt.isUnphased(i));
+        assert(expectedGT.hasAllGenotypeAlleles(i) ==
+               gt.hasAllGenotypeAlleles(i));
+        assert(expectedGT.getNumSampleFields(i) == gt.getNumSampleFields(i));
+        for(int j = 0; j < gt.getNumFormatFields(); j++)
+        {
+            const std::string& key = *(gt.getFormatField(j));
+            const std::string* value = expectedGT.getString(key, i);
+            const std::string* bcfValue = gt.getString(key, i);
+            assert((value == NULL) == (bcfValue == NULL));
+            assert((value == NULL) || (*value == *bcfValue));
+        }
+    }
+}
+
+
+// Read both files to the end, checking the records match.
+static void assertSameReads(VcfFileReader& vcf, VcfFileReader& bcf)
+{
+    VcfRecord expected;
+    VcfRecord record;
+    while(vcf.readRecord(expected))
+    {
+        assert(bcf.readRecord(record));
+        assertSameRecord(expected, record);
+    }
+    assert(!bcf.readRecord(record));
+    assert(vcf.getNumRecords() == bcf.getNumRecords());
+    assert(vcf.getNumKeptRecords() == bcf.getNumKeptRecords());
+}
+
+
+// Convert a vcf file to another format based on the output extension,
+// writing text uncompressed.
+static void convert(const char* inputName, const char* outputName)
+{
+    size_t nameLength = strlen(outputName);
+    InputFile::ifileCompression compression = InputFile::UNCOMPRESSED;
+    if(strcmp(outputName + nameLength - 4, ".bcf") == 0)
+    {
+        compression = InputFile::BGZF;
+    }
+    VcfFileReader reader;
+    VcfFileWriter writer;
+    VcfHeader header;
+    VcfRecord record;
+    assert(reader.open(inputName, header));
+    assert(writer.open(outputName, header, compression));
+    while(reader.readRecord(record))
+    {
+        assert(writer.writeRecord(record));
+    }
+    reader.close();
+    writer.close();
+}
+
+
+void testBcfFile()
+{
+    VcfRecordGenotype::storeAllFields();
+    testBcfRoundTrip();
+    testBcfGTMatrix();
+    testBcfReadSection();
+    testBcfWriteErrors();
+    testBcfInt8Flag();
+    testBcfTypedValues();
+}
+
+
+void testBcfRoundTrip()
+{
+    // Convert to BCF and back, the vcf is compared by the test command.
+    convert("testFiles/vcfFile.vcf", "results/vcfFile.bcf");
+    convert("results/vcfFile.bcf", "results/vcfFileFromBcf.vcf");
+    convert("testFiles/testCsi.vcf", "results/testCsi.bcf");
+
+    VcfHeader header;
+    VcfFileReader vcf;
+    VcfFileReader bcf;
+    assert(vcf.open("testFiles/vcfFile.vcf", header));
+    assert(!vcf.isBcf());
+    assert(bcf.open("results/vcfFile.bcf", header));
+    assert(bcf.isBcf());
+    assert(header.getNumSamples() == 3);
+    assert(header.getSampleName(2) == std::string("NA00003"));
+    assertSameReads(vcf, bcf);
+
+    // Subset the samples.
+    assert(vcf.open("testFiles/vcfFile.vcf", header,
+                    "testFiles/subset1.txt", NULL, NULL, ";"));
+    assert(bcf.open("results/vcfFile.bcf", header,
+                    "testFiles/subset1.txt", NULL, NULL, ";"));
+    assertSameReads(vcf, bcf);
+
+    // Discard by id and by rules.
+    assert(vcf.open("testFiles/vcfFile.vcf", header));
+    assert(bcf.open("results/vcfFile.bcf", header));
+    assert(vcf.setExcludeIDs("testFiles/excludeIDs.txt"));
+    assert(bcf.setExcludeIDs("testFiles/excludeIDs.txt"));
+    assertSameReads(vcf, bcf);
+    vcf.setDiscardRules(VcfFileReader::DISCARD_MISSING_GT |
+                        VcfFileReader::DISCARD_MULTIPLE_ALTS);
+    bcf.setDiscardRules(VcfFileReader::DISCARD_MISSING_GT |
+                        VcfFileReader::DISCARD_MULTIPLE_ALTS);
+    assert(vcf.open("testFiles/vcfFile.vcf", header));
+    assert(bcf.open("results/vcfFile.bcf", header));
+    assertSameReads(vcf, bcf);
+    vcf.setDiscardRules(0);
+    bcf.setDiscardRules(0);
+
+    // Sites only.
+    vcf.setSiteOnly(true);
+    bcf.setSiteOnly(true);
+    assert(vcf.open("testFiles/vcfFile.vcf", header));
+    assert(bcf.open("results/vcfFile.bcf", header));
+    assertSameReads(vcf, bcf);
+
+    // Parse threads are not used for BCF.
+    bcf.setNumParseThreads(2);
+    assert(vcf.open("testFiles/vcfFile.vcf", header));
+    assert(bcf.open("results/vcfFile.bcf", header));
+    assertSameReads(vcf, bcf);
+}
+
+
+void testBcfGTMatrix()
+{
+    VcfHeader header;
+    VcfFileReader vcf;
+    VcfFileReader bcf;
+    VcfRecord expected;
+    VcfRecord record;
+
+    // The typed GT values are decoded straight into the matrix.
+    VcfRecordGenotype::setGTMatrixMode(true);
+    assert(vcf.open("testFiles/vcfFile.vcf", header));
+    assert(bcf.open("results/vcfFile.bcf", header));
+    while(vcf.readRecord(expected))
+    {
+        assert(bcf.readRecord(record));
+        VcfRecordGenotype& expectedGT = expected.getGenotypeInfo();
+        VcfRecordGenotype& gt = record.getGenotypeInfo();
+        assert(expectedGT.usesGTMatrix() == gt.usesGTMatrix());
+        assert(expected.getNumSamples() == record.getNumSamples());
+        for(int i = 0; i < record.getNumSamples(); i++)
+        {
+            assert(expected.getNumGTs(i) == record.getNumGTs(i));
+            for(int j = 0; j < record.getNumGTs(i); j++)
+            {
+                assert(expected.getGT(i, j) == record.getGT(i, j));
+            }
+            assert(expectedGT.isPhased(i) == gt.isPhased(i));
+        }
+    }
+    assert(!bcf.readRecord(record));
+
+    // Subset in matrix mode.
+    assert(vcf.open("testFiles/vcfFile.vcf", header,
+                    "testFiles/subset1.txt", NULL, NULL, ";"));
+    assert(bcf.open("results/vcfFile.bcf", header,
+                    "testFiles/subset1.txt", NULL, NULL, ";"));
+    while(vcf.readRecord(expected))
+    {
+        assert(bcf.readRecord(record));
+        assert(expected.getNumSamples() == record.getNumSamples());
+        for(int i = 0; i < record.getNumSamples(); i++)
+        {
+            assert(expected.getNumGTs(i) == record.getNumGTs(i));
+            for(int j = 0; j < record.getNumGTs(i); j++)
+            {
+                assert(expected.getGT(i, j) == record.getGT(i, j));
+            }
+        }
+    }
+    assert(!bcf.readRecord(record));
+    VcfRecordGenotype::setGTMatrixMode(false);
+
+    // Lazy mode parses the decoded text on access.
+    VcfRecordGenotype::setLazyMode(true);
+    assert(vcf.open("testFiles/vcfFile.vcf", header));
+    assert(bcf.open("results/vcfFile.bcf", header));
+    assertSameReads(vcf, bcf);
+    VcfRecordGenotype::setLazyMode(false);
+}
+
+
+void testBcfReadSection()
+{
+    VcfFileReader reader;
+    VcfHeader header;
+    VcfRecord record;
+
+    assert(reader.open("testFiles/testCsi.bcf", header));
+    assert(reader.isBcf());
+    assert(reader.getCsiIndex() == NULL);
+    assert(reader.readVcfIndex());
+    assert(reader.getVcfIndex() == NULL);
+    const CsiIndex* csiPtr = reader.getCsiIndex();
+    assert(csiPtr != NULL);
+    assert(csiPtr->getNumRefs() == 2);
+    assert(csiPtr->getMinShift() == 14);
+    assert(csiPtr->getDepth() == 5);
+
+    reader.set1BasedReadSection("10", 16384, 32767);
+    assert(reader.readRecord(record) == false);
+
+    reader.set1BasedReadSection("1", 16384, 32768);
+    assert(reader.readRecord(record) == false);
+
+    reader.set1BasedReadSection("1", 16384, 32769);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32768);
+    assert(reader.readRecord(record) == false);
+
+    assert(reader.set1BasedReadSection("1", 32769, 65538));
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 65537);
+    assert(reader.readRecord(record) == false);
+
+    assert(reader.setReadSection("3"));
+    assert(reader.readRecord(record) == true);
+    assert(strcmp(record.getChromStr(), "3") == 0);
+    assert(record.get1BasedPosition() == 32768);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32780);
+    assert(reader.readRecord(record) == false);
+
+    // Overlapping deletion.
+    reader.set1BasedReadSection("3", 32770, 65537, true);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32768);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32780);
+    assert(reader.readRecord(record) == false);
+
+    reader.set1BasedReadSection("3", 32771, 65537, true);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32780);
+    assert(reader.readRecord(record) == false);
+
+    reader.set1BasedReadSection("1", 65537, 65538);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 65537);
+    assert(reader.readRecord(record) == false);
+    reader.close();
+
+    // A BCF CSI index has no names for finding a text VCF's chromosomes.
+    assert(reader.open("testFiles/testTabix.vcf.bgzf", header));
+    bool hitError = false;
+    try
+    {
+        reader.readVcfIndex("testFiles/testCsi.bcf.csi");
+    }
+    catch(std::exception& e)
+    {
+        hitError = true;
+        std::string expectedError = "FAIL_PARSE: ERROR: CSI file has no reference names: testFiles/testCsi.bcf.csi";
+        assert(expectedError == e.what());
+    }
+    assert(hitError);
+    assert(reader.getCsiIndex() == NULL);
+    reader.close();
+}
+
+
+void testBcfWriteErrors()
+{
+    VcfFileReader reader;
+    VcfFileWriter writer;
+    VcfHeader header;
+    VcfRecord record;
+
+    // testTabix.vcf has no contig line for chromosome 3, so it can't be
+    // written as BCF.
+    assert(reader.open("testFiles/testTabix.vcf", header));
+    assert(writer.open("results/testTabix.bcf", header));
+    assert(reader.readRecord(record));
+    assert(writer.writeRecord(record));
+    assert(reader.readRecord(record));
+    assert(writer.writeRecord(record));
+    assert(reader.readRecord(record));
+    bool hitError = false;
+    try
+    {
+        writer.writeRecord(record);
+    }
+    catch(std::exception& e)
+    {
+        hitError = true;
+    }
+    assert(hitError);
+    reader.close();
+    writer.close();
+}
+
+
+void testBcfInt8Flag()
+{
+    // Write DB as an Integer, so it is encoded as a 1 element INT8.
+    FILE* vcfFile = fopen("results/int8Flag.vcf", "w");
+    assert(vcfFile != NULL);
+    fputs("##fileformat=VCFv4.2\n"
+          "##contig=<ID=1,length=1000>\n"
+          "##INFO=<ID=DP,Number=1,Type=Integer,Description=\"Depth\">\n"
+          "##INFO=<ID=DB,Number=1,Type=Integer,Description=\"dbSNP\">\n"
+          "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\n"
+          "1\t100\t.\tA\tG\t.\tPASS\tDP=5;DB=1\n"
+          "1\t200\t.\tC\tT\t.\tPASS\tDP=7\n", vcfFile);
+    fclose(vcfFile);
+    convert("results/int8Flag.vcf", "results/int8Int.bcf");
+
+    // Change the header to declare DB as a Flag, which is how the spec
+    // recommends encoding a present flag.
+    IFILE bcfFile = ifopen("results/int8Int.bcf", "rb");
+    assert(bcfFile != NULL);
+    std::string contents;
+    char buffer[4096];
+    unsigned int numRead;
+    while((numRead = ifread(bcfFile, buffer, sizeof(buffer))) > 0)
+    {
+        contents.append(buffer, numRead);
+    }
+    ifclose(bcfFile);
+    const std::string intType = "ID=DB,Number=1,Type=Integer";
+    const std::string flagType = "ID=DB,Number=0,Type=Flag";
+    size_t typePos = contents.find(intType);
+    assert(typePos != std::string::npos);
+    contents.replace(typePos, intType.length(), flagType);
+    uint32_t textLength = 0;
+    memcpy(&textLength, &(contents[5]), sizeof(textLength));
+    textLength -= intType.length() - flagType.length();
+    memcpy(&(contents[5]), &textLength, sizeof(textLength));
+    bcfFile = ifopen("results/int8Flag.bcf", "wb", InputFile::BGZF);
+    assert(bcfFile != NULL);
+    assert(ifwrite(bcfFile, contents.c_str(), contents.length()) ==
+           contents.length());
+    ifclose(bcfFile);
+
+    // The flag reads back as just the key.
+    VcfFileReader reader;
+    VcfHeader header;
+    VcfRecord record;
+    assert(reader.open("results/int8Flag.bcf", header));
+    assert(reader.readRecord(record));
+    VcfRecordInfo& info = record.getInfo();
+    assert(info.getNumInfoFields() == 2);
+    assert(info.getInfoPair(0) == std::make_pair(std::string("DP"),
+                                                 std::string("5")));
+    assert(info.getInfoPair(1) == std::make_pair(std::string("DB"),
+                                                 std::string("")));
+    assert(reader.readRecord(record));
+    assert(record.getInfo().getNumInfoFields() == 1);
+    assert(!reader.readRecord(record));
+    reader.close();
+}
+
+
+// Assert that the ints/floats of a key are the same, including whether or
+// not they were found.
+static void assertSameValues(bool expectedFound,
+                             const std::vector<int32_t>& expected,
+                             bool found, const std::vector<int32_t>& values)
+{
+    assert(expectedFound == found);
+    assert(expected == values);
+}
+
+
+static void assertSameValues(bool expectedFound,
+                             const std::vector<float>& expected,
+                             bool found, const std::vector<float>& values)
+{
+    assert(expectedFound == found);
+    assert(expected.size() == values.size());
+    for(unsigned int i = 0; i < values.size(); i++)
+    {
+        assert((expected[i] == values[i]) ||
+               (isnan(expected[i]) && isnan(values[i])));
+    }
+}
+
+
+void testBcfTypedValues()
+{
+    static const char* INFO_KEYS[] = {"NS", "DP", "AF", "AA", "DB", "XX"};
+    static const char* FORMAT_KEYS[] = {"GT", "GQ", "DP", "HQ", "XX"};
+    VcfHeader header;
+    VcfFileReader vcf;
+    VcfFileReader bcf;
+    VcfRecord expected;
+    VcfRecord record;
+    std::vector<int32_t> expectedInts;
+    std::vector<int32_t> ints;
+    std::vector<float> expectedFloats;
+    std::vector<float> floats;
+
+    // The typed accessors return the same values whether they are parsed
+    // from text VCF or read from the BCF typed arrays, in both the default
+    // and lazy modes.
+    for(int lazy = 0; lazy < 2; lazy++)
+    {
+        VcfRecordGenotype::setLazyMode(lazy == 1);
+        assert(vcf.open("testFiles/vcfFile.vcf", header));
+        assert(bcf.open("results/vcfFile.bcf", header));
+        while(vcf.readRecord(expected))
+        {
+            assert(bcf.readRecord(record));
+            for(unsigned int i = 0; i < sizeof(INFO_KEYS)/sizeof(char*); i++)
+            {
+                const char* key = INFO_KEYS[i];
+                bool found = expected.getInfo().getInts(key, expectedInts);
+                assertSameValues(found, expectedInts,
+                                 record.getInfo().getInts(key, ints), ints);
+                found = expected.getInfo().getFloats(key, expectedFloats);
+                assertSameValues(found, expectedFloats,
+                                 record.getInfo().getFloats(key, floats),
+                                 floats);
+            }
+            VcfRecordGenotype& expectedGT = expected.getGenotypeInfo();
+            VcfRecordGenotype& gt = record.getGenotypeInfo();
+            for(int sample = 0; sample <= record.getNumSamples(); sample++)
+            {
+                for(unsigned int i = 0;
+                    i < sizeof(FORMAT_KEYS)/sizeof(char*); i++)
+                {
+                    const char* key = FORMAT_KEYS[i];
+                    bool found = expectedGT.getInts(key, sample, expectedInts);
+                    assertSameValues(found, expectedInts,
+                                     gt.getInts(key, sample, ints), ints);
+                    found = expectedGT.getFloats(key, sample, expectedFloats);
+                    assertSameValues(found, expectedFloats,
+                                     gt.getFloats(key, sample, floats),
+                                     floats);
+                }
+            }
+            // The strings still match after the typed accessors.
+            assertSameRecord(expected, record);
+        }
+        assert(!bcf.readRecord(record));
+    }
+    VcfRecordGenotype::setLazyMode(false);
+
+    // Check the values of the first record.
+    assert(bcf.open("results/vcfFile.bcf", header));
+    assert(bcf.readRecord(record));
+    VcfRecordInfo& info = record.getInfo();
+    assert(info.getInts("DP", ints) && (ints.size() == 1) && (ints[0] == 14));
+    assert(info.getFloats("AF", floats) && (floats.size() == 1) &&
+           (floats[0] == 0.5));
+    assert(!info.getInts("AF", ints) && ints.empty());
+    assert(!info.getInts("AA", ints));
+    assert(!info.getInts("DB", ints));
+    VcfRecordGenotype& gt = record.getGenotypeInfo();
+    assert(gt.getInts("HQ", 0, ints) && (ints.size() == 2) &&
+           (ints[0] == 51) && (ints[1] == 51));
+    assert(gt.getInts("HQ", 2, ints) && (ints.size() == 2) &&
+           (ints[0] == BcfTypedValues::INT32_MISSING) &&
+           (ints[1] == BcfTypedValues::INT32_MISSING));
+    assert(!gt.getInts("GT", 0, ints));
+    assert(gt.getFloats("GQ", 0, floats) && (floats.size() == 1) &&
+           (floats[0] == 48));
+    assert(!gt.getFloats("GT", 0, floats));
+    assert(!gt.getInts("GQ", 3, ints));
+
+    // A set value is used instead of the typed values.
+    assert(gt.setString("GQ", 1, "7"));
+    assert(gt.getInts("GQ", 1, ints) && (ints.size() == 1) && (ints[0] == 7));
+    info.setString("DP", "3");
+    assert(info.getInts("DP", ints) && (ints.size() == 1) && (ints[0] == 3));
+
+    // The last record's second sample has no GQ or DP.
+    assert(bcf.open("results/vcfFile.bcf", header));
+    for(int i = 0; i < 7; i++)
+    {
+        assert(bcf.readRecord(record));
+    }
+    assert(record.getGenotypeInfo().getNumSampleFields(1) == 1);
+    assert(record.getGenotypeInfo().getInts("GQ", 1, ints) &&
+           (ints.size() == 1) && (ints[0] == BcfTypedValues::INT32_MISSING));
+    assert(*(record.getGenotypeInfo().getString("GT", 1)) == "0|.");
+    assert(record.getGT(1, 1) == VcfGenotypeSample::MISSING_GT);
+    bcf.close();
+}
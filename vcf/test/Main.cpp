@@ -17,10 +17,26 @@
 
 #include "VcfFileTest.h"
 #include "VcfHeaderTest.h"
+#include "VcfGenotypeMatrixTest.h"
+#include "VcfRecordGenotypeTest.h"
+#include "VcfParallelParserTest.h"
+#include "BcfFileTest.h"
+#include "VcfIndexBuilderTest.h"
+#include "BgzfFileType.h"
 
 
 int main(int argc, char ** argv)
 {
+#ifdef __ZLIB_AVAILABLE__
+    // The expected output files were compressed with zlib.
+    BgzfFileType::setCodec(BGZF_CODEC_ZLIB);
+#endif
+
     testVcfHeader();
     testVcfFile();
+    testVcfGenotypeMatrix();
+    testVcfRecordGenotype();
+    testVcfParallelParser();
+    testBcfFile();
+    testVcfIndexBuilder();
 }
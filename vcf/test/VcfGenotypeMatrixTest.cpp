@@ -0,0 +1,293 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VcfGenotypeMatrixTest.h"
+#include "VcfFileReader.h"
+#include "VcfFileWriter.h"
+#include <assert.h>
+
+void testVcfGenotypeMatrix()
+{
+    // Compare against reading all fields of each sample.
+    VcfRecordGenotype::storeAllFields();
+
+    testGTMatrixLayout();
+    testGTMatrixMatchesSamples("testFiles/vcfFile.vcf", NULL);
+    testGTMatrixMatchesSamples("testFiles/vcfFile.vcf",
+                               "testFiles/subset1.txt");
+    testGTMatrixMatchesSamples("results/genotypeMatrix.vcf", NULL);
+    testGTMatrixWrite();
+}
+
+
+// Read the file normally and in GT matrix mode, checking that the GT
+// accessors return the same values.
+void testGTMatrixMatchesSamples(const char* fileName,
+                                const char* subsetFileName)
+{
+    VcfFileReader reader;
+    VcfFileReader matrixReader;
+    VcfHeader header;
+    VcfHeader matrixHeader;
+    VcfRecord record;
+    VcfRecord matrixRecord;
+
+    if(subsetFileName == NULL)
+    {
+        assert(reader.open(fileName, header));
+        assert(matrixReader.open(fileName, matrixHeader));
+    }
+    else
+    {
+        assert(reader.open(fileName, header, subsetFileName,
+                           NULL, NULL, ";"));
+        assert(matrixReader.open(fileName, matrixHeader, subsetFileName,
+                                 NULL, NULL, ";"));
+    }
+
+    while(reader.readRecord(record))
+    {
+        VcfRecordGenotype::setGTMatrixMode(true);
+        bool matrixRead = matrixReader.readRecord(matrixRecord);
+        VcfRecordGenotype::setGTMatrixMode(false);
+        assert(matrixRead);
+        assert(!record.getGenotypeInfo().usesGTMatrix());
+        assert(matrixRecord.getGenotypeInfo().usesGTMatrix());
+
+        assert(matrixRecord.get1BasedPosition() == record.get1BasedPosition());
+        assert(matrixRecord.getNumSamples() == record.getNumSamples());
+        assert(matrixRecord.allPhased() == record.allPhased());
+        assert(matrixRecord.allUnphased() == record.allUnphased());
+        assert(matrixRecord.hasAllGenotypeAlleles() ==
+               record.hasAllGenotypeAlleles());
+        VcfRecordGenotype& gt = record.getGenotypeInfo();
+        VcfRecordGenotype& matrixGT = matrixRecord.getGenotypeInfo();
+        for(int i = 0; i <= record.getNumSamples(); i++)
+        {
+            assert(matrixRecord.getNumGTs(i) == record.getNumGTs(i));
+            for(int j = 0; j <= record.getNumGTs(i); j++)
+            {
+                assert(matrixRecord.getGT(i, j) == record.getGT(i, j));
+            }
+            assert(matrixGT.isPhased(i) == gt.isPhased(i));
+            assert(matrixGT.isUnphased(i) == gt.isUnphased(i));
+            assert(matrixGT.hasAllGenotypeAlleles(i) ==
+                   gt.hasAllGenotypeAlleles(i));
+        }
+        for(unsigned int i = 0; i <= record.getNumAlts(); i++)
+        {
+            assert(matrixRecord.getAlleleCount(i) == record.getAlleleCount(i));
+        }
+        // Only GT is decoded.
+        assert(matrixGT.getString("GT", 0) == NULL);
+    }
+    VcfRecordGenotype::setGTMatrixMode(true);
+    assert(!matrixReader.readRecord(matrixRecord));
+    VcfRecordGenotype::setGTMatrixMode(false);
+}
+
+
+// Write a file whose records switch between the packed and int layouts
+// and check the arrays directly.
+void testGTMatrixLayout()
+{
+    static const int NUM_SAMPLES = 100;
+
+    IFILE filePtr = ifopen("results/genotypeMatrix.vcf", "w", 
+                           InputFile::UNCOMPRESSED);
+    assert(filePtr != NULL);
+    std::string line = "##fileformat=VCFv4.1\n#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT";
+    for(int i = 0; i < NUM_SAMPLES; i++)
+    {
+        line += "\tS" + std::to_string((long long int)i);
+    }
+    line += '\n';
+    // Biallelic, diploid: packed.
+    line += "1\t100\t.\tA\tC\t.\tPASS\t.\tGT:DP";
+    for(int i = 0; i < NUM_SAMPLES; i++)
+    {
+        line += (i % 3 == 0) ? "\t0|1:4" : ((i % 3 == 1) ? "\t1|1:2" : "\t.|0");
+    }
+    line += '\n';
+    // Allele 12 in the last sample: int layout.
+    line += "1\t200\t.\tA\tC,G,T,AA,AC,AG,AT,CA,CC,CG,CT,GA\t.\tPASS\t.\tDP:GT";
+    for(int i = 0; i < NUM_SAMPLES - 1; i++)
+    {
+        line += "\t3:0/3";
+    }
+    line += "\t3:12/1\n";
+    // Triploid and haploid samples.
+    line += "1\t300\t.\tA\tC\t.\tPASS\t.\tGT";
+    for(int i = 0; i < NUM_SAMPLES; i++)
+    {
+        line += (i == 70) ? "\t0/1/1" : ((i % 2 == 0) ? "\t1" : "\t./.");
+    }
+    line += '\n';
+    // Back to packed, with some samples missing GT.
+    line += "1\t400\t.\tA\tC\t.\tPASS\t.\tDP:GT";
+    for(int i = 0; i < NUM_SAMPLES; i++)
+    {
+        line += (i % 2 == 0) ? "\t3:0/0" : "\t3";
+    }
+    line += '\n';
+    assert(ifwrite(filePtr, line.c_str(), line.size()) == line.size());
+    ifclose(filePtr);
+
+    VcfFileReader reader;
+    VcfHeader header;
+    VcfRecord record;
+    assert(reader.open("results/genotypeMatrix.vcf", header));
+    VcfRecordGenotype::setGTMatrixMode(true);
+
+    assert(reader.readRecord(record));
+    const VcfGenotypeMatrix& matrix = record.getGenotypeInfo().getGTMatrix();
+    assert(matrix.hasGT());
+    assert(matrix.getNumSamples() == NUM_SAMPLES);
+    assert(matrix.isPacked());
+    assert(matrix.getPloidy() == VcfGenotypeMatrix::PACKED_PLOIDY);
+    assert(matrix.getAlleles() == NULL);
+    const uint64_t* packed = matrix.getPackedAlleles();
+    const uint64_t* missing = matrix.getMissing();
+    const uint64_t* phased = matrix.getPhased();
+    const uint64_t* unphased = matrix.getUnphased();
+    for(int i = 0; i < NUM_SAMPLES; i++)
+    {
+        int slot = i * 2;
+        int first = (packed[slot / 32] >> (2 * (slot % 32))) & 3;
+        int second = (packed[(slot + 1) / 32] >> (2 * ((slot + 1) % 32))) & 3;
+        bool firstMissing = (missing[slot / 64] >> (slot % 64)) & 1;
+        bool secondMissing = (missing[(slot + 1) / 64] >> ((slot + 1) % 64)) & 1;
+        assert(matrix.getNumAlleles()[i] == 2);
+        assert((phased[i / 64] >> (i % 64)) & 1);
+        assert(((unphased[i / 64] >> (i % 64)) & 1) == 0);
+        assert(!secondMissing);
+        if(i % 3 == 0)
+        {
+            assert((first == 0) && (second == 1) && !firstMissing);
+        }
+        else if(i % 3 == 1)
+        {
+            assert((first == 1) && (second == 1) && !firstMissing);
+        }
+        else
+        {
+            assert((first == 0) && (second == 0) && firstMissing);
+            assert(matrix.getGT(i, 0) == VcfGenotypeSample::MISSING_GT);
+        }
+    }
+    assert(record.allPhased());
+    assert(!record.hasAllGenotypeAlleles());
+
+    assert(reader.readRecord(record));
+    assert(!matrix.isPacked());
+    assert(matrix.getPloidy() == 2);
+    assert(matrix.getPackedAlleles() == NULL);
+    const int32_t* alleles = matrix.getAlleles();
+    for(int i = 0; i < NUM_SAMPLES - 1; i++)
+    {
+        assert((alleles[i * 2] == 0) && (alleles[i * 2 + 1] == 3));
+    }
+    assert(alleles[NUM_SAMPLES * 2 - 2] == 12);
+    assert(alleles[NUM_SAMPLES * 2 - 1] == 1);
+    assert(record.allUnphased());
+    assert(record.hasAllGenotypeAlleles());
+    assert(record.getAlleleCount(3) == NUM_SAMPLES - 1);
+    assert(record.getAlleleCount(12) == 1);
+
+    // Setting an allele that fits keeps the layout.
+    record.setGT(0, 1, 2);
+    assert(record.getGT(0, 1) == 2);
+
+    assert(reader.readRecord(record));
+    assert(!matrix.isPacked());
+    assert(matrix.getPloidy() == 3);
+    alleles = matrix.getAlleles();
+    missing = matrix.getMissing();
+    for(int i = 0; i < NUM_SAMPLES; i++)
+    {
+        int slot = i * 3;
+        if(i == 70)
+        {
+            assert(matrix.getNumAlleles()[i] == 3);
+            assert((alleles[slot] == 0) && (alleles[slot + 1] == 1) &&
+                   (alleles[slot + 2] == 1));
+        }
+        else if(i % 2 == 0)
+        {
+            assert(matrix.getNumAlleles()[i] == 1);
+            assert(alleles[slot] == 1);
+            assert(alleles[slot + 1] == VcfGenotypeSample::INVALID_GT);
+            assert(!matrix.isPhased(i) && !matrix.isUnphased(i));
+        }
+        else
+        {
+            assert(matrix.getNumAlleles()[i] == 2);
+            assert(alleles[slot] == VcfGenotypeSample::MISSING_GT);
+            assert((missing[slot / 64] >> (slot % 64)) & 1);
+            assert(alleles[slot + 2] == VcfGenotypeSample::INVALID_GT);
+        }
+    }
+    assert(!record.allUnphased());
+
+    assert(reader.readRecord(record));
+    assert(matrix.isPacked());
+    for(int i = 0; i < NUM_SAMPLES; i++)
+    {
+        if(i % 2 == 0)
+        {
+            assert(matrix.getNumAlleles()[i] == 2);
+            assert(record.getGT(i, 1) == 0);
+        }
+        else
+        {
+            // GT is past the end of the sample, so it is missing.
+            assert(matrix.getNumAlleles()[i] == 1);
+            assert(record.getGT(i, 0) == VcfGenotypeSample::MISSING_GT);
+        }
+    }
+    // Setting a large allele switches layouts.
+    record.setGT(2, 0, 7);
+    assert(!matrix.isPacked());
+    assert(record.getGT(2, 0) == 7);
+    assert(record.getGT(2, 1) == 0);
+    assert(record.getGT(3, 0) == VcfGenotypeSample::MISSING_GT);
+
+    assert(!reader.readRecord(record));
+    VcfRecordGenotype::setGTMatrixMode(false);
+}
+
+
+void testGTMatrixWrite()
+{
+    VcfFileReader reader;
+    VcfFileWriter writer;
+    VcfHeader header;
+    VcfRecord record;
+
+    assert(reader.open("testFiles/vcfFile.vcf", header));
+    assert(writer.open("results/vcfFileNoInfoGTMatrix.vcf", header,
+                       InputFile::DEFAULT));
+    VcfRecordGenotype::setGTMatrixMode(true);
+    while(reader.readRecord(record))
+    {
+        record.getInfo().clear();
+        assert(writer.writeRecord(record));
+    }
+    VcfRecordGenotype::setGTMatrixMode(false);
+    reader.close();
+    writer.close();
+}
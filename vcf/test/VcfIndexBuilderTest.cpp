@@ -0,0 +1,349 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "VcfIndexBuilderTest.h"
+#include "VcfFileReader.h"
+#include "VcfFileWriter.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Copy a vcf file, generating the index as it is written.
+static void writeIndexed(const char* inputName, const char* outputName,
+                         bool csi)
+{
+    VcfFileReader reader;
+    VcfFileWriter writer;
+    VcfHeader header;
+    VcfRecord record;
+    writer.generateIndex(true, csi);
+    assert(reader.open(inputName, header));
+    assert(writer.open(outputName, header));
+    while(reader.readRecord(record))
+    {
+        assert(writer.writeRecord(record));
+    }
+    reader.close();
+    writer.close();
+}
+
+
+// Check whether or not the specified file exists.
+static bool fileExists(const char* filename)
+{
+    FILE* filePtr = fopen(filename, "rb");
+    if(filePtr == NULL)
+    {
+        return(false);
+    }
+    fclose(filePtr);
+    return(true);
+}
+
+
+// Check the sections of testTabix.vcf/testCsi.vcf, the records are at
+// 1:32768, 1:65537, 3:32768 (3 bases), and 3:32780.
+static void checkSections(VcfFileReader& reader)
+{
+    VcfRecord record;
+
+    reader.set1BasedReadSection("10", 16384, 32767);
+    assert(reader.readRecord(record) == false);
+
+    reader.set1BasedReadSection("1", 16384, 32768);
+    assert(reader.readRecord(record) == false);
+
+    reader.set1BasedReadSection("1", 16384, 32769);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32768);
+    assert(reader.readRecord(record) == false);
+
+    assert(reader.set1BasedReadSection("1", 32769, 65538));
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 65537);
+    assert(reader.readRecord(record) == false);
+
+    assert(reader.setReadSection("3"));
+    assert(reader.readRecord(record) == true);
+    assert(strcmp(record.getChromStr(), "3") == 0);
+    assert(record.get1BasedPosition() == 32768);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32780);
+    assert(reader.readRecord(record) == false);
+
+    reader.set1BasedReadSection("3", 32770, 65537, true);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32768);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32780);
+    assert(reader.readRecord(record) == false);
+
+    reader.set1BasedReadSection("3", 32771, 65537, true);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32780);
+    assert(reader.readRecord(record) == false);
+
+    reader.set1BasedReadSection("1", 0, 65538);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 32768);
+    assert(reader.readRecord(record) == true);
+    assert(record.get1BasedPosition() == 65537);
+    assert(reader.readRecord(record) == false);
+}
+
+
+void testVcfIndexBuilder()
+{
+    VcfRecordGenotype::storeAllFields();
+    testIndexOnWriteTabix();
+    testIndexOnWriteCsi();
+    testIndexOnWriteGenerated();
+    testIndexOnWriteUnsorted();
+}
+
+
+void testIndexOnWriteTabix()
+{
+    remove("results/indexOnWrite.vcf.gz.tbi");
+    writeIndexed("testFiles/testTabix.vcf", "results/indexOnWrite.vcf.gz",
+                 false);
+    assert(fileExists("results/indexOnWrite.vcf.gz.tbi"));
+    assert(!fileExists("results/indexOnWrite.vcf.gz.csi"));
+
+    VcfFileReader reader;
+    VcfHeader header;
+    assert(reader.open("results/indexOnWrite.vcf.gz", header));
+    assert(reader.readVcfIndex());
+    const Tabix* tabixPtr = reader.getVcfIndex();
+    assert(tabixPtr != NULL);
+    assert(tabixPtr->getFormat() == Tabix::FORMAT_VCF);
+    assert(tabixPtr->getNumRefs() == 2);
+    assert(strcmp(tabixPtr->getRefName(0), "1") == 0);
+    assert(strcmp(tabixPtr->getRefName(1), "3") == 0);
+    checkSections(reader);
+    reader.close();
+
+    // Uncompressed files are not indexed.
+    VcfFileWriter writer;
+    VcfRecord record;
+    remove("results/indexOnWrite.vcf.tbi");
+    writer.generateIndex(true);
+    assert(reader.open("testFiles/testTabix.vcf", header));
+    assert(writer.open("results/indexOnWrite.vcf", header,
+                       InputFile::UNCOMPRESSED));
+    while(reader.readRecord(record))
+    {
+        assert(writer.writeRecord(record));
+    }
+    writer.close();
+    assert(!fileExists("results/indexOnWrite.vcf.tbi"));
+}
+
+
+void testIndexOnWriteCsi()
+{
+    VcfFileReader reader;
+    VcfHeader header;
+
+    // Text VCF CSI has the chromosome names.
+    writeIndexed("testFiles/testTabix.vcf", "results/indexOnWriteCsi.vcf.gz",
+                 true);
+    assert(!fileExists("results/indexOnWriteCsi.vcf.gz.tbi"));
+    assert(reader.open("results/indexOnWriteCsi.vcf.gz", header));
+    assert(reader.readVcfIndex("results/indexOnWriteCsi.vcf.gz.csi"));
+    const CsiIndex* csiPtr = reader.getCsiIndex();
+    assert(csiPtr != NULL);
+    assert(reader.getVcfIndex() == NULL);
+    assert(csiPtr->hasRefNames());
+    assert(csiPtr->getNumRefs() == 2);
+    assert(strcmp(csiPtr->getRefName(1), "3") == 0);
+    assert(csiPtr->getMinShift() == 14);
+    assert(csiPtr->getDepth() == 5);
+    checkSections(reader);
+    reader.close();
+
+    // BCF is always indexed by CSI, numbered by contig.
+    writeIndexed("testFiles/testCsi.vcf", "results/indexOnWrite.bcf", false);
+    assert(reader.open("results/indexOnWrite.bcf", header));
+    assert(reader.isBcf());
+    assert(reader.readVcfIndex());
+    csiPtr = reader.getCsiIndex();
+    assert(csiPtr != NULL);
+    assert(!csiPtr->hasRefNames());
+    assert(csiPtr->getNumRefs() == 2);
+    checkSections(reader);
+    reader.close();
+}
+
+
+void testIndexOnWriteGenerated()
+{
+    // Write enough records for many BGZF blocks, with a contig longer than
+    // tabix supports.
+    static const int NUM_CHROMS = 3;
+    static const char* CHROMS[NUM_CHROMS] = {"1", "2", "10"};
+    static const int NUM_RECORDS = 12000;
+    IFILE filePtr = ifopen("results/indexOnWriteGenerated.vcf", "w",
+                           InputFile::UNCOMPRESSED);
+    assert(filePtr != NULL);
+    ifprintf(filePtr, "##fileformat=VCFv4.1\n");
+    ifprintf(filePtr, "##contig=<ID=1,length=1000000>\n");
+    ifprintf(filePtr, "##contig=<ID=2,length=1000000>\n");
+    ifprintf(filePtr, "##contig=<ID=10,length=1000000000>\n");
+    ifprintf(filePtr, "##INFO=<ID=DP,Number=1,Type=Integer,Description=\"Depth\">\n");
+    ifprintf(filePtr, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n");
+    ifprintf(filePtr, "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tS1\tS2\n");
+    std::vector<std::string> chroms;
+    std::vector<int> starts;
+    std::vector<int> ends;
+    static const char* REFS[] = {"A", "CAGT", "G",
+                                 "TTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTT"};
+    for(int i = 0; i < NUM_RECORDS; i++)
+    {
+        int chrom = i * NUM_CHROMS / NUM_RECORDS;
+        int step = (chrom == 2) ? 100000 : 250;
+        int pos = 1 + (i % (NUM_RECORDS / NUM_CHROMS)) * step + (i % 7);
+        const char* ref = REFS[i % 4];
+        ifprintf(filePtr, "%s\t%d\tid%d\t%s\tC\t%d\tPASS\tDP=%d\tGT\t0|1\t1/1\n",
+                 CHROMS[chrom], pos, i, ref, i % 50, i);
+        chroms.push_back(CHROMS[chrom]);
+        starts.push_back(pos);
+        ends.push_back(pos + strlen(ref) - 1);
+    }
+    ifclose(filePtr);
+
+    writeIndexed("results/indexOnWriteGenerated.vcf",
+                 "results/indexOnWriteGenerated.vcf.gz", false);
+    writeIndexed("results/indexOnWriteGenerated.vcf",
+                 "results/indexOnWriteGenerated.bcf", false);
+
+    const char* files[2] = {"results/indexOnWriteGenerated.vcf.gz",
+                            "results/indexOnWriteGenerated.bcf"};
+    for(int fileIndex = 0; fileIndex < 2; fileIndex++)
+    {
+        VcfFileReader reader;
+        VcfHeader header;
+        VcfRecord record;
+        assert(reader.open(files[fileIndex], header));
+        // The long contig means CSI for the text VCF too.
+        if(fileIndex == 0)
+        {
+            assert(reader.readVcfIndex("results/indexOnWriteGenerated.vcf.gz.csi"));
+        }
+        else
+        {
+            assert(reader.readVcfIndex());
+        }
+        assert(reader.getCsiIndex() != NULL);
+        assert(reader.getCsiIndex()->getDepth() == 6);
+
+        // Check sections against the records that were written.
+        for(int i = 0; i < 60; i++)
+        {
+            int chrom = i % NUM_CHROMS;
+            int maxPos = (chrom == 2) ? 400000000 : 1000000;
+            int start = 1 + (int)(((int64_t)i * 7919 * 104729) % maxPos);
+            int end = start + ((i % 3 == 0) ? 20 : maxPos / 50);
+            bool overlap = (i % 2 == 0);
+            reader.set1BasedReadSection(CHROMS[chrom], start, end, overlap);
+            for(unsigned int j = 0; j < starts.size(); j++)
+            {
+                if((chroms[j] != CHROMS[chrom]) || (starts[j] >= end) ||
+                   ((overlap ? ends[j] : starts[j]) < start))
+                {
+                    continue;
+                }
+                assert(reader.readRecord(record));
+                assert(strcmp(record.getChromStr(), CHROMS[chrom]) == 0);
+                assert(record.get1BasedPosition() == starts[j]);
+            }
+            assert(!reader.readRecord(record));
+        }
+    }
+}
+
+
+void testIndexOnWriteUnsorted()
+{
+    VcfFileReader reader;
+    VcfFileWriter writer;
+    VcfHeader header;
+    VcfRecord record1;
+    VcfRecord record2;
+
+    remove("results/indexOnWriteUnsorted.vcf.gz.tbi");
+    writer.generateIndex(true);
+    assert(reader.open("testFiles/testTabix.vcf", header));
+    assert(writer.open("results/indexOnWriteUnsorted.vcf.gz", header));
+    assert(reader.readRecord(record1));
+    assert(reader.readRecord(record2));
+    assert(writer.writeRecord(record2));
+    assert(writer.writeRecord(record1));
+    bool hitError = false;
+    try
+    {
+        writer.close();
+    }
+    catch(std::exception& e)
+    {
+        hitError = true;
+        assert(strcmp(e.what(), "FAIL_ORDER: Failed to write the vcf index file results/indexOnWriteUnsorted.vcf.gz.tbi: records are not sorted by coordinate") == 0);
+    }
+    assert(hitError);
+    assert(!fileExists("results/indexOnWriteUnsorted.vcf.gz.tbi"));
+
+    // A chromosome that comes back after another is also out of order.
+    assert(reader.open("testFiles/testTabix.vcf", header));
+    assert(writer.open("results/indexOnWriteUnsorted.vcf.gz", header));
+    assert(reader.readRecord(record1));
+    assert(writer.writeRecord(record1));
+    assert(reader.readRecord(record2));
+    assert(reader.readRecord(record2));
+    assert(writer.writeRecord(record2));
+    assert(writer.writeRecord(record1));
+    hitError = false;
+    try
+    {
+        writer.close();
+    }
+    catch(std::exception& e)
+    {
+        hitError = true;
+    }
+    assert(hitError);
+    assert(!fileExists("results/indexOnWriteUnsorted.vcf.gz.tbi"));
+
+    // A position past the end Tabix supports is not an ordering failure.
+    assert(reader.open("testFiles/testTabix.vcf", header));
+    assert(writer.open("results/indexOnWriteUnsorted.vcf.gz", header));
+    assert(reader.readRecord(record1));
+    assert(writer.writeRecord(record1));
+    record1.set1BasedPosition(600000000);
+    assert(writer.writeRecord(record1));
+    hitError = false;
+    try
+    {
+        writer.close();
+    }
+    catch(std::exception& e)
+    {
+        hitError = true;
+        assert(strcmp(e.what(), "FAIL_PARSE: Failed to write the vcf index file results/indexOnWriteUnsorted.vcf.gz.tbi: record position is past the end supported by the index") == 0);
+    }
+    assert(hitError);
+    assert(!fileExists("results/indexOnWriteUnsorted.vcf.gz.tbi"));
+}
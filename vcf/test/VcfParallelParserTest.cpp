@@ -0,0 +1,305 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "VcfParallelParserTest.h"
+#include "VcfFileReader.h"
+#include <assert.h>
+#include <string.h>
+
+static const int NUM_PARSE_THREADS = 3;
+
+// Assert that two records have the same contents.
+static void assertSameRecord(VcfRecord& expected, VcfRecord& record)
+{
+    assert(strcmp(expected.getChromStr(), record.getChromStr()) == 0);
+    assert(expected.get1BasedPosition() == record.get1BasedPosition());
+    assert(strcmp(expected.getIDStr(), record.getIDStr()) == 0);
+    assert(strcmp(expected.getRefStr(), record.getRefStr()) == 0);
+    assert(strcmp(expected.getAltStr(), record.getAltStr()) == 0);
+    assert(strcmp(expected.getQualStr(), record.getQualStr()) == 0);
+    assert(expected.getFilter().getString() == record.getFilter().getString());
+    VcfRecordInfo& info = record.getInfo();
+    assert(expected.getInfo().getNumInfoFields() == info.getNumInfoFields());
+    for(int i = 0; i < info.getNumInfoFields(); i++)
+    {
+        assert(expected.getInfo().getInfoPair(i) == info.getInfoPair(i));
+    }
+    VcfRecordGenotype& expectedGT = expected.getGenotypeInfo();
+    VcfRecordGenotype& gt = record.getGenotypeInfo();
+    assert(expected.getNumSamples() == record.getNumSamples());
+    for(int i = 0; i < record.getNumSamples(); i++)
+    {
+        assert(expected.getNumGTs(i) == record.getNumGTs(i));
+        for(int j = 0; j < record.getNumGTs(i); j++)
+        {
+            assert(expected.getGT(i, j) == record.getGT(i, j));
+        }
+        assert(expectedGT.isPhased(i) == gt.isPhased(i));
+        const std::string* value = expectedGT.getString("DP", i);
+        const std::string* parallelValue = gt.getString("DP", i);
+        assert((value == NULL) == (parallelValue == NULL));
+        assert((value == NULL) || (*value == *parallelValue));
+    }
+}
+
+
+// Read both files to the end, checking the records and counts match.
+static void assertSameReads(VcfFileReader& serial, VcfFileReader& parallel)
+{
+    VcfRecord expected;
+    VcfRecord record;
+    while(true)
+    {
+        bool serialRead = serial.readRecord(expected);
+        bool parallelRead = parallel.readRecord(record);
+        assert(serialRead == parallelRead);
+        assert(serial.getNumRecords() == parallel.getNumRecords());
+        assert(serial.getTotalReadRecords() == parallel.getTotalReadRecords());
+        assert(serial.getNumKeptRecords() == parallel.getNumKeptRecords());
+        if(serialRead)
+        {
+            assertSameRecord(expected, record);
+        }
+        else if(serial.isEOF())
+        {
+            break;
+        }
+    }
+    assert(parallel.isEOF());
+    assert(!parallel.readRecord(record));
+}
+
+
+// Write a file with enough records for many batches, with a blank line and
+// a run of records to exclude by id that spans batches.
+static void writeGeneratedFile(const char* filename, int numRecords,
+                               int badRecord)
+{
+    IFILE filePtr = ifopen(filename, "w", InputFile::UNCOMPRESSED);
+    assert(filePtr != NULL);
+    ifprintf(filePtr, "##fileformat=VCFv4.1\n#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tS1\tS2\tS3\n");
+    static const char* GTS[] = {"0|0", "0|1", "1/1", "./.", "2|1", "0/2"};
+    for(int i = 0; i < numRecords; i++)
+    {
+        if(i == 1500)
+        {
+            ifprintf(filePtr, "\n");
+        }
+        ifprintf(filePtr, "%d\t%d\tid%d\tA\t%s\t%d\t%s\tDP=%d\tGT:DP",
+                 1 + i / 2000, 100 + i, i, (i % 5 == 0) ? "C,G" : "C",
+                 i % 50, (i % 3 == 0) ? "q10" : "PASS", i);
+        for(int j = 0; j < 3; j++)
+        {
+            ifprintf(filePtr, "\t%s:%d", GTS[(i + j * 2) % 6], i + j);
+        }
+        if(i == badRecord)
+        {
+            // Too many fields for the format.
+            ifprintf(filePtr, ":1");
+        }
+        ifprintf(filePtr, "\n");
+    }
+    ifclose(filePtr);
+}
+
+
+void testVcfParallelParser()
+{
+    VcfRecordGenotype::storeAllFields();
+    testParallelMatchesSerial();
+    testParallelGenerated();
+    testParallelSections();
+    testParallelParseError();
+}
+
+
+void testParallelMatchesSerial()
+{
+    VcfHeader header;
+    VcfFileReader serial;
+    VcfFileReader parallel;
+    parallel.setNumParseThreads(NUM_PARSE_THREADS);
+
+    assert(serial.open("testFiles/vcfFile.vcf", header));
+    assert(parallel.open("testFiles/vcfFile.vcf", header));
+    assertSameReads(serial, parallel);
+
+    // Discard by id.
+    assert(serial.open("testFiles/vcfFile.vcf", header));
+    assert(parallel.open("testFiles/vcfFile.vcf", header));
+    assert(serial.setExcludeIDs("testFiles/excludeIDs.txt"));
+    assert(parallel.setExcludeIDs("testFiles/excludeIDs.txt"));
+    assertSameReads(serial, parallel);
+    assert(serial.open("testFiles/vcfFile.vcf", header));
+    assert(parallel.open("testFiles/vcfFile.vcf", header));
+    assert(serial.setIncludeIDs("testFiles/includeIDs.txt"));
+    assert(parallel.setIncludeIDs("testFiles/includeIDs.txt"));
+    assertSameReads(serial, parallel);
+
+    // Subset the samples.
+    assert(serial.open("testFiles/vcfFile.vcf", header,
+                       "testFiles/subset1.txt", NULL, NULL, ";"));
+    assert(parallel.open("testFiles/vcfFile.vcf", header,
+                         "testFiles/subset1.txt", NULL, NULL, ";"));
+    assertSameReads(serial, parallel);
+
+    // Discard rules.
+    serial.setDiscardRules(VcfFileReader::DISCARD_MISSING_GT |
+                           VcfFileReader::DISCARD_MULTIPLE_ALTS);
+    parallel.setDiscardRules(VcfFileReader::DISCARD_MISSING_GT |
+                             VcfFileReader::DISCARD_MULTIPLE_ALTS);
+    assert(serial.open("testFiles/vcfFile.vcf", header));
+    assert(parallel.open("testFiles/vcfFile.vcf", header));
+    assertSameReads(serial, parallel);
+
+    // Sites only.
+    serial.setDiscardRules(0);
+    parallel.setDiscardRules(0);
+    serial.setSiteOnly(true);
+    parallel.setSiteOnly(true);
+    assert(serial.open("testFiles/vcfFile.vcf", header));
+    assert(parallel.open("testFiles/vcfFile.vcf", header));
+    assertSameReads(serial, parallel);
+}
+
+
+void testParallelGenerated()
+{
+    static const int NUM_RECORDS = 5000;
+    writeGeneratedFile("results/parallelParse.vcf", NUM_RECORDS, -1);
+
+    // Exclude every 7th record, a run spanning batches, and the last
+    // records of the file.
+    IFILE idFile = ifopen("results/parallelParseIDs.txt", "w",
+                          InputFile::UNCOMPRESSED);
+    assert(idFile != NULL);
+    for(int i = 0; i < NUM_RECORDS; i++)
+    {
+        if((i % 7 == 3) || ((i >= 2500) && (i < 3700)) ||
+           (i >= NUM_RECORDS - 10))
+        {
+            ifprintf(idFile, "id%d\n", i);
+        }
+    }
+    ifclose(idFile);
+    IFILE subsetFile = ifopen("results/parallelParseSubset.txt", "w",
+                              InputFile::UNCOMPRESSED);
+    assert(subsetFile != NULL);
+    ifprintf(subsetFile, "S1\nS3\n");
+    ifclose(subsetFile);
+
+    VcfHeader header;
+    VcfFileReader serial;
+    VcfFileReader parallel;
+    parallel.setNumParseThreads(NUM_PARSE_THREADS);
+
+    assert(serial.open("results/parallelParse.vcf", header));
+    assert(parallel.open("results/parallelParse.vcf", header));
+    assertSameReads(serial, parallel);
+    assert(serial.getNumKeptRecords() == NUM_RECORDS);
+
+    assert(serial.open("results/parallelParse.vcf", header,
+                       "results/parallelParseSubset.txt", NULL, NULL));
+    assert(parallel.open("results/parallelParse.vcf", header,
+                         "results/parallelParseSubset.txt", NULL, NULL));
+    assert(serial.setExcludeIDs("results/parallelParseIDs.txt"));
+    assert(parallel.setExcludeIDs("results/parallelParseIDs.txt"));
+    serial.setDiscardRules(VcfFileReader::DISCARD_FILTERED);
+    parallel.setDiscardRules(VcfFileReader::DISCARD_FILTERED);
+    serial.addDiscardMinAltAlleleCount(2, NULL);
+    parallel.addDiscardMinAltAlleleCount(2, NULL);
+    assertSameReads(serial, parallel);
+}
+
+
+void testParallelSections()
+{
+    VcfHeader header;
+    VcfFileReader serial;
+    VcfFileReader parallel;
+    VcfRecord expected;
+    VcfRecord record;
+    parallel.setNumParseThreads(NUM_PARSE_THREADS);
+
+    assert(serial.open("testFiles/testTabix.vcf.bgzf", header));
+    assert(parallel.open("testFiles/testTabix.vcf.bgzf", header));
+    assert(serial.readVcfIndex());
+    assert(parallel.readVcfIndex());
+
+    static const char* CHROMS[] = {"1", "3", "1", "1", "3"};
+    static const int STARTS[] = {0, 32768, 32769, 16384, 0};
+    static const int ENDS[] = {65538, 32781, 65538, 32769, -1};
+    for(int i = 0; i < 5; i++)
+    {
+        serial.set1BasedReadSection(CHROMS[i], STARTS[i], ENDS[i]);
+        parallel.set1BasedReadSection(CHROMS[i], STARTS[i], ENDS[i]);
+        bool serialRead = true;
+        // Only read part of the first section before changing sections.
+        for(int j = 0; serialRead && ((i != 0) || (j < 1)); j++)
+        {
+            serialRead = serial.readRecord(expected);
+            assert(parallel.readRecord(record) == serialRead);
+            if(serialRead)
+            {
+                assertSameRecord(expected, record);
+            }
+        }
+    }
+}
+
+
+// A record that fails to parse throws after the same records.
+void testParallelParseError()
+{
+    static const int NUM_RECORDS = 3000;
+    writeGeneratedFile("results/parallelParseError.vcf", NUM_RECORDS, 2200);
+
+    VcfHeader header;
+    VcfFileReader serial;
+    VcfFileReader parallel;
+    VcfRecord expected;
+    VcfRecord record;
+    parallel.setNumParseThreads(NUM_PARSE_THREADS);
+    assert(serial.open("results/parallelParseError.vcf", header));
+    assert(parallel.open("results/parallelParseError.vcf", header));
+
+    int numRead = 0;
+    bool serialFailed = false;
+    bool parallelFailed = false;
+    while(!serialFailed)
+    {
+        try
+        {
+            serial.readRecord(expected);
+        }
+        catch(std::exception& e)
+        {
+            serialFailed = true;
+        }
+        try
+        {
+            parallel.readRecord(record);
+        }
+        catch(std::exception& e)
+        {
+            parallelFailed = true;
+        }
+        assert(serialFailed == parallelFailed);
+        ++numRead;
+    }
+    // The blank line is returned as a failed read.
+    assert(numRead == 2200 + 2);
+}
@@ -0,0 +1,178 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VcfRecordGenotypeTest.h"
+#include "VcfFileReader.h"
+#include "VcfFileWriter.h"
+#include <assert.h>
+
+void testVcfRecordGenotype()
+{
+    VcfRecordGenotype::storeAllFields();
+    testLazyMatchesSamples(NULL);
+    testLazyMatchesSamples("testFiles/subset1.txt");
+    testLazyWrite();
+    testLazyParseError();
+}
+
+
+// Read the file normally and lazily, checking that the samples match.
+void testLazyMatchesSamples(const char* subsetFileName)
+{
+    static const char* KEYS[] = {"GT", "GQ", "DP", "HQ", "XX"};
+    static const int NUM_KEYS = 5;
+
+    VcfFileReader reader;
+    VcfFileReader lazyReader;
+    VcfHeader header;
+    VcfHeader lazyHeader;
+    VcfRecord record;
+    VcfRecord lazyRecord;
+
+    if(subsetFileName == NULL)
+    {
+        assert(reader.open("testFiles/vcfFile.vcf", header));
+        assert(lazyReader.open("testFiles/vcfFile.vcf", lazyHeader));
+    }
+    else
+    {
+        assert(reader.open("testFiles/vcfFile.vcf", header, subsetFileName,
+                           NULL, NULL, ";"));
+        assert(lazyReader.open("testFiles/vcfFile.vcf", lazyHeader,
+                               subsetFileName, NULL, NULL, ";"));
+    }
+
+    while(reader.readRecord(record))
+    {
+        VcfRecordGenotype::setLazyMode(true);
+        bool lazyRead = lazyReader.readRecord(lazyRecord);
+        VcfRecordGenotype::setLazyMode(false);
+        assert(lazyRead);
+
+        VcfRecordGenotype& gt = record.getGenotypeInfo();
+        VcfRecordGenotype& lazyGT = lazyRecord.getGenotypeInfo();
+        assert(lazyRecord.getNumSamples() == record.getNumSamples());
+
+        // Access the samples in reverse order, so they are not parsed
+        // in sample order.
+        for(int i = record.getNumSamples(); i >= 0; i--)
+        {
+            for(int j = 0; j < NUM_KEYS; j++)
+            {
+                const std::string* value = gt.getString(KEYS[j], i);
+                const std::string* lazyValue = lazyGT.getString(KEYS[j], i);
+                assert((value == NULL) == (lazyValue == NULL));
+                assert((value == NULL) || (*value == *lazyValue));
+            }
+            assert(lazyRecord.getNumGTs(i) == record.getNumGTs(i));
+            for(int j = 0; j <= record.getNumGTs(i); j++)
+            {
+                assert(lazyRecord.getGT(i, j) == record.getGT(i, j));
+            }
+            assert(lazyGT.isPhased(i) == gt.isPhased(i));
+            assert(lazyGT.isUnphased(i) == gt.isUnphased(i));
+            assert(lazyGT.hasAllGenotypeAlleles(i) ==
+                   gt.hasAllGenotypeAlleles(i));
+        }
+        assert(lazyRecord.allPhased() == record.allPhased());
+        assert(lazyRecord.allUnphased() == record.allUnphased());
+        assert(lazyRecord.hasAllGenotypeAlleles() ==
+               record.hasAllGenotypeAlleles());
+    }
+    VcfRecordGenotype::setLazyMode(true);
+    assert(!lazyReader.readRecord(lazyRecord));
+    VcfRecordGenotype::setLazyMode(false);
+}
+
+
+void testLazyWrite()
+{
+    VcfFileReader reader;
+    VcfFileWriter writer;
+    VcfHeader header;
+    VcfRecord record;
+
+    VcfRecordGenotype::setLazyMode(true);
+
+    // Unparsed samples are written as they were read.
+    assert(reader.open("testFiles/vcfFile.vcf", header));
+    assert(writer.open("results/vcfFileNoInfoLazy.vcf", header,
+                       InputFile::DEFAULT));
+    int recordNum = 0;
+    while(reader.readRecord(record))
+    {
+        record.getInfo().clear();
+        if(recordNum++ == 1)
+        {
+            // Parse one sample of the second record.
+            assert(record.getGT(1, 1) == 1);
+        }
+        assert(writer.writeRecord(record));
+    }
+
+    // Samples are parsed to write just the stored fields.
+    assert(reader.open("testFiles/vcfFile.vcf", header));
+    VcfRecordGenotype::addStoreField("GT");
+    assert(writer.open("results/vcfFileNoInfoKeepGTLazy.vcf", header,
+                       InputFile::DEFAULT));
+    while(reader.readRecord(record))
+    {
+        record.getInfo().clear();
+        assert(writer.writeRecord(record));
+    }
+    VcfRecordGenotype::storeAllFields();
+
+    VcfRecordGenotype::setLazyMode(false);
+    reader.close();
+    writer.close();
+}
+
+
+// A sample with too many fields only fails when it is accessed.
+void testLazyParseError()
+{
+    IFILE filePtr = ifopen("results/lazyGenotype.vcf", "w", 
+                           InputFile::UNCOMPRESSED);
+    assert(filePtr != NULL);
+    std::string lines = "##fileformat=VCFv4.1\n#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tS1\tS2\tS3\n";
+    lines += "1\t100\t.\tA\tC\t.\tPASS\t.\tGT:DP\t0|1:3\t1|1:4:5\t0/0\n";
+    assert(ifwrite(filePtr, lines.c_str(), lines.size()) == lines.size());
+    ifclose(filePtr);
+
+    VcfFileReader reader;
+    VcfHeader header;
+    VcfRecord record;
+    assert(reader.open("results/lazyGenotype.vcf", header));
+    VcfRecordGenotype::setLazyMode(true);
+    assert(reader.readRecord(record));
+    VcfRecordGenotype::setLazyMode(false);
+
+    assert(record.getNumSamples() == 3);
+    assert(record.getGT(0, 1) == 1);
+    assert(record.getGT(2, 0) == 0);
+    assert(*(record.getGenotypeInfo().getString("DP", 2)) == ".");
+    bool caughtException = false;
+    try
+    {
+        record.getGT(1, 0);
+    }
+    catch(std::exception& e)
+    {
+        caughtException = true;
+    }
+    assert(caughtException);
+}
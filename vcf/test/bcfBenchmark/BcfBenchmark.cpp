@@ -0,0 +1,202 @@
+/*
+ *  Copyright (C) 2026  Regents of the University of Michigan
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compare the speed of reading the same records from bgzipped text VCF and
+// from BCF, in thousands of records per second, for each way of reading the
+// genotypes.  The records are simulated: biallelic SNPs with INFO DP/AF/DB
+// and GT:GQ:DP:AD for every sample.  Only the reads are timed.
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "VcfFileReader.h"
+#include "VcfFileWriter.h"
+
+static const char* VCF_FILE = "results/bcfBenchmark.vcf.gz";
+static const char* BCF_FILE = "results/bcfBenchmark.bcf";
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start)
+{
+    return(std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start).count());
+}
+
+
+// Write numRecords simulated records with numSamples samples as bgzipped
+// VCF, then convert it to BCF.
+static void writeFiles(int numRecords, int numSamples)
+{
+    IFILE vcfFile = ifopen(VCF_FILE, "w", InputFile::BGZF);
+    if(vcfFile == NULL)
+    {
+        std::cerr << "Failed to open " << VCF_FILE << std::endl;
+        exit(1);
+    }
+    ifprintf(vcfFile, "##fileformat=VCFv4.2\n"
+             "##contig=<ID=1,length=250000000>\n"
+             "##INFO=<ID=DP,Number=1,Type=Integer,Description=\"Depth\">\n"
+             "##INFO=<ID=AF,Number=A,Type=Float,Description=\"Frequency\">\n"
+             "##INFO=<ID=DB,Number=0,Type=Flag,Description=\"dbSNP\">\n"
+             "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n"
+             "##FORMAT=<ID=GQ,Number=1,Type=Integer,Description=\"Quality\">\n"
+             "##FORMAT=<ID=DP,Number=1,Type=Integer,Description=\"Depth\">\n"
+             "##FORMAT=<ID=AD,Number=R,Type=Integer,Description=\"Allele depths\">\n"
+             "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT");
+    for(int i = 0; i < numSamples; i++)
+    {
+        ifprintf(vcfFile, "\tS%d", i);
+    }
+    ifprintf(vcfFile, "\n");
+
+    const char bases[] = "ACGT";
+    const char* genotypes[] = {"0/0", "0/0", "0/0", "0/1", "0/1", "1/1",
+                               "0|1", "./."};
+    srand(1);
+    std::string line;
+    char field[64];
+    int pos = 0;
+    for(int i = 0; i < numRecords; i++)
+    {
+        pos += 1 + rand() % 200;
+        int ref = rand() & 3;
+        int depth = 0;
+        line.clear();
+        for(int j = 0; j < numSamples; j++)
+        {
+            const char* gt = genotypes[rand() % 8];
+            int dp = rand() % 60;
+            int alt = (gt[2] == '1') ? dp / ((gt[0] == '1') ? 1 : 2) : 0;
+            depth += dp;
+            snprintf(field, sizeof(field), "\t%s:%d:%d:%d,%d", gt,
+                     rand() % 100, dp, dp - alt, alt);
+            line += field;
+        }
+        ifprintf(vcfFile, "1\t%d\t.\t%c\t%c\t%d\tPASS\tDP=%d;AF=%.3f%s\t"
+                 "GT:GQ:DP:AD%s\n", pos, bases[ref], bases[(ref + 1) & 3],
+                 rand() % 1000, depth, (rand() % 1000) / 1000.0,
+                 (rand() % 4) ? "" : ";DB", line.c_str());
+    }
+    ifclose(vcfFile);
+
+    VcfFileReader reader;
+    VcfFileWriter writer;
+    VcfHeader header;
+    VcfRecord record;
+    VcfRecordGenotype::storeAllFields();
+    if(!reader.open(VCF_FILE, header) ||
+       !writer.open(BCF_FILE, header, InputFile::BGZF))
+    {
+        std::cerr << "Failed to convert " << VCF_FILE << " to BCF\n";
+        exit(1);
+    }
+    while(reader.readRecord(record))
+    {
+        writer.writeRecord(record);
+    }
+    reader.close();
+    writer.close();
+}
+
+
+// Read the file to the end, returning the seconds it took.
+static double readFile(const char* fileName, bool siteOnly)
+{
+    VcfFileReader reader;
+    VcfHeader header;
+    VcfRecord record;
+    reader.setSiteOnly(siteOnly);
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    if(!reader.open(fileName, header))
+    {
+        std::cerr << "Failed to open " << fileName << std::endl;
+        exit(1);
+    }
+    while(reader.readRecord(record))
+    {
+    }
+    reader.close();
+    return(elapsedSeconds(start));
+}
+
+
+static void benchmark(const char* mode, bool siteOnly, int numRecords)
+{
+    double vcfSeconds = readFile(VCF_FILE, siteOnly);
+    double bcfSeconds = readFile(BCF_FILE, siteOnly);
+    std::cout << std::setw(12) << mode << std::fixed << std::setprecision(1)
+              << std::setw(12) << numRecords / vcfSeconds / 1000
+              << std::setw(12) << numRecords / bcfSeconds / 1000
+              << std::setprecision(2)
+              << std::setw(12) << bcfSeconds / vcfSeconds << std::endl;
+}
+
+
+int main(int argc, char** argv)
+{
+    double thousands = 20;
+    int numSamples = 1000;
+    int opt;
+    while((opt = getopt(argc, argv, "n:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n':
+                thousands = atof(optarg);
+                break;
+            case 's':
+                numSamples = atoi(optarg);
+                break;
+            default:
+                std::cerr << "Usage: " << argv[0]
+                          << " [-n thousands of records] [-s samples]\n";
+                return(1);
+        }
+    }
+    int numRecords = (int)(thousands * 1000);
+    if(numSamples < 1)
+    {
+        numSamples = 1;
+    }
+    writeFiles(numRecords, numSamples);
+
+    std::cout << std::setw(12) << "mode"
+              << std::setw(12) << "VCF Krec/s"
+              << std::setw(12) << "BCF Krec/s"
+              << std::setw(12) << "BCF/VCF" << std::endl;
+
+    // All genotype fields, which BCF currently decodes to text and
+    // reparses.
+    VcfRecordGenotype::storeAllFields();
+    benchmark("all fields", false, numRecords);
+
+    // GT straight into the matrix.
+    VcfRecordGenotype::setGTMatrixMode(true);
+    benchmark("GT matrix", false, numRecords);
+    VcfRecordGenotype::setGTMatrixMode(false);
+
+    // Parse the samples on access, which the benchmark never does.
+    VcfRecordGenotype::setLazyMode(true);
+    benchmark("lazy", false, numRecords);
+    VcfRecordGenotype::setLazyMode(false);
+
+    benchmark("site only", true, numRecords);
+    return(0);
+}